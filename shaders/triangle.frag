@@ -1,10 +1,13 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
+// Set per pipeline variant
+layout(constant_id = 0) const float Brightness = 1.0;
+
 layout(location = 0) in vec3 FragColor;
 
 layout(location = 0) out vec4 outColor;
 
 void main() {
-    outColor = vec4(FragColor, 1.0);
-}
\ No newline at end of file
+    outColor = vec4(FragColor * Brightness, 1.0);
+}
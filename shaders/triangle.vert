@@ -15,6 +15,8 @@ layout(binding = 0) uniform MVP_UBO
 
 void main()
 {
-    gl_Position = mvp.proj * mvp.view * mvp.model * vec4(VertPos, 0.0, 1.0);
+    // Instances are laid out in rows of 64, with the first at the origin
+    vec2 offset = vec2(gl_InstanceIndex % 64, gl_InstanceIndex / 64) * 0.05;
+    gl_Position = mvp.proj * mvp.view * mvp.model * vec4(VertPos + offset, 0.0, 1.0);
     FragColor = VertColor;
 }
\ No newline at end of file
@@ -0,0 +1,178 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#include <array>
+#include <stdexcept>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "Renderer.h"
+#include "../vkc/Device.h"
+#include "../vkc/Vertex.h"
+#include "../vkc/CompactVertex.h"
+#include "../vkc/pipeline/ShaderDetails.h"
+#include "../vkc/profile/Profiler.h"
+
+namespace
+{
+    // Same quad the VulkanCube app draws
+    constexpr std::array<Vertex, 4> Vertices =
+            {
+                    Vertex{{-0.5f, -0.5f}, { 1.0f,  0.0f,  0.0f}},
+                    Vertex{{ 0.5f, -0.5f}, { 0.0f,  1.0f,  0.0f}},
+                    Vertex{{ 0.5f,  0.5f}, { 0.0f,  0.0f,  1.0f}},
+                    Vertex{{-0.5f,  0.5f}, { 1.0f,  1.0f,  1.0f}}
+            };
+    constexpr std::array<type::uint16, 6> Indices = {0, 1, 2, 2, 3, 0};
+
+    // Capacity of the shared geometry buffers, room for scenarios that add meshes of their own
+    // Indices are counted as 16 bit
+    constexpr type::uint32 GeometryVertices = 256 * 1024;
+    constexpr type::uint32 GeometryIndices = 3 * 256 * 1024;
+
+    auto AddQuad(vkc::GeometryPool& geometry) -> vkc::GeometryPool::Mesh
+    {
+        std::array<vkc::CompactVertex, Vertices.size()> compactVertices = {};
+        vkc::CompactVertex::Encode(Vertices, compactVertices);
+        return geometry.add(compactVertices.data(), compactVertices.size(), Indices.data(), Indices.size());
+    }
+
+    struct MVP
+    {
+        glm::mat4 model;
+        glm::mat4 view;
+        glm::mat4 proj;
+    };
+
+    using Layout = vkc::VertexLayout<vkc::VertexBinding<vkc::CompactVertex>>;
+
+    auto Shaders() -> std::vector<vkc::ShaderDetails>
+    {
+        return
+                {
+                        {
+                                .filePath = "shaders/triangle.vert.spv",
+                                .stage = VK_SHADER_STAGE_VERTEX_BIT
+                        },
+                        {
+                                .filePath = "shaders/triangle.frag.spv",
+                                .stage = VK_SHADER_STAGE_FRAGMENT_BIT
+                        }
+                };
+    }
+}
+
+vkc::bench::Renderer::Renderer(const vkc::Device& device, VkExtent2D extent, bool renderPass, VkSampleCountFlagBits samples) :
+        m_device(device),
+        m_target(device, extent, FramesInFlight),
+        m_geometry(device, sizeof(vkc::CompactVertex), GeometryVertices, GeometryIndices * sizeof(type::uint16)),
+        m_model(AddQuad(m_geometry)),
+        m_descriptors(device, FramesInFlight),
+        m_ubo(device, m_descriptors, sizeof(MVP), 0, FramesInFlight, VK_SHADER_STAGE_VERTEX_BIT),
+        m_renderPass(renderPass || !device.dynamicRendering() ? std::make_unique<vkc::RenderPass>(device, m_target, device.supportedSampleCount(samples)) : nullptr),
+        m_pipelineCache(device),
+        m_pipeline(device, m_target, m_renderPass.get(), m_descriptors.layouts(), Shaders(), Layout::BindingDescriptions, Layout::AttributeDescriptions, device.supportedSampleCount(samples), &m_pipelineCache),
+        m_syncObjects(device, FramesInFlight, FramesInFlight),
+        m_gpuTimer(device, FramesInFlight),
+        m_drawCmds(device, m_target, m_renderPass.get(), m_ubo, m_pipeline, m_geometry, m_model, &m_gpuTimer),
+        // Results are read back by the scenario instead of exported
+        m_stats(""),
+        m_currentFrame(0)
+{
+}
+
+vkc::bench::Renderer::~Renderer()
+{
+    m_device.vk().DeviceWaitIdle(m_device.logical());
+}
+
+auto vkc::bench::Renderer::drawFrame(const std::function<void(type::uint32 frameIndex)>& work) -> void
+{
+    VKC_ZONE("bench::Renderer::drawFrame");
+
+    {
+        vkc::profile::FrameStats::Scope cpuFrame(m_stats, vkc::profile::FrameStats::Metric::CpuFrame);
+
+        // One image per frame in flight, so the frame index is also the image index
+        {
+            vkc::profile::FrameStats::Scope wait(m_stats, vkc::profile::FrameStats::Metric::FenceWait);
+            m_device.vk().WaitForFences(m_device.logical(), 1, &m_syncObjects.inFlightFence(m_currentFrame), VK_TRUE, type::uint64_max);
+        }
+        if(auto gpuTime = m_gpuTimer.collect(m_currentFrame))
+        {
+            m_stats.add(vkc::profile::FrameStats::Metric::GpuFrame, *gpuTime);
+        }
+        m_descriptors.resetFrame(m_currentFrame);
+
+        if(work)
+        {
+            work(m_currentFrame);
+        }
+        // Work may have moved the buffers the frame draws with
+        m_ubo.refresh(m_currentFrame);
+        m_drawCmds.refresh(m_currentFrame);
+        updateUbo(m_currentFrame);
+
+        VkSubmitInfo submitInfo = {};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &m_drawCmds.command(m_currentFrame);
+
+        m_device.vk().ResetFences(m_device.logical(), 1, &m_syncObjects.inFlightFence(m_currentFrame));
+        if(m_device.vk().QueueSubmit(m_device.graphicsQueue(), 1, &submitInfo, m_syncObjects.inFlightFence(m_currentFrame)) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Command Buffer submission failed");
+        }
+        m_gpuTimer.markSubmitted(m_currentFrame);
+
+        m_currentFrame = (m_currentFrame + 1) % FramesInFlight;
+    }
+    m_stats.endFrame();
+}
+
+auto vkc::bench::Renderer::resize(VkExtent2D extent) -> void
+{
+    VKC_ZONE("bench::Renderer::resize");
+
+    m_device.vk().DeviceWaitIdle(m_device.logical());
+
+    std::unique_lock reloadLock = m_pipeline.lockReloads();
+    m_target.recreate(extent);
+    m_ubo.recreateDescriptorSets(FramesInFlight);
+    if(m_renderPass)
+    {
+        m_renderPass->recreate();
+    }
+    m_pipeline.recreate();
+    m_gpuTimer.recreate(FramesInFlight);
+    m_drawCmds.recreate();
+
+    if(m_renderPass)
+    {
+        m_renderPass->cleanupOld();
+    }
+}
+
+auto vkc::bench::Renderer::setDraws(type::uint32 drawCount, type::uint32 instanceCount) -> void
+{
+    m_device.vk().DeviceWaitIdle(m_device.logical());
+    m_drawCmds.setDraws(drawCount, instanceCount);
+}
+
+auto vkc::bench::Renderer::waitIdle() -> void
+{
+    m_device.vk().DeviceWaitIdle(m_device.logical());
+}
+
+auto vkc::bench::Renderer::updateUbo(type::uint32 index) -> void
+{
+    // Fixed transform so every run draws the same thing
+    MVP mvp = {};
+    mvp.model = glm::mat4(1.0f);
+    mvp.view = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+    mvp.proj = glm::perspective(glm::radians(45.0f), m_target.extent().width / static_cast<float>(m_target.extent().height), 0.1f, 10.0f);
+    mvp.proj[1][1] *= -1;
+
+    m_ubo.setContents(index, sizeof(mvp), 0, &mvp);
+}
@@ -0,0 +1,92 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#ifndef VULKANCUBE_BENCH_RENDERER_H
+#define VULKANCUBE_BENCH_RENDERER_H
+
+#include <functional>
+#include <memory>
+#include <span>
+#include <vulkan/vulkan.h>
+#include "../vkc/NonCopyable.h"
+#include "../vkc/Types.h"
+#include "../vkc/buffer/GeometryPool.h"
+#include "../vkc/buffer/UBO.h"
+#include "../vkc/descriptor/DescriptorAllocator.h"
+#include "../vkc/pipeline/OffscreenTarget.h"
+#include "../vkc/pipeline/RenderPass.h"
+#include "../vkc/pipeline/GraphicsPipeline.h"
+#include "../vkc/pipeline/PipelineCache.h"
+#include "../vkc/SyncObjects.h"
+#include "../vkc/command/DrawCommandBuffers.h"
+#include "../vkc/profile/FrameStats.h"
+#include "../vkc/profile/GpuTimer.h"
+
+namespace vkc::bench
+{
+    // Headless version of the VulkanCube frame loop that scenarios drive
+    // Each scenario gets its own renderer so frame statistics start empty
+    class Renderer : public NonCopyable
+    {
+    public:
+        static constexpr type::uint32 FramesInFlight = 2;
+
+        // Draws with dynamic rendering when the device supports it, unless renderPass is set
+        Renderer(const vkc::Device& device, VkExtent2D extent, bool renderPass = false, VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT);
+        ~Renderer();
+
+        // Renders one frame. work runs inside the measured CPU frame, after the
+        // frame's previous submission has completed and before this one is submitted
+        auto drawFrame(const std::function<void(type::uint32 frameIndex)>& work = {}) -> void;
+        // Same sequence the windowed app goes through when its swap chain is recreated
+        auto resize(VkExtent2D extent) -> void;
+        auto setDraws(type::uint32 drawCount, type::uint32 instanceCount) -> void;
+        auto waitIdle() -> void;
+
+        [[nodiscard]]
+        inline auto device() const -> const vkc::Device& { return m_device; }
+        [[nodiscard]]
+        inline auto stats() const -> const vkc::profile::FrameStats& { return m_stats; }
+        [[nodiscard]]
+        inline auto ubo() -> vkc::UBO& { return m_ubo; }
+        [[nodiscard]]
+        inline auto descriptors() -> vkc::DescriptorAllocator& { return m_descriptors; }
+        [[nodiscard]]
+        inline auto pipeline() -> vkc::GraphicsPipeline& { return m_pipeline; }
+        [[nodiscard]]
+        inline auto target() const -> const vkc::OffscreenTarget& { return m_target; }
+        // Fences of every frame that may still be in flight
+        [[nodiscard]]
+        inline auto inFlightFences() const -> std::span<const VkFence> { return m_syncObjects.inFlightFences(); }
+        [[nodiscard]]
+        inline auto geometry() -> vkc::GeometryPool& { return m_geometry; }
+        [[nodiscard]]
+        inline auto drawsPerFrame() const -> type::uint64 { return m_drawCmds.drawCount(); }
+
+    private:
+        const vkc::Device& m_device;
+
+        vkc::OffscreenTarget m_target;
+        vkc::GeometryPool m_geometry;
+        vkc::GeometryPool::Mesh m_model;
+        vkc::DescriptorAllocator m_descriptors;
+        vkc::UBO m_ubo;
+        // Null when drawing with dynamic rendering
+        std::unique_ptr<vkc::RenderPass> m_renderPass;
+        // In memory only, so every scenario compiles from scratch
+        vkc::PipelineCache m_pipelineCache;
+        vkc::GraphicsPipeline m_pipeline;
+        vkc::SyncObjects m_syncObjects;
+        vkc::profile::GpuTimer m_gpuTimer;
+        vkc::DrawCommandBuffers m_drawCmds;
+        vkc::profile::FrameStats m_stats;
+
+        type::uint32 m_currentFrame;
+
+        auto updateUbo(type::uint32 index) -> void;
+    };
+}
+
+#endif //VULKANCUBE_BENCH_RENDERER_H
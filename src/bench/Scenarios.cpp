@@ -0,0 +1,721 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <glm/glm.hpp>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+#include "Scenarios.h"
+#include "Renderer.h"
+#include "../vkc/CompactVertex.h"
+#include "../vkc/DeletionQueue.h"
+#include "../vkc/Device.h"
+#include "../vkc/Dispatch.h"
+#include "../vkc/Instance.h"
+#include "../vkc/Vertex.h"
+#include "../vkc/buffer/Buffer.h"
+#include "../vkc/command/CommandPool.h"
+#include "../vkc/descriptor/DescriptorWriter.h"
+#include "../vkc/graph/RenderGraph.h"
+#include "../vkc/image/Image.h"
+#include "../vkc/memory/Defragmenter.h"
+#include "../vkc/memory/MemoryPool.h"
+#include "../vkc/mesh/MeshFile.h"
+#include "../vkc/mesh/MeshOptimizer.h"
+#include "../vkc/pipeline/PipelineVariant.h"
+
+namespace
+{
+    using Metric = vkc::profile::FrameStats::Metric;
+
+    auto ToMs(type::uint64 ns) -> double
+    {
+        return static_cast<double>(ns) / 1'000'000.0;
+    }
+
+    // Peak resident set of the whole process, so it only grows from one scenario to the next
+    auto PeakRssKb() -> type::uint64
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        rusage usage = {};
+        getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+        return static_cast<type::uint64>(usage.ru_maxrss) / 1024;
+#else
+        return static_cast<type::uint64>(usage.ru_maxrss);
+#endif
+#else
+        return 0;
+#endif
+    }
+
+    // Renders the configured number of frames and collects the results
+    auto Run(
+            vkc::bench::Renderer& renderer,
+            const vkc::bench::Settings& settings,
+            const std::function<void(type::uint32 frame, type::uint32 frameIndex)>& work = {}
+            ) -> vkc::bench::ScenarioResult
+    {
+        vkc::bench::ScenarioResult result;
+
+        auto start = std::chrono::steady_clock::now();
+        for(type::uint32 frame = 0; frame < settings.frames; ++frame)
+        {
+            if(work)
+            {
+                renderer.drawFrame([&work, frame](type::uint32 frameIndex) { work(frame, frameIndex); });
+            }
+            else
+            {
+                renderer.drawFrame();
+            }
+            result.drawCalls += renderer.drawsPerFrame();
+        }
+        // Include the tail of GPU work still in flight
+        renderer.waitIdle();
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        const auto& stats = renderer.stats();
+        result.frames = stats.frames();
+        result.cpuP50Ms = ToMs(stats.histogram(Metric::CpuFrame).percentile(50.0));
+        result.cpuP99Ms = ToMs(stats.histogram(Metric::CpuFrame).percentile(99.0));
+        result.gpuP50Ms = ToMs(stats.histogram(Metric::GpuFrame).percentile(50.0));
+        result.gpuP99Ms = ToMs(stats.histogram(Metric::GpuFrame).percentile(99.0));
+
+        std::ostringstream json;
+        stats.writeJson(json);
+        result.frameStats = json.str();
+
+        // Taken before the scenario's resources are freed
+        std::ostringstream memory;
+        renderer.device().memorySnapshot(8).writeJson(memory);
+        result.deviceMemory = memory.str();
+        return result;
+    }
+
+    // One draw of settings.count instances
+    auto InstancedCubes(const vkc::Device& device, const vkc::bench::Settings& settings) -> vkc::bench::ScenarioResult
+    {
+        vkc::bench::Renderer renderer(device, settings.extent, settings.renderPass, settings.samples);
+        renderer.setDraws(1, settings.count);
+        return Run(renderer, settings);
+    }
+
+    // settings.count draws of one instance each, the CPU cost of recording and submitting draws
+    auto IndividualDraws(const vkc::Device& device, const vkc::bench::Settings& settings) -> vkc::bench::ScenarioResult
+    {
+        vkc::bench::Renderer renderer(device, settings.extent, settings.renderPass, settings.samples);
+        renderer.setDraws(settings.count, 1);
+        return Run(renderer, settings);
+    }
+
+    // Rewrites the frame's uniform buffer settings.count times per frame
+    auto UniformChurn(const vkc::Device& device, const vkc::bench::Settings& settings) -> vkc::bench::ScenarioResult
+    {
+        vkc::bench::Renderer renderer(device, settings.extent, settings.renderPass, settings.samples);
+        std::array<glm::mat4, 3> mvp = {glm::mat4(1.0f), glm::mat4(1.0f), glm::mat4(1.0f)};
+        return Run(renderer, settings, [&renderer, &settings, &mvp](type::uint32 frame, type::uint32 frameIndex)
+        {
+            for(type::uint32 i = 0; i < settings.count; ++i)
+            {
+                mvp[0][3][0] = static_cast<float>(frame + i);
+                renderer.ubo().setContents(frameIndex, sizeof(mvp), 0, mvp.data());
+            }
+        });
+    }
+
+    // Recreates the render target and everything that depends on it every few frames
+    auto ResizeStorm(const vkc::Device& device, const vkc::bench::Settings& settings) -> vkc::bench::ScenarioResult
+    {
+        constexpr type::uint32 resizeInterval = 8;
+
+        vkc::bench::Renderer renderer(device, settings.extent, settings.renderPass, settings.samples);
+        VkExtent2D full = settings.extent;
+        VkExtent2D half = {std::max(1u, full.width / 2), std::max(1u, full.height / 2)};
+        return Run(renderer, settings, [&renderer, full, half](type::uint32 frame, type::uint32)
+        {
+            if(frame % resizeInterval == resizeInterval - 1)
+            {
+                renderer.resize((frame / resizeInterval) % 2 == 0 ? half : full);
+            }
+        });
+    }
+
+    // Uploads a device local buffer every frame, through its staging buffer when staged, otherwise
+    // only when the device can't write device local memory directly
+    auto Upload(const vkc::Device& device, const vkc::bench::Settings& settings, bool staged) -> vkc::bench::ScenarioResult
+    {
+        constexpr VkDeviceSize uploadSize = 16 * 1024 * 1024;
+
+        vkc::bench::Renderer renderer(device, settings.extent, settings.renderPass, settings.samples);
+        std::unique_ptr<vkc::Buffer> buffer = staged ?
+                std::make_unique<vkc::Buffer>(device, uploadSize,
+                        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_SHARING_MODE_EXCLUSIVE,
+                        true
+                        ) :
+                std::make_unique<vkc::Buffer>(device, uploadSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, vkc::MemoryUsage::GpuOnly);
+        std::vector<std::byte> data(uploadSize, std::byte{0x5A});
+
+        double uploadSeconds = 0.0;
+        type::uint64 uploadedBytes = 0;
+        vkc::bench::ScenarioResult result = Run(renderer, settings,
+                [&buffer, &data, &uploadSeconds, &uploadedBytes](type::uint32, type::uint32)
+        {
+            auto start = std::chrono::steady_clock::now();
+            buffer->setContents(uploadSize, 0, data.data());
+            uploadSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            uploadedBytes += uploadSize;
+        });
+        result.uploadSeconds = uploadSeconds;
+        result.uploadedBytes = uploadedBytes;
+        result.directUpload = !buffer->staged();
+        return result;
+    }
+
+    auto StagingUpload(const vkc::Device& device, const vkc::bench::Settings& settings) -> vkc::bench::ScenarioResult
+    {
+        return Upload(device, settings, true);
+    }
+
+    auto PolicyUpload(const vkc::Device& device, const vkc::bench::Settings& settings) -> vkc::bench::ScenarioResult
+    {
+        return Upload(device, settings, false);
+    }
+
+    // Records settings.count state commands per frame into a command buffer that is never submitted
+    // Only the cost of dispatching the commands is measured, calling through the given function
+    auto RecordCalls(
+            const vkc::Device& device,
+            const vkc::bench::Settings& settings,
+            PFN_vkCmdBindVertexBuffers bindVertexBuffers
+            ) -> vkc::bench::ScenarioResult
+    {
+        const vkc::DeviceDispatch& vk = device.vk();
+
+        vkc::bench::Renderer renderer(device, settings.extent, settings.renderPass, settings.samples);
+        vkc::Buffer buffer(device, 256,
+                VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VK_SHARING_MODE_EXCLUSIVE,
+                false
+                );
+        vkc::CommandPool pool(device, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+
+        VkCommandBufferAllocateInfo allocInfo = {};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = pool.handle();
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandBufferCount = 1;
+
+        VkCommandBuffer cmd;
+        if(vk.AllocateCommandBuffers(device.logical(), &allocInfo, &cmd) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Command buffer allocation failed");
+        }
+
+        double recordSeconds = 0.0;
+        type::uint64 recordedCalls = 0;
+        vkc::bench::ScenarioResult result = Run(renderer, settings,
+                [&](type::uint32, type::uint32)
+        {
+            VkCommandBufferBeginInfo beginInfo = {};
+            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+            vk.ResetCommandPool(device.logical(), pool.handle(), 0);
+            vk.BeginCommandBuffer(cmd, &beginInfo);
+            auto start = std::chrono::steady_clock::now();
+            for(type::uint32 i = 0; i < settings.count; ++i)
+            {
+                VkDeviceSize offset = (i % 16) * 16;
+                bindVertexBuffers(cmd, 0, 1, &buffer.handle(), &offset);
+            }
+            recordSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            vk.EndCommandBuffer(cmd);
+            recordedCalls += settings.count;
+        });
+        result.recordSeconds = recordSeconds;
+        result.recordedCalls = recordedCalls;
+        return result;
+    }
+
+    // Commands looked up through the instance resolve to the loader's trampolines
+    auto RecordLoader(const vkc::Device& device, const vkc::bench::Settings& settings) -> vkc::bench::ScenarioResult
+    {
+        auto bindVertexBuffers = reinterpret_cast<PFN_vkCmdBindVertexBuffers>(
+                vkc::GlobalDispatch::Get().GetInstanceProcAddr(device.instance().handle(), "vkCmdBindVertexBuffers"));
+        return RecordCalls(device, settings, bindVertexBuffers);
+    }
+
+    // Commands loaded from the device go straight to the driver
+    auto RecordDirect(const vkc::Device& device, const vkc::bench::Settings& settings) -> vkc::bench::ScenarioResult
+    {
+        return RecordCalls(device, settings, device.vk().CmdBindVertexBuffers);
+    }
+
+    // Two uniform buffers per set, laid out the way the update template reads them
+    struct ObjectBindings
+    {
+        VkDescriptorBufferInfo transform;
+        VkDescriptorBufferInfo material;
+    };
+
+    // Allocates settings.count transient sets per frame and points each at its own slice of a buffer
+    auto UpdateDescriptors(
+            const vkc::Device& device,
+            const vkc::bench::Settings& settings,
+            bool useTemplate
+            ) -> vkc::bench::ScenarioResult
+    {
+        constexpr VkDeviceSize sliceSize = 256;
+
+        vkc::bench::Renderer renderer(device, settings.extent, settings.renderPass, settings.samples);
+        vkc::Buffer buffer(device, sliceSize * 64,
+                VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VK_SHARING_MODE_EXCLUSIVE,
+                false
+                );
+
+        VkDescriptorSetLayoutBinding binding = {};
+        binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        binding.descriptorCount = 1;
+        binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        VkDescriptorSetLayoutBinding materialBinding = binding;
+        materialBinding.binding = 1;
+        VkDescriptorSetLayout layout = renderer.descriptors().layouts().get({binding, materialBinding});
+
+        vkc::DescriptorUpdateTemplate updateTemplate(device, layout,
+                {
+                        {0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, offsetof(ObjectBindings, transform)},
+                        {1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, offsetof(ObjectBindings, material)}
+                });
+        vkc::DescriptorWriter writer(device);
+
+        double descriptorSeconds = 0.0;
+        type::uint64 descriptorSetUpdates = 0;
+        vkc::bench::ScenarioResult result = Run(renderer, settings,
+                [&](type::uint32, type::uint32 frameIndex)
+        {
+            auto start = std::chrono::steady_clock::now();
+            for(type::uint32 i = 0; i < settings.count; ++i)
+            {
+                VkDescriptorSet set = renderer.descriptors().allocateTransient(frameIndex, layout);
+                VkDeviceSize offset = (i % 64) * sliceSize;
+                if(useTemplate)
+                {
+                    ObjectBindings bindings = {{buffer.handle(), offset, sliceSize}, {buffer.handle(), 0, sliceSize}};
+                    updateTemplate.update(set, bindings);
+                }
+                else
+                {
+                    writer.writeBuffer(set, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, buffer.handle(), offset, sliceSize);
+                    writer.writeBuffer(set, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, buffer.handle(), 0, sliceSize);
+                }
+            }
+            writer.flush();
+            descriptorSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            descriptorSetUpdates += settings.count;
+        });
+        result.descriptorSeconds = descriptorSeconds;
+        result.descriptorSetUpdates = descriptorSetUpdates;
+        return result;
+    }
+
+    auto DescriptorWrites(const vkc::Device& device, const vkc::bench::Settings& settings) -> vkc::bench::ScenarioResult
+    {
+        return UpdateDescriptors(device, settings, false);
+    }
+
+    auto DescriptorTemplates(const vkc::Device& device, const vkc::bench::Settings& settings) -> vkc::bench::ScenarioResult
+    {
+        return UpdateDescriptors(device, settings, true);
+    }
+
+    // Scene pass followed by a chain of full screen post passes, each reading the previous one's output,
+    // then copied into an image outside the graph. Only the graph's barriers are recorded, into a
+    // command buffer that is never submitted, and the passes themselves record nothing
+    auto GraphPostChain(const vkc::Device& device, const vkc::bench::Settings& settings) -> vkc::bench::ScenarioResult
+    {
+        using Graph = vkc::RenderGraph;
+        constexpr type::uint32 chainLength = 8;
+        constexpr VkFormat format = VK_FORMAT_R8G8B8A8_UNORM;
+        const vkc::DeviceDispatch& vk = device.vk();
+        auto noCommands = [](VkCommandBuffer, const Graph&) {};
+
+        vkc::bench::Renderer renderer(device, settings.extent, settings.renderPass, settings.samples);
+        vkc::Image output(device, settings.extent, format,
+                VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                VK_IMAGE_ASPECT_COLOR_BIT
+                );
+        vkc::CommandPool pool(device, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+
+        Graph graph(device);
+        Graph::Resource image = graph.createImage("scene", {format, settings.extent});
+        graph.addPass("scene", [&](Graph::PassBuilder& pass) { image = pass.write(image, vkc::ImageUsage::ColorAttachment); }, noCommands);
+        for(type::uint32 i = 0; i < chainLength; ++i)
+        {
+            Graph::Resource next = graph.createImage("post" + std::to_string(i), {format, settings.extent});
+            graph.addPass("post" + std::to_string(i), [&](Graph::PassBuilder& pass)
+            {
+                pass.read(image, vkc::ImageUsage::Sampled);
+                next = pass.write(next, vkc::ImageUsage::ColorAttachment);
+            }, noCommands);
+            image = next;
+        }
+        // Nothing reads its output, so it's culled and its image never created
+        Graph::Resource debug = graph.createImage("debug", {format, settings.extent});
+        graph.addPass("debug", [&](Graph::PassBuilder& pass)
+        {
+            pass.read(image, vkc::ImageUsage::Sampled);
+            pass.write(debug, vkc::ImageUsage::ColorAttachment);
+        }, noCommands);
+
+        Graph::ImportDesc outputDesc = {};
+        outputDesc.format = format;
+        outputDesc.extent = settings.extent;
+        Graph::Resource result = graph.importImage("output", outputDesc);
+        graph.addPass("copy", [&](Graph::PassBuilder& pass)
+        {
+            pass.read(image, vkc::ImageUsage::TransferSrc);
+            pass.write(result, vkc::ImageUsage::TransferDst);
+        }, noCommands);
+        graph.setImported(result, output.handle(), output.view());
+        graph.compile();
+
+        VkCommandBufferAllocateInfo allocInfo = {};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = pool.handle();
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandBufferCount = 1;
+
+        VkCommandBuffer cmd;
+        if(vk.AllocateCommandBuffers(device.logical(), &allocInfo, &cmd) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Command buffer allocation failed");
+        }
+
+        double recordSeconds = 0.0;
+        type::uint64 recordedCalls = 0;
+        vkc::bench::ScenarioResult scenarioResult = Run(renderer, settings,
+                [&](type::uint32, type::uint32)
+        {
+            VkCommandBufferBeginInfo beginInfo = {};
+            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+            vk.ResetCommandPool(device.logical(), pool.handle(), 0);
+            vk.BeginCommandBuffer(cmd, &beginInfo);
+            auto start = std::chrono::steady_clock::now();
+            graph.execute(cmd);
+            recordSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            vk.EndCommandBuffer(cmd);
+            recordedCalls += graph.barrierBatches();
+        });
+        scenarioResult.recordSeconds = recordSeconds;
+        scenarioResult.recordedCalls = recordedCalls;
+        scenarioResult.transientBytes = graph.transientMemory();
+        scenarioResult.unaliasedTransientBytes = graph.unaliasedMemory();
+        return scenarioResult;
+    }
+
+    // Warms up settings.count variants of the cube pipeline, at most 256, before rendering
+    // Variants differ in the fragment shader's brightness constant, cull mode and blending
+    auto PipelineVariants(const vkc::Device& device, const vkc::bench::Settings& settings) -> vkc::bench::ScenarioResult
+    {
+        constexpr type::uint32 maxVariants = 256;
+
+        vkc::bench::Renderer renderer(device, settings.extent, settings.renderPass, settings.samples);
+        std::vector<vkc::PipelineVariant> variants(std::min(settings.count, maxVariants));
+        for(type::uint32 i = 0; i < variants.size(); ++i)
+        {
+            variants[i].constants = {vkc::SpecializationConstant::Float(0, static_cast<float>(i + 1) / static_cast<float>(variants.size()))};
+            variants[i].cullMode = i % 2 == 0 ? VK_CULL_MODE_BACK_BIT : VK_CULL_MODE_NONE;
+            variants[i].blend = i % 4 >= 2;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        renderer.pipeline().warmUp(variants);
+        double compileSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        vkc::bench::ScenarioResult result = Run(renderer, settings);
+        result.pipelineVariants = variants.size();
+        result.compileSeconds = compileSeconds;
+        return result;
+    }
+
+    // Adds settings.count quads, at most 16384, to the renderer's shared geometry buffers before rendering
+    // Every mesh lands in the same two buffers, so drawing any of them binds nothing new
+    auto GeometryMeshes(const vkc::Device& device, const vkc::bench::Settings& settings) -> vkc::bench::ScenarioResult
+    {
+        constexpr type::uint32 maxMeshes = 16 * 1024;
+
+        vkc::bench::Renderer renderer(device, settings.extent, settings.renderPass, settings.samples);
+        std::array<vkc::CompactVertex, 4> vertices = {};
+        constexpr std::array<type::uint16, 6> indices = {0, 1, 2, 2, 3, 0};
+        type::uint32 meshCount = std::min(settings.count, maxMeshes);
+
+        std::vector<vkc::GeometryPool::Mesh> meshes;
+        meshes.reserve(meshCount);
+        auto start = std::chrono::steady_clock::now();
+        for(type::uint32 i = 0; i < meshCount; ++i)
+        {
+            meshes.push_back(renderer.geometry().add(vertices.data(), vertices.size(), indices.data(), indices.size()));
+        }
+        double uploadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        vkc::bench::ScenarioResult result = Run(renderer, settings);
+        result.uploadedBytes = meshCount * (sizeof(vertices) + sizeof(indices));
+        result.uploadSeconds = uploadSeconds;
+        for(const vkc::GeometryPool::Mesh& mesh : meshes)
+        {
+            renderer.geometry().remove(mesh);
+        }
+        return result;
+    }
+
+    // Keeps settings.count buffers of 4KiB to 1MiB alive, at most 1024, and replaces a sixteenth of them
+    // every frame, while the defragmenter compacts the pool. Half are GPU only and moved with transfers,
+    // half are host visible and moved by the host
+    auto DefragChurn(const vkc::Device& device, const vkc::bench::Settings& settings) -> vkc::bench::ScenarioResult
+    {
+        constexpr type::uint32 maxBuffers = 1024;
+
+        vkc::bench::Renderer renderer(device, settings.extent, settings.renderPass, settings.samples);
+        std::vector<std::unique_ptr<vkc::Buffer>> buffers(std::max(1u, std::min(settings.count, maxBuffers)));
+        // Same sequence every run
+        std::mt19937 random(1234);
+        std::uniform_int_distribution<VkDeviceSize> sizes(4 * 1024, 1024 * 1024);
+        std::uniform_int_distribution<type::size> pick(0, buffers.size() - 1);
+
+        auto create = [&device, &random, &sizes](type::size i) -> std::unique_ptr<vkc::Buffer>
+        {
+            vkc::MemoryUsage usage = i % 2 == 0 ? vkc::MemoryUsage::GpuOnly : vkc::MemoryUsage::Dynamic;
+            return std::make_unique<vkc::Buffer>(device, sizes(random), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, usage, "churn");
+        };
+        for(type::size i = 0; i < buffers.size(); ++i)
+        {
+            buffers[i] = create(i);
+        }
+
+        vkc::DeletionQueue deletions(device);
+        vkc::Defragmenter defragmenter(device);
+        vkc::bench::ScenarioResult result = Run(renderer, settings, [&](type::uint32, type::uint32)
+        {
+            deletions.collect();
+            for(type::size n = 0; n < std::max<type::size>(1, buffers.size() / 16); ++n)
+            {
+                // The defragmenter may still be copying into it
+                type::size i = pick(random);
+                deletions.retire(renderer.inFlightFences(), [buffer = buffers[i].release()]() { delete buffer; });
+                buffers[i] = create(i);
+            }
+            defragmenter.step(deletions, renderer.inFlightFences());
+        });
+        result.movedBytes = defragmenter.movedBytes();
+        result.defragMoves = defragmenter.moves();
+        result.memoryBlocks = device.memoryPool().blockCount();
+        result.poolFragmentation = device.memoryPool().fragmentation();
+        return result;
+    }
+
+    // Grid of the given number of triangles, rounded down to a square of cells, in shuffled order
+    struct Grid
+    {
+        std::vector<Vertex> vertices;
+        // Folded, so some of the grid faces away from the rest
+        std::vector<glm::vec3> positions;
+        std::vector<type::uint32> indices;
+    };
+
+    auto ShuffledGrid(type::uint32 triangleCount) -> Grid
+    {
+        // Two triangles per cell
+        auto cells = static_cast<type::uint32>(std::sqrt(static_cast<double>(std::max(2u, triangleCount)) / 2.0));
+        Grid grid;
+        for(type::uint32 y = 0; y <= cells; ++y)
+        {
+            for(type::uint32 x = 0; x <= cells; ++x)
+            {
+                glm::vec2 pos(static_cast<float>(x) / static_cast<float>(cells) - 0.5f, static_cast<float>(y) / static_cast<float>(cells) - 0.5f);
+                grid.vertices.push_back(Vertex{pos, {pos.x + 0.5f, pos.y + 0.5f, 1.0f}});
+                grid.positions.emplace_back(pos.x, pos.y, std::sin(pos.x * 6.0f) * 0.25f);
+            }
+        }
+        std::vector<std::array<type::uint32, 3>> triangles;
+        for(type::uint32 y = 0; y < cells; ++y)
+        {
+            for(type::uint32 x = 0; x < cells; ++x)
+            {
+                type::uint32 corner = y * (cells + 1) + x;
+                triangles.push_back({corner, corner + cells + 1, corner + 1});
+                triangles.push_back({corner + 1, corner + cells + 1, corner + cells + 2});
+            }
+        }
+        // Same order every run, and nothing like the order they were generated in
+        std::mt19937 random(1234);
+        std::shuffle(triangles.begin(), triangles.end(), random);
+        grid.indices.reserve(triangles.size() * 3);
+        for(const std::array<type::uint32, 3>& triangle : triangles)
+        {
+            grid.indices.insert(grid.indices.end(), triangle.begin(), triangle.end());
+        }
+        return grid;
+    }
+
+    // Shuffled grid of settings.count triangles, at most 65536, optimized for the vertex cache,
+    // overdraw and vertex fetch, then packed and added to the renderer's shared geometry buffers
+    auto MeshOptimize(const vkc::Device& device, const vkc::bench::Settings& settings) -> vkc::bench::ScenarioResult
+    {
+        constexpr type::uint32 maxTriangles = 64 * 1024;
+
+        vkc::bench::Renderer renderer(device, settings.extent, settings.renderPass, settings.samples);
+        Grid grid = ShuffledGrid(std::min(settings.count, maxTriangles));
+
+        auto start = std::chrono::steady_clock::now();
+        vkc::mesh::OptimizeResult optimized = vkc::mesh::Optimize(grid.indices, grid.positions, device.indexTypeUint8());
+        std::vector<Vertex> remapped = vkc::mesh::Remap<Vertex>(grid.vertices, optimized.remap);
+        double optimizeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::vector<vkc::CompactVertex> compactVertices(remapped.size());
+        vkc::CompactVertex::Encode(remapped, compactVertices);
+        std::vector<std::byte> packed = vkc::mesh::PackIndices(grid.indices, optimized.indexType);
+        vkc::GeometryPool::Mesh mesh = renderer.geometry().add(compactVertices.data(), optimized.vertexCount, packed.data(), grid.indices.size(), optimized.indexType);
+
+        vkc::bench::ScenarioResult result = Run(renderer, settings);
+        result.uploadedBytes = compactVertices.size() * sizeof(vkc::CompactVertex) + packed.size();
+        result.acmrBefore = optimized.acmrBefore;
+        result.acmrAfter = optimized.acmrAfter;
+        result.optimizeSeconds = optimizeSeconds;
+        renderer.geometry().remove(mesh);
+        return result;
+    }
+
+    // Writes a mesh file of 16 grids of settings.count / 16 triangles, at most 65536 in all, then times
+    // mapping it and uploading every mesh into the renderer's shared geometry buffers before rendering
+    // The file is written just before, so it's read from the page cache rather than the disk
+    auto MeshFileLoad(const vkc::Device& device, const vkc::bench::Settings& settings) -> vkc::bench::ScenarioResult
+    {
+        constexpr type::uint32 maxTriangles = 64 * 1024;
+        constexpr type::uint32 meshCount = 16;
+        const std::string path = "bench_meshes.vkm";
+
+        vkc::bench::Renderer renderer(device, settings.extent, settings.renderPass, settings.samples);
+        Grid grid = ShuffledGrid(std::min(settings.count, maxTriangles) / meshCount);
+        std::vector<vkc::CompactVertex> compactVertices(grid.vertices.size());
+        vkc::CompactVertex::Encode(grid.vertices, compactVertices);
+
+        vkc::mesh::MeshData data;
+        data.vertexCount = static_cast<type::uint32>(compactVertices.size());
+        data.vertices.resize(compactVertices.size() * sizeof(vkc::CompactVertex));
+        std::memcpy(data.vertices.data(), compactVertices.data(), data.vertices.size());
+        data.indexType = vkc::mesh::IndexTypeFor(data.vertexCount, false);
+        data.indices = vkc::mesh::PackIndices(grid.indices, data.indexType);
+        data.indexCount = static_cast<type::uint32>(grid.indices.size());
+        data.boundsMin = glm::vec3(-0.5f, -0.5f, -0.25f);
+        data.boundsMax = glm::vec3(0.5f, 0.5f, 0.25f);
+        std::vector<vkc::mesh::MeshData> meshes(meshCount, data);
+        vkc::mesh::WriteMeshFile(path, vkc::mesh::MeshVertexFormat::Compact, meshes);
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<vkc::GeometryPool::Mesh> uploaded;
+        type::uint64 uploadedBytes = 0;
+        {
+            vkc::mesh::MeshFile file(path);
+            uploaded = file.upload(renderer.geometry());
+            uploadedBytes = file.vertexData().size() + file.indexData().size();
+        }
+        double uploadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::remove(path.c_str());
+
+        vkc::bench::ScenarioResult result = Run(renderer, settings);
+        result.uploadedBytes = uploadedBytes;
+        result.uploadSeconds = uploadSeconds;
+        for(const vkc::GeometryPool::Mesh& mesh : uploaded)
+        {
+            renderer.geometry().remove(mesh);
+        }
+        return result;
+    }
+}
+
+auto vkc::bench::Scenarios() -> const std::vector<Scenario>&
+{
+    static const std::vector<Scenario> scenarios =
+            {
+                    {"instanced_cubes", "count instances in a single draw", InstancedCubes},
+                    {"individual_draws", "count draws of a single instance", IndividualDraws},
+                    {"uniform_churn", "count uniform buffer writes per frame", UniformChurn},
+                    {"resize_storm", "render target recreated every 8 frames", ResizeStorm},
+                    {"staging_upload", "16MiB staged upload per frame", StagingUpload},
+                    {"policy_upload", "16MiB upload per frame, written directly when the device allows it", PolicyUpload},
+                    {"record_loader", "count commands recorded per frame through the loader trampoline", RecordLoader},
+                    {"record_direct", "count commands recorded per frame through the device dispatch table", RecordDirect},
+                    {"descriptor_writes", "count transient sets per frame updated in one vkUpdateDescriptorSets", DescriptorWrites},
+                    {"descriptor_templates", "count transient sets per frame updated from a packed struct with an update template", DescriptorTemplates},
+                    {"graph_post_chain", "render graph of a scene pass and 8 post passes with aliased transient images", GraphPostChain},
+                    {"pipeline_variants", "count pipeline variants, at most 256, compiled in parallel into a shared cache", PipelineVariants},
+                    {"geometry_meshes", "count quads, at most 16384, added to the shared geometry buffers", GeometryMeshes},
+                    {"defrag_churn", "count buffers, at most 1024, a sixteenth replaced per frame while the pool is defragmented", DefragChurn},
+                    {"mesh_optimize", "count triangles, at most 65536, of a shuffled grid optimized and packed into the shared geometry buffers", MeshOptimize},
+                    {"mesh_file_load", "count triangles, at most 65536, in 16 meshes mapped from a mesh file and uploaded in one batch", MeshFileLoad}
+            };
+    return scenarios;
+}
+
+auto vkc::bench::WriteResult(std::ostream& out, const Scenario& scenario, const Settings& settings, const ScenarioResult& result) -> void
+{
+    double drawCallsPerSecond = result.seconds > 0.0 ? static_cast<double>(result.drawCalls) / result.seconds : 0.0;
+    double uploadMBps = result.uploadSeconds > 0.0 ? static_cast<double>(result.uploadedBytes) / (1024.0 * 1024.0) / result.uploadSeconds : 0.0;
+    double nsPerRecordedCall = result.recordedCalls > 0 ? result.recordSeconds * 1e9 / static_cast<double>(result.recordedCalls) : 0.0;
+    double nsPerDescriptorSet = result.descriptorSetUpdates > 0 ? result.descriptorSeconds * 1e9 / static_cast<double>(result.descriptorSetUpdates) : 0.0;
+    double msPerVariant = result.pipelineVariants > 0 ? result.compileSeconds * 1e3 / static_cast<double>(result.pipelineVariants) : 0.0;
+
+    out << "{\"name\": \"" << scenario.name << "\""
+        << ", \"description\": \"" << scenario.description << "\""
+        << ", \"count\": " << settings.count
+        << ", \"frames\": " << result.frames
+        << ", \"seconds\": " << result.seconds
+        << ", \"cpuFrameP50Ms\": " << result.cpuP50Ms
+        << ", \"cpuFrameP99Ms\": " << result.cpuP99Ms
+        << ", \"gpuFrameP50Ms\": " << result.gpuP50Ms
+        << ", \"gpuFrameP99Ms\": " << result.gpuP99Ms
+        << ", \"drawCalls\": " << result.drawCalls
+        << ", \"drawCallsPerSecond\": " << drawCallsPerSecond
+        << ", \"uploadedBytes\": " << result.uploadedBytes
+        << ", \"uploadMBps\": " << uploadMBps
+        << ", \"directUpload\": " << (result.directUpload ? "true" : "false")
+        << ", \"recordedCalls\": " << result.recordedCalls
+        << ", \"nsPerRecordedCall\": " << nsPerRecordedCall
+        << ", \"descriptorSetUpdates\": " << result.descriptorSetUpdates
+        << ", \"nsPerDescriptorSet\": " << nsPerDescriptorSet
+        << ", \"transientBytes\": " << result.transientBytes
+        << ", \"unaliasedTransientBytes\": " << result.unaliasedTransientBytes
+        << ", \"pipelineVariants\": " << result.pipelineVariants
+        << ", \"compileSeconds\": " << result.compileSeconds
+        << ", \"msPerVariant\": " << msPerVariant
+        << ", \"movedBytes\": " << result.movedBytes
+        << ", \"defragMoves\": " << result.defragMoves
+        << ", \"memoryBlocks\": " << result.memoryBlocks
+        << ", \"poolFragmentation\": " << result.poolFragmentation
+        << ", \"acmrBefore\": " << result.acmrBefore
+        << ", \"acmrAfter\": " << result.acmrAfter
+        << ", \"optimizeSeconds\": " << result.optimizeSeconds
+        << ", \"processPeakRssKb\": " << PeakRssKb()
+        << ", \"deviceMemory\": " << result.deviceMemory
+        << ", \"frameStats\": " << result.frameStats << "}";
+}
@@ -0,0 +1,88 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#ifndef VULKANCUBE_BENCH_SCENARIOS_H
+#define VULKANCUBE_BENCH_SCENARIOS_H
+
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.h>
+#include "../vkc/Types.h"
+
+namespace vkc
+{
+    class Device;
+}
+
+namespace vkc::bench
+{
+    struct Settings
+    {
+        type::uint32 frames = 1000;
+        VkExtent2D extent = {1280, 720};
+        // Number of cubes, draws or writes per frame, depending on the scenario
+        type::uint32 count = 4096;
+        // Draw through a render pass and framebuffers even when dynamic rendering is available
+        bool renderPass = false;
+        // Samples per pixel, lowered to what the device supports
+        VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+    };
+
+    struct ScenarioResult
+    {
+        type::uint64 frames = 0;
+        double seconds = 0.0;
+        type::uint64 drawCalls = 0;
+        // Only set by scenarios that upload
+        type::uint64 uploadedBytes = 0;
+        double uploadSeconds = 0.0;
+        // Whether the upload skipped staging
+        bool directUpload = false;
+        // Only set by scenarios that time command recording
+        type::uint64 recordedCalls = 0;
+        double recordSeconds = 0.0;
+        // Only set by scenarios that update descriptor sets
+        type::uint64 descriptorSetUpdates = 0;
+        double descriptorSeconds = 0.0;
+        // Only set by scenarios that compile a render graph
+        type::uint64 transientBytes = 0;
+        type::uint64 unaliasedTransientBytes = 0;
+        // Only set by scenarios that compile pipelines
+        type::uint64 pipelineVariants = 0;
+        double compileSeconds = 0.0;
+        // Only set by scenarios that defragment
+        type::uint64 movedBytes = 0;
+        type::uint64 defragMoves = 0;
+        type::uint64 memoryBlocks = 0;
+        double poolFragmentation = 0.0;
+        // Only set by scenarios that optimize meshes
+        double acmrBefore = 0.0;
+        double acmrAfter = 0.0;
+        double optimizeSeconds = 0.0;
+        // FrameStats JSON of the run
+        std::string frameStats;
+        // MemorySnapshot JSON at the end of the run
+        std::string deviceMemory;
+        double cpuP50Ms = 0.0;
+        double cpuP99Ms = 0.0;
+        double gpuP50Ms = 0.0;
+        double gpuP99Ms = 0.0;
+    };
+
+    struct Scenario
+    {
+        type::cstr name;
+        type::cstr description;
+        std::function<ScenarioResult(const vkc::Device&, const Settings&)> run;
+    };
+
+    auto Scenarios() -> const std::vector<Scenario>&;
+
+    auto WriteResult(std::ostream& out, const Scenario& scenario, const Settings& settings, const ScenarioResult& result) -> void;
+}
+
+#endif //VULKANCUBE_BENCH_SCENARIOS_H
@@ -0,0 +1,131 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Scenarios.h"
+#include "../vkc/Instance.h"
+#include "../vkc/DebugUtilsMessenger.h"
+#include "../vkc/Device.h"
+#include "../vkc/profile/Profiler.h"
+
+// Runs every scenario (or those picked with --scenario) headless and writes the results as JSON
+// Usage: vkc_bench [--frames N] [--size WxH] [--count N] [--scenario name]... [--out path] [--validation] [--render-pass] [--msaa N]
+auto main(int argc, char** argv) -> int
+{
+    vkc::bench::Settings settings;
+    std::string outPath = "bench.json";
+    std::vector<std::string> selected;
+    // Validation changes the CPU cost being measured, so it's opt in here
+    bool validation = vkc::Instance::ValidationRequested(false);
+
+    try
+    {
+        for(int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if(arg == "--frames" && hasValue)
+            {
+                settings.frames = static_cast<type::uint32>(std::stoul(argv[++i]));
+            }
+            else if(arg == "--count" && hasValue)
+            {
+                settings.count = static_cast<type::uint32>(std::stoul(argv[++i]));
+            }
+            else if(arg == "--size" && hasValue)
+            {
+                std::string size = argv[++i];
+                type::size split = size.find('x');
+                if(split == std::string::npos)
+                {
+                    throw std::runtime_error("--size expects WIDTHxHEIGHT, got " + size);
+                }
+                settings.extent.width = static_cast<type::uint32>(std::stoul(size.substr(0, split)));
+                settings.extent.height = static_cast<type::uint32>(std::stoul(size.substr(split + 1)));
+            }
+            else if(arg == "--scenario" && hasValue)
+            {
+                selected.emplace_back(argv[++i]);
+            }
+            else if(arg == "--out" && hasValue)
+            {
+                outPath = argv[++i];
+            }
+            else if(arg == "--validation")
+            {
+                validation = true;
+            }
+            else if(arg == "--render-pass")
+            {
+                settings.renderPass = true;
+            }
+            else if(arg == "--msaa" && hasValue)
+            {
+                settings.samples = static_cast<VkSampleCountFlagBits>(std::stoul(argv[++i]));
+            }
+            else
+            {
+                throw std::runtime_error("Unknown or incomplete argument " + arg);
+            }
+        }
+
+#ifdef VKC_PROFILER
+        vkc::profile::Profiler profiler("vkc_bench_trace.json");
+#endif
+
+        vkc::Instance instance("vkc_bench", "None", validation, true);
+        vkc::DebugUtilsMessenger debugMessenger(instance);
+        vkc::Device device(instance, {});
+
+        const VkPhysicalDeviceProperties& props = device.properties();
+
+        std::ofstream out(outPath);
+        if(!out)
+        {
+            throw std::runtime_error("Failed to open " + outPath);
+        }
+        out << "{\n\"device\": \"" << props.deviceName << "\",\n"
+            << "\"width\": " << settings.extent.width << ",\n"
+            << "\"height\": " << settings.extent.height << ",\n"
+            << "\"rendering\": \"" << (device.dynamicRendering() && !settings.renderPass ? "dynamic" : "render_pass") << "\",\n"
+            << "\"samples\": " << device.supportedSampleCount(settings.samples) << ",\n"
+            << "\"scenarios\": [";
+
+        bool first = true;
+        for(const auto& scenario : vkc::bench::Scenarios())
+        {
+            if(!selected.empty() && std::find(selected.begin(), selected.end(), scenario.name) == selected.end())
+            {
+                continue;
+            }
+
+            std::cout << "Running " << scenario.name << " (" << scenario.description << ")" << std::endl;
+            vkc::bench::ScenarioResult result = scenario.run(device, settings);
+            std::cout << "    cpu p50 " << result.cpuP50Ms << "ms, p99 " << result.cpuP99Ms << "ms"
+                      << ", gpu p50 " << result.gpuP50Ms << "ms, p99 " << result.gpuP99Ms << "ms" << std::endl;
+
+            out << (first ? "\n" : ",\n");
+            vkc::bench::WriteResult(out, scenario, settings, result);
+            first = false;
+        }
+        // Driver host allocations over the whole run, peaks are the largest of any scenario
+        out << "\n],\n\"hostAllocations\": ";
+        instance.hostAllocator().writeJson(out);
+        out << "\n}\n";
+
+        std::cout << "Results written to " << outPath << std::endl;
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
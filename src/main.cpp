@@ -3,22 +3,45 @@
   * https://github.com/Mnenmenth
   */
 
+#include <algorithm>
+#include <array>
+#include <fstream>
 #include <iostream>
 #include <chrono>
+#include <memory>
+#include <string>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include "vkc/vkc.h"
 #include "vkc/pipeline/RenderPass.h"
 #include "vkc/pipeline/GraphicsPipeline.h"
+#include "vkc/pipeline/PipelineCache.h"
+#include "vkc/pipeline/ShaderWatcher.h"
+#include "vkc/pipeline/OffscreenTarget.h"
 #include "vkc/Vertex.h"
+#include "vkc/CompactVertex.h"
 #include "vkc/pipeline/ShaderDetails.h"
-#include "vkc/buffer/Buffer.h"
+#include "vkc/buffer/GeometryPool.h"
+#include "vkc/mesh/MeshFile.h"
+#include "vkc/mesh/MeshOptimizer.h"
 #include "vkc/buffer/UBO.h"
+#include "vkc/descriptor/DescriptorAllocator.h"
 #include "vkc/SyncObjects.h"
+#include "vkc/DeletionQueue.h"
+#include "vkc/memory/Defragmenter.h"
 #include "vkc/command/DrawCommandBuffers.h"
+#include "vkc/profile/Profiler.h"
+#include "vkc/profile/FrameStats.h"
+#include "vkc/profile/GpuTimer.h"
+#include "vkc/capture/FrameCapture.h"
+#include "vkc/capture/PngWriter.h"
+#include "vkc/capture/Y4mWriter.h"
 
 type::uint32 MAX_FRAMES_IN_FLIGHT = 2;
 type::uint32 currentFrame = 0;
+// Capacity of the shared geometry buffers, indices counted as 16 bit
+constexpr type::uint32 GEOMETRY_VERTICES = 64 * 1024;
+constexpr type::uint32 GEOMETRY_INDICES = 3 * 64 * 1024;
 
 static constexpr std::array<Vertex, 4> vertices =
         {
@@ -46,7 +69,72 @@ struct MVP
     glm::mat4 proj;
 };
 
-auto updateUbo(vkc::UBO& ubo, const vkc::SwapChain& swapChain, type::uint32 currImg) -> void
+struct Options
+{
+    bool validation = true;
+    std::string statsPath = "frame_stats.json";
+    // Frames are captured to a .y4m video, or numbered PNGs with this prefix otherwise
+    std::string capturePath;
+    // Compiled pipelines are kept here between runs
+    std::string pipelineCachePath = "pipeline_cache.bin";
+    // GLSL sources recompiled and reloaded as they change, not watched when empty
+    std::string watchShaders;
+    // Device memory snapshot written as JSON on exit, not written when empty
+    std::string memoryReportPath;
+    // Mesh file from vkc_meshconv drawn instead of the built in quad, when not empty
+    std::string modelPath;
+
+    // Render offscreen without a window or surface
+    bool headless = false;
+    // Draw through a render pass and framebuffers even when dynamic rendering is available
+    bool renderPass = false;
+    // Requested samples per pixel, lowered to what the device supports
+    VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+    type::uint32 frames = 600;
+    VkExtent2D extent = {800, 800};
+};
+
+// Everything needed to draw the model into a render target
+struct Scene
+{
+    Scene(const vkc::Device& device, const vkc::RenderTarget& target, const Options& options);
+
+    // Null unless a model file was given, unmapped once uploaded
+    std::unique_ptr<vkc::mesh::MeshFile> modelFile;
+    // Shared vertex and index buffers, holding the model and whatever else is drawn
+    vkc::GeometryPool geometry;
+    vkc::GeometryPool::Mesh model;
+    vkc::DescriptorAllocator descriptors;
+    vkc::UBO ubo;
+    VkSampleCountFlagBits samples;
+    // Null when drawing with dynamic rendering
+    std::unique_ptr<vkc::RenderPass> renderPass;
+    vkc::PipelineCache pipelineCache;
+    vkc::GraphicsPipeline pipeline;
+    vkc::SyncObjects syncObjects;
+    // Pipelines replaced by shader reloads, until no frame in flight uses them
+    vkc::DeletionQueue deletions;
+    // Moves a few megabytes of pooled buffer memory each frame, retiring what it replaces to deletions
+    vkc::Defragmenter defragmenter;
+    vkc::profile::GpuTimer gpuTimer;
+    vkc::DrawCommandBuffers drawCmds;
+    // Exported when the frame loop ends, or on SIGUSR1
+    vkc::profile::FrameStats stats;
+    // Null unless capturing
+    std::unique_ptr<vkc::capture::FrameCapture> capture;
+    // Null unless watching shaders. Last, so its thread stops before the pipeline goes
+    std::unique_ptr<vkc::ShaderWatcher> shaderWatcher;
+
+    // Half float positions and 8 bit colors from a single vertex buffer
+    using Layout = vkc::VertexLayout<vkc::VertexBinding<vkc::CompactVertex>>;
+    static auto Shaders() -> std::vector<vkc::ShaderDetails>;
+    static auto CreateRenderPass(const vkc::Device& device, const vkc::RenderTarget& target, const Options& options, VkSampleCountFlagBits samples) -> std::unique_ptr<vkc::RenderPass>;
+    static auto CreateConsumer(const std::string& capturePath) -> vkc::capture::FrameConsumer;
+    static auto AddModel(const vkc::Device& device, vkc::GeometryPool& geometry) -> vkc::GeometryPool::Mesh;
+    static auto LoadModel(const vkc::mesh::MeshFile& file, vkc::GeometryPool& geometry) -> vkc::GeometryPool::Mesh;
+};
+
+auto updateUbo(vkc::UBO& ubo, const vkc::RenderTarget& target, type::uint32 currImg) -> void
 {
     // Timer for consistent geometry rotation
     static auto startTime = std::chrono::high_resolution_clock::now();
@@ -56,7 +144,7 @@ auto updateUbo(vkc::UBO& ubo, const vkc::SwapChain& swapChain, type::uint32 curr
     MVP mvp = {};
     mvp.model = glm::rotate(glm::mat4(1.0f), time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
     mvp.view = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-    mvp.proj = glm::perspective(glm::radians(45.0f), swapChain.extent().width / static_cast<float>(swapChain.extent().height), 0.1f, 10.0f);
+    mvp.proj = glm::perspective(glm::radians(45.0f), target.extent().width / static_cast<float>(target.extent().height), 0.1f, 10.0f);
     // GLM was designed in OpenGL in mind and OpenGL inverts the Y axis
     // Vulkan however does not, so undo the inversion
     mvp.proj[1][1] *= -1;
@@ -66,30 +154,34 @@ auto updateUbo(vkc::UBO& ubo, const vkc::SwapChain& swapChain, type::uint32 curr
     ubo.setContents(currImg, sizeof(mvp), 0, &mvp);
 }
 auto GenCube(std::vector<Vertex>* outVertices, std::vector<type::uint16>* outIndices, float size) -> void;
+auto parseOptions(int argc, char** argv) -> Options;
+auto runWindowed(const Options& options) -> void;
+auto runHeadless(const Options& options) -> void;
+auto recordCapture(Scene& scene, type::uint32 imgIndex, std::array<VkCommandBuffer, 2>& cmds) -> type::uint32;
+auto reportCapture(Scene& scene) -> void;
+auto reportMemory(const vkc::Device& device, const Options& options) -> void;
 auto recreateSwapChain(
         bool& framebufferResized,
         vkc::Window& win,
         const vkc::Device& device,
         vkc::SwapChain& swapChain,
-        vkc::RenderPass& renderPass,
-        vkc::GraphicsPipeline& pipeline,
-        vkc::UBO& ubo,
-        vkc::SyncObjects& syncObjects,
-        vkc::DrawCommandBuffers& drawCmds
+        Scene& scene
         ) -> void;
+// Returns false when the swap chain was out of date and nothing was submitted
 auto drawFrame(
         bool& framebufferResized,
         vkc::Window& win,
         const vkc::Device& device,
         vkc::SwapChain& swapChain,
-        vkc::RenderPass& renderPass,
-        vkc::GraphicsPipeline& pipeline,
-        vkc::UBO& ubo,
-        vkc::SyncObjects& syncObjects,
-        vkc::DrawCommandBuffers& drawCmds
+        Scene& scene
+        ) -> bool;
+auto drawOffscreenFrame(
+        const vkc::Device& device,
+        vkc::OffscreenTarget& target,
+        Scene& scene
         ) -> void;
 
-auto main() -> int
+auto main(int argc, char** argv) -> int
 {
 
 /*    std::vector<Vertex> vertices;
@@ -98,95 +190,351 @@ auto main() -> int
 
     try
     {
-        vkc::InitVulkan();
+        Options options = parseOptions(argc, argv);
+
+#ifdef VKC_PROFILER
+        vkc::profile::Profiler profiler("vkc_trace.json");
+#endif
+        if(options.headless)
+        {
+            runHeadless(options);
+        }
+        else
+        {
+            runWindowed(options);
+        }
+
+#ifdef VKC_PROFILER
+        profiler.printSummary(std::cout);
+#endif
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    vkc::CleanupVulkan();
+    return EXIT_SUCCESS;
+ }
+
+auto parseOptions(int argc, char** argv) -> Options
+{
+    Options options;
+    // Flags override the environment
+    options.validation = vkc::Instance::ValidationRequested(options.validation);
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        // Frame statistics output, .csv for CSV, JSON otherwise
+        if(arg == "--stats" && hasValue)
+        {
+            options.statsPath = argv[++i];
+        }
+        else if(arg == "--capture" && hasValue)
+        {
+            options.capturePath = argv[++i];
+        }
+        else if(arg == "--pipeline-cache" && hasValue)
+        {
+            options.pipelineCachePath = argv[++i];
+        }
+        else if(arg == "--watch-shaders" && hasValue)
+        {
+            options.watchShaders = argv[++i];
+        }
+        else if(arg == "--memory-report" && hasValue)
+        {
+            options.memoryReportPath = argv[++i];
+        }
+        else if(arg == "--model" && hasValue)
+        {
+            options.modelPath = argv[++i];
+        }
+        else if(arg == "--no-validation")
+        {
+            options.validation = false;
+        }
+        else if(arg == "--headless")
+        {
+            options.headless = true;
+        }
+        else if(arg == "--render-pass")
+        {
+            options.renderPass = true;
+        }
+        // Samples per pixel for multisample anti-aliasing
+        else if(arg == "--msaa" && hasValue)
+        {
+            options.samples = static_cast<VkSampleCountFlagBits>(std::stoul(argv[++i]));
+        }
+        // Number of frames to render in headless mode
+        else if(arg == "--frames" && hasValue)
+        {
+            options.frames = static_cast<type::uint32>(std::stoul(argv[++i]));
+        }
+        // Resolution as WIDTHxHEIGHT
+        else if(arg == "--size" && hasValue)
+        {
+            std::string size = argv[++i];
+            type::size split = size.find('x');
+            if(split == std::string::npos)
+            {
+                throw std::runtime_error("--size expects WIDTHxHEIGHT, got " + size);
+            }
+            options.extent.width = static_cast<type::uint32>(std::stoul(size.substr(0, split)));
+            options.extent.height = static_cast<type::uint32>(std::stoul(size.substr(split + 1)));
+        }
+        else
+        {
+            throw std::runtime_error("Unknown or incomplete argument " + arg);
+        }
+    }
+    return options;
+}
+
+Scene::Scene(const vkc::Device& device, const vkc::RenderTarget& target, const Options& options) :
+        modelFile(options.modelPath.empty() ? nullptr : std::make_unique<vkc::mesh::MeshFile>(options.modelPath)),
+        // Large enough for the whole model file, if there is one
+        geometry(
+                device,
+                sizeof(vkc::CompactVertex),
+                std::max(GEOMETRY_VERTICES, modelFile ? modelFile->header().vertexCount : 0),
+                std::max<VkDeviceSize>(GEOMETRY_INDICES * sizeof(type::uint16), modelFile ? modelFile->header().indexDataSize : 0)
+                ),
+        model(modelFile ? LoadModel(*modelFile, geometry) : AddModel(device, geometry)),
+        descriptors(device, MAX_FRAMES_IN_FLIGHT),
+        ubo(device, descriptors, sizeof(MVP), 0, target.numImages(), VK_SHADER_STAGE_VERTEX_BIT),
+        samples(device.supportedSampleCount(options.samples)),
+        renderPass(CreateRenderPass(device, target, options, samples)),
+        pipelineCache(device, options.pipelineCachePath),
+        pipeline(device, target, renderPass.get(), descriptors.layouts(), Shaders(), Layout::BindingDescriptions, Layout::AttributeDescriptions, samples, &pipelineCache),
+        syncObjects(device, target.numImages(), MAX_FRAMES_IN_FLIGHT),
+        deletions(device),
+        defragmenter(device),
+        gpuTimer(device, target.numImages()),
+        drawCmds(device, target, renderPass.get(), ubo, pipeline, geometry, model, &gpuTimer),
+        stats(options.statsPath)
+{
+    modelFile.reset();
+    vkc::profile::FrameStats::InstallSignalHandler();
+
+    if(!options.capturePath.empty())
+    {
+        // One buffer per frame in flight, plus one so the consumer has a frame of slack
+        capture = std::make_unique<vkc::capture::FrameCapture>(device, target, MAX_FRAMES_IN_FLIGHT + 1, CreateConsumer(options.capturePath));
+    }
+    if(!options.watchShaders.empty())
+    {
+        // Compiled next to the modules the shaders target built, which the pipeline loads
+        shaderWatcher = std::make_unique<vkc::ShaderWatcher>(pipeline, options.watchShaders, "shaders");
+        std::cout << "Watching " << options.watchShaders << " for shader changes" << std::endl;
+    }
+}
 
-        vkc::Instance instance("VulkanCube", "None", true);
+auto Scene::CreateRenderPass(const vkc::Device& device, const vkc::RenderTarget& target, const Options& options, VkSampleCountFlagBits samples) -> std::unique_ptr<vkc::RenderPass>
+{
+    std::cout << "Rendering with " << samples << " samples per pixel" << std::endl;
+    if(device.dynamicRendering() && !options.renderPass)
+    {
+        std::cout << "Rendering with dynamic rendering" << std::endl;
+        return nullptr;
+    }
+    std::cout << "Rendering with a render pass" << std::endl;
+    return std::make_unique<vkc::RenderPass>(device, target, samples);
+}
 
-        vkc::DebugUtilsMessenger debugMessenger(instance);
+auto Scene::AddModel(const vkc::Device& device, vkc::GeometryPool& geometry) -> vkc::GeometryPool::Mesh
+{
+    // Reordered for the vertex cache, overdraw and vertex fetch, then packed as narrow as the vertex count allows
+    std::vector<type::uint32> modelIndices(indices.begin(), indices.end());
+    std::vector<glm::vec3> positions;
+    positions.reserve(vertices.size());
+    for(const Vertex& vertex : vertices)
+    {
+        positions.emplace_back(vertex.pos.x, vertex.pos.y, 0.0f);
+    }
+    vkc::mesh::OptimizeResult optimized = vkc::mesh::Optimize(modelIndices, positions, device.indexTypeUint8());
+    std::cout << "Model ACMR " << optimized.acmrBefore << " -> " << optimized.acmrAfter
+              << " with " << vkc::mesh::IndexSize(optimized.indexType) * 8 << " bit indices" << std::endl;
+
+    // Uploaded as half float positions and 8 bit colors
+    std::vector<Vertex> modelVertices = vkc::mesh::Remap<Vertex>(vertices, optimized.remap);
+    std::vector<vkc::CompactVertex> compactVertices(modelVertices.size());
+    vkc::CompactVertex::Encode(modelVertices, compactVertices);
+    std::vector<std::byte> packed = vkc::mesh::PackIndices(modelIndices, optimized.indexType);
+    return geometry.add(compactVertices.data(), optimized.vertexCount, packed.data(), modelIndices.size(), optimized.indexType);
+}
 
-        vkc::Window win({800, 800}, "VulkanCube", instance);
+auto Scene::LoadModel(const vkc::mesh::MeshFile& file, vkc::GeometryPool& geometry) -> vkc::GeometryPool::Mesh
+{
+    auto start = std::chrono::steady_clock::now();
+    std::vector<vkc::GeometryPool::Mesh> meshes = file.upload(geometry);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if(meshes.empty())
+    {
+        throw std::runtime_error("Model file has no meshes");
+    }
+    std::cout << "Uploaded " << meshes.size() << " meshes, " << file.header().vertexCount << " vertices, in "
+              << seconds * 1e3 << "ms" << std::endl;
 
-        vkc::Device device(instance, win, vkc::Instance::DeviceExtensions);
+    // Only one mesh is drawn
+    for(type::size i = 1; i < meshes.size(); ++i)
+    {
+        geometry.remove(meshes[i]);
+    }
+    return meshes.front();
+}
 
-        vkc::SwapChain swapChain(device, win);
+auto Scene::CreateConsumer(const std::string& capturePath) -> vkc::capture::FrameConsumer
+{
+    if(capturePath.ends_with(".y4m"))
+    {
+        auto writer = std::make_shared<vkc::capture::Y4mWriter>(capturePath, 60);
+        return [writer](const vkc::capture::CapturedFrame& frame) { writer->write(frame); };
+    }
+    auto writer = std::make_shared<vkc::capture::PngWriter>(capturePath);
+    return [writer](const vkc::capture::CapturedFrame& frame) { writer->write(frame); };
+}
 
-        VkDeviceSize vertBuffSize = sizeof(vertices[0])*vertices.size();
-        VkDeviceSize indexBuffSize = sizeof(indices[0])*indices.size();
+auto Scene::Shaders() -> std::vector<vkc::ShaderDetails>
+{
+    return
+            {
+                    // Vertex shader
+                    {
+                            .filePath = "shaders/triangle.vert.spv",
+                            .stage = VK_SHADER_STAGE_VERTEX_BIT
+                    },
+                    // Fragment shader
+                    {
+                            .filePath = "shaders/triangle.frag.spv",
+                            .stage = VK_SHADER_STAGE_FRAGMENT_BIT
+                    }
+            };
+}
 
-        vkc::Buffer modelBuffer(device, vertBuffSize+indexBuffSize,
-                VK_BUFFER_USAGE_TRANSFER_DST_BIT |
-                VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_SHARING_MODE_EXCLUSIVE,
-                true
-                );
+auto runWindowed(const Options& options) -> void
+{
+    vkc::InitVulkan();
 
+    vkc::Instance instance("VulkanCube", "None", options.validation);
 
-        modelBuffer.setContents(indexBuffSize, 0, indices.data());
-        modelBuffer.setContents(vertBuffSize, indexBuffSize, vertices.data());
+    vkc::DebugUtilsMessenger debugMessenger(instance);
 
+    vkc::Window win({static_cast<int>(options.extent.width), static_cast<int>(options.extent.height)}, "VulkanCube", instance);
 
-        vkc::UBO ubo(device, sizeof(MVP), 0, swapChain.numImages(), VK_SHADER_STAGE_VERTEX_BIT);
+    vkc::Device device(instance, win, vkc::Instance::DeviceExtensions);
 
-        vkc::RenderPass renderPass(device, swapChain);
+    vkc::SwapChain swapChain(device, win);
 
-        // Get binding and attribute descriptions
-        std::vector<VkVertexInputBindingDescription> bindingDescs;
-        Vertex::getBindingDescription(bindingDescs);
-        std::vector<VkVertexInputAttributeDescription> attrDescs;
-        Vertex::getAttributeDescriptions(attrDescs);
+    Scene scene(device, swapChain, options);
 
-        std::vector<vkc::ShaderDetails> shaderDetails =
-                {
-                        // Vertex shader
-                        {
-                                .filePath = "shaders/triangle.vert.spv",
-                                .stage = VK_SHADER_STAGE_VERTEX_BIT
-                        },
-                        // Fragment shader
-                        {
-                                .filePath = "shaders/triangle.frag.spv",
-                                .stage = VK_SHADER_STAGE_FRAGMENT_BIT
-                        }
-                };
-        std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
-        descriptorSetLayouts.push_back(ubo.descriptorSetLayout());
+    win.setDrawFrameFunc(
+            [&win, &device, &swapChain, &scene](bool& framebufferResized) {
+        bool submitted;
+        {
+            vkc::profile::FrameStats::Scope frame(scene.stats, vkc::profile::FrameStats::Metric::CpuFrame);
+            submitted = drawFrame(framebufferResized, win, device, swapChain, scene);
+        }
+        // A frame cut short by an out of date swap chain would skew the statistics
+        if(submitted)
+        {
+            scene.stats.endFrame();
+        }
+        else
+        {
+            scene.stats.discardFrame();
+        }
+    });
 
-        vkc::GraphicsPipeline pipeline(device, swapChain, renderPass, descriptorSetLayouts, shaderDetails, bindingDescs, attrDescs);
+    win.mainLoop();
+    device.vk().DeviceWaitIdle(device.logical());
+    reportCapture(scene);
+    reportMemory(device, options);
 
-        vkc::SyncObjects syncObjects(device, swapChain.numImages(), MAX_FRAMES_IN_FLIGHT);
+    std::cout << "Vulkan host allocations" << std::endl;
+    instance.hostAllocator().writeReport(std::cout);
+}
 
-        vkc::DrawCommandBuffers drawCmds(device, swapChain, renderPass, ubo, pipeline, modelBuffer, indexBuffSize, 0, indexBuffSize);
+auto runHeadless(const Options& options) -> void
+{
+    vkc::Instance instance("VulkanCube", "None", options.validation, true);
 
-        win.setDrawFrameFunc(
-                [&win, &device, &swapChain, &ubo, &renderPass, &pipeline, &syncObjects, &drawCmds](bool& framebufferResized) {
-            drawFrame(framebufferResized, win, device, swapChain, renderPass, pipeline, ubo, syncObjects, drawCmds);
-        });
+    vkc::DebugUtilsMessenger debugMessenger(instance);
 
-        win.mainLoop();
-        vkDeviceWaitIdle(device.logical());
+    // No surface, so no swap chain extension either
+    vkc::Device device(instance, {});
+
+    // One image per frame in flight, so the frame index is also the image index
+    vkc::OffscreenTarget target(device, options.extent, MAX_FRAMES_IN_FLIGHT);
+
+    Scene scene(device, target, options);
+
+    for(type::uint32 frame = 0; frame < options.frames; ++frame)
+    {
+        {
+            vkc::profile::FrameStats::Scope cpuFrame(scene.stats, vkc::profile::FrameStats::Metric::CpuFrame);
+            drawOffscreenFrame(device, target, scene);
+        }
+        scene.stats.endFrame();
     }
-    catch (const std::exception& e)
+
+    device.vk().DeviceWaitIdle(device.logical());
+    reportCapture(scene);
+    reportMemory(device, options);
+
+    std::cout << "Vulkan host allocations" << std::endl;
+    instance.hostAllocator().writeReport(std::cout);
+}
+
+// Appends the copy of the frame to the draw commands, returning how many commands to submit
+auto recordCapture(Scene& scene, type::uint32 imgIndex, std::array<VkCommandBuffer, 2>& cmds) -> type::uint32
+{
+    if(!scene.capture)
     {
-        std::cerr << e.what() << std::endl;
-        return EXIT_FAILURE;
+        return 1;
     }
+    cmds[1] = scene.capture->record(imgIndex);
+    return cmds[1] == VK_NULL_HANDLE ? 1 : 2;
+}
 
-    vkc::CleanupVulkan();
-    return EXIT_SUCCESS;
- }
+auto reportCapture(Scene& scene) -> void
+{
+    if(scene.capture)
+    {
+        // Wait for the last frames to be written before reporting
+        scene.capture->flush();
+        std::cout << "Captured " << scene.capture->captured() << " frames, dropped " << scene.capture->dropped() << std::endl;
+    }
+}
+
+auto reportMemory(const vkc::Device& device, const Options& options) -> void
+{
+    // Taken while the scene is still alive, so it shows what the scene holds
+    vkc::MemorySnapshot snapshot = device.memorySnapshot();
+    std::cout << "Vulkan device memory" << std::endl;
+    snapshot.writeReport(std::cout);
+
+    if(!options.memoryReportPath.empty())
+    {
+        std::ofstream file(options.memoryReportPath);
+        snapshot.writeJson(file);
+        file << '\n';
+    }
+}
 
 auto recreateSwapChain(
         bool& framebufferResized,
         vkc::Window& win,
         const vkc::Device& device,
         vkc::SwapChain& swapChain,
-        vkc::RenderPass& renderPass,
-        vkc::GraphicsPipeline& pipeline,
-        vkc::UBO& ubo,
-        vkc::SyncObjects& syncObjects,
-        vkc::DrawCommandBuffers& drawCmds
+        Scene& scene
         ) -> void
 {
+    VKC_ZONE("recreateSwapChain");
+
     framebufferResized = true;
 
     glm::ivec2 size;
@@ -197,15 +545,29 @@ auto recreateSwapChain(
         glfwWaitEvents();
     }
 
-    vkDeviceWaitIdle(device.logical());
+    device.vk().DeviceWaitIdle(device.logical());
 
+    // A shader reload compiling on the watcher thread finishes first, and the next waits for the old render pass to go
+    std::unique_lock reloadLock = scene.pipeline.lockReloads();
     swapChain.recreate();
-    ubo.recreateDescriptorSets(swapChain.numImages());
-    renderPass.recreate();
-    pipeline.recreate();
-    drawCmds.recreate();
+    scene.ubo.recreateDescriptorSets(swapChain.numImages());
+    // Dynamic rendering has no framebuffers to rebuild, the draws pick up the new image views
+    if(scene.renderPass)
+    {
+        scene.renderPass->recreate();
+    }
+    scene.pipeline.recreate();
+    scene.gpuTimer.recreate(swapChain.numImages());
+    scene.drawCmds.recreate();
+    if(scene.capture)
+    {
+        scene.capture->recreate();
+    }
 
-    renderPass.cleanupOld();
+    if(scene.renderPass)
+    {
+        scene.renderPass->cleanupOld();
+    }
     swapChain.cleanupOld();
 }
 
@@ -214,26 +576,45 @@ auto drawFrame(
         vkc::Window& win,
         const vkc::Device& device,
         vkc::SwapChain& swapChain,
-        vkc::RenderPass& renderPass,
-        vkc::GraphicsPipeline& pipeline,
-        vkc::UBO& ubo,
-        vkc::SyncObjects& syncObjects,
-        vkc::DrawCommandBuffers& drawCmds
-        ) -> void
+        Scene& scene
+        ) -> bool
 {
+    VKC_ZONE("drawFrame");
+
+    vkc::SyncObjects& syncObjects = scene.syncObjects;
+    vkc::profile::FrameStats& stats = scene.stats;
+
     // Sync queues
-    vkWaitForFences(device.logical(), 1, &syncObjects.inFlightFence(currentFrame), VK_TRUE, type::uint64_max);
+    {
+        vkc::profile::FrameStats::Scope wait(stats, vkc::profile::FrameStats::Metric::FenceWait);
+        device.vk().WaitForFences(device.logical(), 1, &syncObjects.inFlightFence(currentFrame), VK_TRUE, type::uint64_max);
+    }
+    // Captures submitted with this fence are complete, and must be picked up before it is reset
+    if(scene.capture)
+    {
+        scene.capture->poll();
+    }
+    // Transient descriptor sets of this frame are no longer in use
+    scene.descriptors.resetFrame(currentFrame);
+    // Frame boundary, where a reloaded pipeline compiled in the background can be swapped in
+    scene.pipeline.applyReload(scene.deletions, syncObjects.inFlightFences());
+    scene.deletions.collect();
+    scene.defragmenter.step(scene.deletions, syncObjects.inFlightFences());
 
     // Submit an image to a queue
 
     //Get image from swap chain
     type::uint32 imgIndex;
-    VkResult result = vkAcquireNextImageKHR(device.logical(), swapChain.handle(), type::uint64_max, syncObjects.imageAvailable(currentFrame), VK_NULL_HANDLE, &imgIndex);
+    VkResult result;
+    {
+        vkc::profile::FrameStats::Scope wait(stats, vkc::profile::FrameStats::Metric::AcquireWait);
+        result = device.vk().AcquireNextImageKHR(device.logical(), swapChain.handle(), type::uint64_max, syncObjects.imageAvailable(currentFrame), VK_NULL_HANDLE, &imgIndex);
+    }
     // Create new swap chain if needed
     if(result == VK_ERROR_OUT_OF_DATE_KHR)
     {
-        recreateSwapChain(framebufferResized, win, device, swapChain, renderPass, pipeline, ubo, syncObjects, drawCmds);
-        return;
+        recreateSwapChain(framebufferResized, win, device, swapChain, scene);
+        return false;
     }
     else if(result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
     {
@@ -243,12 +624,22 @@ auto drawFrame(
     // Make sure previous frame isn't using this image still
     if(syncObjects.imageInFlight(imgIndex) != VK_NULL_HANDLE)
     {
-        vkWaitForFences(device.logical(), 1, &syncObjects.imageInFlight(imgIndex), VK_TRUE, type::uint64_max);
+        vkc::profile::FrameStats::Scope wait(stats, vkc::profile::FrameStats::Metric::FenceWait);
+        device.vk().WaitForFences(device.logical(), 1, &syncObjects.imageInFlight(imgIndex), VK_TRUE, type::uint64_max);
     }
+    // The last submission of this image's command buffer is complete, so its timestamps are ready
+    if(auto gpuTime = scene.gpuTimer.collect(imgIndex))
+    {
+        stats.add(vkc::profile::FrameStats::Metric::GpuFrame, *gpuTime);
+    }
+    // Its last submission is complete, so its set can be rewritten and its commands re-recorded
+    // if the pipeline was reloaded or the buffers they use were moved
+    scene.ubo.refresh(imgIndex);
+    scene.drawCmds.refresh(imgIndex);
     // Mark image as in use
     syncObjects.imageInFlight(imgIndex) = syncObjects.inFlightFence(currentFrame);
 
-    updateUbo(ubo, swapChain, imgIndex);
+    updateUbo(scene.ubo, swapChain, imgIndex);
 
     VkSubmitInfo submitInfo = {};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
@@ -259,17 +650,23 @@ auto drawFrame(
     submitInfo.pWaitSemaphores = &syncObjects.imageAvailable(currentFrame);
     submitInfo.pWaitDstStageMask = &waitStage;
     // Which command buffer to submit for execution
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &drawCmds.command(imgIndex);
+    std::array<VkCommandBuffer, 2> cmds = {scene.drawCmds.command(imgIndex)};
+    submitInfo.commandBufferCount = recordCapture(scene, imgIndex, cmds);
+    submitInfo.pCommandBuffers = cmds.data();
     // Which semaphores to wait for after command buffers
     submitInfo.signalSemaphoreCount = 1;
     submitInfo.pSignalSemaphores = &syncObjects.renderFinished(currentFrame);
 
-    vkResetFences(device.logical(), 1, &syncObjects.inFlightFence(currentFrame));
-    if(vkQueueSubmit(device.graphicsQueue(), 1, &submitInfo, syncObjects.inFlightFence(currentFrame)) != VK_SUCCESS)
+    device.vk().ResetFences(device.logical(), 1, &syncObjects.inFlightFence(currentFrame));
+    if(device.vk().QueueSubmit(device.graphicsQueue(), 1, &submitInfo, syncObjects.inFlightFence(currentFrame)) != VK_SUCCESS)
     {
         throw std::runtime_error("Command Buffer submission failed");
     }
+    scene.gpuTimer.markSubmitted(imgIndex);
+    if(scene.capture)
+    {
+        scene.capture->submitted(syncObjects.inFlightFence(currentFrame));
+    }
 
     // Presentation
     VkPresentInfoKHR presentInfo = {};
@@ -284,17 +681,78 @@ auto drawFrame(
     presentInfo.pImageIndices = &imgIndex;
     presentInfo.pResults = nullptr;
 
-    result = vkQueuePresentKHR(device.presentQueue(), &presentInfo);
+    {
+        vkc::profile::FrameStats::Scope present(stats, vkc::profile::FrameStats::Metric::Present);
+        result = device.vk().QueuePresentKHR(device.presentQueue(), &presentInfo);
+    }
     if(result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || framebufferResized)
     {
         framebufferResized = false;
-        recreateSwapChain(framebufferResized, win, device, swapChain, renderPass, pipeline, ubo, syncObjects, drawCmds);
+        recreateSwapChain(framebufferResized, win, device, swapChain, scene);
     }
     else if(result != VK_SUCCESS)
     {
         throw std::runtime_error("Failed to present swap chain image");
     }
 
+    currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+    return true;
+}
+
+auto drawOffscreenFrame(
+        const vkc::Device& device,
+        vkc::OffscreenTarget& target,
+        Scene& scene
+        ) -> void
+{
+    VKC_ZONE("drawOffscreenFrame");
+
+    vkc::SyncObjects& syncObjects = scene.syncObjects;
+    vkc::profile::FrameStats& stats = scene.stats;
+
+    // Images are owned by frames in flight, so waiting on the frame's fence
+    // also guarantees its image is no longer in use
+    {
+        vkc::profile::FrameStats::Scope wait(stats, vkc::profile::FrameStats::Metric::FenceWait);
+        device.vk().WaitForFences(device.logical(), 1, &syncObjects.inFlightFence(currentFrame), VK_TRUE, type::uint64_max);
+    }
+    // Captures submitted with this fence are complete, and must be picked up before it is reset
+    if(scene.capture)
+    {
+        scene.capture->poll();
+    }
+    // Transient descriptor sets of this frame are no longer in use
+    scene.descriptors.resetFrame(currentFrame);
+    if(auto gpuTime = scene.gpuTimer.collect(currentFrame))
+    {
+        stats.add(vkc::profile::FrameStats::Metric::GpuFrame, *gpuTime);
+    }
+    scene.pipeline.applyReload(scene.deletions, syncObjects.inFlightFences());
+    scene.deletions.collect();
+    scene.defragmenter.step(scene.deletions, syncObjects.inFlightFences());
+    scene.ubo.refresh(currentFrame);
+    scene.drawCmds.refresh(currentFrame);
+
+    updateUbo(scene.ubo, target, currentFrame);
+
+    // Nothing to acquire or present, so no semaphores
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    std::array<VkCommandBuffer, 2> cmds = {scene.drawCmds.command(currentFrame)};
+    submitInfo.commandBufferCount = recordCapture(scene, currentFrame, cmds);
+    submitInfo.pCommandBuffers = cmds.data();
+
+    device.vk().ResetFences(device.logical(), 1, &syncObjects.inFlightFence(currentFrame));
+    if(device.vk().QueueSubmit(device.graphicsQueue(), 1, &submitInfo, syncObjects.inFlightFence(currentFrame)) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Command Buffer submission failed");
+    }
+    scene.gpuTimer.markSubmitted(currentFrame);
+    if(scene.capture)
+    {
+        scene.capture->submitted(syncObjects.inFlightFence(currentFrame));
+    }
+
     currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
 }
 
@@ -354,4 +812,4 @@ auto GenCube(std::vector<Vertex>* outVertices, std::vector<type::uint16>* outInd
         outIndices->push_back(3+groupStride);
         outIndices->push_back(1+groupStride);
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,261 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+#include "../vkc/CompactVertex.h"
+#include "../vkc/Vertex.h"
+#include "../vkc/mesh/MeshFile.h"
+#include "../vkc/mesh/MeshOptimizer.h"
+
+namespace
+{
+    // Triangles of one OBJ object or group, with their vertices deduplicated
+    struct ObjMesh
+    {
+        std::string name;
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec3> normals;
+        std::vector<glm::vec4> colors;
+        std::vector<type::uint32> indices;
+        // Position and normal indices of the file, to the vertex made of them
+        std::unordered_map<type::uint64, type::uint32> vertices;
+        bool hasNormals = true;
+    };
+
+    // OBJ indices count from 1, and negative ones count back from the last element read
+    auto ResolveIndex(const std::string& token, type::size count) -> type::uint32
+    {
+        long index = std::stol(token);
+        long resolved = index < 0 ? static_cast<long>(count) + index : index - 1;
+        if(resolved < 0 || resolved >= static_cast<long>(count))
+        {
+            throw std::runtime_error("OBJ index " + token + " out of range");
+        }
+        return static_cast<type::uint32>(resolved);
+    }
+
+    // Positions, optional vertex colors after them, normals and faces of any vertex count, which are fanned into triangles
+    // Texture coordinates and materials are ignored, neither vertex format has room for them
+    auto ReadObj(const std::string& path) -> std::vector<ObjMesh>
+    {
+        std::ifstream file(path);
+        if(!file)
+        {
+            throw std::runtime_error("Failed to open " + path);
+        }
+
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec4> colors;
+        std::vector<glm::vec3> normals;
+        std::vector<ObjMesh> meshes(1);
+
+        std::string line;
+        std::vector<type::uint32> face;
+        while(std::getline(file, line))
+        {
+            std::istringstream in(line);
+            std::string keyword;
+            in >> keyword;
+            if(keyword == "v")
+            {
+                glm::vec3 position(0.0f);
+                glm::vec4 color(1.0f);
+                in >> position.x >> position.y >> position.z;
+                if(!(in >> color.x >> color.y >> color.z))
+                {
+                    color = glm::vec4(1.0f);
+                }
+                positions.push_back(position);
+                colors.push_back(color);
+            }
+            else if(keyword == "vn")
+            {
+                glm::vec3 normal(0.0f);
+                in >> normal.x >> normal.y >> normal.z;
+                normals.push_back(normal);
+            }
+            else if(keyword == "o" || keyword == "g")
+            {
+                if(!meshes.back().indices.empty())
+                {
+                    meshes.emplace_back();
+                }
+                std::getline(in >> std::ws, meshes.back().name);
+            }
+            else if(keyword == "f")
+            {
+                ObjMesh& mesh = meshes.back();
+                face.clear();
+                std::string corner;
+                while(in >> corner)
+                {
+                    // v, v/vt, v//vn or v/vt/vn
+                    type::size slash = corner.find('/');
+                    type::uint32 position = ResolveIndex(corner.substr(0, slash), positions.size());
+                    type::uint32 normal = type::uint32_max;
+                    type::size lastSlash = corner.rfind('/');
+                    if(slash != std::string::npos && lastSlash != slash)
+                    {
+                        normal = ResolveIndex(corner.substr(lastSlash + 1), normals.size());
+                    }
+                    mesh.hasNormals = mesh.hasNormals && normal != type::uint32_max;
+
+                    type::uint64 key = static_cast<type::uint64>(position) << 32 | normal;
+                    auto [it, added] = mesh.vertices.try_emplace(key, static_cast<type::uint32>(mesh.positions.size()));
+                    if(added)
+                    {
+                        mesh.positions.push_back(positions[position]);
+                        mesh.colors.push_back(colors[position]);
+                        mesh.normals.push_back(normal != type::uint32_max ? normals[normal] : glm::vec3(0.0f));
+                    }
+                    face.push_back(it->second);
+                }
+                for(type::size i = 2; i < face.size(); ++i)
+                {
+                    mesh.indices.insert(mesh.indices.end(), {face[0], face[i - 1], face[i]});
+                }
+            }
+        }
+
+        meshes.erase(std::remove_if(meshes.begin(), meshes.end(), [](const ObjMesh& mesh) { return mesh.indices.empty(); }), meshes.end());
+        return meshes;
+    }
+
+    // Area weighted normals of the faces around each vertex, for files without any
+    auto GenerateNormals(ObjMesh& mesh) -> void
+    {
+        std::fill(mesh.normals.begin(), mesh.normals.end(), glm::vec3(0.0f));
+        for(type::size i = 0; i + 2 < mesh.indices.size(); i += 3)
+        {
+            const glm::vec3& a = mesh.positions[mesh.indices[i]];
+            glm::vec3 normal = glm::cross(mesh.positions[mesh.indices[i + 1]] - a, mesh.positions[mesh.indices[i + 2]] - a);
+            for(type::size corner = 0; corner < 3; ++corner)
+            {
+                mesh.normals[mesh.indices[i + corner]] += normal;
+            }
+        }
+        for(glm::vec3& normal : mesh.normals)
+        {
+            float length = glm::length(normal);
+            normal = length > 0.0f ? normal / length : glm::vec3(0.0f, 0.0f, 1.0f);
+        }
+    }
+
+    auto Convert(ObjMesh& mesh, vkc::mesh::MeshVertexFormat format, bool uint8) -> vkc::mesh::MeshData
+    {
+        if(format == vkc::mesh::MeshVertexFormat::CompactMesh && !mesh.hasNormals)
+        {
+            GenerateNormals(mesh);
+        }
+
+        vkc::mesh::OptimizeResult optimized = vkc::mesh::Optimize(mesh.indices, mesh.positions, uint8);
+        std::vector<glm::vec3> positions = vkc::mesh::Remap<glm::vec3>(mesh.positions, optimized.remap);
+        std::vector<glm::vec3> normals = vkc::mesh::Remap<glm::vec3>(mesh.normals, optimized.remap);
+        std::vector<glm::vec4> colors = vkc::mesh::Remap<glm::vec4>(mesh.colors, optimized.remap);
+
+        vkc::mesh::MeshData data;
+        data.vertexCount = optimized.vertexCount;
+        data.vertices.resize(static_cast<type::size>(data.vertexCount) * vkc::mesh::VertexStride(format));
+        if(format == vkc::mesh::MeshVertexFormat::Compact)
+        {
+            // VulkanCube draws in the XY plane
+            std::vector<Vertex> vertices(positions.size());
+            for(type::size i = 0; i < positions.size(); ++i)
+            {
+                vertices[i] = Vertex{{positions[i].x, positions[i].y}, {colors[i].x, colors[i].y, colors[i].z}};
+            }
+            std::vector<vkc::CompactVertex> compact(vertices.size());
+            vkc::CompactVertex::Encode(vertices, compact);
+            std::memcpy(data.vertices.data(), compact.data(), data.vertices.size());
+        }
+        else
+        {
+            std::vector<vkc::CompactMeshVertex> compact(positions.size());
+            vkc::CompactMeshVertex::Encode(positions, normals, colors, compact);
+            std::memcpy(data.vertices.data(), compact.data(), data.vertices.size());
+        }
+        data.indices = vkc::mesh::PackIndices(mesh.indices, optimized.indexType);
+        data.indexCount = static_cast<type::uint32>(mesh.indices.size());
+        data.indexType = optimized.indexType;
+
+        data.boundsMin = positions.front();
+        data.boundsMax = positions.front();
+        for(const glm::vec3& position : positions)
+        {
+            for(int axis = 0; axis < 3; ++axis)
+            {
+                data.boundsMin[axis] = std::min(data.boundsMin[axis], position[axis]);
+                data.boundsMax[axis] = std::max(data.boundsMax[axis], position[axis]);
+            }
+        }
+
+        std::cout << (mesh.name.empty() ? "(unnamed)" : mesh.name) << ": " << data.vertexCount << " vertices, "
+                  << data.indexCount / 3 << " triangles, ACMR " << optimized.acmrBefore << " -> " << optimized.acmrAfter
+                  << ", " << vkc::mesh::IndexSize(data.indexType) * 8 << " bit indices" << std::endl;
+        return data;
+    }
+}
+
+// Converts a Wavefront OBJ file into a mesh file that VulkanCube and vkc_bench map and upload without parsing
+// Each object or group becomes a mesh, optimized for the vertex cache, overdraw and vertex fetch
+// Usage: vkc_meshconv input.obj output.vkm [--lit] [--uint8]
+//   --lit    CompactMeshVertex with normals, rather than the CompactVertex VulkanCube draws
+//   --uint8  Allow 8 bit indices, which only load on devices with VK_EXT_index_type_uint8
+auto main(int argc, char** argv) -> int
+{
+    std::vector<std::string> paths;
+    vkc::mesh::MeshVertexFormat format = vkc::mesh::MeshVertexFormat::Compact;
+    bool uint8 = false;
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if(arg == "--lit")
+        {
+            format = vkc::mesh::MeshVertexFormat::CompactMesh;
+        }
+        else if(arg == "--uint8")
+        {
+            uint8 = true;
+        }
+        else
+        {
+            paths.push_back(arg);
+        }
+    }
+    if(paths.size() != 2)
+    {
+        std::cerr << "Usage: vkc_meshconv input.obj output.vkm [--lit] [--uint8]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        std::vector<ObjMesh> objMeshes = ReadObj(paths[0]);
+        std::vector<vkc::mesh::MeshData> meshes;
+        meshes.reserve(objMeshes.size());
+        for(ObjMesh& mesh : objMeshes)
+        {
+            meshes.push_back(Convert(mesh, format, uint8));
+        }
+        vkc::mesh::WriteMeshFile(paths[1], format, meshes);
+        std::cout << "Wrote " << meshes.size() << " meshes to " << paths[1] << std::endl;
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
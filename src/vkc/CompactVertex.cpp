@@ -0,0 +1,239 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include "CompactVertex.h"
+#include "Device.h"
+
+// F16C is picked at runtime, so the library still runs on CPUs without it
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define VKC_VERTEX_F16C
+#endif
+
+static_assert(sizeof(vkc::CompactVertex) == 8);
+static_assert(sizeof(vkc::CompactMeshVertex) == 16);
+
+namespace
+{
+    auto Unorm8(float value) -> type::uint32
+    {
+        // fmax and fmin drop NaN, as the SIMD min and max do
+        return static_cast<type::uint32>(std::lrint(std::fmin(std::fmax(value, 0.0f), 1.0f) * 255.0f));
+    }
+
+    auto Snorm(float value, float scale, type::uint32 mask) -> type::uint32
+    {
+        return static_cast<type::uint32>(std::lrint(std::fmin(std::fmax(value, -1.0f), 1.0f) * scale)) & mask;
+    }
+
+#ifdef VKC_VERTEX_F16C
+    auto HasF16C() -> bool
+    {
+        static const bool supported = __builtin_cpu_supports("f16c");
+        return supported;
+    }
+
+    // Rounds to nearest even like lrint, and saturates while packing down to bytes
+    auto ColorSSE(__m128 color) -> type::uint32
+    {
+        color = _mm_min_ps(_mm_max_ps(color, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+        __m128i values = _mm_cvtps_epi32(_mm_mul_ps(color, _mm_set1_ps(255.0f)));
+        values = _mm_packs_epi32(values, values);
+        values = _mm_packus_epi16(values, values);
+        return static_cast<type::uint32>(_mm_cvtsi128_si32(values));
+    }
+
+    auto NormalSSE(__m128 normal) -> type::uint32
+    {
+        normal = _mm_min_ps(_mm_max_ps(normal, _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f));
+        // w only has 2 bits, so it's -1, 0 or 1
+        __m128i values = _mm_cvtps_epi32(_mm_mul_ps(normal, _mm_setr_ps(511.0f, 511.0f, 511.0f, 1.0f)));
+        alignas(16) std::int32_t lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), values);
+        return (static_cast<type::uint32>(lanes[0]) & 0x3ff) |
+               (static_cast<type::uint32>(lanes[1]) & 0x3ff) << 10 |
+               (static_cast<type::uint32>(lanes[2]) & 0x3ff) << 20 |
+               (static_cast<type::uint32>(lanes[3]) & 0x3) << 30;
+    }
+
+    [[gnu::target("f16c")]]
+    auto EncodeF16C(const Vertex* in, vkc::CompactVertex* out, type::size count) -> void
+    {
+        type::size i = 0;
+        // Positions of two vertices fill one conversion
+        for(; i + 2 <= count; i += 2)
+        {
+            __m128 pos = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(&in[i].pos));
+            pos = _mm_loadh_pi(pos, reinterpret_cast<const __m64*>(&in[i + 1].pos));
+            __m128i half = _mm_cvtps_ph(pos, _MM_FROUND_TO_NEAREST_INT);
+
+            auto first = static_cast<type::uint32>(_mm_cvtsi128_si32(half));
+            auto second = static_cast<type::uint32>(_mm_cvtsi128_si32(_mm_srli_si128(half, 4)));
+            std::memcpy(out[i].pos.value, &first, sizeof(first));
+            std::memcpy(out[i + 1].pos.value, &second, sizeof(second));
+
+            out[i].color.value = ColorSSE(_mm_setr_ps(in[i].color.x, in[i].color.y, in[i].color.z, 1.0f));
+            out[i + 1].color.value = ColorSSE(_mm_setr_ps(in[i + 1].color.x, in[i + 1].color.y, in[i + 1].color.z, 1.0f));
+        }
+        for(; i < count; ++i)
+        {
+            out[i] = vkc::CompactVertex::Encode(in[i]);
+        }
+    }
+
+    [[gnu::target("f16c")]]
+    auto EncodeMeshF16C(const glm::vec3* positions, const glm::vec3* normals, const glm::vec4* colors, vkc::CompactMeshVertex* out, type::size count) -> void
+    {
+        for(type::size i = 0; i < count; ++i)
+        {
+            __m128 pos = _mm_setr_ps(positions[i].x, positions[i].y, positions[i].z, 1.0f);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out[i].pos.value), _mm_cvtps_ph(pos, _MM_FROUND_TO_NEAREST_INT));
+            out[i].normal.value = NormalSSE(_mm_setr_ps(normals[i].x, normals[i].y, normals[i].z, 0.0f));
+            out[i].color.value = ColorSSE(_mm_loadu_ps(&colors[i].x));
+        }
+    }
+#endif
+}
+
+auto vkc::EncodeHalf(float value) -> type::uint16
+{
+    type::uint32 bits = std::bit_cast<type::uint32>(value);
+    type::uint32 sign = (bits >> 16) & 0x8000;
+    type::uint32 magnitude = bits & 0x7fffffff;
+
+    // Infinity and NaN, keeping NaN quiet
+    if(magnitude >= 0x7f800000)
+    {
+        return static_cast<type::uint16>(sign | (magnitude > 0x7f800000 ? 0x7e00 : 0x7c00));
+    }
+    // 65520 and up round past the largest half
+    if(magnitude >= 0x477ff000)
+    {
+        return static_cast<type::uint16>(sign | 0x7c00);
+    }
+    // Below the smallest normal half. Adding 0.5 lines the float's last mantissa bit up with
+    // the half subnormal step, so the FPU does the rounding
+    if(magnitude < 0x38800000)
+    {
+        float shifted = std::bit_cast<float>(magnitude) + 0.5f;
+        return static_cast<type::uint16>(sign | (std::bit_cast<type::uint32>(shifted) - 0x3f000000));
+    }
+    // Rebias the exponent from 127 to 15, and round to nearest even on the 13 dropped bits
+    type::uint32 odd = (magnitude >> 13) & 1;
+    magnitude += 0xc8000fff + odd;
+    return static_cast<type::uint16>(sign | (magnitude >> 13));
+}
+
+auto vkc::DecodeHalf(type::uint16 value) -> float
+{
+    type::uint32 sign = static_cast<type::uint32>(value & 0x8000) << 16;
+    type::uint32 exponent = (value >> 10) & 0x1f;
+    type::uint32 mantissa = value & 0x3ff;
+
+    if(exponent == 0)
+    {
+        // Zero and subnormals are exact multiples of 2^-24
+        float magnitude = static_cast<float>(mantissa) * 5.9604645e-8f;
+        return std::bit_cast<float>(sign | std::bit_cast<type::uint32>(magnitude));
+    }
+    if(exponent == 0x1f)
+    {
+        return std::bit_cast<float>(sign | 0x7f800000 | (mantissa << 13));
+    }
+    return std::bit_cast<float>(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+auto vkc::EncodeColor(const glm::vec4& color) -> type::uint32
+{
+    // Red in the lowest byte, which comes first in memory
+    return Unorm8(color.x) | Unorm8(color.y) << 8 | Unorm8(color.z) << 16 | Unorm8(color.w) << 24;
+}
+
+auto vkc::EncodeNormal(const glm::vec3& normal, float w) -> type::uint32
+{
+    return Snorm(normal.x, 511.0f, 0x3ff) |
+           Snorm(normal.y, 511.0f, 0x3ff) << 10 |
+           Snorm(normal.z, 511.0f, 0x3ff) << 20 |
+           Snorm(w, 1.0f, 0x3) << 30;
+}
+
+auto vkc::CompactVertex::Encode(const Vertex& vertex) -> CompactVertex
+{
+    CompactVertex out = {};
+    out.pos.value[0] = EncodeHalf(vertex.pos.x);
+    out.pos.value[1] = EncodeHalf(vertex.pos.y);
+    out.color.value = EncodeColor(glm::vec4(vertex.color, 1.0f));
+    return out;
+}
+
+auto vkc::CompactVertex::Encode(std::span<const Vertex> in, std::span<CompactVertex> out) -> void
+{
+    if(out.size() < in.size())
+    {
+        throw std::runtime_error("Compact vertex output too small");
+    }
+
+#ifdef VKC_VERTEX_F16C
+    if(HasF16C())
+    {
+        EncodeF16C(in.data(), out.data(), in.size());
+        return;
+    }
+#endif
+    for(type::size i = 0; i < in.size(); ++i)
+    {
+        out[i] = Encode(in[i]);
+    }
+}
+
+auto vkc::CompactMeshVertex::Encode(const glm::vec3& pos, const glm::vec3& normal, const glm::vec4& color) -> CompactMeshVertex
+{
+    CompactMeshVertex out = {};
+    out.pos.value[0] = EncodeHalf(pos.x);
+    out.pos.value[1] = EncodeHalf(pos.y);
+    out.pos.value[2] = EncodeHalf(pos.z);
+    out.pos.value[3] = EncodeHalf(1.0f);
+    out.normal.value = EncodeNormal(normal);
+    out.color.value = EncodeColor(color);
+    return out;
+}
+
+auto vkc::CompactMeshVertex::Encode(
+        std::span<const glm::vec3> positions,
+        std::span<const glm::vec3> normals,
+        std::span<const glm::vec4> colors,
+        std::span<CompactMeshVertex> out
+        ) -> void
+{
+    if(normals.size() != positions.size() || colors.size() != positions.size())
+    {
+        throw std::runtime_error("Compact mesh vertex streams differ in length");
+    }
+    if(out.size() < positions.size())
+    {
+        throw std::runtime_error("Compact mesh vertex output too small");
+    }
+
+#ifdef VKC_VERTEX_F16C
+    if(HasF16C())
+    {
+        EncodeMeshF16C(positions.data(), normals.data(), colors.data(), out.data(), positions.size());
+        return;
+    }
+#endif
+    for(type::size i = 0; i < positions.size(); ++i)
+    {
+        out[i] = Encode(positions[i], normals[i], colors[i]);
+    }
+}
+
+auto vkc::CompactMeshVertex::Supported(const vkc::Device& device) -> bool
+{
+    return device.vertexFormatSupported(VK_FORMAT_A2B10G10R10_SNORM_PACK32);
+}
@@ -0,0 +1,93 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#ifndef VULKANCUBE_COMPACTVERTEX_H
+#define VULKANCUBE_COMPACTVERTEX_H
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.h>
+#include <array>
+#include <span>
+#include "Types.h"
+#include "Vertex.h"
+#include "VertexLayout.h"
+
+namespace vkc
+{
+    class Device;
+
+    // Quantization of single attributes, rounded to nearest
+    // Half floats too large for 16 bits become infinity, normalized values are clamped to their range
+    auto EncodeHalf(float value) -> type::uint16;
+    auto DecodeHalf(type::uint16 value) -> float;
+    // VK_FORMAT_R8G8B8A8_UNORM
+    auto EncodeColor(const glm::vec4& color) -> type::uint32;
+    // VK_FORMAT_A2B10G10R10_SNORM_PACK32, w is the 2 bit alpha, such as a tangent's handedness
+    auto EncodeNormal(const glm::vec3& normal, float w = 0.0f) -> type::uint32;
+
+    // Storage of quantized attributes, typed so their vertex format is known
+    struct Half2 { type::uint16 value[2]; };
+    struct Half4 { type::uint16 value[4]; };
+    struct Unorm8x4 { type::uint32 value; };
+    struct Snorm10x3 { type::uint32 value; };
+
+    template<> struct VertexFormat<Half2> : VertexFormatIs<VK_FORMAT_R16G16_SFLOAT> {};
+    template<> struct VertexFormat<Half4> : VertexFormatIs<VK_FORMAT_R16G16B16A16_SFLOAT> {};
+    template<> struct VertexFormat<Unorm8x4> : VertexFormatIs<VK_FORMAT_R8G8B8A8_UNORM> {};
+    template<> struct VertexFormat<Snorm10x3> : VertexFormatIs<VK_FORMAT_A2B10G10R10_SNORM_PACK32> {};
+
+    // Vertex with a half float position and an 8 bit color, 8 bytes rather than 20
+    // Shaders read the same vec2 and vec3 inputs as for Vertex, the attribute formats convert them
+    struct CompactVertex
+    {
+        Half2 pos;
+        // Alpha is ignored by the vec3 input
+        Unorm8x4 color;
+
+        static auto Encode(const Vertex& vertex) -> CompactVertex;
+        // Bulk conversion, uses F16C and SSE2 when the CPU has them. out must be at least as long as in
+        static auto Encode(std::span<const Vertex> in, std::span<CompactVertex> out) -> void;
+
+        // Same locations as Vertex
+        static constexpr auto attributes() -> std::array<VertexAttribute, 2>
+        {
+            return {VKC_VERTEX_ATTRIBUTE(CompactVertex, pos), VKC_VERTEX_ATTRIBUTE(CompactVertex, color)};
+        }
+    };
+
+    // Lit mesh vertex with a half float position, packed normal and 8 bit color
+    // 16 bytes rather than the 40 of a vec3 position, vec3 normal and vec4 color
+    struct CompactMeshVertex
+    {
+        // w is always 1, three component half formats are rarely supported for vertex buffers
+        Half4 pos;
+        Snorm10x3 normal;
+        Unorm8x4 color;
+
+        static auto Encode(const glm::vec3& pos, const glm::vec3& normal, const glm::vec4& color) -> CompactMeshVertex;
+        // Bulk conversion from separate attribute streams of the same length, as mesh loaders produce them
+        static auto Encode(
+                std::span<const glm::vec3> positions,
+                std::span<const glm::vec3> normals,
+                std::span<const glm::vec4> colors,
+                std::span<CompactMeshVertex> out
+                ) -> void;
+
+        // Packed normals aren't a format every device can read from vertex buffers
+        static auto Supported(const vkc::Device& device) -> bool;
+
+        static constexpr auto attributes() -> std::array<VertexAttribute, 3>
+        {
+            return
+                    {
+                            VKC_VERTEX_ATTRIBUTE(CompactMeshVertex, pos),
+                            VKC_VERTEX_ATTRIBUTE(CompactMeshVertex, normal),
+                            VKC_VERTEX_ATTRIBUTE(CompactMeshVertex, color)
+                    };
+        }
+    };
+}
+
+#endif //VULKANCUBE_COMPACTVERTEX_H
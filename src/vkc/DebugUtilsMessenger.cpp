@@ -4,11 +4,131 @@
   * https://github.com/Mnenmenth
   */
 
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <string>
+#include <unordered_map>
 #include "DebugUtilsMessenger.h"
 #include "Instance.h"
+#include "MpscQueue.h"
+#include "Types.h"
 
-vkc::DebugUtilsMessenger::DebugUtilsMessenger(const vkc::Instance& instance) : m_messenger(VK_NULL_HANDLE), m_instance(instance)
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Message
+    {
+        VkDebugUtilsMessageSeverityFlagBitsEXT severity;
+        std::int32_t id;
+        std::string name;
+        std::string text;
+    };
+
+    // Repeats of one message ID
+    struct Repeats
+    {
+        type::uint64 count = 0;
+        // Held back since the last one written
+        type::uint64 held = 0;
+        Clock::time_point written;
+    };
+
+    // Shared by every messenger and the one passed along with instance creation, which has no object to point at
+    struct Log
+    {
+        vkc::MpscQueue<Message> queue;
+        // Held while draining, keeps the queue to one consumer
+        std::mutex drainMutex;
+        std::unordered_map<std::string, Repeats> repeats;
+    };
+
+    constexpr auto RepeatInterval = std::chrono::seconds(1);
+
+    auto GetLog() -> Log&
+    {
+        static Log log;
+        return log;
+    }
+
+    auto SeverityFromEnvironment() -> VkDebugUtilsMessageSeverityFlagBitsEXT
+    {
+        type::cstr value = std::getenv("VKC_VALIDATION_SEVERITY");
+        if(value == nullptr)
+        {
+            return VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT;
+        }
+        if(std::strcmp(value, "verbose") == 0)
+        {
+            return VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT;
+        }
+        if(std::strcmp(value, "info") == 0)
+        {
+            return VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT;
+        }
+        if(std::strcmp(value, "error") == 0)
+        {
+            return VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+        }
+        return VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT;
+    }
+
+    // Severity bits grow with severity, so they compare directly
+    std::atomic<VkDebugUtilsMessageSeverityFlagBitsEXT> MinSeverity = SeverityFromEnvironment();
+
+    auto SeverityName(VkDebugUtilsMessageSeverityFlagBitsEXT severity) -> type::cstr
+    {
+        switch(severity)
+        {
+            case VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT: return "verbose";
+            case VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT: return "info";
+            case VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT: return "warning";
+            default: return "error";
+        }
+    }
+
+    // Batched into one write to the stream per drain
+    auto Drain(Log& log, std::string& out) -> void
+    {
+        Clock::time_point now = Clock::now();
+        Message message;
+        while(log.queue.pop(message))
+        {
+            // Messages without an ID number are told apart by name
+            std::string key = message.id != 0 ? std::to_string(message.id) : message.name;
+            Repeats& repeats = log.repeats[key];
+            ++repeats.count;
+            if(repeats.count > 1 && now - repeats.written < RepeatInterval)
+            {
+                ++repeats.held;
+                continue;
+            }
+
+            out += "Validation Layer ";
+            out += SeverityName(message.severity);
+            if(!message.name.empty())
+            {
+                out += " [" + message.name + "]";
+            }
+            if(repeats.held > 0)
+            {
+                out += " (" + std::to_string(repeats.held) + " repeats held back)";
+            }
+            out += ": \n\t" + message.text + "\n";
+            repeats.held = 0;
+            repeats.written = now;
+        }
+    }
+}
+
+vkc::DebugUtilsMessenger::DebugUtilsMessenger(const vkc::Instance& instance, std::chrono::milliseconds drainInterval) :
+        m_messenger(VK_NULL_HANDLE),
+        m_instance(instance),
+        m_drainInterval(drainInterval),
+        m_stop(false)
 {
     if(m_instance.validationLayersEnabled())
     {
@@ -16,8 +136,8 @@ vkc::DebugUtilsMessenger::DebugUtilsMessenger(const vkc::Instance& instance) : m
         VkDebugUtilsMessengerCreateInfoEXT createInfo = {};
         PopulateCreateInfo(createInfo);
 
-        // Get pointer to extension function
-        auto createFunc = (PFN_vkCreateDebugUtilsMessengerEXT) vkGetInstanceProcAddr(m_instance.handle(), "vkCreateDebugUtilsMessengerEXT");
+        // Extension function is only loaded when the extension was enabled
+        auto createFunc = m_instance.vk().CreateDebugUtilsMessengerEXT;
 
         if(createFunc == nullptr)
         {
@@ -25,12 +145,14 @@ vkc::DebugUtilsMessenger::DebugUtilsMessenger(const vkc::Instance& instance) : m
         }
 
         // Create the messenger
-        VkResult result = createFunc(m_instance.handle(), &createInfo, nullptr, &m_messenger);
+        VkResult result = createFunc(m_instance.handle(), &createInfo, m_instance.allocator(), &m_messenger);
 
         if(result != VK_SUCCESS)
         {
             throw std::runtime_error("Failed to setup Debug Utils Messenger");
         }
+
+        m_thread = std::thread(&DebugUtilsMessenger::run, this);
     }
 }
 
@@ -38,21 +160,40 @@ vkc::DebugUtilsMessenger::~DebugUtilsMessenger()
 {
     if(m_instance.validationLayersEnabled())
     {
-        auto destroyFunc = (PFN_vkDestroyDebugUtilsMessengerEXT) vkGetInstanceProcAddr(m_instance.handle(), "vkDestroyDebugUtilsMessengerEXT");
+        {
+            std::lock_guard lock(m_wakeMutex);
+            m_stop = true;
+        }
+        m_wake.notify_one();
+        m_thread.join();
+
+        auto destroyFunc = m_instance.vk().DestroyDebugUtilsMessengerEXT;
         if(destroyFunc == nullptr)
         {
             throw std::runtime_error("Failed to destroy Debug Utils Messenger");
         }
-        destroyFunc(m_instance.handle(), m_messenger, nullptr);
+        destroyFunc(m_instance.handle(), m_messenger, m_instance.allocator());
+
+        Flush();
+        Log& log = GetLog();
+        std::lock_guard lock(log.drainMutex);
+        for(const auto& [key, repeats] : log.repeats)
+        {
+            if(repeats.held > 0)
+            {
+                std::cerr << "Validation message " << key << " repeated " << repeats.held << " more times" << std::endl;
+            }
+        }
     }
 }
 
 auto vkc::DebugUtilsMessenger::PopulateCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& createInfo) -> void
 {
     createInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
-    // Allow verbose, error, and warning message severity
+    // Every severity, so the filter can be lowered at runtime. The callback drops what's filtered out before copying it
     createInfo.messageSeverity =
             VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT
+            | VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT
             | VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT
             | VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT;
     // Enable general, validation, and performance message types
@@ -69,7 +210,53 @@ auto vkc::DebugUtilsMessenger::DebugCallback(VkDebugUtilsMessageSeverityFlagBits
                                              void* pUserData) -> VKAPI_ATTR VkBool32
 
 {
-    std::cerr << "Validation Layer Debug: \n\t" << pCallbackData->pMessage << std::endl;
+    if(messageSeverity < MinSeverity.load(std::memory_order_relaxed))
+    {
+        return VK_FALSE;
+    }
+
+    GetLog().queue.push({
+            messageSeverity,
+            pCallbackData->messageIdNumber,
+            pCallbackData->pMessageIdName ? pCallbackData->pMessageIdName : "",
+            pCallbackData->pMessage ? pCallbackData->pMessage : ""
+    });
 
     return VK_FALSE;
 }
+
+auto vkc::DebugUtilsMessenger::SetSeverity(VkDebugUtilsMessageSeverityFlagBitsEXT severity) -> void
+{
+    MinSeverity.store(severity, std::memory_order_relaxed);
+}
+
+auto vkc::DebugUtilsMessenger::Severity() -> VkDebugUtilsMessageSeverityFlagBitsEXT
+{
+    return MinSeverity.load(std::memory_order_relaxed);
+}
+
+auto vkc::DebugUtilsMessenger::Flush() -> void
+{
+    Log& log = GetLog();
+    std::string out;
+    {
+        std::lock_guard lock(log.drainMutex);
+        Drain(log, out);
+    }
+    if(!out.empty())
+    {
+        std::cerr << out << std::flush;
+    }
+}
+
+auto vkc::DebugUtilsMessenger::run() -> void
+{
+    std::unique_lock lock(m_wakeMutex);
+    while(!m_stop)
+    {
+        m_wake.wait_for(lock, m_drainInterval, [this] { return m_stop; });
+        lock.unlock();
+        Flush();
+        lock.lock();
+    }
+}
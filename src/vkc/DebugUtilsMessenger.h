@@ -7,17 +7,26 @@
 #define VULKANCUBE_DEBUGUTILSMESSENGER_H
 
 #include <vulkan/vulkan.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include "NonCopyable.h"
 
 
 namespace vkc
 {
     class Instance;
+    // Validation messages are only copied into a lock free queue inside the driver call that raised them,
+    // and written out by a logger thread. Repeats of a message ID are counted, and written at most once a second
+    // Messages raised while no messenger is running, such as during instance creation and destruction,
+    // wait in the queue for the next messenger or Flush()
     class DebugUtilsMessenger : public NonCopyable
     {
     public:
-        explicit DebugUtilsMessenger(const vkc::Instance& instance);
+        explicit DebugUtilsMessenger(const vkc::Instance& instance, std::chrono::milliseconds drainInterval = std::chrono::milliseconds(20));
 
+        // Writes out what's left, and how many repeats of each message were held back
         ~DebugUtilsMessenger();
 
         [[nodiscard]]
@@ -32,9 +41,24 @@ namespace vkc
 
         static auto PopulateCreateInfo(VkDebugUtilsMessengerCreateInfoEXT&) -> void;
 
+        // Messages less severe are dropped before they're copied. Starts at warning,
+        // or VKC_VALIDATION_SEVERITY (verbose, info, warning or error) when it's set
+        static auto SetSeverity(VkDebugUtilsMessageSeverityFlagBitsEXT severity) -> void;
+        static auto Severity() -> VkDebugUtilsMessageSeverityFlagBitsEXT;
+        // Writes out queued messages on the calling thread
+        static auto Flush() -> void;
+
     private:
         const vkc::Instance& m_instance;
         VkDebugUtilsMessengerEXT m_messenger;
+
+        std::chrono::milliseconds m_drainInterval;
+        std::mutex m_wakeMutex;
+        std::condition_variable m_wake;
+        bool m_stop;
+        std::thread m_thread;
+
+        auto run() -> void;
     };
 }
 
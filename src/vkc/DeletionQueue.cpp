@@ -0,0 +1,44 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#include <algorithm>
+#include "DeletionQueue.h"
+#include "Device.h"
+
+vkc::DeletionQueue::DeletionQueue(const vkc::Device& device) : m_device(device)
+{
+}
+
+vkc::DeletionQueue::~DeletionQueue()
+{
+    for(Retired& retired : m_retired)
+    {
+        retired.destroy();
+    }
+}
+
+auto vkc::DeletionQueue::retire(std::span<const VkFence> fences, std::function<void()> destroy) -> void
+{
+    m_retired.push_back({{fences.begin(), fences.end()}, std::move(destroy)});
+}
+
+auto vkc::DeletionQueue::collect() -> void
+{
+    // A fence seen signaled once stays done with, even if it has since been reset for a later submission
+    for(Retired& retired : m_retired)
+    {
+        std::erase_if(retired.fences, [this](VkFence fence)
+        {
+            return m_device.vk().GetFenceStatus(m_device.logical(), fence) == VK_SUCCESS;
+        });
+    }
+
+    auto done = std::stable_partition(m_retired.begin(), m_retired.end(), [](const Retired& retired) { return !retired.fences.empty(); });
+    for(auto it = done; it != m_retired.end(); ++it)
+    {
+        it->destroy();
+    }
+    m_retired.erase(done, m_retired.end());
+}
@@ -0,0 +1,49 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#ifndef VULKANCUBE_DELETIONQUEUE_H
+#define VULKANCUBE_DELETIONQUEUE_H
+
+#include <vulkan/vulkan.h>
+#include <functional>
+#include <span>
+#include <vector>
+#include "NonCopyable.h"
+#include "Types.h"
+
+namespace vkc
+{
+    class Device;
+    // Holds on to objects replaced while submissions that may use them are in flight, and destroys them
+    // once each of those submissions' fences has been seen signaled
+    // Fences are reused from frame to frame, so collect() should be called at least once per frame
+    class DeletionQueue : public NonCopyable
+    {
+    public:
+        explicit DeletionQueue(const vkc::Device& device);
+        // Destroys whatever is left, so the device must be idle
+        ~DeletionQueue();
+
+        // fences are those of every submission that may still use what destroy destroys
+        auto retire(std::span<const VkFence> fences, std::function<void()> destroy) -> void;
+        auto collect() -> void;
+
+        [[nodiscard]]
+        inline auto size() const -> type::size { return m_retired.size(); }
+
+    private:
+        struct Retired
+        {
+            // Fences not yet seen signaled
+            std::vector<VkFence> fences;
+            std::function<void()> destroy;
+        };
+
+        const vkc::Device& m_device;
+        std::vector<Retired> m_retired;
+    };
+}
+
+#endif //VULKANCUBE_DELETIONQUEUE_H
@@ -3,34 +3,290 @@
   * https://github.com/Mnenmenth
   */
 
+#include <algorithm>
+#include <iostream>
+#include <bit>
 #include <vector>
 #include <set>
 #include <map>
+#include <optional>
+#include <tuple>
 #include "Device.h"
 #include "Instance.h"
 #include "Window.h"
+#include "memory/MemoryPool.h"
 #include "pipeline/SwapChain.h"
 #include "pipeline/QueueFamily.h"
+#include "profile/Profiler.h"
+
+const std::vector<type::cstr> vkc::Device::DynamicRenderingExtensions =
+        {
+                VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME,
+                VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME
+        };
 
 vkc::Device::Device(const vkc::Instance& instance, const vkc::Window& window, const std::vector<type::cstr>& extensions) :
         m_physical(VK_NULL_HANDLE),
         m_logical(VK_NULL_HANDLE),
-        m_window(window),
+        m_vk(),
+        m_memProp(),
+        m_properties(),
+        m_apiVersion(VK_API_VERSION_1_0),
+        m_dynamicRendering(false),
+        m_unifiedMemory(false),
+        m_directUpload(false),
+        m_memoryBudget(false),
+        m_indexTypeUint8(false),
+        m_instance(instance),
+        m_allocator(instance.allocator()),
+        m_surface(window.surface()),
+        m_graphicsQueue(VK_NULL_HANDLE),
+        m_presentQueue(VK_NULL_HANDLE)
+{
+    createLogicalDevice(extensions);
+}
+
+vkc::Device::Device(const vkc::Instance& instance, const std::vector<type::cstr>& extensions) :
+        m_physical(VK_NULL_HANDLE),
+        m_logical(VK_NULL_HANDLE),
+        m_vk(),
+        m_memProp(),
+        m_properties(),
+        m_apiVersion(VK_API_VERSION_1_0),
+        m_dynamicRendering(false),
+        m_unifiedMemory(false),
+        m_directUpload(false),
+        m_memoryBudget(false),
+        m_indexTypeUint8(false),
         m_instance(instance),
+        m_allocator(instance.allocator()),
+        m_surface(VK_NULL_HANDLE),
         m_graphicsQueue(VK_NULL_HANDLE),
         m_presentQueue(VK_NULL_HANDLE)
 {
+    createLogicalDevice(extensions);
+}
+
+vkc::Device::~Device()
+{
+    // Anything still allocated was never freed. Pooled allocations are reported
+    // by name, rather than as the blocks holding them
+    std::vector<std::string> leaked = m_memoryPool->live();
+    m_memoryPool.reset();
+    for(const std::string& name : m_memoryTracker.live())
+    {
+        leaked.push_back(name);
+    }
+    for(const std::string& name : leaked)
+    {
+        std::cerr << "Device memory leaked: " << name << std::endl;
+    }
+    m_vk.DestroyDevice(m_logical, m_allocator);
+}
 
-    auto device = FindPhysicalDevice(m_instance.handle(), m_window.surface(), extensions);
+auto vkc::Device::findMemoryType(type::uint32 typeBits, const VkMemoryPropertyFlags& memPropFlags) const -> type::uint32
+{
+    for(type::uint32 i = 0; i < m_memProp.memoryTypeCount; ++i)
+    {
+        if((typeBits & (1 << i)) && (m_memProp.memoryTypes[i].propertyFlags & memPropFlags) == memPropFlags)
+        {
+            return i;
+        }
+    }
+    throw std::runtime_error("Suitable memory type unavailable");
+}
+
+auto vkc::Device::findMemoryType(type::uint32 typeBits, const VkMemoryPropertyFlags& memPropFlags, const VkMemoryPropertyFlags& preferred) const -> type::uint32
+{
+    for(type::uint32 i = 0; i < m_memProp.memoryTypeCount; ++i)
+    {
+        if((typeBits & (1 << i)) && (m_memProp.memoryTypes[i].propertyFlags & (memPropFlags | preferred)) == (memPropFlags | preferred))
+        {
+            return i;
+        }
+    }
+    return findMemoryType(typeBits, memPropFlags);
+}
+
+auto vkc::Device::findMemoryType(type::uint32 typeBits, vkc::MemoryUsage usage, VkDeviceSize size, const VkMemoryPropertyFlags& required) const -> type::uint32
+{
+    // Wanted and unwanted properties for each usage, weighted by how much they matter
+    auto score = [this, usage](VkMemoryPropertyFlags flags) -> int
+    {
+        bool deviceLocal = flags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+        bool hostVisible = flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+        bool hostCached = flags & VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+        switch(usage)
+        {
+            // Host visible video memory is scarce without resizable BAR, it's left for dynamic data
+            case vkc::MemoryUsage::GpuOnly:
+                return deviceLocal * 4 - (hostVisible && !m_unifiedMemory);
+            // Staging memory is only read once by the GPU, so it shouldn't take up video memory
+            case vkc::MemoryUsage::Upload:
+                return -(deviceLocal && !m_unifiedMemory) * 2 - hostCached;
+            // Reading uncached memory from the CPU is slow
+            case vkc::MemoryUsage::Readback:
+                return hostCached * 4 - (deviceLocal && !m_unifiedMemory);
+            // Written over the bus once a frame, saves the GPU reading system memory every draw
+            case vkc::MemoryUsage::Dynamic:
+                return deviceLocal * 2 - hostCached;
+        }
+        return 0;
+    };
+
+    std::vector<vkc::HeapBudget> budget = memoryBudget();
+
+    // Host usages are always mapped. Writes aren't flushed anywhere in vkc, so written memory has to be coherent,
+    // while readers check the type they got and invalidate
+    VkMemoryPropertyFlags requiredFlags = required;
+    if(usage == vkc::MemoryUsage::Readback)
+    {
+        requiredFlags |= VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+    }
+    else if(usage != vkc::MemoryUsage::GpuOnly)
+    {
+        requiredFlags |= VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    }
+    // Lazily allocated memory only backs transient attachments, protected memory needs a protected queue
+    VkMemoryPropertyFlags excluded = VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT | VK_MEMORY_PROPERTY_PROTECTED_BIT;
+
+    // Types fitting in their heap's budget first, then by score, then by heap size
+    std::optional<type::uint32> best;
+    std::tuple<bool, int, VkDeviceSize> bestRank;
+    for(type::uint32 i = 0; i < m_memProp.memoryTypeCount; ++i)
+    {
+        const VkMemoryType& memType = m_memProp.memoryTypes[i];
+        if(!(typeBits & (1 << i)) || (memType.propertyFlags & requiredFlags) != requiredFlags || (memType.propertyFlags & excluded))
+        {
+            continue;
+        }
+
+        std::tuple<bool, int, VkDeviceSize> rank = {
+                budget[memType.heapIndex].available() >= size,
+                score(memType.propertyFlags),
+                m_memProp.memoryHeaps[memType.heapIndex].size
+        };
+        if(!best.has_value() || rank > bestRank)
+        {
+            best = i;
+            bestRank = rank;
+        }
+    }
+
+    if(!best.has_value())
+    {
+        throw std::runtime_error("Suitable memory type unavailable");
+    }
+    return best.value();
+}
+
+auto vkc::Device::memoryBudget() const -> std::vector<vkc::HeapBudget>
+{
+    std::vector<vkc::HeapBudget> heaps(m_memProp.memoryHeapCount);
+    if(m_memoryBudget)
+    {
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProps = {};
+        budgetProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+        VkPhysicalDeviceMemoryProperties2 memProps = {};
+        memProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+        memProps.pNext = &budgetProps;
+        m_instance.vk().GetPhysicalDeviceMemoryProperties2(m_physical, &memProps);
+
+        for(type::uint32 i = 0; i < m_memProp.memoryHeapCount; ++i)
+        {
+            heaps[i] = { budgetProps.heapBudget[i], budgetProps.heapUsage[i] };
+        }
+    }
+    else
+    {
+        // Only what vkc allocated is known to be in use
+        vkc::MemorySnapshot tracked = m_memoryTracker.snapshot(0);
+        for(type::uint32 i = 0; i < m_memProp.memoryHeapCount; ++i)
+        {
+            heaps[i] = { m_memProp.memoryHeaps[i].size, tracked.heaps[i].tracked };
+        }
+    }
+    return heaps;
+}
+
+auto vkc::Device::allocateMemory(const VkMemoryAllocateInfo& allocInfo, VkDeviceMemory& memory, vkc::MemoryCategory category, std::string name, VkDeviceSize used) const -> VkResult
+{
+    VkResult result = m_vk.AllocateMemory(m_logical, &allocInfo, m_allocator, &memory);
+    if(result == VK_SUCCESS)
+    {
+        type::uint32 heap = m_memProp.memoryTypes[allocInfo.memoryTypeIndex].heapIndex;
+        m_memoryTracker.add(memory, heap, allocInfo.allocationSize, used == 0 ? allocInfo.allocationSize : used, category, std::move(name));
+    }
+    return result;
+}
+
+auto vkc::Device::freeMemory(VkDeviceMemory memory) const -> void
+{
+    if(memory == VK_NULL_HANDLE)
+    {
+        return;
+    }
+    m_memoryTracker.remove(memory);
+    m_vk.FreeMemory(m_logical, memory, m_allocator);
+}
+
+auto vkc::Device::memorySnapshot(type::size largest) const -> vkc::MemorySnapshot
+{
+    vkc::MemorySnapshot snapshot = m_memoryTracker.snapshot(largest);
+    std::vector<vkc::HeapBudget> budget = memoryBudget();
+
+    snapshot.heaps.resize(m_memProp.memoryHeapCount);
+    for(type::uint32 i = 0; i < m_memProp.memoryHeapCount; ++i)
+    {
+        vkc::MemorySnapshot::Heap& heap = snapshot.heaps[i];
+        heap.size = m_memProp.memoryHeaps[i].size;
+        heap.deviceLocal = m_memProp.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+        heap.budget = budget[i];
+    }
+    snapshot.maxAllocations = m_properties.limits.maxMemoryAllocationCount;
+    return snapshot;
+}
+
+auto vkc::Device::supportedSampleCount(VkSampleCountFlagBits requested) const -> VkSampleCountFlagBits
+{
+    VkSampleCountFlags supported = m_properties.limits.framebufferColorSampleCounts;
+    // Counts are single bits, so the highest supported bit at or below the request wins
+    for(VkSampleCountFlags count = std::bit_floor(static_cast<VkSampleCountFlags>(requested)); count > VK_SAMPLE_COUNT_1_BIT; count >>= 1)
+    {
+        if(supported & count)
+        {
+            return static_cast<VkSampleCountFlagBits>(count);
+        }
+    }
+    return VK_SAMPLE_COUNT_1_BIT;
+}
+
+auto vkc::Device::vertexFormatSupported(VkFormat format) const -> bool
+{
+    VkFormatProperties props = {};
+    m_instance.vk().GetPhysicalDeviceFormatProperties(m_physical, format, &props);
+    return props.bufferFeatures & VK_FORMAT_FEATURE_VERTEX_BUFFER_BIT;
+}
+
+auto vkc::Device::createLogicalDevice(const std::vector<type::cstr>& extensions) -> void
+{
+    VKC_ZONE("Device::Device");
+
+    auto device = FindPhysicalDevice(m_instance, m_surface, extensions);
     m_physical = device.first;
     m_indices = device.second;
 
+    m_instance.vk().GetPhysicalDeviceMemoryProperties(m_physical, &m_memProp);
+    m_instance.vk().GetPhysicalDeviceProperties(m_physical, &m_properties);
+    m_apiVersion = std::min(m_instance.apiVersion(), m_properties.apiVersion);
+    classifyMemory();
+
     // Setup queue families for device
-    std::set<type::uint32> uniqueQueueFamilies =
-            {
-                m_indices.graphics.value(),
-                m_indices.present.value()
-            };
+    std::set<type::uint32> uniqueQueueFamilies = { m_indices.graphics.value() };
+    if(m_indices.present.has_value())
+    {
+        uniqueQueueFamilies.insert(m_indices.present.value());
+    }
     std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
 
     float priority = 1.0f;
@@ -46,14 +302,93 @@ vkc::Device::Device(const vkc::Instance& instance, const vkc::Window& window, co
 
     VkPhysicalDeviceFeatures deviceFeatures = {};
 
+    // Dynamic rendering and synchronization2 are core in 1.3, and extensions on 1.2
+    std::vector<type::cstr> enabledExtensions = extensions;
+    VkPhysicalDeviceVulkan13Features features13 = {};
+    features13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+    VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures = {};
+    dynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+    VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2Features = {};
+    synchronization2Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR;
+    synchronization2Features.pNext = &dynamicRenderingFeatures;
+
+    void* featureChain = nullptr;
+    if(m_apiVersion >= VK_API_VERSION_1_3)
+    {
+        featureChain = &features13;
+    }
+    else if(m_apiVersion >= VK_API_VERSION_1_2 && CheckExtensionSupport(m_instance.vk(), m_physical, DynamicRenderingExtensions))
+    {
+        featureChain = &synchronization2Features;
+    }
+
+    if(featureChain != nullptr)
+    {
+        VkPhysicalDeviceFeatures2 supported = {};
+        supported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        supported.pNext = featureChain;
+        m_instance.vk().GetPhysicalDeviceFeatures2(m_physical, &supported);
+
+        if(featureChain == &features13)
+        {
+            m_dynamicRendering = features13.dynamicRendering && features13.synchronization2;
+            // The query filled in every 1.3 feature, only enable the two that are used
+            features13 = {};
+            features13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+            features13.dynamicRendering = VK_TRUE;
+            features13.synchronization2 = VK_TRUE;
+        }
+        else
+        {
+            m_dynamicRendering = dynamicRenderingFeatures.dynamicRendering && synchronization2Features.synchronization2;
+            if(m_dynamicRendering)
+            {
+                enabledExtensions.insert(enabledExtensions.end(), DynamicRenderingExtensions.begin(), DynamicRenderingExtensions.end());
+            }
+        }
+    }
+
+    // Budget is queried through vkGetPhysicalDeviceMemoryProperties2, core in 1.1
+    static const std::vector<type::cstr> MemoryBudgetExtensions = { VK_EXT_MEMORY_BUDGET_EXTENSION_NAME };
+    if(m_apiVersion >= VK_API_VERSION_1_1 && m_instance.vk().GetPhysicalDeviceMemoryProperties2 != nullptr &&
+       CheckExtensionSupport(m_instance.vk(), m_physical, MemoryBudgetExtensions))
+    {
+        enabledExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        m_memoryBudget = true;
+    }
+
+    // 8 bit indices halve the index buffers of small meshes, where the device can read them
+    static const std::vector<type::cstr> IndexTypeUint8Extensions = { VK_EXT_INDEX_TYPE_UINT8_EXTENSION_NAME };
+    VkPhysicalDeviceIndexTypeUint8FeaturesEXT indexTypeUint8Features = {};
+    indexTypeUint8Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_INDEX_TYPE_UINT8_FEATURES_EXT;
+    if(m_apiVersion >= VK_API_VERSION_1_1 && m_instance.vk().GetPhysicalDeviceFeatures2 != nullptr &&
+       CheckExtensionSupport(m_instance.vk(), m_physical, IndexTypeUint8Extensions))
+    {
+        VkPhysicalDeviceFeatures2 supported = {};
+        supported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        supported.pNext = &indexTypeUint8Features;
+        m_instance.vk().GetPhysicalDeviceFeatures2(m_physical, &supported);
+        m_indexTypeUint8 = indexTypeUint8Features.indexTypeUint8;
+        if(m_indexTypeUint8)
+        {
+            enabledExtensions.push_back(VK_EXT_INDEX_TYPE_UINT8_EXTENSION_NAME);
+        }
+    }
+
     // Setup logical device
     VkDeviceCreateInfo createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.pNext = m_dynamicRendering ? featureChain : nullptr;
+    if(m_indexTypeUint8)
+    {
+        indexTypeUint8Features.pNext = const_cast<void*>(createInfo.pNext);
+        createInfo.pNext = &indexTypeUint8Features;
+    }
     createInfo.queueCreateInfoCount = static_cast<type::uint32>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
     createInfo.pEnabledFeatures = &deviceFeatures;
-    createInfo.enabledExtensionCount = static_cast<type::uint32>(extensions.size());
-    createInfo.ppEnabledExtensionNames = extensions.data();
+    createInfo.enabledExtensionCount = static_cast<type::uint32>(enabledExtensions.size());
+    createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
     if(m_instance.validationLayersEnabled())
     {
@@ -65,33 +400,70 @@ vkc::Device::Device(const vkc::Instance& instance, const vkc::Window& window, co
         createInfo.enabledLayerCount = 0;
     }
 
-    if(vkCreateDevice(m_physical, &createInfo, nullptr, &m_logical) != VK_SUCCESS)
+    if(m_instance.vk().CreateDevice(m_physical, &createInfo, m_allocator, &m_logical) != VK_SUCCESS)
     {
         throw std::runtime_error("Logical device creation failed");
     }
 
+    // Before 1.3, dynamic rendering is only enabled through the KHR extensions
+    m_vk.load(m_logical, m_instance.vk().GetDeviceProcAddr, m_apiVersion, m_dynamicRendering && m_apiVersion < VK_API_VERSION_1_3);
+
     // Get handles for graphics and presentation queues
-    vkGetDeviceQueue(m_logical, m_indices.graphics.value(), 0, &m_graphicsQueue);
-    vkGetDeviceQueue(m_logical, m_indices.present.value(), 0, &m_presentQueue);
+    m_vk.GetDeviceQueue(m_logical, m_indices.graphics.value(), 0, &m_graphicsQueue);
+    if(m_indices.present.has_value())
+    {
+        m_vk.GetDeviceQueue(m_logical, m_indices.present.value(), 0, &m_presentQueue);
+    }
+
+    m_memoryPool = std::make_unique<vkc::MemoryPool>(*this);
 }
 
-vkc::Device::~Device()
+auto vkc::Device::classifyMemory() -> void
 {
-    vkDestroyDevice(m_logical, nullptr);
+    VkDeviceSize largestDeviceLocal = 0;
+    bool onlyDeviceLocal = true;
+    for(type::uint32 i = 0; i < m_memProp.memoryHeapCount; ++i)
+    {
+        if(m_memProp.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+        {
+            largestDeviceLocal = std::max(largestDeviceLocal, m_memProp.memoryHeaps[i].size);
+        }
+        else
+        {
+            onlyDeviceLocal = false;
+        }
+    }
+    // Software rasterizers report a CPU device, some integrated GPUs report their system memory heap as not device local
+    m_unifiedMemory = onlyDeviceLocal ||
+            m_properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU ||
+            m_properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_CPU;
+
+    // Without resizable BAR only a 256MiB window of video memory is host visible, too little to hold
+    // every upload. With it, the host visible heap is all or nearly all of video memory
+    VkMemoryPropertyFlags mappable = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    VkDeviceSize largestMappable = 0;
+    for(type::uint32 i = 0; i < m_memProp.memoryTypeCount; ++i)
+    {
+        if((m_memProp.memoryTypes[i].propertyFlags & mappable) == mappable)
+        {
+            largestMappable = std::max(largestMappable, m_memProp.memoryHeaps[m_memProp.memoryTypes[i].heapIndex].size);
+        }
+    }
+    m_directUpload = largestMappable > 0 && (m_unifiedMemory || largestMappable >= largestDeviceLocal / 4 * 3);
 }
 
-auto vkc::Device::CheckExtensionSupport(const VkPhysicalDevice& device, const std::vector<type::cstr>& extensions) -> bool
+auto vkc::Device::CheckExtensionSupport(const vkc::InstanceDispatch& vk, const VkPhysicalDevice& device, const std::vector<type::cstr>& extensions) -> bool
 {
     // Get number of extension supported
     type::uint32 extCount;
-    vkEnumerateDeviceExtensionProperties(device, nullptr, &extCount, nullptr);
+    vk.EnumerateDeviceExtensionProperties(device, nullptr, &extCount, nullptr);
 
     if(extCount < 1)
-        return false;
+        return extensions.empty();
 
     // Get supported extensions
     std::vector<VkExtensionProperties> availableExtensions(extCount);
-    vkEnumerateDeviceExtensionProperties(device, nullptr, &extCount, availableExtensions.data());
+    vk.EnumerateDeviceExtensionProperties(device, nullptr, &extCount, availableExtensions.data());
 
     // Iterate through available extensions and make sure that all are present
     std::set<std::string> requiredExtensions(extensions.begin(), extensions.end());
@@ -104,29 +476,35 @@ auto vkc::Device::CheckExtensionSupport(const VkPhysicalDevice& device, const st
 }
 
 auto vkc::Device::RatePhysicalDevice(
+        const vkc::InstanceDispatch& vk,
         const VkPhysicalDevice& device,
         const VkSurfaceKHR& surface,
         const std::vector<type::cstr>& requiredExtensions
         ) -> std::pair<int, vkc::QueueFamilyIndices>
 {
     // Device isn't suitable if it doesn't support required queue families and extensions
-    QueueFamilyIndices indices = vkc::QueueFamily::FindQueueFamilies(device, surface);
-    if(!indices.isComplete() || !CheckExtensionSupport(device, requiredExtensions))
+    // Presentation is only required when there is a surface to present to
+    bool requirePresent = surface != VK_NULL_HANDLE;
+    QueueFamilyIndices indices = vkc::QueueFamily::FindQueueFamilies(vk, device, surface);
+    if(!indices.isComplete(requirePresent) || !CheckExtensionSupport(vk, device, requiredExtensions))
     {
         return std::make_pair(0, indices);
     }
 
     // Device isn't suitable if there isn't at least one format and present mode
-    SwapChainSupportDetails swapChainSupport = SwapChain::QuerySwapChainSupport(device, surface);
-    if(swapChainSupport.formats.empty() || swapChainSupport.presentModes.empty())
+    if(requirePresent)
     {
-        return std::make_pair(0, indices);
+        SwapChainSupportDetails swapChainSupport = SwapChain::QuerySwapChainSupport(vk, device, surface);
+        if(swapChainSupport.formats.empty() || swapChainSupport.presentModes.empty())
+        {
+            return std::make_pair(0, indices);
+        }
     }
 
     VkPhysicalDeviceProperties deviceProperties;
-    vkGetPhysicalDeviceProperties(device, &deviceProperties);
+    vk.GetPhysicalDeviceProperties(device, &deviceProperties);
 //    VkPhysicalDeviceFeatures deviceFeatures;
-//    vkGetPhysicalDeviceFeatures(device, &deviceFeatures);
+//    vk.GetPhysicalDeviceFeatures(device, &deviceFeatures);
 
     int score = 0;
 
@@ -142,14 +520,14 @@ auto vkc::Device::RatePhysicalDevice(
 }
 
 auto vkc::Device::FindPhysicalDevice(
-        const VkInstance& instance,
+        const vkc::Instance& instance,
         const VkSurfaceKHR& surface,
         const std::vector<type::cstr>& requiredExtensions
         )-> std::pair<VkPhysicalDevice, vkc::QueueFamilyIndices>
 {
     // Check for devices with vulkan support
     type::uint32 deviceCount;
-    vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
+    instance.vk().EnumeratePhysicalDevices(instance.handle(), &deviceCount, nullptr);
     if(deviceCount < 1)
     {
         throw std::runtime_error("No GPU's with Vulkan support available");
@@ -157,14 +535,14 @@ auto vkc::Device::FindPhysicalDevice(
 
     // Get available devices
     std::vector<VkPhysicalDevice> devices(deviceCount);
-    vkEnumeratePhysicalDevices(instance, &deviceCount, devices.data());
+    instance.vk().EnumeratePhysicalDevices(instance.handle(), &deviceCount, devices.data());
 
     // Order devices by rating
     int highestRating = 0;
     std::pair<VkPhysicalDevice, vkc::QueueFamilyIndices> highestRated;
     for(const auto& d : devices)
     {
-        auto rating = RatePhysicalDevice(d, surface, requiredExtensions);
+        auto rating = RatePhysicalDevice(instance.vk(), d, surface, requiredExtensions);
         if(std::get<0>(rating) > highestRating)
         {
             highestRating = std::get<0>(rating);
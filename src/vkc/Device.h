@@ -7,21 +7,34 @@
 #define VULKANCUBE_DEVICE_H
 
 #include <vulkan/vulkan.h>
+#include <memory>
+#include <string>
 #include <vector>
 #include "Types.h"
 #include "NonCopyable.h"
+#include "Dispatch.h"
+#include "memory/MemoryTracker.h"
+#include "memory/MemoryUsage.h"
 #include "pipeline/QueueFamilyIndices.h"
 
 namespace vkc
 {
     class Instance;
     class Window;
+    class MemoryPool;
     class Device : public NonCopyable
     {
     public:
         Device(const vkc::Instance& instance, const vkc::Window& window, const std::vector<type::cstr>& extensions);
+        // Headless device. Presentation support isn't required and presentQueue() is VK_NULL_HANDLE
+        Device(const vkc::Instance& instance, const std::vector<type::cstr>& extensions);
         ~Device();
 
+        // Device level commands, loaded right after creation so calls skip the loader's trampoline
+        [[nodiscard]]
+        inline auto vk() const -> const vkc::DeviceDispatch& { return m_vk; }
+        [[nodiscard]]
+        inline auto instance() const -> const vkc::Instance& { return m_instance; }
         [[nodiscard]]
         inline auto physical() const -> const VkPhysicalDevice& { return m_physical; }
         [[nodiscard]]
@@ -32,26 +45,103 @@ namespace vkc
         inline auto graphicsQueue() const -> const VkQueue& { return m_graphicsQueue; }
         [[nodiscard]]
         inline auto presentQueue() const -> const VkQueue& { return m_presentQueue; }
+        [[nodiscard]]
+        inline auto headless() const -> bool { return m_surface == VK_NULL_HANDLE; }
+        [[nodiscard]]
+        inline auto memoryProperties() const -> const VkPhysicalDeviceMemoryProperties& { return m_memProp; }
+        // Version both the instance and the physical device support
+        [[nodiscard]]
+        inline auto apiVersion() const -> type::uint32 { return m_apiVersion; }
+        [[nodiscard]]
+        inline auto properties() const -> const VkPhysicalDeviceProperties& { return m_properties; }
+        // Whether dynamic rendering and synchronization2 were enabled, so draws can begin
+        // rendering against image views without a render pass or framebuffers
+        [[nodiscard]]
+        inline auto dynamicRendering() const -> bool { return m_dynamicRendering; }
+        // Whether device local memory is all the device has, as on integrated GPUs and software rasterizers
+        [[nodiscard]]
+        inline auto unifiedMemory() const -> bool { return m_unifiedMemory; }
+        // Whether device local memory can be mapped and written directly, so uploads don't need staging buffers
+        // True with unified memory, and on discrete GPUs with nearly all of video memory host visible (resizable BAR)
+        [[nodiscard]]
+        inline auto directUpload() const -> bool { return m_directUpload; }
+        // Whether memoryBudget() comes from VK_EXT_memory_budget, otherwise it's the size of each heap less what vkc allocated from it
+        [[nodiscard]]
+        inline auto memoryBudgetSupported() const -> bool { return m_memoryBudget; }
+        // Whether VK_EXT_index_type_uint8 was enabled, so index buffers can hold 8 bit indices
+        [[nodiscard]]
+        inline auto indexTypeUint8() const -> bool { return m_indexTypeUint8; }
+        // Host allocation callbacks of the instance, for every object created from this device
+        [[nodiscard]]
+        inline auto allocator() const -> const VkAllocationCallbacks* { return m_allocator; }
+
+        // Index of the first memory type allowed by typeBits that has all of the requested properties
+        auto findMemoryType(type::uint32 typeBits, const VkMemoryPropertyFlags& memPropFlags) const -> type::uint32;
+        // Same, but picks a type that also has the preferred properties when there is one
+        auto findMemoryType(type::uint32 typeBits, const VkMemoryPropertyFlags& memPropFlags, const VkMemoryPropertyFlags& preferred) const -> type::uint32;
+        // Index of the memory type best suited to the usage among those allowed by typeBits with all of the required properties
+        // Types in heaps without size bytes left in their budget are only picked when no other type fits
+        auto findMemoryType(type::uint32 typeBits, vkc::MemoryUsage usage, VkDeviceSize size, const VkMemoryPropertyFlags& required = 0) const -> type::uint32;
+        // Indexed by heap, queried again on every call
+        auto memoryBudget() const -> std::vector<vkc::HeapBudget>;
+
+        // vkAllocateMemory, recording the allocation under the category and name
+        // Used is how much of the allocation holds resources, 0 for all of it
+        auto allocateMemory(const VkMemoryAllocateInfo& allocInfo, VkDeviceMemory& memory, vkc::MemoryCategory category, std::string name, VkDeviceSize used = 0) const -> VkResult;
+        auto freeMemory(VkDeviceMemory memory) const -> void;
+        // Memory the device doesn't allocate itself is added here
+        [[nodiscard]]
+        inline auto memoryTracker() const -> vkc::MemoryTracker& { return m_memoryTracker; }
+        // Buffers sub-allocate their memory from here
+        [[nodiscard]]
+        inline auto memoryPool() const -> vkc::MemoryPool& { return *m_memoryPool; }
+        // Tracked allocations, the largest few of them, and the budget of every heap
+        auto memorySnapshot(type::size largest = 16) const -> vkc::MemorySnapshot;
+        // Highest sample count color attachments support, no higher than requested
+        auto supportedSampleCount(VkSampleCountFlagBits requested) const -> VkSampleCountFlagBits;
+        // Whether vertex buffers can hold attributes of the format
+        auto vertexFormatSupported(VkFormat format) const -> bool;
 
     private:
         VkPhysicalDevice m_physical;
         VkDevice m_logical;
+        vkc::DeviceDispatch m_vk;
+        VkPhysicalDeviceMemoryProperties m_memProp;
+        VkPhysicalDeviceProperties m_properties;
+        type::uint32 m_apiVersion;
+        bool m_dynamicRendering;
+        bool m_unifiedMemory;
+        bool m_directUpload;
+        bool m_memoryBudget;
+        bool m_indexTypeUint8;
+
+        // Allocations go through const devices
+        mutable vkc::MemoryTracker m_memoryTracker;
+        std::unique_ptr<vkc::MemoryPool> m_memoryPool;
 
         const vkc::Instance& m_instance;
-        const vkc::Window& m_window;
+        const VkAllocationCallbacks* m_allocator;
+        VkSurfaceKHR m_surface;
 
         vkc::QueueFamilyIndices m_indices;
         VkQueue m_graphicsQueue;
         VkQueue m_presentQueue;
 
-        static auto CheckExtensionSupport(const VkPhysicalDevice& device, const std::vector<type::cstr>& extensions) -> bool;
+        auto createLogicalDevice(const std::vector<type::cstr>& extensions) -> void;
+        auto classifyMemory() -> void;
+
+        // Extensions providing dynamic rendering on devices older than Vulkan 1.3
+        static const std::vector<type::cstr> DynamicRenderingExtensions;
+
+        static auto CheckExtensionSupport(const vkc::InstanceDispatch& vk, const VkPhysicalDevice& device, const std::vector<type::cstr>& extensions) -> bool;
         static auto RatePhysicalDevice(
+                const vkc::InstanceDispatch& vk,
                 const VkPhysicalDevice& device,
                 const VkSurfaceKHR& surface,
                 const std::vector<type::cstr>& requiredExtensions
                 ) -> std::pair<int, vkc::QueueFamilyIndices>;
         static auto FindPhysicalDevice(
-                const VkInstance& instance,
+                const vkc::Instance& instance,
                 const VkSurfaceKHR& surface,
                 const std::vector<type::cstr>& requiredExtensions
                 ) -> std::pair<VkPhysicalDevice, vkc::QueueFamilyIndices>;
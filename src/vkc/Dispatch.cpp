@@ -0,0 +1,112 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#include <stdexcept>
+#include "Dispatch.h"
+#include "Types.h"
+
+#ifdef VKC_DLOPEN_VULKAN
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+namespace
+{
+    auto OpenLoader() -> PFN_vkGetInstanceProcAddr
+    {
+#if defined(_WIN32)
+        const type::cstr names[] = { "vulkan-1.dll" };
+#elif defined(__APPLE__)
+        const type::cstr names[] = { "libvulkan.1.dylib", "libvulkan.dylib", "libMoltenVK.dylib" };
+#else
+        const type::cstr names[] = { "libvulkan.so.1", "libvulkan.so" };
+#endif
+        for(type::cstr name : names)
+        {
+            // The library stays open for the lifetime of the process
+#ifdef _WIN32
+            HMODULE library = LoadLibraryA(name);
+            if(library != nullptr)
+            {
+                return reinterpret_cast<PFN_vkGetInstanceProcAddr>(GetProcAddress(library, "vkGetInstanceProcAddr"));
+            }
+#else
+            void* library = dlopen(name, RTLD_NOW | RTLD_LOCAL);
+            if(library != nullptr)
+            {
+                return reinterpret_cast<PFN_vkGetInstanceProcAddr>(dlsym(library, "vkGetInstanceProcAddr"));
+            }
+#endif
+        }
+        return nullptr;
+    }
+}
+#endif
+
+auto vkc::LoaderProcAddr() -> PFN_vkGetInstanceProcAddr
+{
+#ifdef VKC_DLOPEN_VULKAN
+    static PFN_vkGetInstanceProcAddr getProcAddr = OpenLoader();
+    if(getProcAddr == nullptr)
+    {
+        throw std::runtime_error("Vulkan loader library not found");
+    }
+    return getProcAddr;
+#else
+    return &vkGetInstanceProcAddr;
+#endif
+}
+
+auto vkc::GlobalDispatch::Get() -> const GlobalDispatch&
+{
+    static const GlobalDispatch dispatch = []
+    {
+        GlobalDispatch d;
+        d.GetInstanceProcAddr = LoaderProcAddr();
+#define VKC_LOAD_COMMAND(name) d.name = reinterpret_cast<PFN_vk##name>(d.GetInstanceProcAddr(VK_NULL_HANDLE, "vk" #name));
+        VKC_GLOBAL_COMMANDS(VKC_LOAD_COMMAND)
+#undef VKC_LOAD_COMMAND
+        if(d.CreateInstance == nullptr)
+        {
+            throw std::runtime_error("Vulkan loader entry points unavailable");
+        }
+        return d;
+    }();
+    return dispatch;
+}
+
+auto vkc::InstanceDispatch::load(VkInstance instance, PFN_vkGetInstanceProcAddr getProcAddr, type::uint32 apiVersion) -> void
+{
+#define VKC_LOAD_COMMAND(name) name = reinterpret_cast<PFN_vk##name>(getProcAddr(instance, "vk" #name));
+    VKC_INSTANCE_COMMANDS(VKC_LOAD_COMMAND)
+#undef VKC_LOAD_COMMAND
+    if(apiVersion < VK_API_VERSION_1_1)
+    {
+#define VKC_CLEAR_COMMAND(name) name = nullptr;
+        VKC_INSTANCE_1_1_COMMANDS(VKC_CLEAR_COMMAND)
+#undef VKC_CLEAR_COMMAND
+    }
+}
+
+auto vkc::DeviceDispatch::load(VkDevice device, PFN_vkGetDeviceProcAddr getProcAddr, type::uint32 apiVersion, bool khrPromoted) -> void
+{
+#define VKC_LOAD_COMMAND(name) name = reinterpret_cast<PFN_vk##name>(getProcAddr(device, "vk" #name));
+    VKC_DEVICE_COMMANDS(VKC_LOAD_COMMAND)
+#undef VKC_LOAD_COMMAND
+    if(apiVersion < VK_API_VERSION_1_1)
+    {
+#define VKC_CLEAR_COMMAND(name) name = nullptr;
+        VKC_DEVICE_1_1_COMMANDS(VKC_CLEAR_COMMAND)
+#undef VKC_CLEAR_COMMAND
+    }
+    if(apiVersion < VK_API_VERSION_1_3)
+    {
+#define VKC_LOAD_KHR_COMMAND(name) name = khrPromoted ? reinterpret_cast<PFN_vk##name>(getProcAddr(device, "vk" #name "KHR")) : nullptr;
+        VKC_DEVICE_KHR_COMMANDS(VKC_LOAD_KHR_COMMAND)
+#undef VKC_LOAD_KHR_COMMAND
+    }
+}
@@ -0,0 +1,187 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#ifndef VULKANCUBE_DISPATCH_H
+#define VULKANCUBE_DISPATCH_H
+
+#include <vulkan/vulkan.h>
+#include "Types.h"
+
+// Vulkan commands are listed without their vk prefix and loaded once into the tables below
+// Calling through a device table skips the loader's trampoline, which otherwise has to look up
+// the dispatch table of the handle on every call
+
+// Commands that don't take an instance
+#define VKC_GLOBAL_COMMANDS(X) \
+    X(CreateInstance) \
+    X(EnumerateInstanceLayerProperties) \
+    X(EnumerateInstanceExtensionProperties) \
+    X(EnumerateInstanceVersion)
+
+// Commands dispatched on an instance or physical device
+#define VKC_INSTANCE_COMMANDS(X) \
+    X(DestroyInstance) \
+    X(EnumeratePhysicalDevices) \
+    X(EnumerateDeviceExtensionProperties) \
+    X(GetPhysicalDeviceProperties) \
+    X(GetPhysicalDeviceFeatures) \
+    X(GetPhysicalDeviceFeatures2) \
+    X(GetPhysicalDeviceFormatProperties) \
+    X(GetPhysicalDeviceMemoryProperties) \
+    X(GetPhysicalDeviceMemoryProperties2) \
+    X(GetPhysicalDeviceQueueFamilyProperties) \
+    X(CreateDevice) \
+    X(GetDeviceProcAddr) \
+    X(DestroySurfaceKHR) \
+    X(GetPhysicalDeviceSurfaceSupportKHR) \
+    X(GetPhysicalDeviceSurfaceCapabilitiesKHR) \
+    X(GetPhysicalDeviceSurfaceFormatsKHR) \
+    X(GetPhysicalDeviceSurfacePresentModesKHR) \
+    X(CreateDebugUtilsMessengerEXT) \
+    X(DestroyDebugUtilsMessengerEXT)
+
+// Commands dispatched on a device, queue or command buffer
+#define VKC_DEVICE_COMMANDS(X) \
+    X(DestroyDevice) \
+    X(GetDeviceQueue) \
+    X(DeviceWaitIdle) \
+    X(QueueSubmit) \
+    X(QueueWaitIdle) \
+    X(AllocateMemory) \
+    X(FreeMemory) \
+    X(MapMemory) \
+    X(UnmapMemory) \
+    X(FlushMappedMemoryRanges) \
+    X(InvalidateMappedMemoryRanges) \
+    X(CreateBuffer) \
+    X(DestroyBuffer) \
+    X(GetBufferMemoryRequirements) \
+    X(BindBufferMemory) \
+    X(CreateImage) \
+    X(DestroyImage) \
+    X(GetImageMemoryRequirements) \
+    X(BindImageMemory) \
+    X(CreateImageView) \
+    X(DestroyImageView) \
+    X(CreateShaderModule) \
+    X(DestroyShaderModule) \
+    X(CreatePipelineLayout) \
+    X(DestroyPipelineLayout) \
+    X(CreatePipelineCache) \
+    X(DestroyPipelineCache) \
+    X(GetPipelineCacheData) \
+    X(CreateGraphicsPipelines) \
+    X(DestroyPipeline) \
+    X(CreateRenderPass) \
+    X(DestroyRenderPass) \
+    X(CreateFramebuffer) \
+    X(DestroyFramebuffer) \
+    X(CreateDescriptorSetLayout) \
+    X(DestroyDescriptorSetLayout) \
+    X(CreateDescriptorPool) \
+    X(DestroyDescriptorPool) \
+    X(ResetDescriptorPool) \
+    X(AllocateDescriptorSets) \
+    X(UpdateDescriptorSets) \
+    X(CreateDescriptorUpdateTemplate) \
+    X(DestroyDescriptorUpdateTemplate) \
+    X(UpdateDescriptorSetWithTemplate) \
+    X(CreateCommandPool) \
+    X(DestroyCommandPool) \
+    X(ResetCommandPool) \
+    X(AllocateCommandBuffers) \
+    X(FreeCommandBuffers) \
+    X(BeginCommandBuffer) \
+    X(EndCommandBuffer) \
+    X(CreateFence) \
+    X(DestroyFence) \
+    X(ResetFences) \
+    X(GetFenceStatus) \
+    X(WaitForFences) \
+    X(CreateSemaphore) \
+    X(DestroySemaphore) \
+    X(CreateQueryPool) \
+    X(DestroyQueryPool) \
+    X(GetQueryPoolResults) \
+    X(CmdBeginRenderPass) \
+    X(CmdEndRenderPass) \
+    X(CmdBeginRendering) \
+    X(CmdEndRendering) \
+    X(CmdBindPipeline) \
+    X(CmdBindDescriptorSets) \
+    X(CmdBindVertexBuffers) \
+    X(CmdBindIndexBuffer) \
+    X(CmdDraw) \
+    X(CmdDrawIndexed) \
+    X(CmdCopyBuffer) \
+    X(CmdCopyImageToBuffer) \
+    X(CmdPipelineBarrier) \
+    X(CmdPipelineBarrier2) \
+    X(CmdResetQueryPool) \
+    X(CmdWriteTimestamp) \
+    X(CreateSwapchainKHR) \
+    X(DestroySwapchainKHR) \
+    X(GetSwapchainImagesKHR) \
+    X(AcquireNextImageKHR) \
+    X(QueuePresentKHR)
+
+// Instance commands core since Vulkan 1.1, left null on older instances
+#define VKC_INSTANCE_1_1_COMMANDS(X) \
+    X(GetPhysicalDeviceFeatures2) \
+    X(GetPhysicalDeviceMemoryProperties2)
+
+// Device commands core since Vulkan 1.1, left null on older devices
+#define VKC_DEVICE_1_1_COMMANDS(X) \
+    X(CreateDescriptorUpdateTemplate) \
+    X(DestroyDescriptorUpdateTemplate) \
+    X(UpdateDescriptorSetWithTemplate)
+
+// Device commands promoted to core in Vulkan 1.3, loaded by their KHR name when the device is older and enabled the extensions
+#define VKC_DEVICE_KHR_COMMANDS(X) \
+    X(CmdBeginRendering) \
+    X(CmdEndRendering) \
+    X(CmdPipelineBarrier2)
+
+#define VKC_DECLARE_COMMAND(name) PFN_vk##name name = nullptr;
+
+namespace vkc
+{
+    // Entry point of the Vulkan loader that every other command is looked up through
+    // With VKC_DLOPEN_VULKAN the loader library is opened at runtime instead of being linked
+    // Throws if the loader can't be found
+    auto LoaderProcAddr() -> PFN_vkGetInstanceProcAddr;
+
+    struct GlobalDispatch
+    {
+        PFN_vkGetInstanceProcAddr GetInstanceProcAddr = nullptr;
+        VKC_GLOBAL_COMMANDS(VKC_DECLARE_COMMAND)
+
+        // Loaded on first use
+        static auto Get() -> const GlobalDispatch&;
+    };
+
+    struct InstanceDispatch
+    {
+        VKC_INSTANCE_COMMANDS(VKC_DECLARE_COMMAND)
+
+        // Commands of extensions that weren't enabled, or of a newer core version than apiVersion, are left null
+        // Physical device commands also need the physical device to support their version
+        auto load(VkInstance instance, PFN_vkGetInstanceProcAddr getProcAddr, type::uint32 apiVersion) -> void;
+    };
+
+    struct DeviceDispatch
+    {
+        VKC_DEVICE_COMMANDS(VKC_DECLARE_COMMAND)
+
+        // Commands of extensions that weren't enabled, or of a newer core version than apiVersion, are left null
+        // Drivers may return core commands of versions the device doesn't support, so the version decides
+        // between the core and KHR names of promoted commands, rather than which of them is found
+        auto load(VkDevice device, PFN_vkGetDeviceProcAddr getProcAddr, type::uint32 apiVersion, bool khrPromoted) -> void;
+    };
+}
+
+#undef VKC_DECLARE_COMMAND
+
+#endif //VULKANCUBE_DISPATCH_H
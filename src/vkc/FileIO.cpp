@@ -4,9 +4,19 @@
   */
 
 #include <fstream>
+#include <stdexcept>
 #include "FileIO.h"
 #include "Types.h"
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 auto vkc::FileIO::ReadFile(const std::string &fileName, std::vector<char> &buffer) -> void
 {
     std::ifstream file(fileName, std::ios::ate | std::ios::binary);
@@ -18,4 +28,78 @@ auto vkc::FileIO::ReadFile(const std::string &fileName, std::vector<char> &buffe
     file.seekg(0);
     file.read(buffer.data(), fileSize);
     file.close();
-}
\ No newline at end of file
+}
+
+vkc::FileIO::MappedFile::MappedFile(const std::string& fileName) :
+        m_data(nullptr),
+        m_size(0)
+{
+#ifdef _WIN32
+    m_file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    m_mapping = nullptr;
+    if(m_file == INVALID_HANDLE_VALUE)
+    {
+        throw std::runtime_error("Failed to open " + fileName);
+    }
+    LARGE_INTEGER size = {};
+    GetFileSizeEx(m_file, &size);
+    m_size = static_cast<type::size>(size.QuadPart);
+    // Empty files can't be mapped, and have nothing to map anyway
+    if(m_size > 0)
+    {
+        m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        void* view = m_mapping != nullptr ? MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if(view == nullptr)
+        {
+            if(m_mapping != nullptr)
+            {
+                CloseHandle(m_mapping);
+            }
+            CloseHandle(m_file);
+            throw std::runtime_error("Failed to map " + fileName);
+        }
+        m_data = static_cast<const std::byte*>(view);
+    }
+#else
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if(fd < 0)
+    {
+        throw std::runtime_error("Failed to open " + fileName);
+    }
+    struct stat info = {};
+    fstat(fd, &info);
+    m_size = static_cast<type::size>(info.st_size);
+    if(m_size > 0)
+    {
+        void* view = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(view == MAP_FAILED)
+        {
+            close(fd);
+            throw std::runtime_error("Failed to map " + fileName);
+        }
+        // Read front to back, once
+        madvise(view, m_size, MADV_SEQUENTIAL);
+        madvise(view, m_size, MADV_WILLNEED);
+        m_data = static_cast<const std::byte*>(view);
+    }
+    // The mapping keeps the file open
+    close(fd);
+#endif
+}
+
+vkc::FileIO::MappedFile::~MappedFile()
+{
+#ifdef _WIN32
+    if(m_data != nullptr)
+    {
+        UnmapViewOfFile(m_data);
+        CloseHandle(m_mapping);
+    }
+    CloseHandle(m_file);
+#else
+    if(m_data != nullptr)
+    {
+        munmap(const_cast<std::byte*>(m_data), m_size);
+    }
+#endif
+}
@@ -6,12 +6,38 @@
 #ifndef VULKANCUBE_FILEIO_H
 #define VULKANCUBE_FILEIO_H
 
+#include <cstddef>
+#include <span>
 #include <string>
 #include <vector>
+#include "NonCopyable.h"
+#include "Types.h"
 
 namespace vkc::FileIO
 {
     auto ReadFile(const std::string& fileName, std::vector<char>& buffer) -> void;
+
+    // Read only mapping of a whole file, so its contents can be used in place rather than copied
+    // into a buffer. Pages are read in on first touch, and the kernel is asked to read ahead
+    class MappedFile : public NonCopyable
+    {
+    public:
+        explicit MappedFile(const std::string& fileName);
+        ~MappedFile();
+
+        [[nodiscard]]
+        inline auto data() const -> std::span<const std::byte> { return {m_data, m_size}; }
+        [[nodiscard]]
+        inline auto size() const -> type::size { return m_size; }
+
+    private:
+        const std::byte* m_data;
+        type::size m_size;
+#ifdef _WIN32
+        void* m_file;
+        void* m_mapping;
+#endif
+    };
 }
 
 #endif //VULKANCUBE_FILEIO_H
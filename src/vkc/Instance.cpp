@@ -3,12 +3,15 @@
   * https://github.com/Mnenmenth
   */
 
+#include <algorithm>
 #include <stdexcept>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include "Instance.h"
 #include "Window.h"
 #include "DebugUtilsMessenger.h"
+#include "profile/Profiler.h"
 
 const std::vector<type::cstr> vkc::Instance::ValidationLayers =
         {
@@ -19,15 +22,27 @@ const std::vector<type::cstr> vkc::Instance::DeviceExtensions =
                 VK_KHR_SWAPCHAIN_EXTENSION_NAME
         };
 
-vkc::Instance::Instance(const char* appName, const char* engineName, bool validationLayers) :
+vkc::Instance::Instance(const char* appName, const char* engineName, bool validationLayers, bool headless) :
         m_instance(VK_NULL_HANDLE),
+        m_vk(),
+        m_apiVersion(VK_API_VERSION_1_0),
         m_validationLayers(validationLayers)
 {
+    VKC_ZONE("Instance::Instance");
+
     if(m_validationLayers && !CheckValidationLayerSupport())
     {
         throw std::runtime_error("Validation layers requested but not available");
     }
 
+    // Loaders without vkEnumerateInstanceVersion only support 1.0
+    const vkc::GlobalDispatch& global = vkc::GlobalDispatch::Get();
+    if(global.EnumerateInstanceVersion != nullptr)
+    {
+        global.EnumerateInstanceVersion(&m_apiVersion);
+        m_apiVersion = std::min<type::uint32>(m_apiVersion, VK_API_VERSION_1_3);
+    }
+
     // Application info
     VkApplicationInfo appInfo = {};
     appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
@@ -35,7 +50,7 @@ vkc::Instance::Instance(const char* appName, const char* engineName, bool valida
     appInfo.applicationVersion = VK_MAKE_VERSION(0, 0, 1);
     appInfo.pEngineName = engineName;
     appInfo.engineVersion = VK_MAKE_VERSION(0, 0, 1);
-    appInfo.apiVersion = VK_API_VERSION_1_0;
+    appInfo.apiVersion = m_apiVersion;
 
     // Instance info
     VkInstanceCreateInfo instanceInfo = {};
@@ -43,7 +58,7 @@ vkc::Instance::Instance(const char* appName, const char* engineName, bool valida
     instanceInfo.pApplicationInfo = &appInfo;
 
     std::vector<type::cstr> extensions;
-    GetRequiredExtensions(extensions, validationLayers);
+    GetRequiredExtensions(extensions, validationLayers, headless);
 
     instanceInfo.enabledExtensionCount = static_cast<type::uint32>(extensions.size());
     instanceInfo.ppEnabledExtensionNames = extensions.data();
@@ -59,25 +74,42 @@ vkc::Instance::Instance(const char* appName, const char* engineName, bool valida
         instanceInfo.pNext = static_cast<VkDebugUtilsMessengerCreateInfoEXT*>(&debugCreateInfo);
     }
 
-    if(vkCreateInstance(&instanceInfo, nullptr, &m_instance) != VK_SUCCESS)
+    if(global.CreateInstance(&instanceInfo, allocator(), &m_instance) != VK_SUCCESS)
     {
         throw std::runtime_error("Vulkan instance creation failed");
     }
 
+    m_vk.load(m_instance, global.GetInstanceProcAddr, m_apiVersion);
 }
 
 vkc::Instance::~Instance()
 {
-    vkDestroyInstance(m_instance, nullptr);
+    m_vk.DestroyInstance(m_instance, allocator());
+    // Messages from destruction come after the last messenger stopped
+    if(m_validationLayers)
+    {
+        vkc::DebugUtilsMessenger::Flush();
+    }
+}
+
+auto vkc::Instance::ValidationRequested(bool fallback) -> bool
+{
+    type::cstr value = std::getenv("VKC_VALIDATION");
+    if(value == nullptr)
+    {
+        return fallback;
+    }
+    return std::strcmp(value, "0") != 0 && std::strcmp(value, "false") != 0 && std::strcmp(value, "off") != 0;
 }
 
 auto vkc::Instance::CheckValidationLayerSupport() -> bool
 {
+    const vkc::GlobalDispatch& global = vkc::GlobalDispatch::Get();
     type::uint32 layerCount;
-    vkEnumerateInstanceLayerProperties(&layerCount, nullptr);
+    global.EnumerateInstanceLayerProperties(&layerCount, nullptr);
 
     std::vector<VkLayerProperties> availableLayers(layerCount);
-    vkEnumerateInstanceLayerProperties(&layerCount, availableLayers.data());
+    global.EnumerateInstanceLayerProperties(&layerCount, availableLayers.data());
 
     // Check if requested layers are available
     for(type::cstr layerName : ValidationLayers)
@@ -102,9 +134,12 @@ auto vkc::Instance::CheckValidationLayerSupport() -> bool
     return true;
 }
 
-auto vkc::Instance::GetRequiredExtensions(std::vector<type::cstr>& extensions, bool validationLayers) -> void
+auto vkc::Instance::GetRequiredExtensions(std::vector<type::cstr>& extensions, bool validationLayers, bool headless) -> void
 {
-    vkc::Window::GetRequiredExtensions(extensions);
+    if(!headless)
+    {
+        vkc::Window::GetRequiredExtensions(extensions);
+    }
 
     if(validationLayers)
     {
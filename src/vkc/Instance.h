@@ -12,30 +12,54 @@
 #include <memory>
 #include "NonCopyable.h"
 #include "Types.h"
+#include "Dispatch.h"
+#include "memory/HostAllocator.h"
 
 namespace vkc {
     class Instance : public NonCopyable
     {
     public:
-        Instance(const char* appName, const char* engineName, bool validationLayers);
+        // Headless instances don't enable the window system surface extensions
+        Instance(const char* appName, const char* engineName, bool validationLayers, bool headless = false);
         Instance() = delete;
         ~Instance();
 
         [[nodiscard]]
         inline auto handle() const -> const VkInstance& { return m_instance; }
 
+        // Instance level commands, loaded right after creation
+        [[nodiscard]]
+        inline auto vk() const -> const vkc::InstanceDispatch& { return m_vk; }
+
+        // Highest version supported by the loader, up to the newest version vkc uses
+        [[nodiscard]]
+        inline auto apiVersion() const -> type::uint32 { return m_apiVersion; }
+
         [[nodiscard]]
         auto validationLayersEnabled() const -> bool { return m_validationLayers; }
 
+        // Host allocation callbacks passed to every Vulkan object created from this instance
+        [[nodiscard]]
+        inline auto allocator() const -> const VkAllocationCallbacks* { return m_hostAllocator.callbacks(); }
+        [[nodiscard]]
+        inline auto hostAllocator() const -> const vkc::HostAllocator& { return m_hostAllocator; }
+
+        // VKC_VALIDATION set to 0, false or off turns validation off, anything else turns it on. Fallback when it isn't set
+        static auto ValidationRequested(bool fallback) -> bool;
+
         static const std::vector<type::cstr> ValidationLayers;
         static const std::vector<type::cstr> DeviceExtensions;
 
     private:
+        // Declared first so it outlives every object allocated through it
+        vkc::HostAllocator m_hostAllocator;
         VkInstance m_instance;
+        vkc::InstanceDispatch m_vk;
+        type::uint32 m_apiVersion;
         bool m_validationLayers;
 
         static auto CheckValidationLayerSupport() -> bool;
-        static auto GetRequiredExtensions(std::vector<type::cstr>& extensions, bool validationLayers) -> void;
+        static auto GetRequiredExtensions(std::vector<type::cstr>& extensions, bool validationLayers, bool headless) -> void;
 
     };
 }
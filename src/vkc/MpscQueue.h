@@ -0,0 +1,71 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#ifndef VULKANCUBE_MPSCQUEUE_H
+#define VULKANCUBE_MPSCQUEUE_H
+
+#include <atomic>
+#include <utility>
+#include "NonCopyable.h"
+
+namespace vkc
+{
+    // Unbounded queue that any number of threads push to without locking, and one thread pops from
+    // Pushing is a single atomic exchange. A push still in progress can hide the ones after it from pop()
+    // until it finishes, so an empty pop only means nothing was ready
+    template<typename T>
+    class MpscQueue : public NonCopyable
+    {
+    public:
+        MpscQueue() : m_head(new Node()), m_tail(m_head.load(std::memory_order_relaxed))
+        {
+        }
+
+        ~MpscQueue()
+        {
+            T value;
+            while(pop(value))
+            {
+            }
+            delete m_tail;
+        }
+
+        auto push(T value) -> void
+        {
+            Node* node = new Node();
+            node->value = std::move(value);
+            Node* previous = m_head.exchange(node, std::memory_order_acq_rel);
+            previous->next.store(node, std::memory_order_release);
+        }
+
+        // Only ever called from one thread at a time
+        auto pop(T& out) -> bool
+        {
+            // The tail is a node whose value was already taken, its successor holds the oldest value
+            Node* tail = m_tail;
+            Node* next = tail->next.load(std::memory_order_acquire);
+            if(next == nullptr)
+            {
+                return false;
+            }
+            out = std::move(next->value);
+            m_tail = next;
+            delete tail;
+            return true;
+        }
+
+    private:
+        struct Node
+        {
+            std::atomic<Node*> next = nullptr;
+            T value;
+        };
+
+        std::atomic<Node*> m_head;
+        Node* m_tail;
+    };
+}
+
+#endif //VULKANCUBE_MPSCQUEUE_H
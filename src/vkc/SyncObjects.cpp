@@ -28,9 +28,9 @@ vkc::SyncObjects::SyncObjects(const vkc::Device& device, type::uint32 numImages,
     for(type::size i = 0; i < m_maxFramesInFlight; ++i)
     {
         if(
-                vkCreateSemaphore(m_device.logical(), &semaphoreInfo, nullptr, &m_imageAvailable[i]) != VK_SUCCESS ||
-                vkCreateSemaphore(m_device.logical(), &semaphoreInfo, nullptr, &m_renderFinished[i]) != VK_SUCCESS ||
-                vkCreateFence(m_device.logical(), &fenceInfo, nullptr, &m_inFlightFences[i]) != VK_SUCCESS
+                m_device.vk().CreateSemaphore(m_device.logical(), &semaphoreInfo, m_device.allocator(), &m_imageAvailable[i]) != VK_SUCCESS ||
+                m_device.vk().CreateSemaphore(m_device.logical(), &semaphoreInfo, m_device.allocator(), &m_renderFinished[i]) != VK_SUCCESS ||
+                m_device.vk().CreateFence(m_device.logical(), &fenceInfo, m_device.allocator(), &m_inFlightFences[i]) != VK_SUCCESS
                 )
         {
             throw std::runtime_error("Semaphore and/or Fence creation failed");
@@ -41,8 +41,8 @@ vkc::SyncObjects::~SyncObjects()
 {
     for(type::size i = 0; i < m_maxFramesInFlight; ++i)
     {
-        vkDestroySemaphore(m_device.logical(), m_renderFinished[i], nullptr);
-        vkDestroySemaphore(m_device.logical(), m_imageAvailable[i], nullptr);
-        vkDestroyFence(m_device.logical(), m_inFlightFences[i], nullptr);
+        m_device.vk().DestroySemaphore(m_device.logical(), m_renderFinished[i], m_device.allocator());
+        m_device.vk().DestroySemaphore(m_device.logical(), m_imageAvailable[i], m_device.allocator());
+        m_device.vk().DestroyFence(m_device.logical(), m_inFlightFences[i], m_device.allocator());
     }
 }
\ No newline at end of file
@@ -7,6 +7,7 @@
 #define VULKANCUBE_SYNCOBJECTS_H
 
 #include <vulkan/vulkan.h>
+#include <span>
 #include <vector>
 #include "NonCopyable.h"
 #include "Types.h"
@@ -28,6 +29,9 @@ namespace vkc
         inline auto inFlightFence(type::uint32 index) -> VkFence& { return m_inFlightFences[index]; }
         [[nodiscard]]
         inline auto imageInFlight(type::uint32 index) -> VkFence& { return m_imagesInFlight[index]; }
+        // Every frame's fence, the submissions that may be in flight at any time
+        [[nodiscard]]
+        inline auto inFlightFences() const -> std::span<const VkFence> { return m_inFlightFences; }
 
     private:
         const vkc::Device& m_device;
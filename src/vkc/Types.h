@@ -11,6 +11,8 @@
 
 namespace type
 {
+    using uint8 = std::uint8_t;
+    constexpr uint8 uint8_max = UINT8_MAX;
     using uint16 = std::uint16_t;
     constexpr uint16 uint16_max = UINT16_MAX;
     using uint32 = std::uint32_t;
@@ -0,0 +1,136 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#ifndef VULKANCUBE_VERTEXLAYOUT_H
+#define VULKANCUBE_VERTEXLAYOUT_H
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "Types.h"
+
+namespace vkc
+{
+    // Format a vertex attribute of type T is read with, and the locations it takes
+    // Types without a specialization can't be used as attributes
+    template<typename T>
+    struct VertexFormat;
+
+    template<VkFormat F, type::uint32 L = 1>
+    struct VertexFormatIs
+    {
+        static constexpr VkFormat Format = F;
+        static constexpr type::uint32 Locations = L;
+    };
+
+    template<> struct VertexFormat<float> : VertexFormatIs<VK_FORMAT_R32_SFLOAT> {};
+    template<> struct VertexFormat<glm::vec2> : VertexFormatIs<VK_FORMAT_R32G32_SFLOAT> {};
+    template<> struct VertexFormat<glm::vec3> : VertexFormatIs<VK_FORMAT_R32G32B32_SFLOAT> {};
+    template<> struct VertexFormat<glm::vec4> : VertexFormatIs<VK_FORMAT_R32G32B32A32_SFLOAT> {};
+    template<> struct VertexFormat<std::int32_t> : VertexFormatIs<VK_FORMAT_R32_SINT> {};
+    template<> struct VertexFormat<glm::ivec2> : VertexFormatIs<VK_FORMAT_R32G32_SINT> {};
+    template<> struct VertexFormat<glm::ivec3> : VertexFormatIs<VK_FORMAT_R32G32B32_SINT> {};
+    template<> struct VertexFormat<glm::ivec4> : VertexFormatIs<VK_FORMAT_R32G32B32A32_SINT> {};
+    template<> struct VertexFormat<type::uint32> : VertexFormatIs<VK_FORMAT_R32_UINT> {};
+    template<> struct VertexFormat<glm::uvec2> : VertexFormatIs<VK_FORMAT_R32G32_UINT> {};
+    template<> struct VertexFormat<glm::uvec3> : VertexFormatIs<VK_FORMAT_R32G32B32_UINT> {};
+    template<> struct VertexFormat<glm::uvec4> : VertexFormatIs<VK_FORMAT_R32G32B32A32_UINT> {};
+    // Read as four vec4 columns, such as a per instance transform
+    template<> struct VertexFormat<glm::mat4> : VertexFormatIs<VK_FORMAT_R32G32B32A32_SFLOAT, 4> {};
+
+    // Member of a vertex struct, listed by the struct's static constexpr attributes()
+    struct VertexAttribute
+    {
+        type::uint32 offset;
+        VkFormat format;
+        type::uint32 locations;
+        // Distance between the columns of attributes taking more than one location
+        type::uint32 columnStride;
+    };
+
+    template<typename T>
+    constexpr auto MakeVertexAttribute(type::uint32 offset) -> VertexAttribute
+    {
+        return {offset, VertexFormat<T>::Format, VertexFormat<T>::Locations, static_cast<type::uint32>(sizeof(T)) / VertexFormat<T>::Locations};
+    }
+
+    // Vertex buffer binding of T, advanced per vertex or per instance
+    template<typename T, VkVertexInputRate Rate = VK_VERTEX_INPUT_RATE_VERTEX>
+    struct VertexBinding
+    {
+        using Vertex = T;
+        static constexpr VkVertexInputRate InputRate = Rate;
+    };
+
+    // Locations taken by every attribute of T
+    template<typename T>
+    constexpr auto VertexLocationCount() -> type::uint32
+    {
+        type::uint32 count = 0;
+        for(const VertexAttribute& attribute : T::attributes())
+        {
+            count += attribute.locations;
+        }
+        return count;
+    }
+
+    // One description per binding, bound at indices 0, 1, ... in the order given
+    template<typename... Bindings>
+    constexpr auto VertexBindingDescriptions() -> std::array<VkVertexInputBindingDescription, sizeof...(Bindings)>
+    {
+        std::array<VkVertexInputBindingDescription, sizeof...(Bindings)> out = {};
+        type::uint32 binding = 0;
+        ([&]
+        {
+            out[binding].binding = binding;
+            out[binding].stride = static_cast<type::uint32>(sizeof(typename Bindings::Vertex));
+            out[binding].inputRate = Bindings::InputRate;
+            ++binding;
+        }(), ...);
+        return out;
+    }
+
+    // Attribute locations follow the order of the bindings, then the order each vertex type lists its attributes
+    template<typename... Bindings>
+    constexpr auto VertexAttributeDescriptions() -> std::array<VkVertexInputAttributeDescription, (VertexLocationCount<typename Bindings::Vertex>() + ... + 0)>
+    {
+        std::array<VkVertexInputAttributeDescription, (VertexLocationCount<typename Bindings::Vertex>() + ... + 0)> out = {};
+        type::uint32 binding = 0;
+        type::uint32 location = 0;
+        ([&]
+        {
+            for(const VertexAttribute& attribute : Bindings::Vertex::attributes())
+            {
+                for(type::uint32 column = 0; column < attribute.locations; ++column)
+                {
+                    out[location].location = location;
+                    out[location].binding = binding;
+                    out[location].format = attribute.format;
+                    out[location].offset = attribute.offset + column * attribute.columnStride;
+                    ++location;
+                }
+            }
+            ++binding;
+        }(), ...);
+        return out;
+    }
+
+    // Binding and attribute descriptions of vertex buffers, built at compile time
+    // Both are static, so pipelines can refer to them rather than copy them
+    template<typename... Bindings>
+    struct VertexLayout
+    {
+        static constexpr auto BindingDescriptions = VertexBindingDescriptions<Bindings...>();
+        static constexpr auto AttributeDescriptions = VertexAttributeDescriptions<Bindings...>();
+    };
+}
+
+// Attribute for a member of a vertex struct, with the format its type maps to
+// Only usable inside member functions of the struct or after its definition, where it's complete
+#define VKC_VERTEX_ATTRIBUTE(Type, member) ::vkc::MakeVertexAttribute<decltype(Type::member)>(offsetof(Type, member))
+
+#endif //VULKANCUBE_VERTEXLAYOUT_H
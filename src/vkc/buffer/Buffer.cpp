@@ -3,9 +3,11 @@
   * https://github.com/Mnenmenth
   */
 
+#include <cstring>
 #include "Buffer.h"
 #include "../Device.h"
 #include "../command/CommandPool.h"
+#include "../profile/Profiler.h"
 
 vkc::Buffer::Buffer(
         const vkc::Device& device,
@@ -13,27 +15,60 @@ vkc::Buffer::Buffer(
         const VkBufferUsageFlags& usageFlags,
         const VkMemoryPropertyFlags& memPropFlags,
         const VkSharingMode& sharingMode,
-        bool useStagingBuffer
+        bool useStagingBuffer,
+        std::string name
 ) :
         m_useStagingBuffer(useStagingBuffer),
 
         m_buffer(VK_NULL_HANDLE),
-        m_memory(VK_NULL_HANDLE),
-        m_memProp(),
+        m_allocation(),
+        m_generation(0),
         m_size(size),
         m_usageFlags(usageFlags),
         m_memPropFlags(memPropFlags),
+        m_memUsage(memPropFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT ? vkc::MemoryUsage::Dynamic : vkc::MemoryUsage::GpuOnly),
+        m_name(std::move(name)),
         m_sharingMode(sharingMode),
 
         m_stagingBuff(VK_NULL_HANDLE),
-        m_stagingMem(VK_NULL_HANDLE),
+        m_stagingAllocation(),
 
         m_device(device),
         m_cmdPool(m_device, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT)
 {
-    // Get index of memory type that satisfies all requirements
-    vkGetPhysicalDeviceMemoryProperties(m_device.physical(), &m_memProp);
+    createBuffers();
+}
+
+vkc::Buffer::Buffer(
+        const vkc::Device& device,
+        VkDeviceSize size,
+        const VkBufferUsageFlags& usageFlags,
+        vkc::MemoryUsage memUsage,
+        std::string name,
+        const VkSharingMode& sharingMode
+) :
+        m_useStagingBuffer(memUsage == vkc::MemoryUsage::GpuOnly && !device.directUpload()),
+
+        m_buffer(VK_NULL_HANDLE),
+        m_allocation(),
+        m_generation(0),
+        m_size(size),
+        // GPU only memory is copied out of when moved by the defragmenter, as well as into when staged
+        m_usageFlags(memUsage == vkc::MemoryUsage::GpuOnly ?
+                usageFlags | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT : usageFlags),
+        // Directly written GPU only memory still has to be mapped
+        m_memPropFlags(memUsage == vkc::MemoryUsage::GpuOnly && !m_useStagingBuffer ?
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT : 0),
+        m_memUsage(memUsage),
+        m_name(std::move(name)),
+        m_sharingMode(sharingMode),
+
+        m_stagingBuff(VK_NULL_HANDLE),
+        m_stagingAllocation(),
 
+        m_device(device),
+        m_cmdPool(m_device, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT)
+{
     createBuffers();
 }
 
@@ -44,60 +79,97 @@ vkc::Buffer::~Buffer()
 
 auto vkc::Buffer::setContents(VkDeviceSize size, VkDeviceSize offset, const void* data) -> void
 {
+    VKC_ZONE("Buffer::setContents");
+
+    // Host visible memory stays mapped by the pool
     if(m_useStagingBuffer)
     {
-        void* buff;
-        vkMapMemory(m_device.logical(), m_stagingMem, 0, size, 0, &buff);
-        memcpy(buff, data, static_cast<type::size>(size));
-        vkUnmapMemory(m_device.logical(), m_stagingMem);
+        std::memcpy(m_stagingAllocation.mapped, data, static_cast<type::size>(size));
         copyBuffer(m_stagingBuff, size, 0, m_buffer, offset);
     }
+    else if(m_allocation.mapped != nullptr)
+    {
+        std::memcpy(m_allocation.mapped + offset, data, static_cast<type::size>(size));
+    }
     else
     {
-        void* buff;
-        vkMapMemory(m_device.logical(), m_memory, offset, size, 0, &buff);
-        memcpy(buff, data, static_cast<type::size>(size));
-        vkUnmapMemory(m_device.logical(), m_memory);
+        throw std::runtime_error("Buffer memory isn't host visible");
     }
 }
 
+auto vkc::Buffer::relocate(const vkc::MemoryAllocation& from, const vkc::MemoryAllocation& to) -> vkc::Buffer::Relocation
+{
+    bool staging = m_useStagingBuffer && from.memory == m_stagingAllocation.memory && from.offset == m_stagingAllocation.offset;
+    VkBuffer& buffer = staging ? m_stagingBuff : m_buffer;
+    vkc::MemoryAllocation& allocation = staging ? m_stagingAllocation : m_allocation;
+
+    // Buffers can't be rebound, so the new memory gets a new buffer
+    VkBuffer moved = staging ?
+            createBuffer(m_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_SHARING_MODE_EXCLUSIVE) :
+            createBuffer(m_size, m_usageFlags, m_sharingMode);
+    m_device.vk().BindBufferMemory(m_device.logical(), moved, to.memory, to.offset);
+
+    vkc::Buffer::Relocation relocation = { buffer, moved, m_size };
+    buffer = moved;
+    allocation = to;
+    ++m_generation;
+    return relocation;
+}
+
 auto vkc::Buffer::resize(type::uint32 size) -> void
 {
     destroyBuffers();
     m_size = size;
     createBuffers();
+    ++m_generation;
 }
 
 auto vkc::Buffer::createBuffers() -> void
 {
+    vkc::MemoryCategory category = vkc::MemoryCategory::Buffer;
+    if(m_usageFlags & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)
+    {
+        category = vkc::MemoryCategory::Uniform;
+    }
+    else if(m_usageFlags & (VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT))
+    {
+        category = vkc::MemoryCategory::Geometry;
+    }
+    else if(m_memUsage == vkc::MemoryUsage::Readback)
+    {
+        category = vkc::MemoryCategory::Readback;
+    }
+
     // Create main buffer
-    createBufferAndMem(m_buffer, m_memory, m_memReq, m_size, 0, m_usageFlags, m_memPropFlags, m_sharingMode);
+    createBufferAndMem(m_buffer, m_allocation, m_memReq, m_size, m_usageFlags, m_memPropFlags, m_memUsage, m_sharingMode, category, m_name);
 
     if(m_useStagingBuffer)
     {
         // Create staging buffer
         createBufferAndMem(
                 m_stagingBuff,
-                m_stagingMem,
+                m_stagingAllocation,
                 m_stagingMemReq,
                 m_size,
-                0,
                 VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                VK_SHARING_MODE_EXCLUSIVE
+                vkc::MemoryUsage::Upload,
+                VK_SHARING_MODE_EXCLUSIVE,
+                vkc::MemoryCategory::Staging,
+                m_name
         );
     }
 }
 
 auto vkc::Buffer::destroyBuffers() -> void
 {
-    vkDestroyBuffer(m_device.logical(), m_buffer, nullptr);
-    vkFreeMemory(m_device.logical(), m_memory, nullptr);
+    m_device.vk().DestroyBuffer(m_device.logical(), m_buffer, m_device.allocator());
+    m_device.memoryPool().free(m_allocation);
 
     if(m_useStagingBuffer)
     {
-        vkDestroyBuffer(m_device.logical(), m_stagingBuff, nullptr);
-        vkFreeMemory(m_device.logical(), m_stagingMem, nullptr);
+        m_device.vk().DestroyBuffer(m_device.logical(), m_stagingBuff, m_device.allocator());
+        m_device.memoryPool().free(m_stagingAllocation);
     }
 }
 
@@ -109,6 +181,8 @@ auto vkc::Buffer::copyBuffer(
         VkDeviceSize dstOffset
         ) -> void
 {
+    VKC_ZONE("Buffer::copyBuffer");
+
     // Create a one time use command buffer for copying the buffer
     VkCommandBufferAllocateInfo allocInfo = {};
     allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -117,22 +191,22 @@ auto vkc::Buffer::copyBuffer(
     allocInfo.commandBufferCount = 1;
 
     VkCommandBuffer cmdBuff;
-    vkAllocateCommandBuffers(m_device.logical(), &allocInfo, &cmdBuff);
+    m_device.vk().AllocateCommandBuffers(m_device.logical(), &allocInfo, &cmdBuff);
 
     // Record command buffer
     VkCommandBufferBeginInfo beginInfo = {};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     // This command buffer will only be used once then immediately discarded
     beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-    vkBeginCommandBuffer(cmdBuff, &beginInfo);
+    m_device.vk().BeginCommandBuffer(cmdBuff, &beginInfo);
 
     VkBufferCopy copyRegion = {};
     copyRegion.srcOffset = srcOffset;
     copyRegion.dstOffset = dstOffset;
     copyRegion.size = srcSize;
-    vkCmdCopyBuffer(cmdBuff, srcBuffer, dstBuffer, 1, &copyRegion);
+    m_device.vk().CmdCopyBuffer(cmdBuff, srcBuffer, dstBuffer, 1, &copyRegion);
 
-    vkEndCommandBuffer(cmdBuff);
+    m_device.vk().EndCommandBuffer(cmdBuff);
 
     // Submit command buffer
     VkSubmitInfo submitInfo = {};
@@ -141,23 +215,14 @@ auto vkc::Buffer::copyBuffer(
     submitInfo.pCommandBuffers = &cmdBuff;
 
     //TODO: Fence for async transfers
-    vkQueueSubmit(m_device.graphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE);
+    m_device.vk().QueueSubmit(m_device.graphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE);
     //TODO: This is required if not using a fence
-    vkQueueWaitIdle(m_device.graphicsQueue());
+    m_device.vk().QueueWaitIdle(m_device.graphicsQueue());
 
-    vkFreeCommandBuffers(m_device.logical(), m_cmdPool.handle(), 1, &cmdBuff);
+    m_device.vk().FreeCommandBuffers(m_device.logical(), m_cmdPool.handle(), 1, &cmdBuff);
 }
 
-auto vkc::Buffer::createBufferAndMem(
-        VkBuffer& buff,
-        VkDeviceMemory& mem,
-        VkMemoryRequirements& memReq,
-        VkDeviceSize size,
-        VkDeviceSize offset,
-        const VkBufferUsageFlags& usageFlags,
-        const VkMemoryPropertyFlags& memPropFlags,
-        const VkSharingMode& sharingMode
-        ) -> void
+auto vkc::Buffer::createBuffer(VkDeviceSize size, const VkBufferUsageFlags& usageFlags, const VkSharingMode& sharingMode) const -> VkBuffer
 {
     VkBufferCreateInfo bufferInfo = {};
     bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -165,40 +230,37 @@ auto vkc::Buffer::createBufferAndMem(
     bufferInfo.usage = usageFlags;
     bufferInfo.sharingMode = sharingMode;
 
-    if(vkCreateBuffer(m_device.logical(), &bufferInfo, nullptr, &buff) != VK_SUCCESS)
+    VkBuffer buff;
+    if(m_device.vk().CreateBuffer(m_device.logical(), &bufferInfo, m_device.allocator(), &buff) != VK_SUCCESS)
     {
         throw std::runtime_error("Failed to create buffer");
     }
+    return buff;
+}
 
-    // Allocate buffer memory
-    vkGetBufferMemoryRequirements(m_device.logical(), buff, &memReq);
-
-    // Get the index of memory type that satisfies all requirements
-    type::uint32 memIndex;
-    bool found = false;
-    for(type::uint32 i = 0; !found && i < m_memProp.memoryTypeCount; ++i)
-    {
-        if((memReq.memoryTypeBits & (1 << i)) && (m_memProp.memoryTypes[i].propertyFlags & memPropFlags) == memPropFlags)
-        {
-            memIndex = i;
-            found = true;
-        }
-    }
-    if(!found)
-    {
-        throw std::runtime_error("Suitable memory type unavailable");
-    }
+auto vkc::Buffer::createBufferAndMem(
+        VkBuffer& buff,
+        vkc::MemoryAllocation& allocation,
+        VkMemoryRequirements& memReq,
+        VkDeviceSize size,
+        const VkBufferUsageFlags& usageFlags,
+        const VkMemoryPropertyFlags& memPropFlags,
+        vkc::MemoryUsage memUsage,
+        const VkSharingMode& sharingMode,
+        vkc::MemoryCategory category,
+        const std::string& name
+        ) -> void
+{
+    buff = createBuffer(size, usageFlags, sharingMode);
 
-    VkMemoryAllocateInfo allocInfo = {};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memReq.size;
-    allocInfo.memoryTypeIndex = memIndex;
+    // Sub-allocate buffer memory from the memory type best suited to the usage that satisfies all requirements
+    m_device.vk().GetBufferMemoryRequirements(m_device.logical(), buff, &memReq);
 
-    if(vkAllocateMemory(m_device.logical(), &allocInfo, nullptr, &mem))
-    {
-        throw std::runtime_error("Buffer memory allocation failed");
-    }
+    // Contents are moved by a transfer, or by the host when the memory is host visible
+    bool transfer = (usageFlags & VK_BUFFER_USAGE_TRANSFER_SRC_BIT) && (usageFlags & VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+    bool hostVisible = memUsage != vkc::MemoryUsage::GpuOnly || (memPropFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+    allocation = m_device.memoryPool().allocate(memReq, memUsage, memPropFlags, category, name, transfer || hostVisible ? this : nullptr);
 
     // Bind buffer to memory
-    vkBindBufferMemory(m_device.logical(), buff, mem, align(offset, memReq.alignment));
+    m_device.vk().BindBufferMemory(m_device.logical(), buff, allocation.memory, allocation.offset);
 }
@@ -7,10 +7,14 @@
 #define VULKANCUBE_BUFFER_H
 
 #include <vulkan/vulkan.h>
+#include <string>
 #include <vector>
 #include "../NonCopyable.h"
 #include "../Types.h"
 #include "../command/CommandPool.h"
+#include "../memory/MemoryPool.h"
+#include "../memory/MemoryTracker.h"
+#include "../memory/MemoryUsage.h"
 
 // TODO: Command pool for short lived/staging buffers
 
@@ -20,13 +24,25 @@ namespace vkc
     class Buffer : public NonCopyable
     {
     public:
+        // Memory types with all of memPropFlags are ranked as GPU only memory, or dynamic memory when host visible
         Buffer(
                 const vkc::Device& device,
                 VkDeviceSize size,
                 const VkBufferUsageFlags& usageFlags,
                 const VkMemoryPropertyFlags& memPropFlags,
                 const VkSharingMode& sharingMode,
-                bool useStagingBuffer
+                bool useStagingBuffer,
+                std::string name = {}
+                );
+        // Memory type picked by the device for the usage. GPU only buffers are staged
+        // unless the device allows writing them directly, and can be copied to and from so the defragmenter can move them
+        Buffer(
+                const vkc::Device& device,
+                VkDeviceSize size,
+                const VkBufferUsageFlags& usageFlags,
+                vkc::MemoryUsage memUsage,
+                std::string name = {},
+                const VkSharingMode& sharingMode = VK_SHARING_MODE_EXCLUSIVE
                 );
         ~Buffer();
 
@@ -34,41 +50,62 @@ namespace vkc
         inline auto handle() const -> const VkBuffer& { return m_buffer; }
         [[nodiscard]]
         auto inline size() const -> VkDeviceSize { return m_size; }
+        [[nodiscard]]
+        inline auto staged() const -> bool { return m_useStagingBuffer; }
+        // Changes whenever handle() does, so whatever refers to the old handle knows to be updated
+        [[nodiscard]]
+        inline auto generation() const -> type::uint64 { return m_generation; }
         //auto inline copyTo(vkc::Buffer& buffer) -> void { copyBuffer(buffer.m_buffer, buffer.m_size, 0, m_buffer, ); }
 
         //TODO: Non-destructive resize
         auto resize(type::uint32 size) -> void;
 
         auto setContents(VkDeviceSize size, VkDeviceSize offset, const void* data) -> void;
+
+        // Old handle of a buffer moved to new memory. It has to outlive whatever still uses it
+        struct Relocation
+        {
+            VkBuffer from;
+            VkBuffer to;
+            VkDeviceSize size;
+        };
+        // Binds a new buffer to the memory at to, in place of the buffer bound at from
+        // Contents aren't copied, and from isn't freed
+        auto relocate(const vkc::MemoryAllocation& from, const vkc::MemoryAllocation& to) -> vkc::Buffer::Relocation;
         static inline auto align(VkDeviceSize size, VkDeviceSize alignment) { return (size + alignment - 1) & -alignment; }
 
     protected:
         bool m_useStagingBuffer;
 
-        VkPhysicalDeviceMemoryProperties m_memProp;
-
         VkBuffer m_buffer;
-        VkDeviceMemory m_memory;
+        vkc::MemoryAllocation m_allocation;
         VkMemoryRequirements m_memReq;
+        type::uint64 m_generation;
 
         VkDeviceSize m_size;
         VkBufferUsageFlags m_usageFlags;
         VkMemoryPropertyFlags m_memPropFlags;
+        vkc::MemoryUsage m_memUsage;
+        // Memory is tracked under this name
+        std::string m_name;
         VkSharingMode m_sharingMode;
 
         VkBuffer m_stagingBuff;
-        VkDeviceMemory m_stagingMem;
+        vkc::MemoryAllocation m_stagingAllocation;
         VkMemoryRequirements m_stagingMemReq;
 
+        auto createBuffer(VkDeviceSize size, const VkBufferUsageFlags& usageFlags, const VkSharingMode& sharingMode) const -> VkBuffer;
         auto createBufferAndMem(
                 VkBuffer& buff,
-                VkDeviceMemory& mem,
+                vkc::MemoryAllocation& allocation,
                 VkMemoryRequirements& memReq,
                 VkDeviceSize size,
-                VkDeviceSize offset,
                 const VkBufferUsageFlags& usageFlags,
                 const VkMemoryPropertyFlags& memPropFlags,
-                const VkSharingMode& sharingMode
+                vkc::MemoryUsage memUsage,
+                const VkSharingMode& sharingMode,
+                vkc::MemoryCategory category,
+                const std::string& name
                 ) -> void;
 
         auto createBuffers() -> void;
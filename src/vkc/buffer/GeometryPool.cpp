@@ -0,0 +1,127 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#include <optional>
+#include <stdexcept>
+#include "GeometryPool.h"
+#include "../Device.h"
+#include "../mesh/MeshOptimizer.h"
+
+vkc::GeometryPool::GeometryPool(
+        const vkc::Device& device,
+        VkDeviceSize vertexStride,
+        type::uint32 vertexCapacity,
+        VkDeviceSize indexBytes
+) :
+        m_device(device),
+        m_vertexStride(vertexStride),
+        m_vertices(device, vertexStride * vertexCapacity, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, vkc::MemoryUsage::GpuOnly, "geometry vertices"),
+        m_indices(device, indexBytes, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, vkc::MemoryUsage::GpuOnly, "geometry indices"),
+        m_vertexRanges(vertexCapacity),
+        m_indexRanges(indexBytes)
+{
+}
+
+auto vkc::GeometryPool::add(
+        const void* vertices,
+        type::uint32 vertexCount,
+        const void* indices,
+        type::uint32 indexCount,
+        VkIndexType indexType
+) -> vkc::GeometryPool::Mesh
+{
+    if(vertexCount == 0 || indexCount == 0)
+    {
+        throw std::runtime_error("Geometry pool meshes need vertices and indices");
+    }
+    if(indexType == VK_INDEX_TYPE_UINT8_EXT && !m_device.indexTypeUint8())
+    {
+        throw std::runtime_error("8 bit indices aren't enabled on this device");
+    }
+    VkDeviceSize indexSize = vkc::mesh::IndexSize(indexType);
+
+    std::optional<VkDeviceSize> firstVertex = m_vertexRanges.allocate(vertexCount, 1);
+    if(!firstVertex)
+    {
+        throw std::runtime_error("Geometry pool out of vertex space");
+    }
+    // Aligned to the index size so the first index is a whole number of them into the buffer
+    std::optional<VkDeviceSize> indexOffset = m_indexRanges.allocate(indexCount * indexSize, indexSize);
+    if(!indexOffset)
+    {
+        m_vertexRanges.free(*firstVertex, vertexCount);
+        throw std::runtime_error("Geometry pool out of index space");
+    }
+
+    m_vertices.setContents(vertexCount * m_vertexStride, *firstVertex * m_vertexStride, vertices);
+    m_indices.setContents(indexCount * indexSize, *indexOffset, indices);
+
+    Mesh mesh;
+    mesh.firstIndex = static_cast<type::uint32>(*indexOffset / indexSize);
+    mesh.vertexOffset = static_cast<std::int32_t>(*firstVertex);
+    mesh.indexCount = indexCount;
+    mesh.vertexCount = vertexCount;
+    mesh.indexType = indexType;
+    return mesh;
+}
+
+auto vkc::GeometryPool::addBatch(
+        const void* vertices,
+        type::uint32 vertexCount,
+        const void* indices,
+        VkDeviceSize indexBytes,
+        std::span<const vkc::GeometryPool::Mesh> meshes
+) -> std::vector<vkc::GeometryPool::Mesh>
+{
+    if(vertexCount == 0 || indexBytes == 0)
+    {
+        throw std::runtime_error("Geometry pool meshes need vertices and indices");
+    }
+    for(const Mesh& mesh : meshes)
+    {
+        if(mesh.indexType == VK_INDEX_TYPE_UINT8_EXT && !m_device.indexTypeUint8())
+        {
+            throw std::runtime_error("8 bit indices aren't enabled on this device");
+        }
+    }
+
+    std::optional<VkDeviceSize> firstVertex = m_vertexRanges.allocate(vertexCount, 1);
+    if(!firstVertex)
+    {
+        throw std::runtime_error("Geometry pool out of vertex space");
+    }
+    // Aligned for the widest index type, so every mesh's indices stay aligned to their own size
+    std::optional<VkDeviceSize> indexOffset = m_indexRanges.allocate(indexBytes, sizeof(type::uint32));
+    if(!indexOffset)
+    {
+        m_vertexRanges.free(*firstVertex, vertexCount);
+        throw std::runtime_error("Geometry pool out of index space");
+    }
+
+    m_vertices.setContents(vertexCount * m_vertexStride, *firstVertex * m_vertexStride, vertices);
+    m_indices.setContents(indexBytes, *indexOffset, indices);
+
+    std::vector<Mesh> added(meshes.begin(), meshes.end());
+    for(Mesh& mesh : added)
+    {
+        mesh.firstIndex += static_cast<type::uint32>(*indexOffset / vkc::mesh::IndexSize(mesh.indexType));
+        mesh.vertexOffset += static_cast<std::int32_t>(*firstVertex);
+    }
+    return added;
+}
+
+auto vkc::GeometryPool::remove(const vkc::GeometryPool::Mesh& mesh) -> void
+{
+    VkDeviceSize indexSize = vkc::mesh::IndexSize(mesh.indexType);
+    m_vertexRanges.free(static_cast<VkDeviceSize>(mesh.vertexOffset), mesh.vertexCount);
+    m_indexRanges.free(mesh.firstIndex * indexSize, mesh.indexCount * indexSize);
+}
+
+auto vkc::GeometryPool::bind(VkCommandBuffer cmd, VkIndexType indexType) const -> void
+{
+    VkDeviceSize offset = 0;
+    m_device.vk().CmdBindVertexBuffers(cmd, 0, 1, &m_vertices.handle(), &offset);
+    m_device.vk().CmdBindIndexBuffer(cmd, m_indices.handle(), 0, indexType);
+}
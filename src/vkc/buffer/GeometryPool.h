@@ -0,0 +1,99 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#ifndef VULKANCUBE_GEOMETRYPOOL_H
+#define VULKANCUBE_GEOMETRYPOOL_H
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "Buffer.h"
+#include "../NonCopyable.h"
+#include "../Types.h"
+#include "../memory/RangeAllocator.h"
+
+namespace vkc
+{
+    class Device;
+    // One vertex buffer and one index buffer shared by every mesh, so draws of any mesh
+    // need only a single bind of each. Meshes get ranges of both from free lists, and are drawn
+    // with the first index and vertex offset of their handle
+    // Indices are relative to the mesh's first vertex, so each mesh can use the narrowest index type its
+    // vertex count allows, and draws rebind the index buffer only when that type changes
+    class GeometryPool : public NonCopyable
+    {
+    public:
+        // Arguments of vkCmdDrawIndexed for a mesh, and what it was allocated
+        struct Mesh
+        {
+            type::uint32 firstIndex = 0;
+            std::int32_t vertexOffset = 0;
+            type::uint32 indexCount = 0;
+            type::uint32 vertexCount = 0;
+            VkIndexType indexType = VK_INDEX_TYPE_UINT16;
+        };
+
+        GeometryPool(
+                const vkc::Device& device,
+                VkDeviceSize vertexStride,
+                type::uint32 vertexCapacity,
+                VkDeviceSize indexBytes
+                );
+        ~GeometryPool() = default;
+
+        // Uploads vertexCount vertices of vertexStride bytes, and indexCount indices of indexType
+        // Throws when either buffer has no free range large enough, or 8 bit indices aren't enabled
+        auto add(
+                const void* vertices,
+                type::uint32 vertexCount,
+                const void* indices,
+                type::uint32 indexCount,
+                VkIndexType indexType = VK_INDEX_TYPE_UINT16
+                ) -> vkc::GeometryPool::Mesh;
+        // Uploads meshes packed back to back, with one copy of each buffer's data rather than one per mesh
+        // Meshes are relative to the data: vertexOffset counts from its first vertex, and firstIndex from the
+        // start of the index data in indices of the mesh's type. They must cover all of both, so removing
+        // every one of them frees everything the batch took
+        auto addBatch(
+                const void* vertices,
+                type::uint32 vertexCount,
+                const void* indices,
+                VkDeviceSize indexBytes,
+                std::span<const vkc::GeometryPool::Mesh> meshes
+                ) -> std::vector<vkc::GeometryPool::Mesh>;
+        // The mesh must no longer be drawn by any submission in flight
+        auto remove(const vkc::GeometryPool::Mesh& mesh) -> void;
+
+        // Binds both buffers at offset 0, once for any number of meshes with the same index type
+        auto bind(VkCommandBuffer cmd, VkIndexType indexType) const -> void;
+
+        [[nodiscard]]
+        inline auto vertexBuffer() const -> const vkc::Buffer& { return m_vertices; }
+        [[nodiscard]]
+        inline auto indexBuffer() const -> const vkc::Buffer& { return m_indices; }
+        [[nodiscard]]
+        inline auto vertexStride() const -> VkDeviceSize { return m_vertexStride; }
+        // Changes whenever either buffer's handle does, so recorded binds can be refreshed
+        [[nodiscard]]
+        inline auto generation() const -> type::uint64 { return m_vertices.generation() + m_indices.generation(); }
+        [[nodiscard]]
+        inline auto usedVertices() const -> VkDeviceSize { return m_vertexRanges.used(); }
+        [[nodiscard]]
+        inline auto usedIndexBytes() const -> VkDeviceSize { return m_indexRanges.used(); }
+
+    private:
+        const vkc::Device& m_device;
+        VkDeviceSize m_vertexStride;
+
+        vkc::Buffer m_vertices;
+        vkc::Buffer m_indices;
+        // In vertices, and in bytes since index sizes differ between meshes
+        vkc::RangeAllocator m_vertexRanges;
+        vkc::RangeAllocator m_indexRanges;
+    };
+}
+
+#endif //VULKANCUBE_GEOMETRYPOOL_H
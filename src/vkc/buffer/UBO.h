@@ -10,33 +10,47 @@
 #include <vector>
 #include "../NonCopyable.h"
 #include "Buffer.h"
+#include "../descriptor/ResourceSet.h"
 
-//TODO: Multiple layout bindings
 namespace vkc
 {
     class Device;
+    class DescriptorAllocator;
+    // One uniform buffer per frame, each in its own per-frame resource set
+    // Sets combining several resources are built with vkc::ResourceSetBuilder
     class UBO : public NonCopyable
     {
     public:
         UBO(
                 const vkc::Device& device,
+                vkc::DescriptorAllocator& descriptors,
                 VkDeviceSize size,
                 type::uint32 layoutBinding,
                 type::uint32 numDescriptorSets,
                 VkShaderStageFlags stages
                 );
-        ~UBO();
+        ~UBO() = default;
 
+        // Sets allocated before are kept and rewritten, only missing ones are allocated
         auto recreateDescriptorSets(type::uint32 numDescriptorSets) -> void;
 
         auto setContents(type::uint32 descriptorIndex, VkDeviceSize size, VkDeviceSize offset, void* data) -> void;
+        // Rewrites the set if the buffer moved since it was written. No submission may be using the set
+        auto refresh(type::uint32 descriptorIndex) -> bool;
 
         [[nodiscard]]
         inline auto size() const -> VkDeviceSize { return m_uboSize; }
         [[nodiscard]]
         inline auto descriptorSetLayout() const -> const VkDescriptorSetLayout& { return m_descriptorSetLayout; }
         [[nodiscard]]
-        inline auto descriptorSet(type::uint32 index) const -> const VkDescriptorSet& { return m_descriptorSets[index]; }
+        inline auto descriptorSet(type::uint32 index) const -> const VkDescriptorSet& { return m_descriptorSets[index].set; }
+        [[nodiscard]]
+        inline auto resourceSet(type::uint32 index) const -> const vkc::ResourceSet& { return m_descriptorSets[index]; }
+        [[nodiscard]]
+        inline auto buffer() const -> const vkc::Buffer& { return m_buffer; }
+        // Buffer generation the set was last written with. Command buffers that bound it are invalid once it changes
+        [[nodiscard]]
+        inline auto written(type::uint32 index) const -> type::uint64 { return m_written[index]; }
 
     private:
         vkc::Buffer m_buffer;
@@ -45,17 +59,19 @@ namespace vkc
         type::uint32 m_numDescriptorSets;
         VkShaderStageFlags m_stages;
         type::uint32 m_layoutBinding;
+        // Owned by the allocator's layout cache
         VkDescriptorSetLayout m_descriptorSetLayout;
-        VkDescriptorPool m_descriptorSetPool;
-        std::vector<VkDescriptorSet> m_descriptorSets;
+        // Persistent sets, never returned to the allocator. Can hold more than m_numDescriptorSets
+        std::vector<vkc::ResourceSet> m_descriptorSets;
+        // Buffer generation each set was written with
+        std::vector<type::uint64> m_written;
 
         const vkc::Device& m_device;
+        vkc::DescriptorAllocator& m_descriptors;
 
         auto createDescriptorLayout() -> void;
-        auto createDescriptorPool() -> void;
+        auto setBuilder(type::uint32 index) const -> vkc::ResourceSetBuilder;
         auto createDescriptorSets() -> void;
-
-        auto destroyDescriptorPool() -> void;
     };
 }
 
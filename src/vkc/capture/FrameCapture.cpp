@@ -0,0 +1,406 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#include <stdexcept>
+#include "FrameCapture.h"
+#include "../Device.h"
+#include "../pipeline/RenderTarget.h"
+#include "../profile/Profiler.h"
+
+namespace
+{
+    // Bytes per pixel of every format that can be captured
+    constexpr type::size PixelSize = 4;
+
+    auto IsBgra(VkFormat format) -> bool
+    {
+        switch(format)
+        {
+            case VK_FORMAT_B8G8R8A8_UNORM:
+            case VK_FORMAT_B8G8R8A8_SRGB:
+                return true;
+            case VK_FORMAT_R8G8B8A8_UNORM:
+            case VK_FORMAT_R8G8B8A8_SRGB:
+                return false;
+            default:
+                throw std::runtime_error("Frame capture only supports 8 bit RGBA and BGRA formats");
+        }
+    }
+}
+
+vkc::capture::FrameCapture::FrameCapture(
+        const vkc::Device& device,
+        const vkc::RenderTarget& target,
+        type::uint32 numSlots,
+        FrameConsumer consumer
+) :
+        m_device(device),
+        m_target(target),
+        m_consumer(std::move(consumer)),
+        m_cmdPool(device, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT),
+        m_slots(numSlots),
+        m_nextSlot(0),
+        m_recordedSlot(0),
+        m_coherent(false),
+        m_extent(),
+        m_rowPitch(0),
+        m_bgra(false),
+        m_frameNumber(0),
+        m_dropped(0),
+        m_captured(0),
+        m_busy(false),
+        m_stop(false)
+{
+    if(!(m_target.imageUsage() & VK_IMAGE_USAGE_TRANSFER_SRC_BIT))
+    {
+        throw std::runtime_error("Render target images can't be copied from for frame capture");
+    }
+
+    // Command buffers are re-recorded for every capture since the source image changes
+    std::vector<VkCommandBuffer> cmds(numSlots);
+    VkCommandBufferAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = m_cmdPool.handle();
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = numSlots;
+    if(m_device.vk().AllocateCommandBuffers(m_device.logical(), &allocInfo, cmds.data()) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Frame capture command buffer allocation failed");
+    }
+    for(type::uint32 i = 0; i < numSlots; ++i)
+    {
+        m_slots[i].cmd = cmds[i];
+    }
+
+    createBuffers();
+
+    m_thread = std::thread(&FrameCapture::run, this);
+}
+
+vkc::capture::FrameCapture::~FrameCapture()
+{
+    // Anything still in flight has finished once the device is idle, so it can still be consumed
+    m_device.vk().DeviceWaitIdle(m_device.logical());
+    flush();
+    {
+        std::lock_guard lock(m_queueMutex);
+        m_stop = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+
+    destroyBuffers();
+}
+
+auto vkc::capture::FrameCapture::record(type::uint32 imageIndex) -> VkCommandBuffer
+{
+    VKC_ZONE("FrameCapture::record");
+
+    // Slots are used round robin, so a busy next slot means the consumer is falling behind
+    Slot& slot = m_slots[m_nextSlot];
+    if(slot.state.load(std::memory_order_acquire) != SlotState::Free)
+    {
+        ++m_dropped;
+        ++m_frameNumber;
+        return VK_NULL_HANDLE;
+    }
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    if(m_device.vk().BeginCommandBuffer(slot.cmd, &beginInfo) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Frame capture command buffer recording failed");
+    }
+
+    VkImage image = m_target.image(imageIndex);
+    VkImageLayout finalLayout = m_target.finalLayout();
+
+    VkImageSubresourceRange range = {};
+    range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    range.baseMipLevel = 0;
+    range.levelCount = 1;
+    range.baseArrayLayer = 0;
+    range.layerCount = 1;
+
+    // Wait for the render pass to finish writing before copying, moving the image out of
+    // whatever layout the render pass left it in (presentation source for a swap chain)
+    VkImageMemoryBarrier toTransfer = {};
+    toTransfer.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    toTransfer.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    toTransfer.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    toTransfer.oldLayout = finalLayout;
+    toTransfer.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    toTransfer.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    toTransfer.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    toTransfer.image = image;
+    toTransfer.subresourceRange = range;
+    m_device.vk().CmdPipelineBarrier(
+            slot.cmd,
+            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            0, 0, nullptr, 0, nullptr, 1, &toTransfer
+            );
+
+    VkBufferImageCopy region = {};
+    region.bufferOffset = 0;
+    // Tightly packed
+    region.bufferRowLength = 0;
+    region.bufferImageHeight = 0;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = {0, 0, 0};
+    region.imageExtent = {m_extent.width, m_extent.height, 1};
+    m_device.vk().CmdCopyImageToBuffer(slot.cmd, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slot.buffer, 1, &region);
+
+    // Make the copy visible to the host once the fence signals
+    VkBufferMemoryBarrier toHost = {};
+    toHost.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    toHost.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    toHost.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    toHost.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    toHost.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    toHost.buffer = slot.buffer;
+    toHost.offset = 0;
+    toHost.size = VK_WHOLE_SIZE;
+
+    // Put the image back so presentation sees the layout it expects
+    VkImageMemoryBarrier toFinal = toTransfer;
+    toFinal.srcAccessMask = 0;
+    toFinal.dstAccessMask = 0;
+    toFinal.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    toFinal.newLayout = finalLayout;
+    type::uint32 imageBarrierCount = finalLayout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL ? 0 : 1;
+
+    m_device.vk().CmdPipelineBarrier(
+            slot.cmd,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_HOST_BIT | VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+            0, 0, nullptr, 1, &toHost, imageBarrierCount, &toFinal
+            );
+
+    if(m_device.vk().EndCommandBuffer(slot.cmd) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Frame capture command buffer recording failed");
+    }
+
+    slot.frameNumber = m_frameNumber++;
+    slot.state.store(SlotState::Recorded, std::memory_order_relaxed);
+    m_recordedSlot = m_nextSlot;
+    m_nextSlot = (m_nextSlot + 1) % static_cast<type::uint32>(m_slots.size());
+    return slot.cmd;
+}
+
+auto vkc::capture::FrameCapture::submitted(VkFence fence) -> void
+{
+    Slot& slot = m_slots[m_recordedSlot];
+    if(slot.state.load(std::memory_order_relaxed) != SlotState::Recorded)
+    {
+        return;
+    }
+    slot.fence = fence;
+    slot.state.store(SlotState::InFlight, std::memory_order_relaxed);
+}
+
+auto vkc::capture::FrameCapture::poll() -> void
+{
+    VKC_ZONE("FrameCapture::poll");
+
+    bool queued = false;
+    for(type::uint32 i = 0; i < m_slots.size(); ++i)
+    {
+        Slot& slot = m_slots[i];
+        if(slot.state.load(std::memory_order_relaxed) != SlotState::InFlight)
+        {
+            continue;
+        }
+        if(m_device.vk().GetFenceStatus(m_device.logical(), slot.fence) != VK_SUCCESS)
+        {
+            continue;
+        }
+        slot.state.store(SlotState::Queued, std::memory_order_release);
+        std::lock_guard lock(m_queueMutex);
+        m_queue.push_back(i);
+        queued = true;
+    }
+    if(queued)
+    {
+        m_wake.notify_one();
+    }
+
+    std::lock_guard lock(m_queueMutex);
+    if(!m_error.empty())
+    {
+        throw std::runtime_error("Frame capture failed: " + m_error);
+    }
+}
+
+auto vkc::capture::FrameCapture::flush() -> void
+{
+    // With the device idle every submitted copy is complete
+    for(type::uint32 i = 0; i < m_slots.size(); ++i)
+    {
+        if(m_slots[i].state.load(std::memory_order_relaxed) == SlotState::InFlight)
+        {
+            m_slots[i].state.store(SlotState::Queued, std::memory_order_release);
+            std::lock_guard lock(m_queueMutex);
+            m_queue.push_back(i);
+        }
+    }
+    m_wake.notify_one();
+    waitForWorker();
+}
+
+auto vkc::capture::FrameCapture::recreate() -> void
+{
+    // Consume everything captured at the old size before resizing
+    flush();
+
+    for(auto& slot : m_slots)
+    {
+        slot.state.store(SlotState::Free, std::memory_order_relaxed);
+    }
+    m_nextSlot = 0;
+
+    destroyBuffers();
+    createBuffers();
+}
+
+auto vkc::capture::FrameCapture::createBuffers() -> void
+{
+    m_extent = m_target.extent();
+    m_bgra = IsBgra(m_target.imageFormat());
+    m_rowPitch = m_extent.width * PixelSize;
+    VkDeviceSize size = m_rowPitch * m_extent.height;
+
+    for(auto& slot : m_slots)
+    {
+        VkBufferCreateInfo bufferInfo = {};
+        bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferInfo.size = size;
+        bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        if(m_device.vk().CreateBuffer(m_device.logical(), &bufferInfo, m_device.allocator(), &slot.buffer) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Frame capture buffer creation failed");
+        }
+
+        VkMemoryRequirements memReq;
+        m_device.vk().GetBufferMemoryRequirements(m_device.logical(), slot.buffer, &memReq);
+
+        VkMemoryAllocateInfo allocInfo = {};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize = memReq.size;
+        allocInfo.memoryTypeIndex = chooseMemoryType(memReq.memoryTypeBits, memReq.size);
+
+        if(m_device.allocateMemory(allocInfo, slot.memory, vkc::MemoryCategory::Readback, "frame capture", size) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Frame capture memory allocation failed");
+        }
+        m_device.vk().BindBufferMemory(m_device.logical(), slot.buffer, slot.memory, 0);
+
+        // Stays mapped for the lifetime of the buffer
+        if(m_device.vk().MapMemory(m_device.logical(), slot.memory, 0, VK_WHOLE_SIZE, 0, &slot.mapped) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Frame capture memory mapping failed");
+        }
+    }
+}
+
+auto vkc::capture::FrameCapture::destroyBuffers() -> void
+{
+    for(auto& slot : m_slots)
+    {
+        if(slot.memory != VK_NULL_HANDLE)
+        {
+            m_device.vk().UnmapMemory(m_device.logical(), slot.memory);
+        }
+        m_device.vk().DestroyBuffer(m_device.logical(), slot.buffer, m_device.allocator());
+        m_device.freeMemory(slot.memory);
+        slot.buffer = VK_NULL_HANDLE;
+        slot.memory = VK_NULL_HANDLE;
+        slot.mapped = nullptr;
+    }
+}
+
+auto vkc::capture::FrameCapture::chooseMemoryType(type::uint32 typeBits, VkDeviceSize size) -> type::uint32
+{
+    // Readback memory is cached where the device has it, which isn't always coherent
+    type::uint32 memType = m_device.findMemoryType(typeBits, vkc::MemoryUsage::Readback, size);
+    m_coherent = m_device.memoryProperties().memoryTypes[memType].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    return memType;
+}
+
+auto vkc::capture::FrameCapture::waitForWorker() -> void
+{
+    std::unique_lock lock(m_queueMutex);
+    m_idle.wait(lock, [this] { return m_queue.empty() && !m_busy; });
+}
+
+auto vkc::capture::FrameCapture::run() -> void
+{
+    std::unique_lock lock(m_queueMutex);
+    while(true)
+    {
+        m_wake.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+        if(m_queue.empty())
+        {
+            // Only reached when stopping
+            break;
+        }
+
+        type::uint32 index = m_queue.front();
+        m_queue.pop_front();
+        m_busy = true;
+        lock.unlock();
+
+        Slot& slot = m_slots[index];
+        if(!m_coherent)
+        {
+            VkMappedMemoryRange range = {};
+            range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+            range.memory = slot.memory;
+            range.offset = 0;
+            range.size = VK_WHOLE_SIZE;
+            m_device.vk().InvalidateMappedMemoryRanges(m_device.logical(), 1, &range);
+        }
+
+        CapturedFrame frame = {};
+        frame.pixels = static_cast<const std::byte*>(slot.mapped);
+        frame.width = m_extent.width;
+        frame.height = m_extent.height;
+        frame.rowPitch = m_rowPitch;
+        frame.bgra = m_bgra;
+        frame.frameNumber = slot.frameNumber;
+
+        std::string error;
+        try
+        {
+            m_consumer(frame);
+            m_captured.fetch_add(1, std::memory_order_relaxed);
+        }
+        catch(const std::exception& e)
+        {
+            error = e.what();
+        }
+
+        // Hand the slot back to the render thread
+        slot.state.store(SlotState::Free, std::memory_order_release);
+
+        lock.lock();
+        if(m_error.empty())
+        {
+            m_error = error;
+        }
+        m_busy = false;
+        if(m_queue.empty())
+        {
+            m_idle.notify_all();
+        }
+    }
+}
@@ -0,0 +1,133 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#ifndef VULKANCUBE_FRAMECAPTURE_H
+#define VULKANCUBE_FRAMECAPTURE_H
+
+#include <vulkan/vulkan.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../NonCopyable.h"
+#include "../Types.h"
+#include "../command/CommandPool.h"
+
+namespace vkc
+{
+    class Device;
+    class RenderTarget;
+}
+
+namespace vkc::capture
+{
+    // Pixels of a captured frame, tightly packed 4 bytes per pixel
+    // Only valid for the duration of the consumer callback
+    struct CapturedFrame
+    {
+        const std::byte* pixels;
+        type::uint32 width;
+        type::uint32 height;
+        type::size rowPitch;
+        // Channel order is BGRA instead of RGBA, as is common for swap chains
+        bool bgra;
+        type::uint64 frameNumber;
+    };
+
+    using FrameConsumer = std::function<void(const CapturedFrame&)>;
+
+    // Copies rendered images into a ring of host visible buffers without stalling the frame loop
+    // The copy is recorded into its own command buffer and submitted together with the frame's draw
+    // commands. Completion is detected by polling the frame's fence, then the mapped buffer is handed
+    // to the consumer on a worker thread. When every buffer is still in use the frame is dropped
+    class FrameCapture : public NonCopyable
+    {
+    public:
+        FrameCapture(const vkc::Device& device, const vkc::RenderTarget& target, type::uint32 numSlots, FrameConsumer consumer);
+        ~FrameCapture();
+
+        // Records a copy of the target image into a free buffer
+        // Returns VK_NULL_HANDLE if no buffer is free and the frame is dropped
+        auto record(type::uint32 imageIndex) -> VkCommandBuffer;
+        // Must be called with the fence the recorded command buffer was submitted with
+        auto submitted(VkFence fence) -> void;
+        // Hands completed copies to the worker. Must be called after waiting on a frame's
+        // fence and before resetting it, since that fence may still guard a capture
+        // Rethrows the first error raised by the consumer
+        auto poll() -> void;
+        // Consumes every submitted capture and waits for the consumer to finish. Device must be idle
+        auto flush() -> void;
+        // Resize buffers to match the target after it was recreated. Device must be idle
+        auto recreate() -> void;
+
+        [[nodiscard]]
+        inline auto captured() const -> type::uint64 { return m_captured.load(std::memory_order_relaxed); }
+        [[nodiscard]]
+        inline auto dropped() const -> type::uint64 { return m_dropped; }
+
+    private:
+        enum class SlotState : type::uint32
+        {
+            Free,
+            Recorded,
+            InFlight,
+            // Owned by the worker until it returns to Free
+            Queued
+        };
+
+        struct Slot
+        {
+            VkBuffer buffer;
+            VkDeviceMemory memory;
+            void* mapped;
+            VkCommandBuffer cmd;
+            VkFence fence;
+            type::uint64 frameNumber;
+            std::atomic<SlotState> state;
+        };
+
+        const vkc::Device& m_device;
+        const vkc::RenderTarget& m_target;
+        FrameConsumer m_consumer;
+
+        vkc::CommandPool m_cmdPool;
+        std::vector<Slot> m_slots;
+        type::uint32 m_nextSlot;
+        type::uint32 m_recordedSlot;
+        // Host cached memory is preferred for fast reads, but may not be coherent
+        bool m_coherent;
+
+        VkExtent2D m_extent;
+        type::size m_rowPitch;
+        bool m_bgra;
+
+        type::uint64 m_frameNumber;
+        type::uint64 m_dropped;
+        std::atomic<type::uint64> m_captured;
+
+        std::thread m_thread;
+        std::mutex m_queueMutex;
+        std::condition_variable m_wake;
+        std::condition_variable m_idle;
+        std::deque<type::uint32> m_queue;
+        bool m_busy;
+        bool m_stop;
+        std::string m_error;
+
+        auto createBuffers() -> void;
+        auto destroyBuffers() -> void;
+        auto chooseMemoryType(type::uint32 typeBits, VkDeviceSize size) -> type::uint32;
+        // Blocks until every queued capture has been consumed
+        auto waitForWorker() -> void;
+        auto run() -> void;
+    };
+}
+
+#endif //VULKANCUBE_FRAMECAPTURE_H
@@ -0,0 +1,208 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include "PngWriter.h"
+#include "FrameCapture.h"
+#include "../profile/Profiler.h"
+
+namespace
+{
+    constexpr auto CrcTable = []
+    {
+        std::array<type::uint32, 256> table = {};
+        for(type::uint32 n = 0; n < 256; ++n)
+        {
+            type::uint32 c = n;
+            for(int k = 0; k < 8; ++k)
+            {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[n] = c;
+        }
+        return table;
+    }();
+
+    // Largest amount of data a stored deflate block can hold
+    constexpr type::size MaxStoredBlock = 65535;
+    constexpr type::uint32 AdlerMod = 65521;
+    // Largest run of bytes that can be summed before the adler sums overflow 32 bits
+    constexpr type::size AdlerRun = 5552;
+
+    // Streams the contents of a single chunk, keeping its CRC up to date
+    class ChunkStream
+    {
+    public:
+        ChunkStream(std::ofstream& out, const char* name, type::uint32 length) : m_out(out), m_crc(0xFFFFFFFFu)
+        {
+            type::uint8 header[4] = {
+                    static_cast<type::uint8>(length >> 24), static_cast<type::uint8>(length >> 16),
+                    static_cast<type::uint8>(length >> 8), static_cast<type::uint8>(length)
+            };
+            m_out.write(reinterpret_cast<const char*>(header), 4);
+            put(reinterpret_cast<const type::uint8*>(name), 4);
+        }
+
+        inline auto put(const type::uint8* data, type::size size) -> void
+        {
+            m_crc = vkc::capture::PngWriter::Crc32(m_crc, data, size);
+            m_out.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+        }
+        inline auto putU32(type::uint32 value) -> void
+        {
+            type::uint8 bytes[4] = {
+                    static_cast<type::uint8>(value >> 24), static_cast<type::uint8>(value >> 16),
+                    static_cast<type::uint8>(value >> 8), static_cast<type::uint8>(value)
+            };
+            put(bytes, 4);
+        }
+
+        auto end() -> void
+        {
+            type::uint32 crc = m_crc ^ 0xFFFFFFFFu;
+            type::uint8 bytes[4] = {
+                    static_cast<type::uint8>(crc >> 24), static_cast<type::uint8>(crc >> 16),
+                    static_cast<type::uint8>(crc >> 8), static_cast<type::uint8>(crc)
+            };
+            m_out.write(reinterpret_cast<const char*>(bytes), 4);
+        }
+
+    private:
+        std::ofstream& m_out;
+        type::uint32 m_crc;
+    };
+}
+
+vkc::capture::PngWriter::PngWriter(std::string prefix) : m_prefix(std::move(prefix))
+{
+}
+
+auto vkc::capture::PngWriter::Crc32(type::uint32 crc, const type::uint8* data, type::size size) -> type::uint32
+{
+    for(type::size i = 0; i < size; ++i)
+    {
+        crc = CrcTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+auto vkc::capture::PngWriter::write(const CapturedFrame& frame) -> void
+{
+    VKC_ZONE("PngWriter::write");
+
+    char suffix[32];
+    std::snprintf(suffix, sizeof(suffix), "_%06llu.png", static_cast<unsigned long long>(frame.frameNumber));
+    std::string path = m_prefix + suffix;
+
+    std::ofstream out(path, std::ios::binary);
+    if(!out)
+    {
+        throw std::runtime_error("Failed to open " + path);
+    }
+
+    static constexpr type::uint8 signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    out.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+    ChunkStream header(out, "IHDR", 13);
+    header.putU32(frame.width);
+    header.putU32(frame.height);
+    // 8 bits per channel, truecolor without alpha, deflate, adaptive filtering, no interlacing
+    static constexpr type::uint8 format[5] = {8, 2, 0, 0, 0};
+    header.put(format, sizeof(format));
+    header.end();
+
+    // Every row is prefixed with its filter type
+    type::size rowSize = 1 + static_cast<type::size>(frame.width) * 3;
+    type::size rawSize = rowSize * frame.height;
+    type::size numBlocks = std::max<type::size>(1, (rawSize + MaxStoredBlock - 1) / MaxStoredBlock);
+    // zlib header, stored blocks each with a 5 byte header, then the adler32 checksum
+    type::size dataSize = 2 + rawSize + numBlocks * 5 + 4;
+    if(dataSize > type::uint32_max / 2)
+    {
+        throw std::runtime_error("Frame too large to encode as PNG");
+    }
+
+    ChunkStream data(out, "IDAT", static_cast<type::uint32>(dataSize));
+    // Deflate with a 32K window and no compression, checksum bits make the header divisible by 31
+    static constexpr type::uint8 zlibHeader[2] = {0x78, 0x01};
+    data.put(zlibHeader, sizeof(zlibHeader));
+
+    type::uint32 adlerA = 1;
+    type::uint32 adlerB = 0;
+    type::size rawLeft = rawSize;
+    type::size blockLeft = 0;
+    if(rawSize == 0)
+    {
+        // Empty final block
+        static constexpr type::uint8 emptyBlock[5] = {1, 0x00, 0x00, 0xFF, 0xFF};
+        data.put(emptyBlock, sizeof(emptyBlock));
+    }
+
+    m_row.resize(rowSize);
+    // Filter type 0, rows are stored as is
+    m_row[0] = 0;
+    type::size red = frame.bgra ? 2 : 0;
+    type::size blue = frame.bgra ? 0 : 2;
+    for(type::uint32 y = 0; y < frame.height; ++y)
+    {
+        const auto* src = reinterpret_cast<const type::uint8*>(frame.pixels + y * frame.rowPitch);
+        type::uint8* dst = m_row.data() + 1;
+        for(type::uint32 x = 0; x < frame.width; ++x, src += 4, dst += 3)
+        {
+            dst[0] = src[red];
+            dst[1] = src[1];
+            dst[2] = src[blue];
+        }
+
+        for(type::size i = 0; i < rowSize; i += AdlerRun)
+        {
+            type::size end = std::min(rowSize, i + AdlerRun);
+            for(type::size j = i; j < end; ++j)
+            {
+                adlerA += m_row[j];
+                adlerB += adlerA;
+            }
+            adlerA %= AdlerMod;
+            adlerB %= AdlerMod;
+        }
+
+        // Split the row across stored blocks
+        type::size offset = 0;
+        while(offset < rowSize)
+        {
+            if(blockLeft == 0)
+            {
+                blockLeft = std::min(MaxStoredBlock, rawLeft);
+                auto len = static_cast<type::uint16>(blockLeft);
+                auto nlen = static_cast<type::uint16>(~len);
+                type::uint8 blockHeader[5] = {
+                        static_cast<type::uint8>(blockLeft == rawLeft ? 1 : 0),
+                        static_cast<type::uint8>(len), static_cast<type::uint8>(len >> 8),
+                        static_cast<type::uint8>(nlen), static_cast<type::uint8>(nlen >> 8)
+                };
+                data.put(blockHeader, sizeof(blockHeader));
+            }
+            type::size count = std::min(blockLeft, rowSize - offset);
+            data.put(m_row.data() + offset, count);
+            offset += count;
+            blockLeft -= count;
+            rawLeft -= count;
+        }
+    }
+
+    data.putU32((adlerB << 16) | adlerA);
+    data.end();
+
+    ChunkStream end(out, "IEND", 0);
+    end.end();
+
+    if(!out)
+    {
+        throw std::runtime_error("Failed to write " + path);
+    }
+}
@@ -0,0 +1,38 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#ifndef VULKANCUBE_PNGWRITER_H
+#define VULKANCUBE_PNGWRITER_H
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "../NonCopyable.h"
+#include "../Types.h"
+
+namespace vkc::capture
+{
+    struct CapturedFrame;
+
+    // Writes each frame to <prefix>_<frame number>.png as 8 bit RGB
+    // Pixel rows are streamed straight from the mapped buffer into uncompressed deflate blocks,
+    // so encoding is a single pass with one row of scratch memory and no compression library
+    class PngWriter : public NonCopyable
+    {
+    public:
+        explicit PngWriter(std::string prefix);
+
+        auto write(const CapturedFrame& frame) -> void;
+
+        static auto Crc32(type::uint32 crc, const type::uint8* data, type::size size) -> type::uint32;
+
+    private:
+        std::string m_prefix;
+        std::vector<type::uint8> m_row;
+    };
+}
+
+#endif //VULKANCUBE_PNGWRITER_H
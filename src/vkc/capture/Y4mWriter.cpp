@@ -0,0 +1,106 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#include <algorithm>
+#include <stdexcept>
+#include "Y4mWriter.h"
+#include "FrameCapture.h"
+#include "../profile/Profiler.h"
+
+namespace
+{
+    // BT.601 full range coefficients in 16.16 fixed point
+    inline auto Luma(int r, int g, int b) -> type::uint8
+    {
+        return static_cast<type::uint8>((19595 * r + 38470 * g + 7471 * b + 32768) >> 16);
+    }
+    inline auto ChromaBlue(int r, int g, int b) -> type::uint8
+    {
+        return static_cast<type::uint8>(std::clamp(((-11059 * r - 21709 * g + 32768 * b + 32768) >> 16) + 128, 0, 255));
+    }
+    inline auto ChromaRed(int r, int g, int b) -> type::uint8
+    {
+        return static_cast<type::uint8>(std::clamp(((32768 * r - 27439 * g - 5329 * b + 32768) >> 16) + 128, 0, 255));
+    }
+}
+
+vkc::capture::Y4mWriter::Y4mWriter(const std::string& path, type::uint32 framesPerSecond) :
+        m_out(path, std::ios::binary),
+        m_path(path),
+        m_fps(framesPerSecond),
+        m_width(0),
+        m_height(0)
+{
+    if(!m_out)
+    {
+        throw std::runtime_error("Failed to open " + path);
+    }
+}
+
+auto vkc::capture::Y4mWriter::write(const CapturedFrame& frame) -> void
+{
+    VKC_ZONE("Y4mWriter::write");
+
+    // The stream header is written with the first frame since that's when the size is known
+    if(m_width == 0)
+    {
+        m_width = frame.width;
+        m_height = frame.height;
+        m_out << "YUV4MPEG2 W" << m_width << " H" << m_height << " F" << m_fps << ":1 Ip A1:1 C420jpeg\n";
+    }
+    else if(frame.width != m_width || frame.height != m_height)
+    {
+        throw std::runtime_error("Video frames must all be the same size");
+    }
+    m_out << "FRAME\n";
+
+    type::size red = frame.bgra ? 2 : 0;
+    type::size blue = frame.bgra ? 0 : 2;
+    auto pixel = [&frame](type::uint32 x, type::uint32 y)
+    {
+        return reinterpret_cast<const type::uint8*>(frame.pixels + y * frame.rowPitch) + x * 4;
+    };
+
+    // Luma plane
+    m_row.resize(m_width);
+    for(type::uint32 y = 0; y < m_height; ++y)
+    {
+        const type::uint8* src = pixel(0, y);
+        for(type::uint32 x = 0; x < m_width; ++x, src += 4)
+        {
+            m_row[x] = Luma(src[red], src[1], src[blue]);
+        }
+        m_out.write(reinterpret_cast<const char*>(m_row.data()), m_width);
+    }
+
+    // Chroma planes from the average of each 2x2 block, clamped at odd edges
+    type::uint32 chromaWidth = (m_width + 1) / 2;
+    type::uint32 chromaHeight = (m_height + 1) / 2;
+    m_row.resize(chromaWidth);
+    m_vPlane.resize(static_cast<type::size>(chromaWidth) * chromaHeight);
+    for(type::uint32 cy = 0; cy < chromaHeight; ++cy)
+    {
+        type::uint32 y0 = cy * 2;
+        type::uint32 y1 = std::min(y0 + 1, m_height - 1);
+        for(type::uint32 cx = 0; cx < chromaWidth; ++cx)
+        {
+            type::uint32 x0 = cx * 2;
+            type::uint32 x1 = std::min(x0 + 1, m_width - 1);
+            const type::uint8* p[4] = {pixel(x0, y0), pixel(x1, y0), pixel(x0, y1), pixel(x1, y1)};
+            int r = (p[0][red] + p[1][red] + p[2][red] + p[3][red] + 2) / 4;
+            int g = (p[0][1] + p[1][1] + p[2][1] + p[3][1] + 2) / 4;
+            int b = (p[0][blue] + p[1][blue] + p[2][blue] + p[3][blue] + 2) / 4;
+            m_row[cx] = ChromaBlue(r, g, b);
+            m_vPlane[static_cast<type::size>(cy) * chromaWidth + cx] = ChromaRed(r, g, b);
+        }
+        m_out.write(reinterpret_cast<const char*>(m_row.data()), chromaWidth);
+    }
+    m_out.write(reinterpret_cast<const char*>(m_vPlane.data()), static_cast<std::streamsize>(m_vPlane.size()));
+
+    if(!m_out)
+    {
+        throw std::runtime_error("Failed to write " + m_path);
+    }
+}
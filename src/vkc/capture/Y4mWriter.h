@@ -0,0 +1,41 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#ifndef VULKANCUBE_Y4MWRITER_H
+#define VULKANCUBE_Y4MWRITER_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include "../NonCopyable.h"
+#include "../Types.h"
+
+namespace vkc::capture
+{
+    struct CapturedFrame;
+
+    // Appends frames to a single raw YUV4MPEG2 video, 4:2:0 full range BT.601
+    // Y and U planes are streamed row by row, only the V plane is buffered since it follows U
+    // Every frame must have the size of the first frame
+    class Y4mWriter : public NonCopyable
+    {
+    public:
+        Y4mWriter(const std::string& path, type::uint32 framesPerSecond);
+
+        auto write(const CapturedFrame& frame) -> void;
+
+    private:
+        std::ofstream m_out;
+        std::string m_path;
+        type::uint32 m_fps;
+        type::uint32 m_width;
+        type::uint32 m_height;
+
+        std::vector<type::uint8> m_row;
+        std::vector<type::uint8> m_vPlane;
+    };
+}
+
+#endif //VULKANCUBE_Y4MWRITER_H
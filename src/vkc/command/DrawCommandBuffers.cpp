@@ -5,33 +5,39 @@
 
 #include "DrawCommandBuffers.h"
 #include "../Device.h"
-#include "../pipeline/SwapChain.h"
+#include "../pipeline/RenderTarget.h"
 #include "../pipeline/RenderPass.h"
 #include "../buffer/UBO.h"
 #include "../pipeline/GraphicsPipeline.h"
-#include "../buffer/Buffer.h"
+#include "../profile/GpuTimer.h"
+#include "../descriptor/ResourceSet.h"
 
 vkc::DrawCommandBuffers::DrawCommandBuffers(
         const vkc::Device& device,
-        const vkc::SwapChain& swapChain,
-        const vkc::RenderPass& renderPass,
+        const vkc::RenderTarget& target,
+        const vkc::RenderPass* renderPass,
         const vkc::UBO& ubo,
         const vkc::GraphicsPipeline& pipeline,
-        const vkc::Buffer& modelBuffer,
-        VkDeviceSize vertexOffset,
-        VkDeviceSize indexOffset,
-        type::uint32 indexSize
+        const vkc::GeometryPool& geometry,
+        const vkc::GeometryPool::Mesh& mesh,
+        const vkc::profile::GpuTimer* gpuTimer
         ) :
-        m_pool(device, 0),
+        // Each command buffer is re-recorded on its own when the pipeline is reloaded
+        m_pool(device, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT),
         m_device(device),
-        m_swapChain(swapChain),
+        m_target(target),
         m_renderPass(renderPass),
         m_ubo(ubo),
         m_pipeline(pipeline),
-        m_modelBuffer(modelBuffer),
-        m_vertexOffset(vertexOffset),
-        m_indexOffset(indexOffset),
-        m_indexSize(indexSize)
+        m_geometry(geometry),
+        m_mesh(mesh),
+        m_drawCount(1),
+        m_instanceCount(1),
+        m_gpuTimer(gpuTimer),
+        m_graph(device),
+        m_color(0),
+        m_multisample(0),
+        m_recording(0)
 {
     create();
 }
@@ -47,9 +53,21 @@ auto vkc::DrawCommandBuffers::recreate() -> void
     create();
 }
 
+auto vkc::DrawCommandBuffers::setDraws(type::uint32 drawCount, type::uint32 instanceCount) -> void
+{
+    m_drawCount = drawCount;
+    m_instanceCount = instanceCount;
+    recreate();
+}
+
 auto vkc::DrawCommandBuffers::create() -> void
 {
-    m_commands.resize(m_swapChain.numImages());
+    const vkc::DeviceDispatch& vk = m_device.vk();
+    m_commands.resize(m_target.numImages());
+    if(!m_renderPass)
+    {
+        buildGraph();
+    }
 
     VkCommandBufferAllocateInfo allocInfo = {};
     allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -58,60 +76,216 @@ auto vkc::DrawCommandBuffers::create() -> void
     allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
     allocInfo.commandBufferCount = static_cast<type::uint32>(m_commands.size());
 
-    if(vkAllocateCommandBuffers(m_device.logical(), &allocInfo, m_commands.data()) != VK_SUCCESS)
+    if(vk.AllocateCommandBuffers(m_device.logical(), &allocInfo, m_commands.data()) != VK_SUCCESS)
     {
         throw std::runtime_error("Command buffer allocation failed");
     }
 
     // Record commands for each command buffer
-    for(type::size i = 0; i < m_commands.size(); ++i)
+    m_recorded.assign(m_commands.size(), {VK_NULL_HANDLE, 0, 0});
+    for(type::uint32 i = 0; i < m_commands.size(); ++i)
+    {
+        record(i);
+    }
+}
+
+auto vkc::DrawCommandBuffers::refresh(type::uint32 index) -> bool
+{
+    if(m_recorded[index].pipeline == m_pipeline.pipeline() &&
+       m_recorded[index].geometryGeneration == m_geometry.generation() &&
+       m_recorded[index].uboGeneration == m_ubo.written(index))
+    {
+        return false;
+    }
+    // Beginning a command buffer from a resettable pool resets it
+    record(index);
+    return true;
+}
+
+auto vkc::DrawCommandBuffers::record(type::uint32 index) -> void
+{
+    const vkc::DeviceDispatch& vk = m_device.vk();
+    VkCommandBuffer cmd = m_commands[index];
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = 0;
+    beginInfo.pInheritanceInfo = nullptr;
+
+    if(vk.BeginCommandBuffer(cmd, &beginInfo) != VK_SUCCESS)
     {
-        VkCommandBufferBeginInfo beginInfo = {};
-        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        beginInfo.flags = 0;
-        beginInfo.pInheritanceInfo = nullptr;
+        throw std::runtime_error("Command buffer recording failed to start");
+    }
 
-        if(vkBeginCommandBuffer(m_commands[i], &beginInfo) != VK_SUCCESS)
-        {
-            throw std::runtime_error("Command buffer recording failed to start");
-        }
+    if(m_gpuTimer)
+    {
+        m_gpuTimer->cmdBegin(cmd, index);
+    }
 
+    if(m_renderPass)
+    {
+        beginRendering(cmd, index);
+        recordDraws(cmd, index);
+        endRendering(cmd);
+    }
+    else
+    {
+        // The graph's pass records the draws, surrounded by the layout transitions it planned
+        m_recording = index;
+        m_graph.setImported(m_color, m_target.image(index), m_target.imageView(index));
+        m_graph.execute(cmd);
+    }
+
+    if(m_gpuTimer)
+    {
+        m_gpuTimer->cmdEnd(cmd, index);
+    }
+
+    if(vk.EndCommandBuffer(cmd) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Command Buffer recording failed");
+    }
+    m_recorded[index] = {m_pipeline.pipeline(), m_geometry.generation(), m_ubo.written(index)};
+}
+
+auto vkc::DrawCommandBuffers::destroy() -> void
+{
+    m_device.vk().FreeCommandBuffers(m_device.logical(), m_pool.handle(), static_cast<type::uint32>(m_commands.size()), m_commands.data());
+}
+
+auto vkc::DrawCommandBuffers::buildGraph() -> void
+{
+    m_graph.clear();
+
+    vkc::RenderGraph::ImportDesc target = {};
+    target.format = m_target.imageFormat();
+    target.extent = m_target.extent();
+    // Previous contents are cleared, and the acquire semaphore is waited on at color output
+    target.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    target.initialStages = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+    // Left in whatever layout the target uses next (presentation source for a swap chain)
+    // Frame capture waits on color output before copying, so the transition finishes before that
+    target.finalLayout = m_target.finalLayout();
+    target.finalStages = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+    m_color = m_graph.importImage("target", target);
+
+    bool multisampled = m_pipeline.samples() != VK_SAMPLE_COUNT_1_BIT;
+    if(multisampled)
+    {
+        vkc::RenderGraph::ImageDesc multisample = {};
+        multisample.format = m_target.imageFormat();
+        multisample.extent = m_target.extent();
+        multisample.samples = m_pipeline.samples();
+        multisample.lazy = true;
+        m_multisample = m_graph.createImage("multisample", multisample);
+    }
+
+    m_graph.addPass("scene",
+            [this, multisampled](vkc::RenderGraph::PassBuilder& pass)
+            {
+                // The resolve writes the target at color attachment output as well
+                if(multisampled)
+                {
+                    pass.write(m_multisample, vkc::ImageUsage::ColorAttachment);
+                }
+                pass.write(m_color, vkc::ImageUsage::ColorAttachment);
+            },
+            [this](VkCommandBuffer cmd, const vkc::RenderGraph& graph)
+            {
+                beginRendering(cmd, m_recording);
+                recordDraws(cmd, m_recording);
+                endRendering(cmd);
+            });
+    m_graph.compile();
+}
+
+auto vkc::DrawCommandBuffers::recordDraws(VkCommandBuffer cmd, type::uint32 index) -> void
+{
+    const vkc::DeviceDispatch& vk = m_device.vk();
+    vkc::ResourceBinder binder(m_device);
+
+    // Bind pipeline
+    vk.CmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline.pipeline());
+
+    // Bind the shared vertex and index buffers, meshes are told apart by the draws
+    m_geometry.bind(cmd, m_mesh.indexType);
+
+    // Bind the descriptor sets
+    binder.begin(cmd);
+    binder.setLayout(m_pipeline.layout());
+    binder.bind(m_ubo.resourceSet(index));
+
+    // Draw
+    for(type::uint32 draw = 0; draw < m_drawCount; ++draw)
+    {
+        // Only sets that changed since the last draw are bound
+        binder.flush();
+        vk.CmdDrawIndexed(cmd, m_mesh.indexCount, m_instanceCount, m_mesh.firstIndex, m_mesh.vertexOffset, draw);
+    }
+}
+
+auto vkc::DrawCommandBuffers::beginRendering(VkCommandBuffer cmd, type::uint32 index) -> void
+{
+    const vkc::DeviceDispatch& vk = m_device.vk();
+    static constexpr VkClearValue clearColor = {0.0f, 0.0f, 0.0f, 1.0f};
+
+    if(m_renderPass)
+    {
         VkRenderPassBeginInfo passInfo = {};
         passInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-        passInfo.renderPass = m_renderPass.handle();
+        passInfo.renderPass = m_renderPass->handle();
         // Use framebuffer as color attachment
-        passInfo.framebuffer = m_renderPass.frameBuffer(i);
+        passInfo.framebuffer = m_renderPass->frameBuffer(index);
         passInfo.renderArea.offset = {0, 0};
-        passInfo.renderArea.extent = m_swapChain.extent();
-        static constexpr VkClearValue clearColor = {0.0f, 0.0f, 0.0f, 1.0f};
+        passInfo.renderArea.extent = m_target.extent();
         passInfo.clearValueCount = 1;
         passInfo.pClearValues = &clearColor;
 
         // Last param specifies that this is the primary command buffer
-        vkCmdBeginRenderPass(m_commands[i], &passInfo, VK_SUBPASS_CONTENTS_INLINE);
-
-        // Bind pipeline
-        vkCmdBindPipeline(m_commands[i], VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline.pipeline());
-
-        // Bind vertex and index buffers
-        vkCmdBindVertexBuffers(m_commands[i], 0, 1, &m_modelBuffer.handle(), &m_vertexOffset);
-        vkCmdBindIndexBuffer(m_commands[i], m_modelBuffer.handle(), m_indexOffset, VK_INDEX_TYPE_UINT16);
+        vk.CmdBeginRenderPass(cmd, &passInfo, VK_SUBPASS_CONTENTS_INLINE);
+        return;
+    }
 
-        // Bind the descriptor sets
-        vkCmdBindDescriptorSets(m_commands[i], VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline.layout(), 0, 1, &m_ubo.descriptorSet(i), 0, nullptr);
+    VkRenderingAttachmentInfo colorAttachment = {};
+    colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+    colorAttachment.imageView = m_graph.imageView(m_color);
+    colorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    colorAttachment.resolveMode = VK_RESOLVE_MODE_NONE;
+    // Clear data before rendering, then store result after
+    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    colorAttachment.clearValue = clearColor;
+    if(m_pipeline.samples() != VK_SAMPLE_COUNT_1_BIT)
+    {
+        // Render into the multisample image and resolve into the target as rendering ends
+        // The samples themselves are never stored
+        colorAttachment.imageView = m_graph.imageView(m_multisample);
+        colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        colorAttachment.resolveMode = VK_RESOLVE_MODE_AVERAGE_BIT;
+        colorAttachment.resolveImageView = m_graph.imageView(m_color);
+        colorAttachment.resolveImageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    }
 
-        // Draw
-        vkCmdDrawIndexed(m_commands[i], m_indexSize, 1, 0, 0, 0);
-        vkCmdEndRenderPass(m_commands[i]);
+    VkRenderingInfo renderingInfo = {};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+    renderingInfo.renderArea.offset = {0, 0};
+    renderingInfo.renderArea.extent = m_target.extent();
+    renderingInfo.layerCount = 1;
+    renderingInfo.viewMask = 0;
+    renderingInfo.colorAttachmentCount = 1;
+    renderingInfo.pColorAttachments = &colorAttachment;
 
-        if(vkEndCommandBuffer(m_commands[i]) != VK_SUCCESS)
-        {
-            throw std::runtime_error("Command Buffer recording failed");
-        }
-    }
+    vk.CmdBeginRendering(cmd, &renderingInfo);
 }
 
-auto vkc::DrawCommandBuffers::destroy() -> void
+auto vkc::DrawCommandBuffers::endRendering(VkCommandBuffer cmd) -> void
 {
-    vkFreeCommandBuffers(m_device.logical(), m_pool.handle(), static_cast<type::uint32>(m_commands.size()), m_commands.data());
+    if(m_renderPass)
+    {
+        m_device.vk().CmdEndRenderPass(cmd);
+    }
+    else
+    {
+        m_device.vk().CmdEndRendering(cmd);
+    }
 }
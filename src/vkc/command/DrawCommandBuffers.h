@@ -10,29 +10,34 @@
 #include <vector>
 #include "../NonCopyable.h"
 #include "CommandPool.h"
+#include "../buffer/GeometryPool.h"
+#include "../graph/RenderGraph.h"
 #include "../Types.h"
 
 namespace vkc
 {
     class Device;
-    class SwapChain;
+    class RenderTarget;
     class RenderPass;
     class UBO;
     class GraphicsPipeline;
-    class Buffer;
+    namespace profile { class GpuTimer; }
     class DrawCommandBuffers : public NonCopyable
     {
     public:
+        // Without a render pass, draws begin dynamic rendering against the target's image views
+        // and the image layouts are transitioned by a render graph
+        // A multisampled pipeline renders into a transient multisample image that is resolved into the target
+        // The geometry pool's buffers are bound once, and every draw is of mesh
         DrawCommandBuffers(
                 const vkc::Device& device,
-                const vkc::SwapChain& swapChain,
-                const vkc::RenderPass& renderPass,
+                const vkc::RenderTarget& target,
+                const vkc::RenderPass* renderPass,
                 const vkc::UBO& ubo,
                 const vkc::GraphicsPipeline& pipeline,
-                const vkc::Buffer& modelBuffer,
-                VkDeviceSize vertexOffset,
-                VkDeviceSize indexOffset,
-                type::uint32 indexSize
+                const vkc::GeometryPool& geometry,
+                const vkc::GeometryPool::Mesh& mesh,
+                const vkc::profile::GpuTimer* gpuTimer = nullptr
                 );
         ~DrawCommandBuffers();
 
@@ -40,23 +45,58 @@ namespace vkc
         inline auto command(type::uint32 index) -> VkCommandBuffer& { return m_commands[index]; }
 
         auto recreate() -> void;
+        // Draw the model drawCount times with instanceCount instances each, draws are
+        // told apart in shaders by their first instance. Re-records, so the device must be idle
+        auto setDraws(type::uint32 drawCount, type::uint32 instanceCount) -> void;
+        // Re-records the image's commands if the pipeline was swapped, the geometry buffers moved or the image's
+        // uniform descriptor set was rewritten since they were recorded, so the other images keep drawing with theirs
+        // Call after UBO::refresh. The image's last submission must be complete
+        auto refresh(type::uint32 index) -> bool;
+
+        [[nodiscard]]
+        inline auto drawCount() const -> type::uint32 { return m_drawCount; }
+        [[nodiscard]]
+        inline auto instanceCount() const -> type::uint32 { return m_instanceCount; }
 
     private:
         CommandPool m_pool;
         std::vector<VkCommandBuffer> m_commands;
+        // What each command buffer was recorded with
+        struct Recorded
+        {
+            VkPipeline pipeline;
+            type::uint64 geometryGeneration;
+            // Updating a bound descriptor set invalidates the command buffer
+            type::uint64 uboGeneration;
+        };
+        std::vector<Recorded> m_recorded;
 
         const vkc::Device& m_device;
-        const vkc::SwapChain& m_swapChain;
-        const vkc::RenderPass& m_renderPass;
+        const vkc::RenderTarget& m_target;
+        const vkc::RenderPass* m_renderPass;
         const vkc::UBO& m_ubo;
         const vkc::GraphicsPipeline& m_pipeline;
-        const vkc::Buffer& m_modelBuffer;
-        VkDeviceSize m_vertexOffset;
-        VkDeviceSize m_indexOffset;
-        type::uint32 m_indexSize;
+        const vkc::GeometryPool& m_geometry;
+        vkc::GeometryPool::Mesh m_mesh;
+        type::uint32 m_drawCount;
+        type::uint32 m_instanceCount;
+        const vkc::profile::GpuTimer* m_gpuTimer;
+
+        // Only used for dynamic rendering, where the render pass no longer handles layouts
+        vkc::RenderGraph m_graph;
+        vkc::RenderGraph::Resource m_color;
+        vkc::RenderGraph::Resource m_multisample;
+        // Image whose command buffer the graph is recording
+        type::uint32 m_recording;
 
         auto create() -> void;
         auto destroy() -> void;
+        auto record(type::uint32 index) -> void;
+
+        auto buildGraph() -> void;
+        auto recordDraws(VkCommandBuffer cmd, type::uint32 index) -> void;
+        auto beginRendering(VkCommandBuffer cmd, type::uint32 index) -> void;
+        auto endRendering(VkCommandBuffer cmd) -> void;
     };
 }
 
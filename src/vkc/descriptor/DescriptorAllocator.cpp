@@ -0,0 +1,198 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include "DescriptorAllocator.h"
+#include "../Device.h"
+
+namespace
+{
+    // Descriptors of each type reserved per set in a pool
+    struct PoolRatio
+    {
+        VkDescriptorType type;
+        float perSet;
+    };
+
+    // Every type shader reflection produces and the descriptor writer can write
+    constexpr std::array<PoolRatio, 11> PoolRatios =
+            {{
+                    {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2.0f},
+                    {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.0f},
+                    {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2.0f},
+                    {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1.0f},
+                    {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4.0f},
+                    {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 1.0f},
+                    {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1.0f},
+                    {VK_DESCRIPTOR_TYPE_SAMPLER, 1.0f},
+                    {VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER, 0.5f},
+                    {VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER, 0.5f},
+                    {VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 0.5f}
+            }};
+}
+
+vkc::DescriptorAllocator::DescriptorAllocator(const vkc::Device& device, type::uint32 framesInFlight) :
+        m_device(device),
+        m_layouts(device),
+        m_persistent(),
+        m_frames(framesInFlight)
+{
+}
+
+vkc::DescriptorAllocator::~DescriptorAllocator()
+{
+    destroyChain(m_persistent);
+    for(auto& frame : m_frames)
+    {
+        destroyChain(frame);
+    }
+}
+
+auto vkc::DescriptorAllocator::allocate(VkDescriptorSetLayout layout) -> VkDescriptorSet
+{
+    std::lock_guard lock(m_mutex);
+    return allocateFrom(m_persistent, layout);
+}
+
+auto vkc::DescriptorAllocator::allocateTransient(type::uint32 frameIndex, VkDescriptorSetLayout layout) -> VkDescriptorSet
+{
+    std::lock_guard lock(m_mutex);
+    return allocateFrom(m_frames[frameIndex], layout);
+}
+
+auto vkc::DescriptorAllocator::resetFrame(type::uint32 frameIndex) -> void
+{
+    std::lock_guard lock(m_mutex);
+    PoolChain& chain = m_frames[frameIndex];
+    if(chain.current != VK_NULL_HANDLE)
+    {
+        chain.full.push_back(chain.current);
+        chain.current = VK_NULL_HANDLE;
+    }
+    // Resetting returns every set of the pool at once
+    for(VkDescriptorPool pool : chain.full)
+    {
+        m_device.vk().ResetDescriptorPool(m_device.logical(), pool, 0);
+        chain.ready.push_back(pool);
+    }
+    chain.full.clear();
+}
+
+auto vkc::DescriptorAllocator::poolCount() const -> type::size
+{
+    std::lock_guard lock(m_mutex);
+    auto count = [](const PoolChain& chain)
+    {
+        return chain.full.size() + chain.ready.size() + (chain.current != VK_NULL_HANDLE ? 1 : 0);
+    };
+    type::size pools = count(m_persistent);
+    for(const auto& frame : m_frames)
+    {
+        pools += count(frame);
+    }
+    return pools;
+}
+
+auto vkc::DescriptorAllocator::allocateFrom(PoolChain& chain, VkDescriptorSetLayout layout) -> VkDescriptorSet
+{
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &layout;
+
+    // Ready pools are tried in turn, then one newly created with room for the set,
+    // a set that doesn't fit a pool sized for it never will
+    while(true)
+    {
+        bool created = false;
+        if(chain.current == VK_NULL_HANDLE)
+        {
+            created = chain.ready.empty();
+            chain.current = nextPool(chain, layout);
+        }
+        allocInfo.descriptorPool = chain.current;
+
+        VkDescriptorSet set;
+        VkResult result = m_device.vk().AllocateDescriptorSets(m_device.logical(), &allocInfo, &set);
+        if(result == VK_SUCCESS)
+        {
+            return set;
+        }
+        if(result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL)
+        {
+            break;
+        }
+        chain.full.push_back(chain.current);
+        chain.current = VK_NULL_HANDLE;
+        if(created)
+        {
+            break;
+        }
+    }
+    throw std::runtime_error("Descriptor Set allocation failed");
+}
+
+auto vkc::DescriptorAllocator::nextPool(PoolChain& chain, VkDescriptorSetLayout layout) -> VkDescriptorPool
+{
+    if(!chain.ready.empty())
+    {
+        VkDescriptorPool pool = chain.ready.back();
+        chain.ready.pop_back();
+        return pool;
+    }
+
+    type::uint32 maxSets = chain.nextPoolSets;
+    chain.nextPoolSets = std::min(chain.nextPoolSets * 2, MaxPoolSets);
+
+    std::vector<VkDescriptorPoolSize> sizes(PoolRatios.size());
+    for(type::size i = 0; i < PoolRatios.size(); ++i)
+    {
+        sizes[i].type = PoolRatios[i].type;
+        sizes[i].descriptorCount = static_cast<type::uint32>(PoolRatios[i].perSet * static_cast<float>(maxSets));
+    }
+    // On top of the ratios, so a set with a binding larger than they allow still fits
+    for(const VkDescriptorSetLayoutBinding& binding : m_layouts.bindings(layout))
+    {
+        auto size = std::find_if(sizes.begin(), sizes.end(), [&](const VkDescriptorPoolSize& poolSize) { return poolSize.type == binding.descriptorType; });
+        if(size == sizes.end())
+        {
+            sizes.push_back({binding.descriptorType, 0});
+            size = sizes.end() - 1;
+        }
+        size->descriptorCount += binding.descriptorCount;
+    }
+
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = static_cast<type::uint32>(sizes.size());
+    poolInfo.pPoolSizes = sizes.data();
+    poolInfo.maxSets = maxSets;
+
+    VkDescriptorPool pool;
+    if(m_device.vk().CreateDescriptorPool(m_device.logical(), &poolInfo, m_device.allocator(), &pool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Descriptor Pool creation failed");
+    }
+    return pool;
+}
+
+auto vkc::DescriptorAllocator::destroyChain(PoolChain& chain) -> void
+{
+    if(chain.current != VK_NULL_HANDLE)
+    {
+        chain.full.push_back(chain.current);
+        chain.current = VK_NULL_HANDLE;
+    }
+    for(auto* pools : {&chain.full, &chain.ready})
+    {
+        for(VkDescriptorPool pool : *pools)
+        {
+            m_device.vk().DestroyDescriptorPool(m_device.logical(), pool, m_device.allocator());
+        }
+        pools->clear();
+    }
+}
@@ -0,0 +1,71 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#ifndef VULKANCUBE_DESCRIPTORALLOCATOR_H
+#define VULKANCUBE_DESCRIPTORALLOCATOR_H
+
+#include <vulkan/vulkan.h>
+#include <mutex>
+#include <vector>
+#include "../NonCopyable.h"
+#include "../Types.h"
+#include "DescriptorLayoutCache.h"
+
+namespace vkc
+{
+    class Device;
+    // Device wide source of descriptor sets
+    // Persistent sets live as long as the allocator. Transient sets live for one frame in flight,
+    // their pools are reset whole once that frame's fence has signaled instead of freeing sets one by one
+    // Pools are created on demand and grow geometrically, so nothing has to be sized up front
+    // A pool created for a set that didn't fit also has room for that set's own bindings, such as large arrays
+    class DescriptorAllocator : public NonCopyable
+    {
+    public:
+        DescriptorAllocator(const vkc::Device& device, type::uint32 framesInFlight);
+        ~DescriptorAllocator();
+
+        auto allocate(VkDescriptorSetLayout layout) -> VkDescriptorSet;
+        // Valid until resetFrame is called with the same frame index
+        auto allocateTransient(type::uint32 frameIndex, VkDescriptorSetLayout layout) -> VkDescriptorSet;
+        // Must only be called once the GPU is done with the frame, after waiting on its fence
+        auto resetFrame(type::uint32 frameIndex) -> void;
+
+        [[nodiscard]]
+        inline auto layouts() -> vkc::DescriptorLayoutCache& { return m_layouts; }
+        [[nodiscard]]
+        auto poolCount() const -> type::size;
+
+        // Sets per pool of the first pool in a chain, and the cap it doubles towards
+        static constexpr type::uint32 InitialPoolSets = 64;
+        static constexpr type::uint32 MaxPoolSets = 4096;
+
+    private:
+        struct PoolChain
+        {
+            // Pool new sets are allocated from
+            VkDescriptorPool current = VK_NULL_HANDLE;
+            // Pools that ran out of space
+            std::vector<VkDescriptorPool> full;
+            // Empty pools left over from a reset, used before creating new ones
+            std::vector<VkDescriptorPool> ready;
+            type::uint32 nextPoolSets = InitialPoolSets;
+        };
+
+        const vkc::Device& m_device;
+        vkc::DescriptorLayoutCache m_layouts;
+
+        mutable std::mutex m_mutex;
+        PoolChain m_persistent;
+        std::vector<PoolChain> m_frames;
+
+        auto allocateFrom(PoolChain& chain, VkDescriptorSetLayout layout) -> VkDescriptorSet;
+        // Layout is the one whose set is being allocated
+        auto nextPool(PoolChain& chain, VkDescriptorSetLayout layout) -> VkDescriptorPool;
+        auto destroyChain(PoolChain& chain) -> void;
+    };
+}
+
+#endif //VULKANCUBE_DESCRIPTORALLOCATOR_H
@@ -0,0 +1,161 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include "DescriptorLayoutCache.h"
+#include "../Device.h"
+
+namespace
+{
+    inline auto HashCombine(type::size seed, type::size value) -> type::size
+    {
+        return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+    }
+}
+
+vkc::DescriptorLayoutCache::DescriptorLayoutCache(const vkc::Device& device) : m_device(device)
+{
+}
+
+vkc::DescriptorLayoutCache::~DescriptorLayoutCache()
+{
+    for(const auto& [key, layout] : m_pipelineLayouts)
+    {
+        m_device.vk().DestroyPipelineLayout(m_device.logical(), layout, m_device.allocator());
+    }
+    for(const auto& [key, layout] : m_layouts)
+    {
+        m_device.vk().DestroyDescriptorSetLayout(m_device.logical(), layout, m_device.allocator());
+    }
+}
+
+auto vkc::DescriptorLayoutCache::get(std::vector<VkDescriptorSetLayoutBinding> bindings) -> VkDescriptorSetLayout
+{
+    std::sort(bindings.begin(), bindings.end(), [](const auto& a, const auto& b) { return a.binding < b.binding; });
+    Key key{std::move(bindings)};
+
+    std::lock_guard lock(m_mutex);
+    auto it = m_layouts.find(key);
+    if(it != m_layouts.end())
+    {
+        return it->second;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<type::uint32>(key.bindings.size());
+    layoutInfo.pBindings = key.bindings.data();
+
+    VkDescriptorSetLayout layout;
+    if(m_device.vk().CreateDescriptorSetLayout(m_device.logical(), &layoutInfo, m_device.allocator(), &layout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Descriptor Set Layout creation failed");
+    }
+    auto added = m_layouts.emplace(std::move(key), layout).first;
+    m_bindings.emplace(layout, &added->first.bindings);
+    return layout;
+}
+
+auto vkc::DescriptorLayoutCache::pipelineLayout(
+        std::span<const VkDescriptorSetLayout> setLayouts,
+        std::span<const VkPushConstantRange> pushConstants
+        ) -> VkPipelineLayout
+{
+    PipelineKey key{{setLayouts.begin(), setLayouts.end()}, {pushConstants.begin(), pushConstants.end()}};
+
+    std::lock_guard lock(m_mutex);
+    auto it = m_pipelineLayouts.find(key);
+    if(it != m_pipelineLayouts.end())
+    {
+        return it->second;
+    }
+
+    VkPipelineLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    layoutInfo.setLayoutCount = static_cast<type::uint32>(key.setLayouts.size());
+    layoutInfo.pSetLayouts = key.setLayouts.data();
+    layoutInfo.pushConstantRangeCount = static_cast<type::uint32>(key.pushConstants.size());
+    layoutInfo.pPushConstantRanges = key.pushConstants.data();
+
+    VkPipelineLayout layout;
+    if(m_device.vk().CreatePipelineLayout(m_device.logical(), &layoutInfo, m_device.allocator(), &layout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Pipeline Layout creation failed");
+    }
+    m_pipelineLayouts.emplace(std::move(key), layout);
+    return layout;
+}
+
+auto vkc::DescriptorLayoutCache::bindings(VkDescriptorSetLayout layout) const -> std::vector<VkDescriptorSetLayoutBinding>
+{
+    std::lock_guard lock(m_mutex);
+    auto it = m_bindings.find(layout);
+    if(it == m_bindings.end())
+    {
+        return {};
+    }
+    return *it->second;
+}
+
+auto vkc::DescriptorLayoutCache::size() const -> type::size
+{
+    std::lock_guard lock(m_mutex);
+    return m_layouts.size();
+}
+
+auto vkc::DescriptorLayoutCache::Key::operator==(const Key& other) const -> bool
+{
+    return std::equal(bindings.begin(), bindings.end(), other.bindings.begin(), other.bindings.end(),
+            [](const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b)
+            {
+                return a.binding == b.binding &&
+                       a.descriptorType == b.descriptorType &&
+                       a.descriptorCount == b.descriptorCount &&
+                       a.stageFlags == b.stageFlags &&
+                       a.pImmutableSamplers == b.pImmutableSamplers;
+            });
+}
+
+auto vkc::DescriptorLayoutCache::KeyHash::operator()(const Key& key) const -> type::size
+{
+    type::size hash = key.bindings.size();
+    for(const auto& binding : key.bindings)
+    {
+        hash = HashCombine(hash, binding.binding);
+        hash = HashCombine(hash, binding.descriptorType);
+        hash = HashCombine(hash, binding.descriptorCount);
+        hash = HashCombine(hash, binding.stageFlags);
+        hash = HashCombine(hash, std::hash<const void*>()(binding.pImmutableSamplers));
+    }
+    return hash;
+}
+
+auto vkc::DescriptorLayoutCache::PipelineKey::operator==(const PipelineKey& other) const -> bool
+{
+    return setLayouts == other.setLayouts &&
+           std::equal(pushConstants.begin(), pushConstants.end(), other.pushConstants.begin(), other.pushConstants.end(),
+            [](const VkPushConstantRange& a, const VkPushConstantRange& b)
+            {
+                return a.stageFlags == b.stageFlags && a.offset == b.offset && a.size == b.size;
+            });
+}
+
+auto vkc::DescriptorLayoutCache::PipelineKeyHash::operator()(const PipelineKey& key) const -> type::size
+{
+    type::size hash = key.setLayouts.size();
+    for(VkDescriptorSetLayout layout : key.setLayouts)
+    {
+        hash = HashCombine(hash, std::hash<VkDescriptorSetLayout>()(layout));
+    }
+    for(const auto& range : key.pushConstants)
+    {
+        hash = HashCombine(hash, range.stageFlags);
+        hash = HashCombine(hash, range.offset);
+        hash = HashCombine(hash, range.size);
+    }
+    return hash;
+}
@@ -0,0 +1,76 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#ifndef VULKANCUBE_DESCRIPTORLAYOUTCACHE_H
+#define VULKANCUBE_DESCRIPTORLAYOUTCACHE_H
+
+#include <vulkan/vulkan.h>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include "../NonCopyable.h"
+#include "../Types.h"
+
+namespace vkc
+{
+    class Device;
+    // Creates each distinct descriptor set layout once, keyed by its bindings,
+    // and each distinct pipeline layout once, keyed by its set layouts and push constants
+    // Layouts are owned by the cache and destroyed with it
+    class DescriptorLayoutCache : public NonCopyable
+    {
+    public:
+        explicit DescriptorLayoutCache(const vkc::Device& device);
+        ~DescriptorLayoutCache();
+
+        // Binding order doesn't matter, bindings are sorted before lookup
+        auto get(std::vector<VkDescriptorSetLayoutBinding> bindings) -> VkDescriptorSetLayout;
+        // Pipelines whose shaders declare the same resources share a layout, so sets bound for one stay compatible with the other
+        auto pipelineLayout(std::span<const VkDescriptorSetLayout> setLayouts, std::span<const VkPushConstantRange> pushConstants) -> VkPipelineLayout;
+        // Bindings a layout was created with, empty for layouts the cache didn't create
+        [[nodiscard]]
+        auto bindings(VkDescriptorSetLayout layout) const -> std::vector<VkDescriptorSetLayoutBinding>;
+
+        [[nodiscard]]
+        auto size() const -> type::size;
+
+    private:
+        struct Key
+        {
+            std::vector<VkDescriptorSetLayoutBinding> bindings;
+
+            auto operator==(const Key& other) const -> bool;
+        };
+
+        struct KeyHash
+        {
+            auto operator()(const Key& key) const -> type::size;
+        };
+
+        struct PipelineKey
+        {
+            std::vector<VkDescriptorSetLayout> setLayouts;
+            std::vector<VkPushConstantRange> pushConstants;
+
+            auto operator==(const PipelineKey& other) const -> bool;
+        };
+
+        struct PipelineKeyHash
+        {
+            auto operator()(const PipelineKey& key) const -> type::size;
+        };
+
+        const vkc::Device& m_device;
+
+        mutable std::mutex m_mutex;
+        std::unordered_map<Key, VkDescriptorSetLayout, KeyHash> m_layouts;
+        // Points into the keys of m_layouts, whose nodes never move
+        std::unordered_map<VkDescriptorSetLayout, const std::vector<VkDescriptorSetLayoutBinding>*> m_bindings;
+        std::unordered_map<PipelineKey, VkPipelineLayout, PipelineKeyHash> m_pipelineLayouts;
+    };
+}
+
+#endif //VULKANCUBE_DESCRIPTORLAYOUTCACHE_H
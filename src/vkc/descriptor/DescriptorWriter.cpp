@@ -0,0 +1,288 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#include <cstddef>
+#include <stdexcept>
+#include "DescriptorWriter.h"
+#include "../Device.h"
+
+namespace
+{
+    // Which info a write of each descriptor type points at
+    enum class InfoKind
+    {
+        Buffer,
+        Image,
+        TexelBuffer
+    };
+
+    auto InfoOf(VkDescriptorType type) -> InfoKind
+    {
+        switch(type)
+        {
+            case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+            case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+            case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+            case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+                return InfoKind::Buffer;
+            case VK_DESCRIPTOR_TYPE_SAMPLER:
+            case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+            case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+            case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+            case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+                return InfoKind::Image;
+            case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+            case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+                return InfoKind::TexelBuffer;
+            default:
+                throw std::runtime_error("Descriptor type can't be written by buffer, image or texel buffer info");
+        }
+    }
+
+    auto InfoSize(InfoKind kind) -> type::size
+    {
+        switch(kind)
+        {
+            case InfoKind::Buffer: return sizeof(VkDescriptorBufferInfo);
+            case InfoKind::Image: return sizeof(VkDescriptorImageInfo);
+            default: return sizeof(VkBufferView);
+        }
+    }
+}
+
+vkc::DescriptorWriter::DescriptorWriter(const vkc::Device& device) : m_device(device)
+{
+}
+
+auto vkc::DescriptorWriter::writeBuffer(
+        VkDescriptorSet set,
+        type::uint32 binding,
+        VkDescriptorType type,
+        VkBuffer buffer,
+        VkDeviceSize offset,
+        VkDeviceSize range,
+        type::uint32 arrayElement
+        ) -> DescriptorWriter&
+{
+    if(InfoOf(type) != InfoKind::Buffer)
+    {
+        throw std::runtime_error("Descriptor type isn't written with a buffer");
+    }
+    VkDescriptorBufferInfo bufferInfo = {};
+    bufferInfo.buffer = buffer;
+    bufferInfo.offset = offset;
+    bufferInfo.range = range;
+    m_infoIndices.push_back(m_bufferInfos.size());
+    m_bufferInfos.push_back(bufferInfo);
+
+    VkWriteDescriptorSet write = {};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = set;
+    write.dstBinding = binding;
+    write.dstArrayElement = arrayElement;
+    write.descriptorType = type;
+    write.descriptorCount = 1;
+    m_writes.push_back(write);
+    return *this;
+}
+
+auto vkc::DescriptorWriter::writeImage(
+        VkDescriptorSet set,
+        type::uint32 binding,
+        VkDescriptorType type,
+        VkImageView view,
+        VkSampler sampler,
+        VkImageLayout layout,
+        type::uint32 arrayElement
+        ) -> DescriptorWriter&
+{
+    if(InfoOf(type) != InfoKind::Image)
+    {
+        throw std::runtime_error("Descriptor type isn't written with an image");
+    }
+    VkDescriptorImageInfo imageInfo = {};
+    imageInfo.sampler = sampler;
+    imageInfo.imageView = view;
+    imageInfo.imageLayout = layout;
+    m_infoIndices.push_back(m_imageInfos.size());
+    m_imageInfos.push_back(imageInfo);
+
+    VkWriteDescriptorSet write = {};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = set;
+    write.dstBinding = binding;
+    write.dstArrayElement = arrayElement;
+    write.descriptorType = type;
+    write.descriptorCount = 1;
+    m_writes.push_back(write);
+    return *this;
+}
+
+auto vkc::DescriptorWriter::writeTexelBuffer(
+        VkDescriptorSet set,
+        type::uint32 binding,
+        VkDescriptorType type,
+        VkBufferView view,
+        type::uint32 arrayElement
+        ) -> DescriptorWriter&
+{
+    if(InfoOf(type) != InfoKind::TexelBuffer)
+    {
+        throw std::runtime_error("Descriptor type isn't written with a texel buffer view");
+    }
+    m_infoIndices.push_back(m_texelViews.size());
+    m_texelViews.push_back(view);
+
+    VkWriteDescriptorSet write = {};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = set;
+    write.dstBinding = binding;
+    write.dstArrayElement = arrayElement;
+    write.descriptorType = type;
+    write.descriptorCount = 1;
+    m_writes.push_back(write);
+    return *this;
+}
+
+auto vkc::DescriptorWriter::flush() -> void
+{
+    if(m_writes.empty())
+    {
+        return;
+    }
+
+    for(type::size i = 0; i < m_writes.size(); ++i)
+    {
+        VkWriteDescriptorSet& write = m_writes[i];
+        switch(InfoOf(write.descriptorType))
+        {
+            case InfoKind::Buffer: write.pBufferInfo = &m_bufferInfos[m_infoIndices[i]]; break;
+            case InfoKind::Image: write.pImageInfo = &m_imageInfos[m_infoIndices[i]]; break;
+            case InfoKind::TexelBuffer: write.pTexelBufferView = &m_texelViews[m_infoIndices[i]]; break;
+        }
+    }
+    m_device.vk().UpdateDescriptorSets(m_device.logical(), static_cast<type::uint32>(m_writes.size()), m_writes.data(), 0, nullptr);
+
+    m_writes.clear();
+    m_infoIndices.clear();
+    m_bufferInfos.clear();
+    m_imageInfos.clear();
+    m_texelViews.clear();
+}
+
+vkc::DescriptorUpdateTemplate::DescriptorUpdateTemplate(
+        const vkc::Device& device,
+        VkDescriptorSetLayout layout,
+        std::vector<Entry> entries
+        ) :
+        m_device(device),
+        m_entries(std::move(entries)),
+        m_template(VK_NULL_HANDLE)
+{
+    for(Entry& entry : m_entries)
+    {
+        // Also rejects types neither path can write
+        InfoKind kind = InfoOf(entry.type);
+        if(entry.stride == 0)
+        {
+            entry.stride = InfoSize(kind);
+        }
+    }
+
+    if(!Supported(m_device))
+    {
+        return;
+    }
+
+    std::vector<VkDescriptorUpdateTemplateEntry> templateEntries;
+    templateEntries.reserve(m_entries.size());
+    for(const Entry& entry : m_entries)
+    {
+        VkDescriptorUpdateTemplateEntry templateEntry = {};
+        templateEntry.dstBinding = entry.binding;
+        templateEntry.dstArrayElement = 0;
+        templateEntry.descriptorCount = entry.count;
+        templateEntry.descriptorType = entry.type;
+        templateEntry.offset = entry.offset;
+        templateEntry.stride = entry.stride;
+        templateEntries.push_back(templateEntry);
+    }
+
+    VkDescriptorUpdateTemplateCreateInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+    info.descriptorUpdateEntryCount = static_cast<type::uint32>(templateEntries.size());
+    info.pDescriptorUpdateEntries = templateEntries.data();
+    info.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+    info.descriptorSetLayout = layout;
+
+    if(m_device.vk().CreateDescriptorUpdateTemplate(m_device.logical(), &info, m_device.allocator(), &m_template) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Descriptor Update Template creation failed");
+    }
+}
+
+vkc::DescriptorUpdateTemplate::~DescriptorUpdateTemplate()
+{
+    if(m_template != VK_NULL_HANDLE)
+    {
+        m_device.vk().DestroyDescriptorUpdateTemplate(m_device.logical(), m_template, m_device.allocator());
+    }
+}
+
+auto vkc::DescriptorUpdateTemplate::update(VkDescriptorSet set, const void* data) const -> void
+{
+    if(m_template != VK_NULL_HANDLE)
+    {
+        // The driver reads the descriptors straight out of data
+        m_device.vk().UpdateDescriptorSetWithTemplate(m_device.logical(), set, m_template, data);
+    }
+    else
+    {
+        updateWithWrites(set, data);
+    }
+}
+
+auto vkc::DescriptorUpdateTemplate::Supported(const vkc::Device& device) -> bool
+{
+    // Left null by the dispatch table on devices older than 1.1
+    return device.vk().UpdateDescriptorSetWithTemplate != nullptr;
+}
+
+auto vkc::DescriptorUpdateTemplate::updateWithWrites(VkDescriptorSet set, const void* data) const -> void
+{
+    const auto* bytes = static_cast<const std::byte*>(data);
+    // Strided arrays can't be passed to a write directly, so each element gets its own write
+    type::size writeCount = 0;
+    for(const Entry& entry : m_entries)
+    {
+        writeCount += entry.count;
+    }
+
+    std::vector<VkWriteDescriptorSet> writes;
+    writes.reserve(writeCount);
+    for(const Entry& entry : m_entries)
+    {
+        for(type::uint32 element = 0; element < entry.count; ++element)
+        {
+            const std::byte* info = bytes + entry.offset + element * entry.stride;
+
+            VkWriteDescriptorSet write = {};
+            write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.dstSet = set;
+            write.dstBinding = entry.binding;
+            write.dstArrayElement = element;
+            write.descriptorType = entry.type;
+            write.descriptorCount = 1;
+            switch(InfoOf(entry.type))
+            {
+                case InfoKind::Buffer: write.pBufferInfo = reinterpret_cast<const VkDescriptorBufferInfo*>(info); break;
+                case InfoKind::Image: write.pImageInfo = reinterpret_cast<const VkDescriptorImageInfo*>(info); break;
+                case InfoKind::TexelBuffer: write.pTexelBufferView = reinterpret_cast<const VkBufferView*>(info); break;
+            }
+            writes.push_back(write);
+        }
+    }
+    m_device.vk().UpdateDescriptorSets(m_device.logical(), static_cast<type::uint32>(writes.size()), writes.data(), 0, nullptr);
+}
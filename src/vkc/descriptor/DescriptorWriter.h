@@ -0,0 +1,107 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#ifndef VULKANCUBE_DESCRIPTORWRITER_H
+#define VULKANCUBE_DESCRIPTORWRITER_H
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include "../NonCopyable.h"
+#include "../Types.h"
+
+namespace vkc
+{
+    class Device;
+    // Collects descriptor writes, for any number of sets, and applies them with a single vkUpdateDescriptorSets
+    class DescriptorWriter : public NonCopyable
+    {
+    public:
+        explicit DescriptorWriter(const vkc::Device& device);
+
+        auto writeBuffer(
+                VkDescriptorSet set,
+                type::uint32 binding,
+                VkDescriptorType type,
+                VkBuffer buffer,
+                VkDeviceSize offset,
+                VkDeviceSize range,
+                type::uint32 arrayElement = 0
+                ) -> DescriptorWriter&;
+        auto writeImage(
+                VkDescriptorSet set,
+                type::uint32 binding,
+                VkDescriptorType type,
+                VkImageView view,
+                VkSampler sampler,
+                VkImageLayout layout,
+                type::uint32 arrayElement = 0
+                ) -> DescriptorWriter&;
+        // Uniform and storage texel buffers
+        auto writeTexelBuffer(
+                VkDescriptorSet set,
+                type::uint32 binding,
+                VkDescriptorType type,
+                VkBufferView view,
+                type::uint32 arrayElement = 0
+                ) -> DescriptorWriter&;
+
+        // Applies and clears every queued write
+        auto flush() -> void;
+
+        [[nodiscard]]
+        inline auto pending() const -> type::size { return m_writes.size(); }
+
+    private:
+        const vkc::Device& m_device;
+
+        // Infos are referenced by index until flush, since the vectors may reallocate
+        std::vector<VkWriteDescriptorSet> m_writes;
+        std::vector<type::size> m_infoIndices;
+        std::vector<VkDescriptorBufferInfo> m_bufferInfos;
+        std::vector<VkDescriptorImageInfo> m_imageInfos;
+        std::vector<VkBufferView> m_texelViews;
+    };
+
+    // Writes every binding of a set from one packed struct with vkUpdateDescriptorSetWithTemplate
+    // Each entry names the offset of a VkDescriptorBufferInfo, VkDescriptorImageInfo or, for texel buffers,
+    // a VkBufferView in the struct. Throws for descriptor types that are written with none of them
+    // Devices without Vulkan 1.1 fall back to building the equivalent writes from the same struct
+    class DescriptorUpdateTemplate : public NonCopyable
+    {
+    public:
+        struct Entry
+        {
+            type::uint32 binding;
+            VkDescriptorType type;
+            type::size offset;
+            type::uint32 count = 1;
+            // Distance between array elements, defaults to the size of the info type
+            type::size stride = 0;
+        };
+
+        DescriptorUpdateTemplate(const vkc::Device& device, VkDescriptorSetLayout layout, std::vector<Entry> entries);
+        ~DescriptorUpdateTemplate();
+
+        auto update(VkDescriptorSet set, const void* data) const -> void;
+
+        template<typename T>
+        inline auto update(VkDescriptorSet set, const T& data) const -> void { update(set, static_cast<const void*>(&data)); }
+
+        [[nodiscard]]
+        inline auto native() const -> bool { return m_template != VK_NULL_HANDLE; }
+
+        // Whether the device can use descriptor update templates
+        static auto Supported(const vkc::Device& device) -> bool;
+
+    private:
+        const vkc::Device& m_device;
+        std::vector<Entry> m_entries;
+        VkDescriptorUpdateTemplate m_template;
+
+        auto updateWithWrites(VkDescriptorSet set, const void* data) const -> void;
+    };
+}
+
+#endif //VULKANCUBE_DESCRIPTORWRITER_H
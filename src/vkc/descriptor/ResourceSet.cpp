@@ -0,0 +1,189 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#include <stdexcept>
+#include "ResourceSet.h"
+#include "DescriptorAllocator.h"
+#include "DescriptorLayoutCache.h"
+#include "DescriptorWriter.h"
+#include "../Device.h"
+
+vkc::ResourceSetBuilder::ResourceSetBuilder(UpdateFrequency frequency) : m_frequency(frequency), m_dynamic(false)
+{
+}
+
+auto vkc::ResourceSetBuilder::uniformBuffer(type::uint32 binding, VkShaderStageFlags stages, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range) -> ResourceSetBuilder&
+{
+    return add(binding, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, stages, {buffer, offset, range, VK_NULL_HANDLE, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_UNDEFINED});
+}
+
+auto vkc::ResourceSetBuilder::dynamicUniformBuffer(type::uint32 binding, VkShaderStageFlags stages, VkBuffer buffer, VkDeviceSize range) -> ResourceSetBuilder&
+{
+    if(m_dynamic)
+    {
+        throw std::runtime_error("Resource set already has a dynamic uniform buffer");
+    }
+    m_dynamic = true;
+    return add(binding, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, stages, {buffer, 0, range, VK_NULL_HANDLE, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_UNDEFINED});
+}
+
+auto vkc::ResourceSetBuilder::storageBuffer(type::uint32 binding, VkShaderStageFlags stages, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range) -> ResourceSetBuilder&
+{
+    return add(binding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, stages, {buffer, offset, range, VK_NULL_HANDLE, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_UNDEFINED});
+}
+
+auto vkc::ResourceSetBuilder::combinedImageSampler(type::uint32 binding, VkShaderStageFlags stages, VkImageView view, VkSampler sampler) -> ResourceSetBuilder&
+{
+    return add(binding, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, stages, {VK_NULL_HANDLE, 0, 0, view, sampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL});
+}
+
+auto vkc::ResourceSetBuilder::sampledImage(type::uint32 binding, VkShaderStageFlags stages, VkImageView view) -> ResourceSetBuilder&
+{
+    return add(binding, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, stages, {VK_NULL_HANDLE, 0, 0, view, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL});
+}
+
+auto vkc::ResourceSetBuilder::storageImage(type::uint32 binding, VkShaderStageFlags stages, VkImageView view) -> ResourceSetBuilder&
+{
+    return add(binding, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, stages, {VK_NULL_HANDLE, 0, 0, view, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_GENERAL});
+}
+
+auto vkc::ResourceSetBuilder::sampler(type::uint32 binding, VkShaderStageFlags stages, VkSampler sampler) -> ResourceSetBuilder&
+{
+    return add(binding, VK_DESCRIPTOR_TYPE_SAMPLER, stages, {VK_NULL_HANDLE, 0, 0, VK_NULL_HANDLE, sampler, VK_IMAGE_LAYOUT_UNDEFINED});
+}
+
+auto vkc::ResourceSetBuilder::layout(vkc::DescriptorLayoutCache& cache) const -> VkDescriptorSetLayout
+{
+    return cache.get(m_bindings);
+}
+
+auto vkc::ResourceSetBuilder::build(vkc::DescriptorAllocator& allocator, vkc::DescriptorWriter& writer) const -> vkc::ResourceSet
+{
+    VkDescriptorSetLayout setLayout = layout(allocator.layouts());
+    vkc::ResourceSet set = {m_frequency, setLayout, allocator.allocate(setLayout), m_dynamic};
+    write(set, writer);
+    return set;
+}
+
+auto vkc::ResourceSetBuilder::buildTransient(vkc::DescriptorAllocator& allocator, type::uint32 frameIndex, vkc::DescriptorWriter& writer) const -> vkc::ResourceSet
+{
+    VkDescriptorSetLayout setLayout = layout(allocator.layouts());
+    vkc::ResourceSet set = {m_frequency, setLayout, allocator.allocateTransient(frameIndex, setLayout), m_dynamic};
+    write(set, writer);
+    return set;
+}
+
+auto vkc::ResourceSetBuilder::write(const vkc::ResourceSet& set, vkc::DescriptorWriter& writer) const -> void
+{
+    for(type::size i = 0; i < m_bindings.size(); ++i)
+    {
+        const VkDescriptorSetLayoutBinding& binding = m_bindings[i];
+        const Resource& resource = m_resources[i];
+        // By type rather than by which handle is set, a null handle is written as what the binding is
+        switch(binding.descriptorType)
+        {
+            case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+            case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+            case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+            case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+                writer.writeBuffer(set.set, binding.binding, binding.descriptorType, resource.buffer, resource.offset, resource.range);
+                break;
+            case VK_DESCRIPTOR_TYPE_SAMPLER:
+            case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+            case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+            case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+                writer.writeImage(set.set, binding.binding, binding.descriptorType, resource.view, resource.sampler, resource.imageLayout);
+                break;
+            default:
+                throw std::runtime_error("Resource set binding has a descriptor type the builder can't write");
+        }
+    }
+}
+
+auto vkc::ResourceSetBuilder::add(type::uint32 binding, VkDescriptorType type, VkShaderStageFlags stages, const Resource& resource) -> ResourceSetBuilder&
+{
+    VkDescriptorSetLayoutBinding layoutBinding = {};
+    layoutBinding.binding = binding;
+    layoutBinding.descriptorType = type;
+    layoutBinding.descriptorCount = 1;
+    layoutBinding.stageFlags = stages;
+    layoutBinding.pImmutableSamplers = nullptr;
+    m_bindings.push_back(layoutBinding);
+    m_resources.push_back(resource);
+    return *this;
+}
+
+vkc::ResourceBinder::ResourceBinder(const vkc::Device& device, VkPipelineBindPoint bindPoint) :
+        m_device(device),
+        m_bindPoint(bindPoint),
+        m_cmd(VK_NULL_HANDLE),
+        m_layout(VK_NULL_HANDLE),
+        m_bound(),
+        m_pending(),
+        m_bindCalls(0),
+        m_setsBound(0)
+{
+}
+
+auto vkc::ResourceBinder::begin(VkCommandBuffer cmd) -> void
+{
+    m_cmd = cmd;
+    m_layout = VK_NULL_HANDLE;
+    m_bound = {};
+    m_pending = {};
+}
+
+auto vkc::ResourceBinder::setLayout(VkPipelineLayout layout) -> void
+{
+    if(layout != m_layout)
+    {
+        m_layout = layout;
+        m_bound = {};
+    }
+}
+
+auto vkc::ResourceBinder::bind(const vkc::ResourceSet& set, type::uint32 dynamicOffset) -> void
+{
+    Slot& slot = m_pending[set.index()];
+    slot.set = set.set;
+    slot.dynamic = set.dynamic;
+    slot.dynamicOffset = set.dynamic ? dynamicOffset : 0;
+}
+
+auto vkc::ResourceBinder::flush() -> void
+{
+    std::array<VkDescriptorSet, NumUpdateFrequencies> sets = {};
+    std::array<type::uint32, NumUpdateFrequencies> offsets = {};
+
+    type::uint32 index = 0;
+    while(index < NumUpdateFrequencies)
+    {
+        if(m_pending[index].set == VK_NULL_HANDLE || m_pending[index] == m_bound[index])
+        {
+            ++index;
+            continue;
+        }
+
+        // Gather the run of changed sets starting here
+        type::uint32 first = index;
+        type::uint32 setCount = 0;
+        type::uint32 offsetCount = 0;
+        while(index < NumUpdateFrequencies && m_pending[index].set != VK_NULL_HANDLE && !(m_pending[index] == m_bound[index]))
+        {
+            const Slot& slot = m_pending[index];
+            sets[setCount++] = slot.set;
+            if(slot.dynamic)
+            {
+                offsets[offsetCount++] = slot.dynamicOffset;
+            }
+            m_bound[index] = slot;
+            ++index;
+        }
+
+        m_device.vk().CmdBindDescriptorSets(m_cmd, m_bindPoint, m_layout, first, setCount, sets.data(), offsetCount, offsets.data());
+        ++m_bindCalls;
+        m_setsBound += setCount;
+    }
+}
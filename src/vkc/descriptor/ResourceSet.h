@@ -0,0 +1,136 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#ifndef VULKANCUBE_RESOURCESET_H
+#define VULKANCUBE_RESOURCESET_H
+
+#include <vulkan/vulkan.h>
+#include <array>
+#include <vector>
+#include "../NonCopyable.h"
+#include "../Types.h"
+
+namespace vkc
+{
+    class Device;
+    class DescriptorAllocator;
+    class DescriptorLayoutCache;
+    class DescriptorWriter;
+
+    // How often the resources of a set change. Doubles as the set index in pipeline layouts,
+    // so resources that change less often are bound at lower indices and stay bound longer
+    enum class UpdateFrequency : type::uint32
+    {
+        Frame = 0,
+        Material = 1,
+        Draw = 2
+    };
+    constexpr type::uint32 NumUpdateFrequencies = 3;
+
+    // A descriptor set and the layout it was allocated with. The set is owned by the allocator
+    struct ResourceSet
+    {
+        UpdateFrequency frequency;
+        VkDescriptorSetLayout layout;
+        VkDescriptorSet set;
+        // Whether the set has a dynamic uniform buffer, whose offset is given when it's bound
+        bool dynamic;
+
+        [[nodiscard]]
+        inline auto index() const -> type::uint32 { return static_cast<type::uint32>(frequency); }
+    };
+
+    // Combines buffers, images and samplers into a single descriptor set
+    // Sets built from the same bindings share one layout through the layout cache
+    class ResourceSetBuilder
+    {
+    public:
+        explicit ResourceSetBuilder(UpdateFrequency frequency);
+
+        auto uniformBuffer(type::uint32 binding, VkShaderStageFlags stages, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range) -> ResourceSetBuilder&;
+        // Offset is given at bind time, for many objects sharing one set over a large buffer
+        // Only one per set
+        auto dynamicUniformBuffer(type::uint32 binding, VkShaderStageFlags stages, VkBuffer buffer, VkDeviceSize range) -> ResourceSetBuilder&;
+        auto storageBuffer(type::uint32 binding, VkShaderStageFlags stages, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range) -> ResourceSetBuilder&;
+        auto combinedImageSampler(type::uint32 binding, VkShaderStageFlags stages, VkImageView view, VkSampler sampler) -> ResourceSetBuilder&;
+        auto sampledImage(type::uint32 binding, VkShaderStageFlags stages, VkImageView view) -> ResourceSetBuilder&;
+        auto storageImage(type::uint32 binding, VkShaderStageFlags stages, VkImageView view) -> ResourceSetBuilder&;
+        auto sampler(type::uint32 binding, VkShaderStageFlags stages, VkSampler sampler) -> ResourceSetBuilder&;
+
+        // Layout of the set, for pipeline layouts that are created before any set
+        auto layout(vkc::DescriptorLayoutCache& cache) const -> VkDescriptorSetLayout;
+
+        // Persistent set, writes are queued on writer and applied on its next flush
+        auto build(vkc::DescriptorAllocator& allocator, vkc::DescriptorWriter& writer) const -> vkc::ResourceSet;
+        // Set that is only valid for the frame in flight
+        auto buildTransient(vkc::DescriptorAllocator& allocator, type::uint32 frameIndex, vkc::DescriptorWriter& writer) const -> vkc::ResourceSet;
+        // Points an existing set with the same layout at this builder's resources
+        auto write(const vkc::ResourceSet& set, vkc::DescriptorWriter& writer) const -> void;
+
+    private:
+        struct Resource
+        {
+            VkBuffer buffer;
+            VkDeviceSize offset;
+            VkDeviceSize range;
+            VkImageView view;
+            VkSampler sampler;
+            VkImageLayout imageLayout;
+        };
+
+        UpdateFrequency m_frequency;
+        bool m_dynamic;
+        std::vector<VkDescriptorSetLayoutBinding> m_bindings;
+        std::vector<Resource> m_resources;
+
+        auto add(type::uint32 binding, VkDescriptorType type, VkShaderStageFlags stages, const Resource& resource) -> ResourceSetBuilder&;
+    };
+
+    // Tracks the sets bound to a command buffer so only the ones that changed are rebound
+    // Consecutive changed sets are bound with a single vkCmdBindDescriptorSets
+    class ResourceBinder : public NonCopyable
+    {
+    public:
+        ResourceBinder(const vkc::Device& device, VkPipelineBindPoint bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS);
+
+        // Forgets what is bound, for a new command buffer
+        auto begin(VkCommandBuffer cmd) -> void;
+        // A different pipeline layout invalidates every bound set
+        auto setLayout(VkPipelineLayout layout) -> void;
+        // Queues a set to be bound at its frequency's index. Nothing is recorded until flush
+        auto bind(const vkc::ResourceSet& set, type::uint32 dynamicOffset = 0) -> void;
+        // Records the binds needed before a draw
+        auto flush() -> void;
+
+        // vkCmdBindDescriptorSets calls recorded, and sets bound by them
+        [[nodiscard]]
+        inline auto bindCalls() const -> type::uint64 { return m_bindCalls; }
+        [[nodiscard]]
+        inline auto setsBound() const -> type::uint64 { return m_setsBound; }
+
+    private:
+        struct Slot
+        {
+            VkDescriptorSet set = VK_NULL_HANDLE;
+            bool dynamic = false;
+            type::uint32 dynamicOffset = 0;
+
+            auto operator==(const Slot& other) const -> bool = default;
+        };
+
+        const vkc::Device& m_device;
+        VkPipelineBindPoint m_bindPoint;
+        VkCommandBuffer m_cmd;
+        VkPipelineLayout m_layout;
+
+        std::array<Slot, NumUpdateFrequencies> m_bound;
+        std::array<Slot, NumUpdateFrequencies> m_pending;
+
+        type::uint64 m_bindCalls;
+        type::uint64 m_setsBound;
+    };
+}
+
+#endif //VULKANCUBE_RESOURCESET_H
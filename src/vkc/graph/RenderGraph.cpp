@@ -0,0 +1,730 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+#include "RenderGraph.h"
+#include "../Device.h"
+#include "../profile/Profiler.h"
+
+namespace
+{
+    constexpr type::uint32 None = type::uint32_max;
+
+    // What an image usage needs from the image and from barriers around it
+    struct UsageState
+    {
+        VkImageLayout layout;
+        VkPipelineStageFlags2 stages;
+        VkAccessFlags2 readAccess;
+        VkAccessFlags2 writeAccess;
+        VkImageUsageFlags imageUsage;
+    };
+
+    // Only flags that also exist in the original synchronization API are used,
+    // so barriers can be recorded with vkCmdPipelineBarrier when synchronization2 is unavailable
+    auto GetUsageState(vkc::ImageUsage usage, bool write) -> UsageState
+    {
+        constexpr VkPipelineStageFlags2 shaderStages = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+        switch(usage)
+        {
+            case vkc::ImageUsage::ColorAttachment:
+                return {VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                        VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+                        VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT,
+                        VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+                        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT};
+            case vkc::ImageUsage::DepthAttachment:
+                return {write ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+                        VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+                        VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT,
+                        VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT};
+            case vkc::ImageUsage::Sampled:
+                return {VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                        shaderStages,
+                        VK_ACCESS_2_SHADER_READ_BIT,
+                        VK_ACCESS_2_NONE,
+                        VK_IMAGE_USAGE_SAMPLED_BIT};
+            case vkc::ImageUsage::Storage:
+                return {VK_IMAGE_LAYOUT_GENERAL,
+                        shaderStages,
+                        VK_ACCESS_2_SHADER_READ_BIT,
+                        VK_ACCESS_2_SHADER_WRITE_BIT,
+                        VK_IMAGE_USAGE_STORAGE_BIT};
+            case vkc::ImageUsage::TransferSrc:
+                return {VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                        VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                        VK_ACCESS_2_TRANSFER_READ_BIT,
+                        VK_ACCESS_2_NONE,
+                        VK_IMAGE_USAGE_TRANSFER_SRC_BIT};
+            case vkc::ImageUsage::TransferDst:
+                return {VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                        VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                        VK_ACCESS_2_NONE,
+                        VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                        VK_IMAGE_USAGE_TRANSFER_DST_BIT};
+        }
+        throw std::runtime_error("Unknown render graph image usage");
+    }
+}
+
+vkc::RenderGraph::PassBuilder::PassBuilder(vkc::RenderGraph& graph, type::uint32 pass) :
+        m_graph(graph),
+        m_pass(pass)
+{
+}
+
+auto vkc::RenderGraph::PassBuilder::read(Resource resource, ImageUsage usage) -> void
+{
+    if(usage == ImageUsage::TransferDst)
+    {
+        throw std::runtime_error("Render graph transfer destinations can't be read");
+    }
+    m_graph.m_passes[m_pass].accesses.push_back({resource, usage, false});
+    m_graph.m_versions[resource].readers.push_back(m_pass);
+}
+
+auto vkc::RenderGraph::PassBuilder::write(Resource resource, ImageUsage usage) -> Resource
+{
+    if(usage == ImageUsage::Sampled || usage == ImageUsage::TransferSrc)
+    {
+        throw std::runtime_error("Render graph sampled images and transfer sources can't be written");
+    }
+    // Two passes writing over the same version would leave their order undefined
+    if(m_graph.m_versions[resource].next != None)
+    {
+        throw std::runtime_error("Render graph image version is already written by " + m_graph.m_passes[m_graph.m_versions[m_graph.m_versions[resource].next].producer].name);
+    }
+    m_graph.m_passes[m_pass].accesses.push_back({resource, usage, true});
+
+    Resource next = static_cast<Resource>(m_graph.m_versions.size());
+    m_graph.m_versions.push_back({m_graph.m_versions[resource].image, m_pass, {}, None});
+    m_graph.m_versions[resource].next = next;
+    return next;
+}
+
+auto vkc::RenderGraph::PassBuilder::sideEffect() -> void
+{
+    m_graph.m_passes[m_pass].sideEffect = true;
+}
+
+vkc::RenderGraph::RenderGraph(const vkc::Device& device) :
+        m_device(device),
+        m_finalBarrier(0),
+        m_unaliasedMemory(0),
+        m_compiled(false)
+{
+}
+
+vkc::RenderGraph::~RenderGraph()
+{
+    destroyTransients();
+}
+
+auto vkc::RenderGraph::createImage(std::string name, const ImageDesc& desc) -> Resource
+{
+    ImageNode node = {};
+    node.name = std::move(name);
+    node.desc = desc;
+    node.imported = false;
+    m_images.push_back(node);
+
+    m_versions.push_back({static_cast<type::uint32>(m_images.size() - 1), None, {}, None});
+    m_compiled = false;
+    return static_cast<Resource>(m_versions.size() - 1);
+}
+
+auto vkc::RenderGraph::importImage(std::string name, const ImportDesc& desc) -> Resource
+{
+    ImageNode node = {};
+    node.name = std::move(name);
+    node.desc = {desc.format, desc.extent, desc.aspect, VK_SAMPLE_COUNT_1_BIT};
+    node.imported = true;
+    node.import = desc;
+    m_images.push_back(node);
+
+    m_versions.push_back({static_cast<type::uint32>(m_images.size() - 1), None, {}, None});
+    m_compiled = false;
+    return static_cast<Resource>(m_versions.size() - 1);
+}
+
+auto vkc::RenderGraph::setImported(Resource resource, VkImage image, VkImageView view) -> void
+{
+    ImageNode& node = m_images[m_versions[resource].image];
+    if(!node.imported)
+    {
+        throw std::runtime_error("Render graph image " + node.name + " isn't imported");
+    }
+    node.image = image;
+    node.view = view;
+}
+
+auto vkc::RenderGraph::addPass(std::string name, const std::function<void(PassBuilder&)>& setup, ExecuteFunc execute) -> void
+{
+    Pass pass = {};
+    pass.name = std::move(name);
+    pass.execute = std::move(execute);
+    m_passes.push_back(std::move(pass));
+
+    PassBuilder builder(*this, static_cast<type::uint32>(m_passes.size() - 1));
+    setup(builder);
+    m_compiled = false;
+}
+
+auto vkc::RenderGraph::compile() -> void
+{
+    VKC_ZONE("RenderGraph::compile");
+
+    destroyTransients();
+    m_order.clear();
+    m_barriers.clear();
+    m_unaliasedMemory = 0;
+
+    cull();
+    sort();
+
+    // Lifetimes and usage only count passes that will run
+    for(ImageNode& node : m_images)
+    {
+        node.usage = 0;
+        node.firstUse = None;
+        node.lastUse = None;
+    }
+    for(type::uint32 position = 0; position < m_order.size(); ++position)
+    {
+        for(const Access& access : m_passes[m_order[position]].accesses)
+        {
+            ImageNode& node = m_images[m_versions[access.resource].image];
+            node.usage |= GetUsageState(access.usage, access.write).imageUsage;
+            node.firstUse = std::min(node.firstUse, position);
+            node.lastUse = node.lastUse == None ? position : std::max(node.lastUse, position);
+        }
+    }
+
+    allocateTransients();
+    planBarriers();
+    m_compiled = true;
+}
+
+auto vkc::RenderGraph::execute(VkCommandBuffer cmd) const -> void
+{
+    if(!m_compiled)
+    {
+        throw std::runtime_error("Render graph executed before being compiled");
+    }
+
+    for(type::uint32 index : m_order)
+    {
+        const Pass& pass = m_passes[index];
+        recordBarriers(cmd, pass.firstBarrier, pass.barrierCount);
+        pass.execute(cmd, *this);
+    }
+    recordBarriers(cmd, m_finalBarrier, static_cast<type::uint32>(m_barriers.size()) - m_finalBarrier);
+}
+
+auto vkc::RenderGraph::clear() -> void
+{
+    destroyTransients();
+    m_images.clear();
+    m_versions.clear();
+    m_passes.clear();
+    m_order.clear();
+    m_barriers.clear();
+    m_finalBarrier = 0;
+    m_unaliasedMemory = 0;
+    m_compiled = false;
+}
+
+auto vkc::RenderGraph::image(Resource resource) const -> VkImage
+{
+    return m_images[m_versions[resource].image].image;
+}
+
+auto vkc::RenderGraph::imageView(Resource resource) const -> VkImageView
+{
+    return m_images[m_versions[resource].image].view;
+}
+
+auto vkc::RenderGraph::desc(Resource resource) const -> const ImageDesc&
+{
+    return m_images[m_versions[resource].image].desc;
+}
+
+auto vkc::RenderGraph::barrierBatches() const -> type::size
+{
+    type::size batches = m_finalBarrier < m_barriers.size() ? 1 : 0;
+    for(type::uint32 index : m_order)
+    {
+        batches += m_passes[index].barrierCount > 0 ? 1 : 0;
+    }
+    return batches;
+}
+
+auto vkc::RenderGraph::transientMemory() const -> VkDeviceSize
+{
+    VkDeviceSize size = 0;
+    for(const MemoryBlock& block : m_blocks)
+    {
+        size += block.size;
+    }
+    return size;
+}
+
+auto vkc::RenderGraph::cull() -> void
+{
+    // Passes are kept if they have side effects or write what the frame leaves behind in imported images
+    std::vector<type::uint32> work;
+    for(type::uint32 i = 0; i < m_passes.size(); ++i)
+    {
+        m_passes[i].live = m_passes[i].sideEffect;
+        if(m_passes[i].live)
+        {
+            work.push_back(i);
+        }
+    }
+    for(const Version& version : m_versions)
+    {
+        if(m_images[version.image].imported && version.next == None && version.producer != None && !m_passes[version.producer].live)
+        {
+            m_passes[version.producer].live = true;
+            work.push_back(version.producer);
+        }
+    }
+
+    // Then whatever produced the versions those passes read or write over
+    while(!work.empty())
+    {
+        type::uint32 index = work.back();
+        work.pop_back();
+        for(const Access& access : m_passes[index].accesses)
+        {
+            type::uint32 producer = m_versions[access.resource].producer;
+            if(producer != None && !m_passes[producer].live)
+            {
+                m_passes[producer].live = true;
+                work.push_back(producer);
+            }
+        }
+    }
+}
+
+auto vkc::RenderGraph::sort() -> void
+{
+    // A version's producer runs before its readers, and they all run before the version is written over
+    std::vector<std::vector<type::uint32>> edges(m_passes.size());
+    std::vector<type::uint32> inDegree(m_passes.size(), 0);
+    auto addEdge = [&](type::uint32 from, type::uint32 to)
+    {
+        if(from != None && to != None && from != to && m_passes[from].live && m_passes[to].live)
+        {
+            edges[from].push_back(to);
+            ++inDegree[to];
+        }
+    };
+    for(const Version& version : m_versions)
+    {
+        type::uint32 overwriter = version.next != None ? m_versions[version.next].producer : None;
+        for(type::uint32 reader : version.readers)
+        {
+            addEdge(version.producer, reader);
+            addEdge(reader, overwriter);
+        }
+        addEdge(version.producer, overwriter);
+    }
+
+    // Ties go to the pass added first, so independent passes keep the order they were added in
+    std::priority_queue<type::uint32, std::vector<type::uint32>, std::greater<>> ready;
+    type::size liveCount = 0;
+    for(type::uint32 i = 0; i < m_passes.size(); ++i)
+    {
+        if(m_passes[i].live)
+        {
+            ++liveCount;
+            if(inDegree[i] == 0)
+            {
+                ready.push(i);
+            }
+        }
+    }
+    while(!ready.empty())
+    {
+        type::uint32 index = ready.top();
+        ready.pop();
+        m_order.push_back(index);
+        for(type::uint32 next : edges[index])
+        {
+            if(--inDegree[next] == 0)
+            {
+                ready.push(next);
+            }
+        }
+    }
+
+    if(m_order.size() != liveCount)
+    {
+        throw std::runtime_error("Render graph passes depend on each other in a cycle");
+    }
+}
+
+auto vkc::RenderGraph::allocateTransients() -> void
+{
+    const vkc::DeviceDispatch& vk = m_device.vk();
+
+    std::vector<type::uint32> transients;
+    for(type::uint32 i = 0; i < m_images.size(); ++i)
+    {
+        ImageNode& node = m_images[i];
+        node.block = None;
+        // Images no live pass uses are never created
+        if(node.imported || node.firstUse == None)
+        {
+            continue;
+        }
+
+        VkImageCreateInfo imageInfo = {};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = node.desc.format;
+        imageInfo.extent = {node.desc.extent.width, node.desc.extent.height, 1};
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = node.desc.samples;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = node.desc.lazy ? node.usage | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT : node.usage;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        if(vk.CreateImage(m_device.logical(), &imageInfo, m_device.allocator(), &node.image) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Render graph image creation failed");
+        }
+        vk.GetImageMemoryRequirements(m_device.logical(), node.image, &node.requirements);
+        m_unaliasedMemory += node.requirements.size;
+        transients.push_back(i);
+    }
+
+    // Largest first, so smaller images fill blocks that are already big enough
+    std::sort(transients.begin(), transients.end(), [this](type::uint32 a, type::uint32 b)
+    {
+        return m_images[a].requirements.size > m_images[b].requirements.size;
+    });
+
+    for(type::uint32 i : transients)
+    {
+        ImageNode& node = m_images[i];
+        for(type::uint32 b = 0; b < m_blocks.size() && node.block == None; ++b)
+        {
+            MemoryBlock& block = m_blocks[b];
+            if(block.lazy != node.desc.lazy || (block.typeBits & node.requirements.memoryTypeBits) == 0)
+            {
+                continue;
+            }
+            bool overlaps = std::any_of(block.images.begin(), block.images.end(), [&](type::uint32 other)
+            {
+                return m_images[other].firstUse <= node.lastUse && node.firstUse <= m_images[other].lastUse;
+            });
+            if(!overlaps)
+            {
+                node.block = b;
+            }
+        }
+        if(node.block == None)
+        {
+            m_blocks.push_back({VK_NULL_HANDLE, 0, node.requirements.memoryTypeBits, node.desc.lazy, {}});
+            node.block = static_cast<type::uint32>(m_blocks.size() - 1);
+        }
+
+        MemoryBlock& block = m_blocks[node.block];
+        block.size = std::max(block.size, node.requirements.size);
+        block.typeBits &= node.requirements.memoryTypeBits;
+        block.images.push_back(i);
+    }
+
+    for(MemoryBlock& block : m_blocks)
+    {
+        VkMemoryAllocateInfo allocInfo = {};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize = block.size;
+        allocInfo.memoryTypeIndex = block.lazy ?
+                m_device.findMemoryType(block.typeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT) :
+                m_device.findMemoryType(block.typeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        // Named after the images aliasing the block
+        std::string name;
+        for(type::uint32 i : block.images)
+        {
+            name += (name.empty() ? "" : ", ") + m_images[i].name;
+        }
+        if(m_device.allocateMemory(allocInfo, block.memory, vkc::MemoryCategory::Transient, std::move(name)) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Render graph memory allocation failed");
+        }
+
+        // Every image starts at the beginning of the block, so alignment is always met
+        for(type::uint32 i : block.images)
+        {
+            ImageNode& node = m_images[i];
+            vk.BindImageMemory(m_device.logical(), node.image, block.memory, 0);
+
+            VkImageViewCreateInfo viewInfo = {};
+            viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            viewInfo.image = node.image;
+            viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+            viewInfo.format = node.desc.format;
+            viewInfo.components.r =
+            viewInfo.components.g =
+            viewInfo.components.b =
+            viewInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
+            viewInfo.subresourceRange.aspectMask = node.desc.aspect;
+            viewInfo.subresourceRange.baseMipLevel = 0;
+            viewInfo.subresourceRange.levelCount = 1;
+            viewInfo.subresourceRange.baseArrayLayer = 0;
+            viewInfo.subresourceRange.layerCount = 1;
+
+            if(vk.CreateImageView(m_device.logical(), &viewInfo, m_device.allocator(), &node.view) != VK_SUCCESS)
+            {
+                throw std::runtime_error("Render graph image view creation failed");
+            }
+        }
+    }
+}
+
+auto vkc::RenderGraph::planBarriers() -> void
+{
+    // Where each image was last synchronized. Reads of the same layout don't need a barrier
+    // unless they happen in stages that haven't waited on the last write or transition yet
+    struct State
+    {
+        VkImageLayout layout;
+        VkPipelineStageFlags2 writeStages;
+        VkAccessFlags2 writeAccess;
+        VkPipelineStageFlags2 readStages;
+        VkPipelineStageFlags2 visibleStages;
+    };
+
+    std::vector<State> states(m_images.size());
+    std::vector<type::uint32> firstBarriers(m_images.size(), None);
+    for(type::uint32 i = 0; i < m_images.size(); ++i)
+    {
+        const ImageNode& node = m_images[i];
+        states[i] = {VK_IMAGE_LAYOUT_UNDEFINED, 0, 0, 0, 0};
+        if(node.imported)
+        {
+            // Whatever wrote the contents before the frame isn't known, so make all of it visible
+            bool preserved = node.import.initialLayout != VK_IMAGE_LAYOUT_UNDEFINED;
+            states[i] = {node.import.initialLayout, node.import.initialStages, preserved ? VK_ACCESS_2_MEMORY_WRITE_BIT : VK_ACCESS_2_NONE, 0, 0};
+        }
+    }
+
+    for(type::uint32 position = 0; position < m_order.size(); ++position)
+    {
+        Pass& pass = m_passes[m_order[position]];
+        pass.firstBarrier = static_cast<type::uint32>(m_barriers.size());
+
+        // A pass can access an image more than once, such as reading and writing a storage image
+        struct Use
+        {
+            type::uint32 image;
+            UsageState state;
+            bool write;
+        };
+        std::vector<Use> uses;
+        for(const Access& access : pass.accesses)
+        {
+            type::uint32 image = m_versions[access.resource].image;
+            UsageState state = GetUsageState(access.usage, access.write);
+            auto use = std::find_if(uses.begin(), uses.end(), [image](const Use& u) { return u.image == image; });
+            if(use == uses.end())
+            {
+                uses.push_back({image, state, access.write});
+                continue;
+            }
+            if(use->state.layout != state.layout)
+            {
+                throw std::runtime_error("Render graph pass " + pass.name + " uses " + m_images[image].name + " in two layouts");
+            }
+            use->state.stages |= state.stages;
+            use->state.readAccess |= state.readAccess;
+            use->state.writeAccess |= state.writeAccess;
+            use->write = use->write || access.write;
+        }
+
+        for(const Use& use : uses)
+        {
+            State& state = states[use.image];
+            const ImageNode& node = m_images[use.image];
+            VkAccessFlags2 access = use.state.readAccess | (use.write ? use.state.writeAccess : VK_ACCESS_2_NONE);
+            // Transient contents never carry over from a previous frame or from memory it aliases
+            bool discard = !node.imported && position == node.firstUse;
+
+            if(discard || state.layout != use.state.layout || use.write)
+            {
+                // Writes wait for earlier reads and writes, layout transitions for everything
+                Barrier barrier = {
+                        use.image,
+                        state.writeStages | state.readStages, state.writeAccess,
+                        use.state.stages, access,
+                        discard ? VK_IMAGE_LAYOUT_UNDEFINED : state.layout, use.state.layout
+                };
+                if(discard)
+                {
+                    firstBarriers[use.image] = static_cast<type::uint32>(m_barriers.size());
+                }
+                if(discard || barrier.srcStages != 0 || barrier.oldLayout != barrier.newLayout)
+                {
+                    m_barriers.push_back(barrier);
+                }
+                state = {use.state.layout, use.state.stages, use.write ? use.state.writeAccess : VK_ACCESS_2_NONE, 0, use.state.stages};
+            }
+            else
+            {
+                if((use.state.stages & ~state.visibleStages) != 0 && state.writeStages != 0)
+                {
+                    m_barriers.push_back({
+                            use.image,
+                            state.writeStages, state.writeAccess,
+                            use.state.stages, access,
+                            state.layout, state.layout
+                    });
+                    state.visibleStages |= use.state.stages;
+                }
+                state.readStages |= use.state.stages;
+            }
+        }
+
+        pass.barrierCount = static_cast<type::uint32>(m_barriers.size()) - pass.firstBarrier;
+    }
+
+    // The first use of a transient waits for the image that used its memory last, which for
+    // the first image in a block is the last one of the previous frame
+    for(const MemoryBlock& block : m_blocks)
+    {
+        std::vector<type::uint32> images = block.images;
+        std::sort(images.begin(), images.end(), [this](type::uint32 a, type::uint32 b)
+        {
+            return m_images[a].firstUse < m_images[b].firstUse;
+        });
+        for(type::size i = 0; i < images.size(); ++i)
+        {
+            const State& previous = states[images[(i + images.size() - 1) % images.size()]];
+            Barrier& barrier = m_barriers[firstBarriers[images[i]]];
+            barrier.srcStages = previous.writeStages | previous.readStages;
+            barrier.srcAccess = previous.writeAccess;
+        }
+    }
+
+    m_finalBarrier = static_cast<type::uint32>(m_barriers.size());
+    for(type::uint32 i = 0; i < m_images.size(); ++i)
+    {
+        const ImageNode& node = m_images[i];
+        if(!node.imported || node.firstUse == None || node.import.finalLayout == VK_IMAGE_LAYOUT_UNDEFINED)
+        {
+            continue;
+        }
+        const State& state = states[i];
+        if(state.layout != node.import.finalLayout)
+        {
+            m_barriers.push_back({
+                    i,
+                    state.writeStages | state.readStages, state.writeAccess,
+                    node.import.finalStages, VK_ACCESS_2_NONE,
+                    state.layout, node.import.finalLayout
+            });
+        }
+    }
+}
+
+auto vkc::RenderGraph::destroyTransients() -> void
+{
+    const vkc::DeviceDispatch& vk = m_device.vk();
+    for(ImageNode& node : m_images)
+    {
+        if(node.imported || node.image == VK_NULL_HANDLE)
+        {
+            continue;
+        }
+        vk.DestroyImageView(m_device.logical(), node.view, m_device.allocator());
+        vk.DestroyImage(m_device.logical(), node.image, m_device.allocator());
+        node.view = VK_NULL_HANDLE;
+        node.image = VK_NULL_HANDLE;
+    }
+    for(MemoryBlock& block : m_blocks)
+    {
+        m_device.freeMemory(block.memory);
+    }
+    m_blocks.clear();
+}
+
+auto vkc::RenderGraph::recordBarriers(VkCommandBuffer cmd, type::uint32 first, type::uint32 count) const -> void
+{
+    if(count == 0)
+    {
+        return;
+    }
+
+    // Synchronization2 is enabled along with dynamic rendering
+    if(m_device.dynamicRendering())
+    {
+        std::vector<VkImageMemoryBarrier2> barriers(count);
+        for(type::uint32 i = 0; i < count; ++i)
+        {
+            const Barrier& barrier = m_barriers[first + i];
+            const ImageNode& node = m_images[barrier.image];
+            VkImageMemoryBarrier2& imageBarrier = barriers[i];
+            imageBarrier = {};
+            imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+            imageBarrier.srcStageMask = barrier.srcStages;
+            imageBarrier.srcAccessMask = barrier.srcAccess;
+            imageBarrier.dstStageMask = barrier.dstStages;
+            imageBarrier.dstAccessMask = barrier.dstAccess;
+            imageBarrier.oldLayout = barrier.oldLayout;
+            imageBarrier.newLayout = barrier.newLayout;
+            imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            imageBarrier.image = node.image;
+            imageBarrier.subresourceRange = {node.desc.aspect, 0, 1, 0, 1};
+        }
+
+        VkDependencyInfo dependency = {};
+        dependency.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+        dependency.imageMemoryBarrierCount = count;
+        dependency.pImageMemoryBarriers = barriers.data();
+        m_device.vk().CmdPipelineBarrier2(cmd, &dependency);
+        return;
+    }
+
+    // The original API takes one pair of stage masks for the whole batch
+    VkPipelineStageFlags srcStages = 0;
+    VkPipelineStageFlags dstStages = 0;
+    std::vector<VkImageMemoryBarrier> barriers(count);
+    for(type::uint32 i = 0; i < count; ++i)
+    {
+        const Barrier& barrier = m_barriers[first + i];
+        const ImageNode& node = m_images[barrier.image];
+        srcStages |= static_cast<VkPipelineStageFlags>(barrier.srcStages);
+        dstStages |= static_cast<VkPipelineStageFlags>(barrier.dstStages);
+
+        VkImageMemoryBarrier& imageBarrier = barriers[i];
+        imageBarrier = {};
+        imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        imageBarrier.srcAccessMask = static_cast<VkAccessFlags>(barrier.srcAccess);
+        imageBarrier.dstAccessMask = static_cast<VkAccessFlags>(barrier.dstAccess);
+        imageBarrier.oldLayout = barrier.oldLayout;
+        imageBarrier.newLayout = barrier.newLayout;
+        imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imageBarrier.image = node.image;
+        imageBarrier.subresourceRange = {node.desc.aspect, 0, 1, 0, 1};
+    }
+    m_device.vk().CmdPipelineBarrier(
+            cmd,
+            srcStages != 0 ? srcStages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+            dstStages != 0 ? dstStages : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+            0, 0, nullptr, 0, nullptr, count, barriers.data()
+            );
+}
@@ -0,0 +1,216 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#ifndef VULKANCUBE_RENDERGRAPH_H
+#define VULKANCUBE_RENDERGRAPH_H
+
+#include <vulkan/vulkan.h>
+#include <functional>
+#include <string>
+#include <vector>
+#include "../NonCopyable.h"
+#include "../Types.h"
+
+namespace vkc
+{
+    class Device;
+
+    // How a pass uses an image. Decides the layout it needs and the stages and accesses barriers wait on
+    enum class ImageUsage
+    {
+        ColorAttachment,
+        // Read only depth is kept in the read only layout
+        DepthAttachment,
+        // Read by fragment or compute shaders through a sampler
+        Sampled,
+        Storage,
+        TransferSrc,
+        TransferDst
+    };
+
+    // Frame of passes that declare which images they read and write
+    // compile() culls passes whose results are never used, orders the rest by their dependencies,
+    // plans the barriers between them and places transient images with disjoint lifetimes in the same memory
+    // execute() then records each pass after a single batched barrier
+    class RenderGraph : public NonCopyable
+    {
+    public:
+        // A version of an image. Writing an image produces a new version, which readers of it depend on
+        using Resource = type::uint32;
+        using ExecuteFunc = std::function<void(VkCommandBuffer cmd, const vkc::RenderGraph& graph)>;
+
+        struct ImageDesc
+        {
+            VkFormat format;
+            VkExtent2D extent;
+            VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+            VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+            // Only used as an attachment and never stored, such as a multisample image that is resolved
+            // Placed in lazily allocated memory where the device has it, so tilers keep it in tile memory
+            bool lazy = false;
+        };
+
+        // Image owned outside the graph, whose contents outlive the frame
+        struct ImportDesc
+        {
+            VkFormat format;
+            VkExtent2D extent;
+            VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+            // Layout the image is in when the graph starts, and the stages that must finish before it's first used
+            VkImageLayout initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            VkPipelineStageFlags2 initialStages = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+            // Layout the image is left in, and the stages that wait on that transition
+            VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            VkPipelineStageFlags2 finalStages = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+        };
+
+        class PassBuilder
+        {
+        public:
+            auto read(Resource resource, ImageUsage usage) -> void;
+            // Returns the version of the image holding this pass's output
+            auto write(Resource resource, ImageUsage usage) -> Resource;
+            // Keeps the pass even if nothing uses what it writes
+            auto sideEffect() -> void;
+
+        private:
+            friend class RenderGraph;
+            PassBuilder(vkc::RenderGraph& graph, type::uint32 pass);
+
+            vkc::RenderGraph& m_graph;
+            type::uint32 m_pass;
+        };
+
+        explicit RenderGraph(const vkc::Device& device);
+        ~RenderGraph();
+
+        // Transient image. Its contents don't survive the frame, and its memory may be shared
+        auto createImage(std::string name, const ImageDesc& desc) -> Resource;
+        auto importImage(std::string name, const ImportDesc& desc) -> Resource;
+        // Image used for an imported resource by the next execute, such as the acquired swap chain image
+        auto setImported(Resource resource, VkImage image, VkImageView view) -> void;
+
+        auto addPass(std::string name, const std::function<void(PassBuilder&)>& setup, ExecuteFunc execute) -> void;
+
+        // Plans the frame and creates the transient images. Must be called again after the graph changes
+        auto compile() -> void;
+        auto execute(VkCommandBuffer cmd) const -> void;
+        // Removes every pass and image, so the graph can be rebuilt for a new extent
+        auto clear() -> void;
+
+        [[nodiscard]]
+        auto image(Resource resource) const -> VkImage;
+        [[nodiscard]]
+        auto imageView(Resource resource) const -> VkImageView;
+        [[nodiscard]]
+        auto desc(Resource resource) const -> const ImageDesc&;
+
+        // Passes that survived culling, in execution order
+        [[nodiscard]]
+        inline auto livePasses() const -> type::size { return m_order.size(); }
+        [[nodiscard]]
+        inline auto imageBarriers() const -> type::size { return m_barriers.size(); }
+        // Pipeline barrier commands recorded per execute
+        [[nodiscard]]
+        auto barrierBatches() const -> type::size;
+        // Memory of transient images after aliasing, and what it would take without
+        [[nodiscard]]
+        auto transientMemory() const -> VkDeviceSize;
+        [[nodiscard]]
+        inline auto unaliasedMemory() const -> VkDeviceSize { return m_unaliasedMemory; }
+
+    private:
+        struct ImageNode
+        {
+            std::string name;
+            ImageDesc desc;
+            bool imported;
+            ImportDesc import;
+            VkImageUsageFlags usage;
+
+            VkImage image;
+            VkImageView view;
+            // Memory block shared with other transients, or none
+            type::uint32 block;
+            VkMemoryRequirements requirements;
+            // First and last position in the execution order of the passes using it
+            type::uint32 firstUse;
+            type::uint32 lastUse;
+        };
+
+        struct Version
+        {
+            type::uint32 image;
+            // Pass that wrote this version, or none for the contents the frame starts with
+            type::uint32 producer;
+            std::vector<type::uint32> readers;
+            // Version written over this one, or none if it's the latest
+            Resource next;
+        };
+
+        struct Access
+        {
+            Resource resource;
+            ImageUsage usage;
+            bool write;
+        };
+
+        struct Pass
+        {
+            std::string name;
+            ExecuteFunc execute;
+            std::vector<Access> accesses;
+            bool sideEffect;
+            bool live;
+            // Range of m_barriers recorded before the pass
+            type::uint32 firstBarrier;
+            type::uint32 barrierCount;
+        };
+
+        struct Barrier
+        {
+            type::uint32 image;
+            VkPipelineStageFlags2 srcStages;
+            VkAccessFlags2 srcAccess;
+            VkPipelineStageFlags2 dstStages;
+            VkAccessFlags2 dstAccess;
+            VkImageLayout oldLayout;
+            VkImageLayout newLayout;
+        };
+
+        struct MemoryBlock
+        {
+            VkDeviceMemory memory;
+            VkDeviceSize size;
+            type::uint32 typeBits;
+            // Holds lazy images, which only share memory with each other
+            bool lazy;
+            std::vector<type::uint32> images;
+        };
+
+        const vkc::Device& m_device;
+
+        std::vector<ImageNode> m_images;
+        std::vector<Version> m_versions;
+        std::vector<Pass> m_passes;
+        std::vector<MemoryBlock> m_blocks;
+
+        std::vector<type::uint32> m_order;
+        std::vector<Barrier> m_barriers;
+        // Barriers moving imported images into their final layout, recorded after the last pass
+        type::uint32 m_finalBarrier;
+        VkDeviceSize m_unaliasedMemory;
+        bool m_compiled;
+
+        auto cull() -> void;
+        auto sort() -> void;
+        auto allocateTransients() -> void;
+        auto planBarriers() -> void;
+        auto destroyTransients() -> void;
+        auto recordBarriers(VkCommandBuffer cmd, type::uint32 first, type::uint32 count) const -> void;
+    };
+}
+
+#endif //VULKANCUBE_RENDERGRAPH_H
@@ -0,0 +1,92 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#include <stdexcept>
+#include "Image.h"
+#include "../Device.h"
+
+vkc::Image::Image(
+        const vkc::Device& device,
+        VkExtent2D extent,
+        VkFormat format,
+        const VkImageUsageFlags& usageFlags,
+        const VkMemoryPropertyFlags& memPropFlags,
+        VkImageAspectFlags aspect,
+        VkSampleCountFlagBits samples,
+        std::string name
+) :
+        m_image(VK_NULL_HANDLE),
+        m_memory(VK_NULL_HANDLE),
+        m_view(VK_NULL_HANDLE),
+        m_extent(extent),
+        m_format(format),
+        m_samples(samples),
+        m_device(device)
+{
+    VkImageCreateInfo imageInfo = {};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = m_format;
+    imageInfo.extent = {m_extent.width, m_extent.height, 1};
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = m_samples;
+    // Optimal tiling, the contents are only ever read back through copies
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = usageFlags;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    if(m_device.vk().CreateImage(m_device.logical(), &imageInfo, m_device.allocator(), &m_image) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Image creation failed");
+    }
+
+    VkMemoryRequirements memReq;
+    m_device.vk().GetImageMemoryRequirements(m_device.logical(), m_image, &memReq);
+
+    VkMemoryAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = memReq.size;
+    // Lazily allocated memory is only committed if the attachment spills out of tile memory
+    VkMemoryPropertyFlags preferred = (usageFlags & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT) ? VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT : 0;
+    allocInfo.memoryTypeIndex = m_device.findMemoryType(memReq.memoryTypeBits, memPropFlags, preferred);
+
+    // Attachments are render targets, anything else is only sampled
+    vkc::MemoryCategory category = (usageFlags & (VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT)) ?
+            vkc::MemoryCategory::RenderTarget : vkc::MemoryCategory::Texture;
+    if(m_device.allocateMemory(allocInfo, m_memory, category, std::move(name)) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Image memory allocation failed");
+    }
+    m_device.vk().BindImageMemory(m_device.logical(), m_image, m_memory, 0);
+
+    VkImageViewCreateInfo viewInfo = {};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = m_image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = m_format;
+    viewInfo.components.r =
+    viewInfo.components.g =
+    viewInfo.components.b =
+    viewInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
+    viewInfo.subresourceRange.aspectMask = aspect;
+    viewInfo.subresourceRange.baseMipLevel = 0;
+    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.baseArrayLayer = 0;
+    viewInfo.subresourceRange.layerCount = 1;
+
+    if(m_device.vk().CreateImageView(m_device.logical(), &viewInfo, m_device.allocator(), &m_view) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Image view creation failed");
+    }
+}
+
+vkc::Image::~Image()
+{
+    m_device.vk().DestroyImageView(m_device.logical(), m_view, m_device.allocator());
+    m_device.vk().DestroyImage(m_device.logical(), m_image, m_device.allocator());
+    m_device.freeMemory(m_memory);
+}
@@ -0,0 +1,59 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#ifndef VULKANCUBE_IMAGE_H
+#define VULKANCUBE_IMAGE_H
+
+#include <vulkan/vulkan.h>
+#include <string>
+#include "../NonCopyable.h"
+#include "../Types.h"
+
+namespace vkc
+{
+    class Device;
+    // Single mip, single layer 2D image with its own memory and a view over the whole image
+    // Transient attachments are placed in lazily allocated memory where the device has it,
+    // so on tilers they only ever live in tile memory
+    class Image : public NonCopyable
+    {
+    public:
+        Image(
+                const vkc::Device& device,
+                VkExtent2D extent,
+                VkFormat format,
+                const VkImageUsageFlags& usageFlags,
+                const VkMemoryPropertyFlags& memPropFlags,
+                VkImageAspectFlags aspect,
+                VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT,
+                std::string name = {}
+                );
+        ~Image();
+
+        [[nodiscard]]
+        inline auto handle() const -> const VkImage& { return m_image; }
+        [[nodiscard]]
+        inline auto view() const -> const VkImageView& { return m_view; }
+        [[nodiscard]]
+        inline auto format() const -> const VkFormat& { return m_format; }
+        [[nodiscard]]
+        inline auto extent() const -> const VkExtent2D& { return m_extent; }
+        [[nodiscard]]
+        inline auto samples() const -> VkSampleCountFlagBits { return m_samples; }
+
+    private:
+        VkImage m_image;
+        VkDeviceMemory m_memory;
+        VkImageView m_view;
+
+        VkExtent2D m_extent;
+        VkFormat m_format;
+        VkSampleCountFlagBits m_samples;
+
+        const vkc::Device& m_device;
+    };
+}
+
+#endif //VULKANCUBE_IMAGE_H
@@ -0,0 +1,152 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#include <cstring>
+#include <stdexcept>
+#include "Defragmenter.h"
+#include "MemoryPool.h"
+#include "../Device.h"
+#include "../DeletionQueue.h"
+#include "../buffer/Buffer.h"
+#include "../profile/Profiler.h"
+
+vkc::Defragmenter::Defragmenter(const vkc::Device& device, VkDeviceSize bytesPerFrame) :
+        m_device(device),
+        m_bytesPerFrame(bytesPerFrame),
+        m_cmdPool(device, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT),
+        m_movedBytes(0),
+        m_moves(0)
+{
+}
+
+vkc::Defragmenter::~Defragmenter()
+{
+    for(Slot& slot : m_slots)
+    {
+        m_device.vk().WaitForFences(m_device.logical(), 1, &slot.fence, VK_TRUE, type::uint64_max);
+        m_device.vk().DestroyFence(m_device.logical(), slot.fence, m_device.allocator());
+    }
+}
+
+auto vkc::Defragmenter::step(vkc::DeletionQueue& deletions, std::span<const VkFence> inFlight) -> VkDeviceSize
+{
+    VKC_ZONE("Defragmenter::step");
+
+    std::vector<vkc::MemoryPool::Move> moves = m_device.memoryPool().planMoves(m_bytesPerFrame);
+    if(moves.empty())
+    {
+        return 0;
+    }
+
+    Slot* slot = nullptr;
+    std::vector<VkFence> fences(inFlight.begin(), inFlight.end());
+    std::vector<VkBuffer> old;
+    VkDeviceSize moved = 0;
+    for(const vkc::MemoryPool::Move& move : moves)
+    {
+        vkc::Buffer::Relocation relocation = move.owner->relocate(move.from, move.to);
+        old.push_back(relocation.from);
+        if(move.from.mapped != nullptr && move.to.mapped != nullptr)
+        {
+            std::memcpy(move.to.mapped, move.from.mapped, static_cast<type::size>(move.from.size));
+        }
+        else
+        {
+            if(slot == nullptr)
+            {
+                slot = &freeSlot();
+                fences.push_back(slot->fence);
+
+                VkCommandBufferBeginInfo beginInfo = {};
+                beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+                beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+                if(m_device.vk().BeginCommandBuffer(slot->cmd, &beginInfo) != VK_SUCCESS)
+                {
+                    throw std::runtime_error("Defragmenter command buffer recording failed");
+                }
+            }
+            VkBufferCopy region = {};
+            region.srcOffset = 0;
+            region.dstOffset = 0;
+            region.size = relocation.size;
+            m_device.vk().CmdCopyBuffer(slot->cmd, relocation.from, relocation.to, 1, &region);
+        }
+        moved += move.from.size;
+    }
+
+    if(slot != nullptr)
+    {
+        // Frames submitted after the copies read the new buffers, and may write them
+        VkMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+        m_device.vk().CmdPipelineBarrier(
+                slot->cmd,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                0,
+                1, &barrier,
+                0, nullptr,
+                0, nullptr
+                );
+        m_device.vk().EndCommandBuffer(slot->cmd);
+
+        VkSubmitInfo submitInfo = {};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &slot->cmd;
+        m_device.vk().ResetFences(m_device.logical(), 1, &slot->fence);
+        if(m_device.vk().QueueSubmit(m_device.graphicsQueue(), 1, &submitInfo, slot->fence) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Defragmenter copy submission failed");
+        }
+    }
+
+    // Frames in flight still use the old buffers, and copies read from them
+    // The queue may outlive the defragmenter, so the device is captured rather than this
+    for(type::size i = 0; i < moves.size(); ++i)
+    {
+        deletions.retire(fences, [&device = m_device, buffer = old[i], from = moves[i].from]()
+        {
+            device.vk().DestroyBuffer(device.logical(), buffer, device.allocator());
+            device.memoryPool().free(from);
+        });
+    }
+    m_movedBytes += moved;
+    m_moves += moves.size();
+    return moved;
+}
+
+auto vkc::Defragmenter::freeSlot() -> Slot&
+{
+    for(Slot& slot : m_slots)
+    {
+        if(m_device.vk().GetFenceStatus(m_device.logical(), slot.fence) == VK_SUCCESS)
+        {
+            return slot;
+        }
+    }
+
+    Slot slot = {};
+    VkCommandBufferAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = m_cmdPool.handle();
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = 1;
+    if(m_device.vk().AllocateCommandBuffers(m_device.logical(), &allocInfo, &slot.cmd) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Defragmenter command buffer allocation failed");
+    }
+
+    VkFenceCreateInfo fenceInfo = {};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    if(m_device.vk().CreateFence(m_device.logical(), &fenceInfo, m_device.allocator(), &slot.fence) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Defragmenter fence creation failed");
+    }
+    m_slots.push_back(slot);
+    return m_slots.back();
+}
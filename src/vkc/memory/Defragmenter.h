@@ -0,0 +1,62 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#ifndef VULKANCUBE_DEFRAGMENTER_H
+#define VULKANCUBE_DEFRAGMENTER_H
+
+#include <vulkan/vulkan.h>
+#include <span>
+#include <vector>
+#include "../NonCopyable.h"
+#include "../Types.h"
+#include "../command/CommandPool.h"
+
+namespace vkc
+{
+    class Device;
+    class DeletionQueue;
+    // Compacts the device's memory pool a few megabytes per frame, emptying sparsely used blocks
+    // into the others so they can be freed
+    // Moved buffers get new handles, so users of a buffer compare its generation() to re-record
+    // commands and rewrite descriptors that refer to it
+    class Defragmenter : public NonCopyable
+    {
+    public:
+        explicit Defragmenter(const vkc::Device& device, VkDeviceSize bytesPerFrame = 4 * 1024 * 1024);
+        // Waits for copies still in flight
+        ~Defragmenter();
+
+        // Moves up to bytesPerFrame, copying mapped memory on the host and the rest with a transfer
+        // submitted to the graphics queue ahead of the frame. Old buffers and memory are retired
+        // to deletions until the copy and every submission in inFlight are complete
+        // Returns the bytes moved
+        auto step(vkc::DeletionQueue& deletions, std::span<const VkFence> inFlight) -> VkDeviceSize;
+
+        [[nodiscard]]
+        inline auto movedBytes() const -> VkDeviceSize { return m_movedBytes; }
+        [[nodiscard]]
+        inline auto moves() const -> type::uint64 { return m_moves; }
+
+    private:
+        // Command buffer and fence of a copy, reused once the fence is signaled
+        struct Slot
+        {
+            VkCommandBuffer cmd;
+            VkFence fence;
+        };
+
+        const vkc::Device& m_device;
+        VkDeviceSize m_bytesPerFrame;
+        vkc::CommandPool m_cmdPool;
+        std::vector<Slot> m_slots;
+
+        VkDeviceSize m_movedBytes;
+        type::uint64 m_moves;
+
+        auto freeSlot() -> Slot&;
+    };
+}
+
+#endif //VULKANCUBE_DEFRAGMENTER_H
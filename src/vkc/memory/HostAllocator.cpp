@@ -0,0 +1,313 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <iomanip>
+#include <new>
+#include <ostream>
+#include "HostAllocator.h"
+
+namespace
+{
+    // Stored directly in front of every allocation handed to the driver
+    struct Header
+    {
+        type::uint64 size;
+        // Distance from the start of the block to the allocation
+        type::uint32 offset;
+        // Index of the pool the block came from, or NumClasses for the system allocator
+        type::uint8 sizeClass;
+        type::uint8 scope;
+        type::uint16 unused;
+    };
+    static_assert(sizeof(Header) == 16);
+
+    // Chunks are aligned to the largest size class so every block is aligned to its own size
+    constexpr std::align_val_t ChunkAlignment{vkc::HostAllocator::MaxClassSize};
+
+    inline auto HeaderOf(void* memory) -> Header*
+    {
+        return reinterpret_cast<Header*>(static_cast<std::byte*>(memory) - sizeof(Header));
+    }
+
+    // Room before the allocation for the header, keeping the allocation aligned
+    inline auto OffsetFor(type::size alignment) -> type::size
+    {
+        return std::max(sizeof(Header), alignment);
+    }
+
+    inline auto ClassFor(type::size blockSize) -> type::size
+    {
+        type::size rounded = std::bit_ceil(std::max(blockSize, type::size(1) << vkc::HostAllocator::MinClassShift));
+        return static_cast<type::size>(std::countr_zero(rounded)) - vkc::HostAllocator::MinClassShift;
+    }
+
+    inline auto ClassSize(type::size sizeClass) -> type::size
+    {
+        return type::size(1) << (sizeClass + vkc::HostAllocator::MinClassShift);
+    }
+}
+
+vkc::HostAllocator::HostAllocator() : m_counters(), m_callbacks()
+{
+    m_callbacks.pUserData = this;
+    m_callbacks.pfnAllocation = &HostAllocator::Allocate;
+    m_callbacks.pfnReallocation = &HostAllocator::Reallocate;
+    m_callbacks.pfnFree = &HostAllocator::Free;
+    m_callbacks.pfnInternalAllocation = &HostAllocator::InternalAllocation;
+    m_callbacks.pfnInternalFree = &HostAllocator::InternalFree;
+}
+
+vkc::HostAllocator::~HostAllocator()
+{
+    for(auto& scopePools : m_pools)
+    {
+        for(auto& pool : scopePools)
+        {
+            for(void* chunk : pool.chunks)
+            {
+                ::operator delete(chunk, ChunkAlignment);
+            }
+        }
+    }
+}
+
+auto vkc::HostAllocator::stats(VkSystemAllocationScope scope) const -> ScopeStats
+{
+    const Counters& counters = m_counters[static_cast<type::size>(scope)];
+    ScopeStats stats = {};
+    stats.bytes = counters.bytes.load(std::memory_order_relaxed);
+    stats.peakBytes = counters.peakBytes.load(std::memory_order_relaxed);
+    stats.allocations = counters.allocations.load(std::memory_order_relaxed);
+    stats.reallocations = counters.reallocations.load(std::memory_order_relaxed);
+    stats.frees = counters.frees.load(std::memory_order_relaxed);
+    stats.pooled = counters.pooled.load(std::memory_order_relaxed);
+    stats.internalBytes = counters.internalBytes.load(std::memory_order_relaxed);
+    return stats;
+}
+
+auto vkc::HostAllocator::writeReport(std::ostream& out) const -> void
+{
+    out << std::left << std::setw(12) << "Scope"
+        << std::right << std::setw(12) << "Allocs"
+        << std::setw(12) << "Reallocs"
+        << std::setw(12) << "Pooled"
+        << std::setw(12) << "Live(KB)"
+        << std::setw(12) << "Peak(KB)"
+        << std::setw(14) << "Internal(KB)" << '\n';
+    out << std::fixed << std::setprecision(1);
+    for(type::size i = 0; i < NumScopes; ++i)
+    {
+        auto scope = static_cast<VkSystemAllocationScope>(i);
+        ScopeStats s = stats(scope);
+        out << std::left << std::setw(12) << ScopeName(scope)
+            << std::right << std::setw(12) << s.allocations
+            << std::setw(12) << s.reallocations
+            << std::setw(12) << s.pooled
+            << std::setw(12) << s.bytes / 1024.0
+            << std::setw(12) << s.peakBytes / 1024.0
+            << std::setw(14) << s.internalBytes / 1024.0 << '\n';
+    }
+    out << std::defaultfloat;
+}
+
+auto vkc::HostAllocator::writeJson(std::ostream& out) const -> void
+{
+    out << "{";
+    for(type::size i = 0; i < NumScopes; ++i)
+    {
+        auto scope = static_cast<VkSystemAllocationScope>(i);
+        ScopeStats s = stats(scope);
+        out << (i == 0 ? "" : ", ") << "\"" << ScopeName(scope) << "\": {"
+            << "\"allocations\": " << s.allocations
+            << ", \"reallocations\": " << s.reallocations
+            << ", \"frees\": " << s.frees
+            << ", \"pooled\": " << s.pooled
+            << ", \"bytes\": " << s.bytes
+            << ", \"peakBytes\": " << s.peakBytes
+            << ", \"internalBytes\": " << s.internalBytes << "}";
+    }
+    out << "}";
+}
+
+auto vkc::HostAllocator::ScopeName(VkSystemAllocationScope scope) -> type::cstr
+{
+    switch(scope)
+    {
+        case VK_SYSTEM_ALLOCATION_SCOPE_COMMAND: return "command";
+        case VK_SYSTEM_ALLOCATION_SCOPE_OBJECT: return "object";
+        case VK_SYSTEM_ALLOCATION_SCOPE_CACHE: return "cache";
+        case VK_SYSTEM_ALLOCATION_SCOPE_DEVICE: return "device";
+        case VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE: return "instance";
+        default: return "unknown";
+    }
+}
+
+auto vkc::HostAllocator::allocate(type::size size, type::size alignment, VkSystemAllocationScope scope) -> void*
+{
+    auto scopeIndex = static_cast<type::size>(scope);
+    type::size offset = OffsetFor(alignment);
+    type::size blockSize = offset + size;
+
+    std::byte* block;
+    type::size sizeClass = NumClasses;
+    if(blockSize <= MaxClassSize)
+    {
+        sizeClass = ClassFor(blockSize);
+        block = static_cast<std::byte*>(poolAllocate(m_pools[scopeIndex][sizeClass], ClassSize(sizeClass)));
+    }
+    else
+    {
+        block = static_cast<std::byte*>(::operator new(blockSize, std::align_val_t(offset), std::nothrow));
+    }
+    // Returning null reports VK_ERROR_OUT_OF_HOST_MEMORY, the driver can't take an exception
+    if(block == nullptr)
+    {
+        return nullptr;
+    }
+
+    void* memory = block + offset;
+    Header* header = HeaderOf(memory);
+    header->size = size;
+    header->offset = static_cast<type::uint32>(offset);
+    header->sizeClass = static_cast<type::uint8>(sizeClass);
+    header->scope = static_cast<type::uint8>(scopeIndex);
+
+    m_counters[scopeIndex].allocations.fetch_add(1, std::memory_order_relaxed);
+    if(sizeClass != NumClasses)
+    {
+        m_counters[scopeIndex].pooled.fetch_add(1, std::memory_order_relaxed);
+    }
+    addBytes(scopeIndex, size);
+    return memory;
+}
+
+auto vkc::HostAllocator::reallocate(void* original, type::size size, type::size alignment, VkSystemAllocationScope scope) -> void*
+{
+    if(original == nullptr)
+    {
+        return allocate(size, alignment, scope);
+    }
+    if(size == 0)
+    {
+        free(original);
+        return nullptr;
+    }
+
+    Header* header = HeaderOf(original);
+    auto scopeIndex = static_cast<type::size>(scope);
+    m_counters[scopeIndex].reallocations.fetch_add(1, std::memory_order_relaxed);
+
+    // Grow or shrink in place when the block has room and stays in the same scope
+    if(header->sizeClass < NumClasses && header->scope == scopeIndex &&
+       header->offset + size <= ClassSize(header->sizeClass))
+    {
+        m_counters[scopeIndex].bytes.fetch_sub(header->size, std::memory_order_relaxed);
+        addBytes(scopeIndex, size);
+        header->size = size;
+        return original;
+    }
+
+    void* memory = allocate(size, alignment, scope);
+    if(memory == nullptr)
+    {
+        // The original allocation must be left untouched on failure
+        return nullptr;
+    }
+    std::memcpy(memory, original, std::min<type::size>(size, header->size));
+    free(original);
+    return memory;
+}
+
+auto vkc::HostAllocator::free(void* memory) -> void
+{
+    if(memory == nullptr)
+    {
+        return;
+    }
+
+    Header* header = HeaderOf(memory);
+    Counters& counters = m_counters[header->scope];
+    counters.bytes.fetch_sub(header->size, std::memory_order_relaxed);
+    counters.frees.fetch_add(1, std::memory_order_relaxed);
+
+    std::byte* block = static_cast<std::byte*>(memory) - header->offset;
+    if(header->sizeClass < NumClasses)
+    {
+        Pool& pool = m_pools[header->scope][header->sizeClass];
+        std::lock_guard lock(pool.mutex);
+        // The block's first bytes hold the next free block
+        *reinterpret_cast<void**>(block) = pool.freeList;
+        pool.freeList = block;
+    }
+    else
+    {
+        ::operator delete(block, std::align_val_t(header->offset));
+    }
+}
+
+auto vkc::HostAllocator::poolAllocate(Pool& pool, type::size blockSize) -> void*
+{
+    std::lock_guard lock(pool.mutex);
+    if(pool.freeList == nullptr)
+    {
+        // Carve a new chunk into a free list of blocks
+        auto* chunk = static_cast<std::byte*>(::operator new(ChunkSize, ChunkAlignment, std::nothrow));
+        if(chunk == nullptr)
+        {
+            return nullptr;
+        }
+        pool.chunks.push_back(chunk);
+        for(type::size offset = ChunkSize; offset >= blockSize; offset -= blockSize)
+        {
+            std::byte* block = chunk + offset - blockSize;
+            *reinterpret_cast<void**>(block) = pool.freeList;
+            pool.freeList = block;
+        }
+    }
+
+    void* block = pool.freeList;
+    pool.freeList = *reinterpret_cast<void**>(block);
+    return block;
+}
+
+auto vkc::HostAllocator::addBytes(type::size scope, type::uint64 bytes) -> void
+{
+    Counters& counters = m_counters[scope];
+    type::uint64 current = counters.bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    type::uint64 peak = counters.peakBytes.load(std::memory_order_relaxed);
+    while(current > peak && !counters.peakBytes.compare_exchange_weak(peak, current, std::memory_order_relaxed))
+    {
+    }
+}
+
+auto vkc::HostAllocator::Allocate(void* userData, size_t size, size_t alignment, VkSystemAllocationScope scope) -> VKAPI_ATTR void* VKAPI_CALL
+{
+    return static_cast<HostAllocator*>(userData)->allocate(size, alignment, scope);
+}
+
+auto vkc::HostAllocator::Reallocate(void* userData, void* original, size_t size, size_t alignment, VkSystemAllocationScope scope) -> VKAPI_ATTR void* VKAPI_CALL
+{
+    return static_cast<HostAllocator*>(userData)->reallocate(original, size, alignment, scope);
+}
+
+auto vkc::HostAllocator::Free(void* userData, void* memory) -> VKAPI_ATTR void VKAPI_CALL
+{
+    static_cast<HostAllocator*>(userData)->free(memory);
+}
+
+auto vkc::HostAllocator::InternalAllocation(void* userData, size_t size, VkInternalAllocationType, VkSystemAllocationScope scope) -> VKAPI_ATTR void VKAPI_CALL
+{
+    auto* allocator = static_cast<HostAllocator*>(userData);
+    allocator->m_counters[static_cast<type::size>(scope)].internalBytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+auto vkc::HostAllocator::InternalFree(void* userData, size_t size, VkInternalAllocationType, VkSystemAllocationScope scope) -> VKAPI_ATTR void VKAPI_CALL
+{
+    auto* allocator = static_cast<HostAllocator*>(userData);
+    allocator->m_counters[static_cast<type::size>(scope)].internalBytes.fetch_sub(size, std::memory_order_relaxed);
+}
@@ -0,0 +1,102 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#ifndef VULKANCUBE_HOSTALLOCATOR_H
+#define VULKANCUBE_HOSTALLOCATOR_H
+
+#include <vulkan/vulkan.h>
+#include <array>
+#include <atomic>
+#include <iosfwd>
+#include <mutex>
+#include <vector>
+#include "../NonCopyable.h"
+#include "../Types.h"
+
+namespace vkc
+{
+    // Host memory allocator handed to the driver through VkAllocationCallbacks
+    // Small allocations come from power of two size class pools, kept separately for each
+    // allocation scope so short lived command scope allocations don't fragment the pools
+    // holding long lived objects. Larger allocations go straight to the system allocator
+    // Bytes, calls and peak usage are counted per scope
+    class HostAllocator : public NonCopyable
+    {
+    public:
+        // VK_SYSTEM_ALLOCATION_SCOPE_COMMAND through VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE
+        static constexpr type::size NumScopes = 5;
+        // Size classes from 16 bytes to 4KiB, including the allocation header and alignment
+        static constexpr type::size MinClassShift = 4;
+        static constexpr type::size NumClasses = 9;
+        static constexpr type::size MaxClassSize = type::size(1) << (MinClassShift + NumClasses - 1);
+        // Pools grow a chunk at a time
+        static constexpr type::size ChunkSize = 64 * 1024;
+
+        struct ScopeStats
+        {
+            // Bytes currently allocated by the driver
+            type::uint64 bytes;
+            type::uint64 peakBytes;
+            type::uint64 allocations;
+            type::uint64 reallocations;
+            type::uint64 frees;
+            // Allocations served from a size class pool instead of the system allocator
+            type::uint64 pooled;
+            // Memory the driver allocated itself and reported through the internal notifications
+            type::uint64 internalBytes;
+        };
+
+        HostAllocator();
+        ~HostAllocator();
+
+        [[nodiscard]]
+        inline auto callbacks() const -> const VkAllocationCallbacks* { return &m_callbacks; }
+
+        [[nodiscard]]
+        auto stats(VkSystemAllocationScope scope) const -> ScopeStats;
+        auto writeReport(std::ostream& out) const -> void;
+        auto writeJson(std::ostream& out) const -> void;
+
+        static auto ScopeName(VkSystemAllocationScope scope) -> type::cstr;
+
+    private:
+        struct Pool
+        {
+            std::mutex mutex;
+            void* freeList = nullptr;
+            std::vector<void*> chunks;
+        };
+
+        struct Counters
+        {
+            std::atomic<type::uint64> bytes;
+            std::atomic<type::uint64> peakBytes;
+            std::atomic<type::uint64> allocations;
+            std::atomic<type::uint64> reallocations;
+            std::atomic<type::uint64> frees;
+            std::atomic<type::uint64> pooled;
+            std::atomic<type::uint64> internalBytes;
+        };
+
+        std::array<std::array<Pool, NumClasses>, NumScopes> m_pools;
+        std::array<Counters, NumScopes> m_counters;
+        VkAllocationCallbacks m_callbacks;
+
+        auto allocate(type::size size, type::size alignment, VkSystemAllocationScope scope) -> void*;
+        auto reallocate(void* original, type::size size, type::size alignment, VkSystemAllocationScope scope) -> void*;
+        auto free(void* memory) -> void;
+
+        auto poolAllocate(Pool& pool, type::size blockSize) -> void*;
+        auto addBytes(type::size scope, type::uint64 bytes) -> void;
+
+        static auto Allocate(void* userData, size_t size, size_t alignment, VkSystemAllocationScope scope) -> VKAPI_ATTR void* VKAPI_CALL;
+        static auto Reallocate(void* userData, void* original, size_t size, size_t alignment, VkSystemAllocationScope scope) -> VKAPI_ATTR void* VKAPI_CALL;
+        static auto Free(void* userData, void* memory) -> VKAPI_ATTR void VKAPI_CALL;
+        static auto InternalAllocation(void* userData, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope) -> VKAPI_ATTR void VKAPI_CALL;
+        static auto InternalFree(void* userData, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope) -> VKAPI_ATTR void VKAPI_CALL;
+    };
+}
+
+#endif //VULKANCUBE_HOSTALLOCATOR_H
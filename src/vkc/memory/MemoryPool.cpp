@@ -0,0 +1,292 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#include <algorithm>
+#include <stdexcept>
+#include "MemoryPool.h"
+#include "../Device.h"
+
+vkc::MemoryPool::MemoryPool(const vkc::Device& device) :
+        m_device(device)
+{
+}
+
+vkc::MemoryPool::~MemoryPool()
+{
+    for(auto& [key, blocks] : m_blocks)
+    {
+        for(auto& block : blocks)
+        {
+            m_device.freeMemory(block->memory);
+        }
+    }
+}
+
+auto vkc::MemoryPool::allocate(
+        const VkMemoryRequirements& memReq,
+        vkc::MemoryUsage usage,
+        const VkMemoryPropertyFlags& required,
+        vkc::MemoryCategory category,
+        const std::string& name,
+        vkc::Buffer* owner
+        ) -> vkc::MemoryAllocation
+{
+    if(memReq.size == 0)
+    {
+        throw std::runtime_error("Memory allocation of 0 bytes");
+    }
+    type::uint32 memoryType = m_device.findMemoryType(memReq.memoryTypeBits, usage, memReq.size, required);
+    const VkMemoryType& type = m_device.memoryProperties().memoryTypes[memoryType];
+    VkDeviceSize heapSize = m_device.memoryProperties().memoryHeaps[type.heapIndex].size;
+
+    // Mapped ranges of memory that isn't coherent are flushed in whole atoms, so keep allocations from sharing one
+    VkDeviceSize alignment = memReq.alignment;
+    if((type.propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) && !(type.propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+    {
+        alignment = std::max(alignment, m_device.properties().limits.nonCoherentAtomSize);
+    }
+    // Small heaps get smaller blocks, so one block can't take most of the heap
+    VkDeviceSize blockSize = std::min(BlockSize, std::max<VkDeviceSize>(heapSize / 8, 1));
+
+    std::lock_guard lock(m_mutex);
+    Key key = { memoryType, category };
+    if(memReq.size > blockSize / 2)
+    {
+        Block& block = createBlock(key, memReq.size, true, name);
+        return *place(block, memReq.size, alignment, owner, name);
+    }
+
+    for(auto& block : m_blocks[key])
+    {
+        if(block->dedicated || block->draining)
+        {
+            continue;
+        }
+        if(auto allocation = place(*block, memReq.size, alignment, owner, name))
+        {
+            return *allocation;
+        }
+    }
+
+    std::string blockName = std::string(vkc::MemorySnapshot::CategoryName(category)) + " pool";
+    Block& block = createBlock(key, blockSize, false, blockName);
+    return *place(block, memReq.size, alignment, owner, name);
+}
+
+auto vkc::MemoryPool::free(const vkc::MemoryAllocation& allocation) -> void
+{
+    if(allocation.memory == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    std::lock_guard lock(m_mutex);
+    auto it = m_blockOf.find(allocation.memory);
+    if(it == m_blockOf.end())
+    {
+        throw std::runtime_error("Freed memory not allocated from the pool");
+    }
+    auto [key, block] = it->second;
+    release(key, *block, allocation);
+}
+
+auto vkc::MemoryPool::planMoves(VkDeviceSize budget) -> std::vector<Move>
+{
+    std::lock_guard lock(m_mutex);
+    std::vector<Move> moves;
+
+    for(auto& [key, blocks] : m_blocks)
+    {
+        // Resume a block already being drained, otherwise start on the emptiest block
+        // that everything it holds can move out of
+        Block* source = nullptr;
+        for(auto& block : blocks)
+        {
+            if(block->draining)
+            {
+                source = block.get();
+                break;
+            }
+        }
+        if(source == nullptr)
+        {
+            VkDeviceSize free = 0;
+            for(auto& block : blocks)
+            {
+                if(!block->dedicated)
+                {
+                    free += block->ranges.size() - block->ranges.used();
+                }
+            }
+            for(auto& block : blocks)
+            {
+                if(block->dedicated || block->ranges.empty())
+                {
+                    continue;
+                }
+                // Blocks holding allocations that can't move would never empty
+                bool movable = std::all_of(block->allocations.begin(), block->allocations.end(),
+                                           [](const auto& entry) { return entry.second.owner != nullptr; });
+                VkDeviceSize elsewhere = free - (block->ranges.size() - block->ranges.used());
+                if(movable && block->ranges.used() <= elsewhere && (source == nullptr || block->ranges.used() < source->ranges.used()))
+                {
+                    source = block.get();
+                }
+            }
+        }
+        if(source == nullptr)
+        {
+            continue;
+        }
+        source->draining = true;
+
+        for(auto& [offset, allocation] : source->allocations)
+        {
+            if(allocation.moving)
+            {
+                continue;
+            }
+            if(!moves.empty() && allocation.size > budget)
+            {
+                return moves;
+            }
+
+            std::optional<vkc::MemoryAllocation> to;
+            for(auto& block : blocks)
+            {
+                if(block.get() == source || block->dedicated || block->draining)
+                {
+                    continue;
+                }
+                to = place(*block, allocation.size, allocation.alignment, allocation.owner, allocation.name);
+                if(to)
+                {
+                    break;
+                }
+            }
+            if(!to)
+            {
+                // Fragmented too badly to take the rest, so leave the block in use
+                source->draining = false;
+                break;
+            }
+
+            vkc::MemoryAllocation from = { source->memory, offset, allocation.size, source->mapped ? source->mapped + offset : nullptr };
+            moves.push_back({ allocation.owner, from, *to });
+            allocation.moving = true;
+            budget -= std::min(budget, allocation.size);
+        }
+    }
+    return moves;
+}
+
+auto vkc::MemoryPool::blockCount() const -> type::size
+{
+    std::lock_guard lock(m_mutex);
+    return m_blockOf.size();
+}
+
+auto vkc::MemoryPool::fragmentation() const -> double
+{
+    std::lock_guard lock(m_mutex);
+    VkDeviceSize size = 0;
+    VkDeviceSize used = 0;
+    for(const auto& [key, blocks] : m_blocks)
+    {
+        for(const auto& block : blocks)
+        {
+            size += block->ranges.size();
+            used += block->ranges.used();
+        }
+    }
+    return size > 0 ? 1.0 - static_cast<double>(used) / static_cast<double>(size) : 0.0;
+}
+
+auto vkc::MemoryPool::live() const -> std::vector<std::string>
+{
+    std::lock_guard lock(m_mutex);
+    std::vector<std::string> names;
+    for(const auto& [key, blocks] : m_blocks)
+    {
+        for(const auto& block : blocks)
+        {
+            for(const auto& [offset, allocation] : block->allocations)
+            {
+                names.push_back(std::string(vkc::MemorySnapshot::CategoryName(key.second)) + " " + allocation.name);
+            }
+        }
+    }
+    return names;
+}
+
+auto vkc::MemoryPool::createBlock(Key key, VkDeviceSize size, bool dedicated, const std::string& name) -> Block&
+{
+    VkMemoryAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = size;
+    allocInfo.memoryTypeIndex = key.first;
+
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    if(m_device.allocateMemory(allocInfo, memory, key.second, name) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Memory block allocation failed");
+    }
+
+    // Host visible blocks stay mapped for as long as they live
+    void* mapped = nullptr;
+    if(m_device.memoryProperties().memoryTypes[key.first].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    {
+        if(m_device.vk().MapMemory(m_device.logical(), memory, 0, VK_WHOLE_SIZE, 0, &mapped) != VK_SUCCESS)
+        {
+            m_device.freeMemory(memory);
+            throw std::runtime_error("Memory block mapping failed");
+        }
+    }
+
+    auto block = std::make_unique<Block>(Block{ memory, static_cast<std::byte*>(mapped), vkc::RangeAllocator(size), dedicated, false, {} });
+    Block& ref = *block;
+    m_blocks[key].push_back(std::move(block));
+    m_blockOf[memory] = { key, &ref };
+    return ref;
+}
+
+auto vkc::MemoryPool::destroyBlock(Key key, Block& block) -> void
+{
+    // Freeing memory unmaps it
+    m_device.freeMemory(block.memory);
+    m_blockOf.erase(block.memory);
+    auto& blocks = m_blocks[key];
+    blocks.erase(std::find_if(blocks.begin(), blocks.end(), [&block](const auto& b) { return b.get() == &block; }));
+    if(blocks.empty())
+    {
+        m_blocks.erase(key);
+    }
+}
+
+auto vkc::MemoryPool::place(Block& block, VkDeviceSize size, VkDeviceSize alignment, vkc::Buffer* owner, const std::string& name) -> std::optional<vkc::MemoryAllocation>
+{
+    std::optional<VkDeviceSize> offset = block.ranges.allocate(size, alignment);
+    if(!offset)
+    {
+        return std::nullopt;
+    }
+    block.allocations[*offset] = { size, alignment, owner, false, name };
+    m_device.memoryTracker().setUsed(block.memory, block.ranges.used());
+    return vkc::MemoryAllocation{ block.memory, *offset, size, block.mapped ? block.mapped + *offset : nullptr };
+}
+
+auto vkc::MemoryPool::release(Key key, Block& block, const vkc::MemoryAllocation& allocation) -> void
+{
+    block.ranges.free(allocation.offset, allocation.size);
+    block.allocations.erase(allocation.offset);
+    m_device.memoryTracker().setUsed(block.memory, block.ranges.used());
+
+    // Keep one block around so allocations freed and made again each frame don't reallocate it,
+    // but drained blocks always go, that's what they were drained for
+    if(block.ranges.empty() && (block.dedicated || block.draining || m_blocks[key].size() > 1))
+    {
+        destroyBlock(key, block);
+    }
+}
@@ -0,0 +1,127 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#ifndef VULKANCUBE_MEMORYPOOL_H
+#define VULKANCUBE_MEMORYPOOL_H
+
+#include <vulkan/vulkan.h>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "MemoryTracker.h"
+#include "MemoryUsage.h"
+#include "RangeAllocator.h"
+#include "../NonCopyable.h"
+#include "../Types.h"
+
+namespace vkc
+{
+    class Device;
+    class Buffer;
+
+    // Range of a block of device memory
+    struct MemoryAllocation
+    {
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkDeviceSize offset = 0;
+        VkDeviceSize size = 0;
+        // Start of the range in persistently mapped host visible memory, null otherwise
+        std::byte* mapped = nullptr;
+    };
+
+    // Buffer memory sub-allocated from large blocks, so buffers don't each cost a driver allocation
+    // Blocks are kept apart by memory type and category, and host visible blocks stay mapped
+    // Allocations larger than half a block get a dedicated block of their own
+    class MemoryPool : public NonCopyable
+    {
+    public:
+        static constexpr VkDeviceSize BlockSize = 32 * 1024 * 1024;
+
+        // Allocation moved by the defragmenter. The owner has to be pointed at the new range,
+        // and the old range freed once nothing is using it
+        struct Move
+        {
+            vkc::Buffer* owner;
+            vkc::MemoryAllocation from;
+            vkc::MemoryAllocation to;
+        };
+
+        explicit MemoryPool(const vkc::Device& device);
+        // Frees every block, so the device must be idle
+        ~MemoryPool();
+
+        // Owners are the buffers the defragmenter can move allocations of, null if the allocation can't move
+        auto allocate(
+                const VkMemoryRequirements& memReq,
+                vkc::MemoryUsage usage,
+                const VkMemoryPropertyFlags& required,
+                vkc::MemoryCategory category,
+                const std::string& name,
+                vkc::Buffer* owner
+                ) -> vkc::MemoryAllocation;
+        // Blocks left empty are freed, unless they're the last block of their kind
+        auto free(const vkc::MemoryAllocation& allocation) -> void;
+
+        // Picks the emptiest block whose allocations fit in the other blocks of its kind, and allocates
+        // their new ranges, up to budget bytes. The first move is always planned, however large
+        // The block takes no new allocations from then on, and is freed once everything has moved out
+        // No block is allocated for moves, so memory use never grows while compacting
+        auto planMoves(VkDeviceSize budget) -> std::vector<Move>;
+
+        [[nodiscard]]
+        auto blockCount() const -> type::size;
+        // Share of pooled block memory that holds no allocation, 0 to 1
+        [[nodiscard]]
+        auto fragmentation() const -> double;
+        // Allocations that are still live, as a list of names
+        [[nodiscard]]
+        auto live() const -> std::vector<std::string>;
+
+    private:
+        struct Allocation
+        {
+            VkDeviceSize size;
+            VkDeviceSize alignment;
+            vkc::Buffer* owner;
+            // Planned to move out of its block, so it isn't moved again
+            bool moving;
+            std::string name;
+        };
+
+        struct Block
+        {
+            VkDeviceMemory memory;
+            std::byte* mapped;
+            vkc::RangeAllocator ranges;
+            // Holds a single allocation larger than half a block
+            bool dedicated;
+            // Being emptied by the defragmenter
+            bool draining;
+            // By offset
+            std::map<VkDeviceSize, Allocation> allocations;
+        };
+
+        // Memory type and category
+        using Key = std::pair<type::uint32, vkc::MemoryCategory>;
+
+        const vkc::Device& m_device;
+        mutable std::mutex m_mutex;
+        std::map<Key, std::vector<std::unique_ptr<Block>>> m_blocks;
+        std::unordered_map<VkDeviceMemory, std::pair<Key, Block*>> m_blockOf;
+
+        auto createBlock(Key key, VkDeviceSize size, bool dedicated, const std::string& name) -> Block&;
+        auto destroyBlock(Key key, Block& block) -> void;
+        auto place(Block& block, VkDeviceSize size, VkDeviceSize alignment, vkc::Buffer* owner, const std::string& name) -> std::optional<vkc::MemoryAllocation>;
+        auto release(Key key, Block& block, const vkc::MemoryAllocation& allocation) -> void;
+    };
+}
+
+#endif //VULKANCUBE_MEMORYPOOL_H
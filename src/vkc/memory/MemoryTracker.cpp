@@ -0,0 +1,236 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+#include "MemoryTracker.h"
+
+namespace
+{
+    // Names come from vkc, only quotes and backslashes need escaping
+    auto WriteJsonString(std::ostream& out, const std::string& value) -> void
+    {
+        out << '"';
+        for(char c : value)
+        {
+            if(c == '"' || c == '\\')
+            {
+                out << '\\';
+            }
+            out << c;
+        }
+        out << '"';
+    }
+}
+
+auto vkc::MemorySnapshot::fragmentation() const -> double
+{
+    VkDeviceSize tracked = 0;
+    VkDeviceSize used = 0;
+    for(const Heap& heap : heaps)
+    {
+        tracked += heap.tracked;
+        used += heap.used;
+    }
+    return tracked > 0 ? 1.0 - static_cast<double>(used) / static_cast<double>(tracked) : 0.0;
+}
+
+auto vkc::MemorySnapshot::writeReport(std::ostream& out) const -> void
+{
+    out << std::fixed << std::setprecision(1);
+    out << std::left << std::setw(8) << "Heap"
+        << std::right << std::setw(14) << "Size(MB)"
+        << std::setw(14) << "Budget(MB)"
+        << std::setw(14) << "Usage(MB)"
+        << std::setw(14) << "Tracked(MB)" << '\n';
+    for(type::size i = 0; i < heaps.size(); ++i)
+    {
+        const Heap& heap = heaps[i];
+        out << std::left << std::setw(8) << (std::to_string(i) + (heap.deviceLocal ? " dev" : ""))
+            << std::right << std::setw(14) << heap.size / (1024.0 * 1024.0)
+            << std::setw(14) << heap.budget.budget / (1024.0 * 1024.0)
+            << std::setw(14) << heap.budget.usage / (1024.0 * 1024.0)
+            << std::setw(14) << heap.tracked / (1024.0 * 1024.0) << '\n';
+    }
+
+    out << std::left << std::setw(14) << "Category"
+        << std::right << std::setw(8) << "Allocs"
+        << std::setw(14) << "Bytes(KB)"
+        << std::setw(14) << "Used(KB)" << '\n';
+    for(type::size i = 0; i < categories.size(); ++i)
+    {
+        const Category& category = categories[i];
+        if(category.allocations == 0)
+        {
+            continue;
+        }
+        out << std::left << std::setw(14) << CategoryName(static_cast<vkc::MemoryCategory>(i))
+            << std::right << std::setw(8) << category.allocations
+            << std::setw(14) << category.bytes / 1024.0
+            << std::setw(14) << category.used / 1024.0 << '\n';
+    }
+
+    out << "Allocations " << allocations << " of " << maxAllocations
+        << ", peak " << peakBytes / (1024.0 * 1024.0) << "MB"
+        << ", fragmentation " << fragmentation() * 100.0 << "%\n";
+    for(const Allocation& allocation : largest)
+    {
+        out << "    " << std::setw(12) << allocation.size / 1024.0 << "KB  "
+            << CategoryName(allocation.category) << " " << allocation.name << '\n';
+    }
+    out << std::defaultfloat;
+}
+
+auto vkc::MemorySnapshot::writeJson(std::ostream& out) const -> void
+{
+    out << "{\"heaps\": [";
+    for(type::size i = 0; i < heaps.size(); ++i)
+    {
+        const Heap& heap = heaps[i];
+        out << (i == 0 ? "" : ", ") << "{"
+            << "\"size\": " << heap.size
+            << ", \"deviceLocal\": " << (heap.deviceLocal ? "true" : "false")
+            << ", \"budget\": " << heap.budget.budget
+            << ", \"usage\": " << heap.budget.usage
+            << ", \"tracked\": " << heap.tracked
+            << ", \"used\": " << heap.used << "}";
+    }
+
+    out << "], \"categories\": {";
+    for(type::size i = 0; i < categories.size(); ++i)
+    {
+        const Category& category = categories[i];
+        out << (i == 0 ? "" : ", ") << "\"" << CategoryName(static_cast<vkc::MemoryCategory>(i)) << "\": {"
+            << "\"allocations\": " << category.allocations
+            << ", \"bytes\": " << category.bytes
+            << ", \"used\": " << category.used << "}";
+    }
+
+    out << "}, \"largest\": [";
+    for(type::size i = 0; i < largest.size(); ++i)
+    {
+        const Allocation& allocation = largest[i];
+        out << (i == 0 ? "" : ", ") << "{\"name\": ";
+        WriteJsonString(out, allocation.name);
+        out << ", \"category\": \"" << CategoryName(allocation.category) << "\"";
+        if(allocation.heap < VK_MAX_MEMORY_HEAPS)
+        {
+            out << ", \"heap\": " << allocation.heap;
+        }
+        out << ", \"size\": " << allocation.size
+            << ", \"used\": " << allocation.used << "}";
+    }
+
+    out << "], \"allocations\": " << allocations
+        << ", \"maxAllocations\": " << maxAllocations
+        << ", \"peakBytes\": " << peakBytes
+        << ", \"fragmentation\": " << fragmentation() << "}";
+}
+
+auto vkc::MemorySnapshot::CategoryName(vkc::MemoryCategory category) -> type::cstr
+{
+    switch(category)
+    {
+        case vkc::MemoryCategory::Geometry: return "geometry";
+        case vkc::MemoryCategory::Uniform: return "uniform";
+        case vkc::MemoryCategory::Staging: return "staging";
+        case vkc::MemoryCategory::Buffer: return "buffer";
+        case vkc::MemoryCategory::Readback: return "readback";
+        case vkc::MemoryCategory::RenderTarget: return "render_target";
+        case vkc::MemoryCategory::Transient: return "transient";
+        case vkc::MemoryCategory::Texture: return "texture";
+        case vkc::MemoryCategory::SwapChain: return "swap_chain";
+        default: return "unknown";
+    }
+}
+
+auto vkc::MemoryTracker::add(VkDeviceMemory memory, type::uint32 heap, VkDeviceSize size, VkDeviceSize used, vkc::MemoryCategory category, std::string name) -> void
+{
+    std::lock_guard lock(m_mutex);
+    m_allocations[memory] = { heap, size, std::min(used, size), category, std::move(name) };
+    m_bytes += size;
+    m_peakBytes = std::max(m_peakBytes, m_bytes);
+}
+
+auto vkc::MemoryTracker::remove(VkDeviceMemory memory) -> void
+{
+    std::lock_guard lock(m_mutex);
+    auto it = m_allocations.find(memory);
+    if(it != m_allocations.end())
+    {
+        m_bytes -= it->second.size;
+        m_allocations.erase(it);
+    }
+}
+
+auto vkc::MemoryTracker::setUsed(VkDeviceMemory memory, VkDeviceSize used) -> void
+{
+    std::lock_guard lock(m_mutex);
+    auto it = m_allocations.find(memory);
+    if(it != m_allocations.end())
+    {
+        it->second.used = std::min(used, it->second.size);
+    }
+}
+
+auto vkc::MemoryTracker::addExternal(const void* owner, VkDeviceSize size, vkc::MemoryCategory category, std::string name) -> void
+{
+    std::lock_guard lock(m_mutex);
+    m_external[owner] = { VK_MAX_MEMORY_HEAPS, size, size, category, std::move(name) };
+}
+
+auto vkc::MemoryTracker::removeExternal(const void* owner) -> void
+{
+    std::lock_guard lock(m_mutex);
+    m_external.erase(owner);
+}
+
+auto vkc::MemoryTracker::snapshot(type::size largest) const -> vkc::MemorySnapshot
+{
+    vkc::MemorySnapshot snapshot = {};
+    snapshot.heaps.resize(VK_MAX_MEMORY_HEAPS);
+
+    std::lock_guard lock(m_mutex);
+    snapshot.allocations = m_allocations.size();
+    snapshot.peakBytes = m_peakBytes;
+
+    auto count = [&snapshot](const Allocation& allocation)
+    {
+        vkc::MemorySnapshot::Category& category = snapshot.categories[static_cast<type::size>(allocation.category)];
+        ++category.allocations;
+        category.bytes += allocation.size;
+        category.used += allocation.used;
+        snapshot.largest.push_back({ allocation.name, allocation.category, allocation.heap, allocation.size, allocation.used });
+    };
+    for(const auto& [memory, allocation] : m_allocations)
+    {
+        snapshot.heaps[allocation.heap].tracked += allocation.size;
+        snapshot.heaps[allocation.heap].used += allocation.used;
+        count(allocation);
+    }
+    for(const auto& [owner, allocation] : m_external)
+    {
+        count(allocation);
+    }
+
+    auto bySize = [](const vkc::MemorySnapshot::Allocation& a, const vkc::MemorySnapshot::Allocation& b) { return a.size > b.size; };
+    largest = std::min(largest, snapshot.largest.size());
+    std::partial_sort(snapshot.largest.begin(), snapshot.largest.begin() + static_cast<std::ptrdiff_t>(largest), snapshot.largest.end(), bySize);
+    snapshot.largest.resize(largest);
+    return snapshot;
+}
+
+auto vkc::MemoryTracker::live() const -> std::vector<std::string>
+{
+    std::lock_guard lock(m_mutex);
+    std::vector<std::string> names;
+    names.reserve(m_allocations.size());
+    for(const auto& [memory, allocation] : m_allocations)
+    {
+        names.push_back(std::string(vkc::MemorySnapshot::CategoryName(allocation.category)) + " " + allocation.name);
+    }
+    return names;
+}
@@ -0,0 +1,131 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#ifndef VULKANCUBE_MEMORYTRACKER_H
+#define VULKANCUBE_MEMORYTRACKER_H
+
+#include <vulkan/vulkan.h>
+#include <array>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "MemoryUsage.h"
+#include "../NonCopyable.h"
+#include "../Types.h"
+
+namespace vkc
+{
+    enum class MemoryCategory
+    {
+        // Vertex and index buffers
+        Geometry,
+        Uniform,
+        Staging,
+        // Buffers that don't fit any other category
+        Buffer,
+        Readback,
+        // Images drawn to, other than the swap chain's
+        RenderTarget,
+        // Images aliased by the render graph
+        Transient,
+        Texture,
+        // Owned by the presentation engine, so the size is estimated and belongs to no heap
+        SwapChain,
+        Count
+    };
+
+    // Memory use at one point in time
+    struct MemorySnapshot
+    {
+        struct Heap
+        {
+            VkDeviceSize size;
+            bool deviceLocal;
+            // From VK_EXT_memory_budget when the device has it, otherwise size and tracked
+            vkc::HeapBudget budget;
+            // Allocated through the device, and how much of it holds resources
+            VkDeviceSize tracked;
+            VkDeviceSize used;
+        };
+
+        struct Category
+        {
+            type::uint64 allocations;
+            VkDeviceSize bytes;
+            VkDeviceSize used;
+        };
+
+        struct Allocation
+        {
+            std::string name;
+            vkc::MemoryCategory category;
+            // VK_MAX_MEMORY_HEAPS for memory the device doesn't own
+            type::uint32 heap;
+            VkDeviceSize size;
+            VkDeviceSize used;
+        };
+
+        std::vector<Heap> heaps;
+        std::array<Category, static_cast<type::size>(vkc::MemoryCategory::Count)> categories;
+        // Largest first
+        std::vector<Allocation> largest;
+        type::uint64 allocations;
+        // Device limit on live allocations, sub-allocating keeps well below it
+        type::uint32 maxAllocations;
+        VkDeviceSize peakBytes;
+
+        // Share of tracked device memory that holds no resource, 0 to 1
+        [[nodiscard]]
+        auto fragmentation() const -> double;
+        auto writeReport(std::ostream& out) const -> void;
+        auto writeJson(std::ostream& out) const -> void;
+
+        static auto CategoryName(vkc::MemoryCategory category) -> type::cstr;
+    };
+
+    // Device memory allocations tagged with a category and a name
+    // Allocations aren't always used in full, padding from requirements and free space
+    // left by sub-allocation are counted as fragmentation
+    class MemoryTracker : public NonCopyable
+    {
+    public:
+        MemoryTracker() = default;
+        ~MemoryTracker() = default;
+
+        auto add(VkDeviceMemory memory, type::uint32 heap, VkDeviceSize size, VkDeviceSize used, vkc::MemoryCategory category, std::string name) -> void;
+        auto remove(VkDeviceMemory memory) -> void;
+        // For allocations shared by several resources as they come and go
+        auto setUsed(VkDeviceMemory memory, VkDeviceSize used) -> void;
+
+        // Memory the device doesn't allocate, such as swap chain images, keyed by the object owning it
+        auto addExternal(const void* owner, VkDeviceSize size, vkc::MemoryCategory category, std::string name) -> void;
+        auto removeExternal(const void* owner) -> void;
+
+        // Heaps are filled in by the device
+        auto snapshot(type::size largest) const -> vkc::MemorySnapshot;
+        // Allocations that are still live, as a list of names
+        auto live() const -> std::vector<std::string>;
+
+    private:
+        struct Allocation
+        {
+            type::uint32 heap;
+            VkDeviceSize size;
+            VkDeviceSize used;
+            vkc::MemoryCategory category;
+            std::string name;
+        };
+
+        mutable std::mutex m_mutex;
+        std::unordered_map<VkDeviceMemory, Allocation> m_allocations;
+        std::unordered_map<const void*, Allocation> m_external;
+        VkDeviceSize m_bytes = 0;
+        VkDeviceSize m_peakBytes = 0;
+    };
+}
+
+#endif //VULKANCUBE_MEMORYTRACKER_H
@@ -0,0 +1,39 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#ifndef VULKANCUBE_MEMORYUSAGE_H
+#define VULKANCUBE_MEMORYUSAGE_H
+
+#include <vulkan/vulkan.h>
+
+namespace vkc
+{
+    // How memory is accessed, ranks the memory types of a device for an allocation
+    enum class MemoryUsage
+    {
+        // Only accessed by the GPU. Filled through a staging buffer, or written directly when the device allows it
+        GpuOnly,
+        // Written once by the CPU and copied from by the GPU, such as staging buffers
+        Upload,
+        // Written by the GPU and read back by the CPU
+        Readback,
+        // Rewritten by the CPU every frame and read by the GPU, such as uniform buffers
+        Dynamic
+    };
+
+    // Room left in one memory heap
+    struct HeapBudget
+    {
+        // Bytes the process can allocate from the heap without oversubscribing it
+        VkDeviceSize budget;
+        // Bytes the process has allocated from the heap
+        VkDeviceSize usage;
+
+        [[nodiscard]]
+        inline auto available() const -> VkDeviceSize { return budget > usage ? budget - usage : 0; }
+    };
+}
+
+#endif //VULKANCUBE_MEMORYUSAGE_H
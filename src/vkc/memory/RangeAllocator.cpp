@@ -0,0 +1,92 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#include <algorithm>
+#include "RangeAllocator.h"
+
+vkc::RangeAllocator::RangeAllocator(VkDeviceSize size) :
+        m_size(size),
+        m_used(0)
+{
+    m_free[0] = size;
+}
+
+auto vkc::RangeAllocator::allocate(VkDeviceSize size, VkDeviceSize alignment) -> std::optional<VkDeviceSize>
+{
+    if(size == 0)
+    {
+        return std::nullopt;
+    }
+    alignment = std::max<VkDeviceSize>(alignment, 1);
+
+    // Smallest free range holding the aligned allocation, so large ranges are kept for large allocations
+    auto best = m_free.end();
+    VkDeviceSize bestOffset = 0;
+    for(auto it = m_free.begin(); it != m_free.end(); ++it)
+    {
+        VkDeviceSize offset = (it->first + alignment - 1) / alignment * alignment;
+        if(offset + size > it->first + it->second)
+        {
+            continue;
+        }
+        if(best == m_free.end() || it->second < best->second)
+        {
+            best = it;
+            bestOffset = offset;
+        }
+    }
+    if(best == m_free.end())
+    {
+        return std::nullopt;
+    }
+
+    // Split off the padding before and the rest after
+    VkDeviceSize start = best->first;
+    VkDeviceSize end = best->first + best->second;
+    m_free.erase(best);
+    if(bestOffset > start)
+    {
+        m_free[start] = bestOffset - start;
+    }
+    if(bestOffset + size < end)
+    {
+        m_free[bestOffset + size] = end - (bestOffset + size);
+    }
+    m_used += size;
+    return bestOffset;
+}
+
+auto vkc::RangeAllocator::free(VkDeviceSize offset, VkDeviceSize size) -> void
+{
+    m_used -= size;
+
+    auto it = m_free.emplace(offset, size).first;
+    // Merge with the next range, then the previous
+    auto next = std::next(it);
+    if(next != m_free.end() && it->first + it->second == next->first)
+    {
+        it->second += next->second;
+        m_free.erase(next);
+    }
+    if(it != m_free.begin())
+    {
+        auto prev = std::prev(it);
+        if(prev->first + prev->second == it->first)
+        {
+            prev->second += it->second;
+            m_free.erase(it);
+        }
+    }
+}
+
+auto vkc::RangeAllocator::largestFree() const -> VkDeviceSize
+{
+    VkDeviceSize largest = 0;
+    for(const auto& [offset, size] : m_free)
+    {
+        largest = std::max(largest, size);
+    }
+    return largest;
+}
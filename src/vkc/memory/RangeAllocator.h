@@ -0,0 +1,44 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#ifndef VULKANCUBE_RANGEALLOCATOR_H
+#define VULKANCUBE_RANGEALLOCATOR_H
+
+#include <vulkan/vulkan.h>
+#include <map>
+#include <optional>
+#include "../Types.h"
+
+namespace vkc
+{
+    // Hands out ranges of a block of the given size. Best fit, and freed ranges merge with free neighbours
+    // Alignment padding stays free, so ranges are freed with the offset and size they were allocated with
+    class RangeAllocator
+    {
+    public:
+        explicit RangeAllocator(VkDeviceSize size);
+
+        // Offset of the range, or nothing when no free range fits it
+        auto allocate(VkDeviceSize size, VkDeviceSize alignment) -> std::optional<VkDeviceSize>;
+        auto free(VkDeviceSize offset, VkDeviceSize size) -> void;
+
+        [[nodiscard]]
+        inline auto size() const -> VkDeviceSize { return m_size; }
+        [[nodiscard]]
+        inline auto used() const -> VkDeviceSize { return m_used; }
+        [[nodiscard]]
+        inline auto empty() const -> bool { return m_used == 0; }
+        [[nodiscard]]
+        auto largestFree() const -> VkDeviceSize;
+
+    private:
+        VkDeviceSize m_size;
+        VkDeviceSize m_used;
+        // Size of each free range, by offset
+        std::map<VkDeviceSize, VkDeviceSize> m_free;
+    };
+}
+
+#endif //VULKANCUBE_RANGEALLOCATOR_H
@@ -0,0 +1,235 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+#include "MeshFile.h"
+#include "MeshOptimizer.h"
+#include "../CompactVertex.h"
+#include "../profile/Profiler.h"
+
+namespace
+{
+    auto IndexTypeOfSize(type::uint32 size) -> VkIndexType
+    {
+        switch(size)
+        {
+            case 1: return VK_INDEX_TYPE_UINT8_EXT;
+            case 2: return VK_INDEX_TYPE_UINT16;
+            case 4: return VK_INDEX_TYPE_UINT32;
+            default: throw std::runtime_error("Mesh file index size isn't 1, 2 or 4 bytes");
+        }
+    }
+
+    auto AlignUp(type::uint64 offset, type::uint64 alignment) -> type::uint64
+    {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    // Ranges of every mesh, sorted, must follow on from each other from 0 to size
+    template<typename Range>
+    auto Tiles(std::vector<Range> ranges, type::uint64 size) -> bool
+    {
+        std::sort(ranges.begin(), ranges.end());
+        type::uint64 next = 0;
+        for(const Range& range : ranges)
+        {
+            if(range.first != next)
+            {
+                return false;
+            }
+            next += range.second;
+        }
+        return next == size;
+    }
+}
+
+auto vkc::mesh::VertexStride(MeshVertexFormat format) -> type::uint32
+{
+    switch(format)
+    {
+        case MeshVertexFormat::Compact: return sizeof(vkc::CompactVertex);
+        case MeshVertexFormat::CompactMesh: return sizeof(vkc::CompactMeshVertex);
+        default: throw std::runtime_error("Unknown mesh vertex format");
+    }
+}
+
+vkc::mesh::MeshFile::MeshFile(const std::string& path) :
+        m_file(path),
+        m_header()
+{
+    std::span<const std::byte> data = m_file.data();
+    if(data.size() < sizeof(MeshFileHeader))
+    {
+        throw std::runtime_error(path + " is too small to be a mesh file");
+    }
+    std::memcpy(&m_header, data.data(), sizeof(MeshFileHeader));
+    if(m_header.magic != MeshFileMagic)
+    {
+        throw std::runtime_error(path + " isn't a mesh file");
+    }
+    if(m_header.version != MeshFileVersion)
+    {
+        throw std::runtime_error(path + " is mesh file version " + std::to_string(m_header.version) + ", expected " + std::to_string(MeshFileVersion));
+    }
+    if(m_header.vertexStride != VertexStride(m_header.vertexFormat))
+    {
+        throw std::runtime_error(path + " vertex stride doesn't match its format");
+    }
+
+    type::uint64 tableSize = static_cast<type::uint64>(m_header.meshCount) * sizeof(MeshFileEntry);
+    type::uint64 vertexSize = static_cast<type::uint64>(m_header.vertexCount) * m_header.vertexStride;
+    if(m_header.meshTableOffset + tableSize > data.size() ||
+       m_header.vertexDataOffset + vertexSize > data.size() ||
+       m_header.indexDataOffset + m_header.indexDataSize > data.size())
+    {
+        throw std::runtime_error(path + " is truncated");
+    }
+    m_meshes.resize(m_header.meshCount);
+    std::memcpy(m_meshes.data(), data.data() + m_header.meshTableOffset, tableSize);
+
+    // Every vertex and index byte belongs to exactly one mesh, so removing the meshes frees all of them
+    std::vector<std::pair<type::uint64, type::uint64>> vertexRanges;
+    std::vector<std::pair<type::uint64, type::uint64>> indexRanges;
+    for(const MeshFileEntry& mesh : m_meshes)
+    {
+        IndexTypeOfSize(mesh.indexSize);
+        if(mesh.vertexCount == 0 || mesh.indexCount == 0)
+        {
+            throw std::runtime_error(path + " has an empty mesh");
+        }
+        vertexRanges.emplace_back(mesh.firstVertex, mesh.vertexCount);
+        indexRanges.emplace_back(static_cast<type::uint64>(mesh.firstIndex) * mesh.indexSize, static_cast<type::uint64>(mesh.indexCount) * mesh.indexSize);
+    }
+    if(!Tiles(std::move(vertexRanges), m_header.vertexCount) || !Tiles(std::move(indexRanges), m_header.indexDataSize))
+    {
+        throw std::runtime_error(path + " mesh table doesn't match its vertex and index data");
+    }
+}
+
+auto vkc::mesh::MeshFile::vertexData() const -> std::span<const std::byte>
+{
+    return m_file.data().subspan(m_header.vertexDataOffset, static_cast<type::size>(m_header.vertexCount) * m_header.vertexStride);
+}
+
+auto vkc::mesh::MeshFile::indexData() const -> std::span<const std::byte>
+{
+    return m_file.data().subspan(m_header.indexDataOffset, m_header.indexDataSize);
+}
+
+auto vkc::mesh::MeshFile::upload(vkc::GeometryPool& geometry) const -> std::vector<vkc::GeometryPool::Mesh>
+{
+    VKC_ZONE("MeshFile::upload");
+
+    if(geometry.vertexStride() != m_header.vertexStride)
+    {
+        throw std::runtime_error("Mesh file vertex stride doesn't match the geometry pool's");
+    }
+    if(m_meshes.empty())
+    {
+        return {};
+    }
+
+    std::vector<vkc::GeometryPool::Mesh> meshes;
+    meshes.reserve(m_meshes.size());
+    for(const MeshFileEntry& entry : m_meshes)
+    {
+        vkc::GeometryPool::Mesh mesh;
+        mesh.firstIndex = entry.firstIndex;
+        mesh.vertexOffset = static_cast<std::int32_t>(entry.firstVertex);
+        mesh.indexCount = entry.indexCount;
+        mesh.vertexCount = entry.vertexCount;
+        mesh.indexType = IndexTypeOfSize(entry.indexSize);
+        meshes.push_back(mesh);
+    }
+    return geometry.addBatch(vertexData().data(), m_header.vertexCount, indexData().data(), m_header.indexDataSize, meshes);
+}
+
+auto vkc::mesh::WriteMeshFile(const std::string& path, MeshVertexFormat format, std::span<const MeshData> meshes) -> void
+{
+    type::uint32 stride = VertexStride(format);
+
+    MeshFileHeader header = {};
+    header.magic = MeshFileMagic;
+    header.version = MeshFileVersion;
+    header.vertexFormat = format;
+    header.vertexStride = stride;
+    header.meshCount = static_cast<type::uint32>(meshes.size());
+    header.meshTableOffset = AlignUp(sizeof(MeshFileHeader), alignof(MeshFileEntry));
+
+    std::vector<MeshFileEntry> table(meshes.size());
+    glm::vec3 boundsMin(0.0f);
+    glm::vec3 boundsMax(0.0f);
+    for(type::size i = 0; i < meshes.size(); ++i)
+    {
+        if(meshes[i].vertices.size() != static_cast<type::size>(meshes[i].vertexCount) * stride ||
+           meshes[i].indices.size() != meshes[i].indexCount * IndexSize(meshes[i].indexType))
+        {
+            throw std::runtime_error("Mesh data sizes don't match its counts");
+        }
+        table[i].firstVertex = header.vertexCount;
+        table[i].vertexCount = meshes[i].vertexCount;
+        table[i].indexCount = meshes[i].indexCount;
+        table[i].indexSize = static_cast<type::uint32>(IndexSize(meshes[i].indexType));
+        for(int axis = 0; axis < 3; ++axis)
+        {
+            table[i].boundsMin[axis] = meshes[i].boundsMin[axis];
+            table[i].boundsMax[axis] = meshes[i].boundsMax[axis];
+            boundsMin[axis] = i == 0 ? meshes[i].boundsMin[axis] : std::min(boundsMin[axis], meshes[i].boundsMin[axis]);
+            boundsMax[axis] = i == 0 ? meshes[i].boundsMax[axis] : std::max(boundsMax[axis], meshes[i].boundsMax[axis]);
+        }
+        header.vertexCount += meshes[i].vertexCount;
+    }
+    for(int axis = 0; axis < 3; ++axis)
+    {
+        header.boundsMin[axis] = boundsMin[axis];
+        header.boundsMax[axis] = boundsMax[axis];
+    }
+
+    // Widest first, every size is a multiple of the ones after it so each mesh starts aligned
+    std::vector<type::size> indexOrder(meshes.size());
+    std::iota(indexOrder.begin(), indexOrder.end(), 0);
+    std::stable_sort(indexOrder.begin(), indexOrder.end(), [&table](type::size a, type::size b) { return table[a].indexSize > table[b].indexSize; });
+    for(type::size i : indexOrder)
+    {
+        table[i].firstIndex = static_cast<type::uint32>(header.indexDataSize / table[i].indexSize);
+        header.indexDataSize += meshes[i].indices.size();
+    }
+
+    header.vertexDataOffset = AlignUp(header.meshTableOffset + table.size() * sizeof(MeshFileEntry), MeshFileAlignment);
+    header.indexDataOffset = AlignUp(header.vertexDataOffset + static_cast<type::uint64>(header.vertexCount) * stride, MeshFileAlignment);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if(!file)
+    {
+        throw std::runtime_error("Failed to open " + path + " for writing");
+    }
+    auto padTo = [&file](type::uint64 offset)
+    {
+        static constexpr char zeros[MeshFileAlignment] = {};
+        auto at = static_cast<type::uint64>(file.tellp());
+        file.write(zeros, static_cast<std::streamsize>(offset - at));
+    };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    padTo(header.meshTableOffset);
+    file.write(reinterpret_cast<const char*>(table.data()), static_cast<std::streamsize>(table.size() * sizeof(MeshFileEntry)));
+    padTo(header.vertexDataOffset);
+    for(const MeshData& mesh : meshes)
+    {
+        file.write(reinterpret_cast<const char*>(mesh.vertices.data()), static_cast<std::streamsize>(mesh.vertices.size()));
+    }
+    padTo(header.indexDataOffset);
+    for(type::size i : indexOrder)
+    {
+        file.write(reinterpret_cast<const char*>(meshes[i].indices.data()), static_cast<std::streamsize>(meshes[i].indices.size()));
+    }
+    if(!file)
+    {
+        throw std::runtime_error("Failed to write " + path);
+    }
+}
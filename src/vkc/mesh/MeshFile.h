@@ -0,0 +1,121 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#ifndef VULKANCUBE_MESHFILE_H
+#define VULKANCUBE_MESHFILE_H
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.h>
+#include <cstddef>
+#include <span>
+#include <string>
+#include <vector>
+#include "../FileIO.h"
+#include "../NonCopyable.h"
+#include "../Types.h"
+#include "../buffer/GeometryPool.h"
+
+// Binary container of meshes ready to upload, written offline by vkc_meshconv
+// A header, a table of meshes, then the vertices and indices of every mesh in the layout the GPU reads them,
+// each starting on a page. Loading maps the file and copies the pages straight into the geometry buffers,
+// so it's bound by I/O rather than parsing
+namespace vkc::mesh
+{
+    // "VKCM" in a little endian file
+    constexpr type::uint32 MeshFileMagic = 0x4D434B56;
+    constexpr type::uint32 MeshFileVersion = 1;
+    // Both blobs start on a multiple of this, the page size of most hosts
+    constexpr type::uint64 MeshFileAlignment = 4096;
+
+    enum class MeshVertexFormat : type::uint32
+    {
+        // vkc::CompactVertex, what VulkanCube draws
+        Compact = 1,
+        // vkc::CompactMeshVertex
+        CompactMesh = 2
+    };
+    auto VertexStride(MeshVertexFormat format) -> type::uint32;
+
+    struct MeshFileHeader
+    {
+        type::uint32 magic;
+        type::uint32 version;
+        MeshVertexFormat vertexFormat;
+        type::uint32 vertexStride;
+        type::uint32 vertexCount;
+        type::uint32 meshCount;
+        // Byte offsets from the start of the file
+        type::uint64 meshTableOffset;
+        type::uint64 vertexDataOffset;
+        type::uint64 indexDataOffset;
+        type::uint64 indexDataSize;
+        // Of every mesh
+        float boundsMin[3];
+        float boundsMax[3];
+    };
+
+    struct MeshFileEntry
+    {
+        // In vertices from the start of the vertex data
+        type::uint32 firstVertex;
+        type::uint32 vertexCount;
+        // In indices of this mesh's size from the start of the index data
+        type::uint32 firstIndex;
+        type::uint32 indexCount;
+        // 1, 2 or 4 bytes
+        type::uint32 indexSize;
+        type::uint32 reserved;
+        float boundsMin[3];
+        float boundsMax[3];
+    };
+
+    static_assert(sizeof(MeshFileHeader) == 80, "Mesh file header layout changed");
+    static_assert(sizeof(MeshFileEntry) == 48, "Mesh file entry layout changed");
+
+    // Mapped mesh file. Throws if it isn't one, or its tables don't describe its data
+    // Indices aren't checked against vertex counts, files are trusted as the converter wrote them
+    class MeshFile : public NonCopyable
+    {
+    public:
+        explicit MeshFile(const std::string& path);
+        ~MeshFile() = default;
+
+        // Every mesh, in table order, with a single copy of each blob from the mapped pages
+        // The geometry pool's vertex stride must match the file's
+        auto upload(vkc::GeometryPool& geometry) const -> std::vector<vkc::GeometryPool::Mesh>;
+
+        [[nodiscard]]
+        inline auto header() const -> const MeshFileHeader& { return m_header; }
+        [[nodiscard]]
+        inline auto meshes() const -> std::span<const MeshFileEntry> { return m_meshes; }
+        [[nodiscard]]
+        auto vertexData() const -> std::span<const std::byte>;
+        [[nodiscard]]
+        auto indexData() const -> std::span<const std::byte>;
+
+    private:
+        vkc::FileIO::MappedFile m_file;
+        // Copied out of the mapping, they're small and read more than once
+        MeshFileHeader m_header;
+        std::vector<MeshFileEntry> m_meshes;
+    };
+
+    // One mesh to write, already in its vertex format and packed to its index type
+    struct MeshData
+    {
+        std::vector<std::byte> vertices;
+        type::uint32 vertexCount = 0;
+        std::vector<std::byte> indices;
+        type::uint32 indexCount = 0;
+        VkIndexType indexType = VK_INDEX_TYPE_UINT16;
+        glm::vec3 boundsMin = glm::vec3(0.0f);
+        glm::vec3 boundsMax = glm::vec3(0.0f);
+    };
+
+    // Indices are laid out widest type first, so every mesh's stay aligned without padding
+    auto WriteMeshFile(const std::string& path, MeshVertexFormat format, std::span<const MeshData> meshes) -> void;
+}
+
+#endif //VULKANCUBE_MESHFILE_H
@@ -0,0 +1,369 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include "MeshOptimizer.h"
+
+namespace
+{
+    // Forsyth's scoring, cache positions beyond MaxCache score nothing
+    constexpr type::uint32 MaxCache = 32;
+    constexpr float CacheDecayPower = 1.5f;
+    constexpr float LastTriangleScore = 0.75f;
+    constexpr float ValenceBoostScale = 2.0f;
+    constexpr float ValenceBoostPower = 0.5f;
+
+    auto VertexScore(std::int32_t cachePosition, type::uint32 remaining) -> float
+    {
+        if(remaining == 0)
+        {
+            return -1.0f;
+        }
+
+        float score = 0.0f;
+        if(cachePosition >= 0)
+        {
+            // The last triangle's vertices score a fixed amount, so the next triangle doesn't
+            // just reuse the edge it shares with the last, which strips rather than fans
+            if(cachePosition < 3)
+            {
+                score = LastTriangleScore;
+            }
+            else
+            {
+                float scale = 1.0f / static_cast<float>(MaxCache - 3);
+                score = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scale, CacheDecayPower);
+            }
+        }
+        // Vertices with few triangles left are finished off, rather than left to miss later
+        score += ValenceBoostScale * std::pow(static_cast<float>(remaining), -ValenceBoostPower);
+        return score;
+    }
+}
+
+auto vkc::mesh::ACMR(std::span<const type::uint32> indices, type::uint32 vertexCount, type::uint32 cacheSize) -> double
+{
+    if(indices.size() < 3)
+    {
+        return 0.0;
+    }
+
+    // Time each vertex entered the cache, it's still there while fewer than cacheSize misses have happened since
+    std::vector<type::uint64> entered(vertexCount, 0);
+    type::uint64 misses = 0;
+    for(type::uint32 index : indices)
+    {
+        if(entered[index] == 0 || misses - entered[index] >= cacheSize)
+        {
+            ++misses;
+            entered[index] = misses;
+        }
+    }
+    return static_cast<double>(misses) / static_cast<double>(indices.size() / 3);
+}
+
+auto vkc::mesh::OptimizeVertexCache(std::span<type::uint32> indices, type::uint32 vertexCount) -> void
+{
+    type::size triangleCount = indices.size() / 3;
+    if(triangleCount == 0)
+    {
+        return;
+    }
+
+    // Triangles of each vertex, packed one vertex after another
+    std::vector<type::uint32> remaining(vertexCount, 0);
+    for(type::uint32 index : indices)
+    {
+        ++remaining[index];
+    }
+    std::vector<type::uint32> firstTriangle(vertexCount + 1, 0);
+    std::partial_sum(remaining.begin(), remaining.end(), firstTriangle.begin() + 1);
+    std::vector<type::uint32> triangles(indices.size());
+    {
+        std::vector<type::uint32> filled(firstTriangle.begin(), firstTriangle.end() - 1);
+        for(type::size i = 0; i < indices.size(); ++i)
+        {
+            triangles[filled[indices[i]]++] = static_cast<type::uint32>(i / 3);
+        }
+    }
+
+    std::vector<std::int32_t> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    for(type::uint32 v = 0; v < vertexCount; ++v)
+    {
+        vertexScore[v] = VertexScore(-1, remaining[v]);
+    }
+    std::vector<float> triangleScore(triangleCount);
+    for(type::size t = 0; t < triangleCount; ++t)
+    {
+        triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+    }
+    std::vector<bool> emitted(triangleCount, false);
+
+    std::vector<type::uint32> output;
+    output.reserve(indices.size());
+    // Three more than MaxCache, so the vertices of the triangle just emitted can push out three others
+    std::vector<type::uint32> cache;
+    cache.reserve(MaxCache + 3);
+
+    type::size best = 0;
+    // Triangles before it were all emitted, so the fallback scan never restarts from the beginning
+    type::size cursor = 0;
+    while(output.size() < indices.size())
+    {
+        const type::uint32* triangle = &indices[best * 3];
+        output.insert(output.end(), triangle, triangle + 3);
+        emitted[best] = true;
+
+        // Move the triangle's vertices to the front of the cache, and take the triangle off their lists
+        std::vector<type::uint32> updated(triangle, triangle + 3);
+        for(type::uint32 v : updated)
+        {
+            auto it = std::find(cache.begin(), cache.end(), v);
+            if(it != cache.end())
+            {
+                cache.erase(it);
+            }
+
+            type::uint32* begin = &triangles[firstTriangle[v]];
+            type::uint32* end = begin + remaining[v];
+            std::iter_swap(std::find(begin, end, static_cast<type::uint32>(best)), end - 1);
+            --remaining[v];
+        }
+        // Degenerate triangles repeat a vertex, which only takes one cache entry
+        std::vector<type::uint32> front;
+        for(type::uint32 v : updated)
+        {
+            if(std::find(front.begin(), front.end(), v) == front.end())
+            {
+                front.push_back(v);
+            }
+        }
+        cache.insert(cache.begin(), front.begin(), front.end());
+        for(type::size i = MaxCache; i < cache.size(); ++i)
+        {
+            cachePosition[cache[i]] = -1;
+            updated.push_back(cache[i]);
+        }
+        cache.resize(std::min<type::size>(cache.size(), MaxCache));
+
+        // Rescore the vertices that moved, and the triangles still using them
+        for(type::size i = 0; i < cache.size(); ++i)
+        {
+            cachePosition[cache[i]] = static_cast<std::int32_t>(i);
+        }
+        for(type::uint32 v : cache)
+        {
+            updated.push_back(v);
+        }
+        std::sort(updated.begin(), updated.end());
+        updated.erase(std::unique(updated.begin(), updated.end()), updated.end());
+
+        float bestScore = -1.0f;
+        for(type::uint32 v : updated)
+        {
+            float score = VertexScore(cachePosition[v], remaining[v]);
+            float delta = score - vertexScore[v];
+            vertexScore[v] = score;
+            for(type::uint32 i = 0; i < remaining[v]; ++i)
+            {
+                type::uint32 t = triangles[firstTriangle[v] + i];
+                triangleScore[t] += delta;
+            }
+        }
+        // Only triangles of cached vertices can have gained score, the rest are found by the scan below
+        for(type::uint32 v : cache)
+        {
+            for(type::uint32 i = 0; i < remaining[v]; ++i)
+            {
+                type::uint32 t = triangles[firstTriangle[v] + i];
+                if(triangleScore[t] > bestScore)
+                {
+                    bestScore = triangleScore[t];
+                    best = t;
+                }
+            }
+        }
+
+        if(bestScore < 0.0f && output.size() < indices.size())
+        {
+            // Nothing left around the cache, so start on the next triangle not yet emitted
+            while(emitted[cursor])
+            {
+                ++cursor;
+            }
+            best = cursor;
+        }
+    }
+
+    std::copy(output.begin(), output.end(), indices.begin());
+}
+
+auto vkc::mesh::OptimizeOverdraw(std::span<type::uint32> indices, std::span<const glm::vec3> positions, float threshold) -> void
+{
+    type::size triangleCount = indices.size() / 3;
+    if(triangleCount == 0)
+    {
+        return;
+    }
+
+    // Clusters are drawn in a new order, so each starts with a cold cache. Grow them until their ACMR
+    // counting that start is within threshold of the whole mesh's, so reordering costs little cache reuse
+    double targetAcmr = ACMR(indices, static_cast<type::uint32>(positions.size())) * threshold;
+    std::vector<type::size> clusters = {0};
+    {
+        std::vector<type::uint64> entered(positions.size(), 0);
+        type::uint64 total = 0;
+        type::uint64 clusterStart = 0;
+        type::uint32 clusterMisses = 0;
+        for(type::size t = 0; t < triangleCount; ++t)
+        {
+            for(type::size corner = 0; corner < 3; ++corner)
+            {
+                type::uint32 index = indices[t * 3 + corner];
+                if(entered[index] <= clusterStart || total - entered[index] >= CacheSize)
+                {
+                    ++total;
+                    entered[index] = total;
+                    ++clusterMisses;
+                }
+            }
+            double clusterAcmr = static_cast<double>(clusterMisses) / static_cast<double>(t + 1 - clusters.back());
+            if(t + 1 < triangleCount && clusterAcmr <= targetAcmr)
+            {
+                clusters.push_back(t + 1);
+                clusterStart = total;
+                clusterMisses = 0;
+            }
+        }
+    }
+    clusters.push_back(triangleCount);
+
+    // Area weighted centroid of the mesh, and of each cluster with its normal
+    glm::vec3 meshCentroid(0.0f);
+    float meshArea = 0.0f;
+    std::vector<glm::vec3> clusterCentroid(clusters.size() - 1, glm::vec3(0.0f));
+    std::vector<glm::vec3> clusterNormal(clusters.size() - 1, glm::vec3(0.0f));
+    for(type::size c = 0; c + 1 < clusters.size(); ++c)
+    {
+        float area = 0.0f;
+        for(type::size t = clusters[c]; t < clusters[c + 1]; ++t)
+        {
+            const glm::vec3& a = positions[indices[t * 3]];
+            const glm::vec3& b = positions[indices[t * 3 + 1]];
+            const glm::vec3& d = positions[indices[t * 3 + 2]];
+            // Twice the area, the factor cancels out
+            glm::vec3 normal = glm::cross(b - a, d - a);
+            float triangleArea = glm::length(normal);
+            glm::vec3 centroid = (a + b + d) / 3.0f;
+
+            clusterCentroid[c] += centroid * triangleArea;
+            clusterNormal[c] += normal;
+            area += triangleArea;
+        }
+        meshCentroid += clusterCentroid[c];
+        meshArea += area;
+        clusterCentroid[c] = area > 0.0f ? clusterCentroid[c] / area : clusterCentroid[c];
+        float length = glm::length(clusterNormal[c]);
+        clusterNormal[c] = length > 0.0f ? clusterNormal[c] / length : clusterNormal[c];
+    }
+    meshCentroid = meshArea > 0.0f ? meshCentroid / meshArea : meshCentroid;
+
+    // Clusters facing out from the centre are likelier to occlude than be occluded, so they go first
+    std::vector<type::size> order(clusters.size() - 1);
+    std::iota(order.begin(), order.end(), 0);
+    std::vector<float> facing(order.size());
+    for(type::size c = 0; c < order.size(); ++c)
+    {
+        facing[c] = glm::dot(clusterCentroid[c] - meshCentroid, clusterNormal[c]);
+    }
+    std::stable_sort(order.begin(), order.end(), [&facing](type::size a, type::size b) { return facing[a] > facing[b]; });
+
+    std::vector<type::uint32> output;
+    output.reserve(indices.size());
+    for(type::size c : order)
+    {
+        output.insert(output.end(), indices.begin() + static_cast<std::ptrdiff_t>(clusters[c] * 3), indices.begin() + static_cast<std::ptrdiff_t>(clusters[c + 1] * 3));
+    }
+    std::copy(output.begin(), output.end(), indices.begin());
+}
+
+auto vkc::mesh::OptimizeVertexFetch(std::span<type::uint32> indices, type::uint32 vertexCount) -> std::vector<type::uint32>
+{
+    std::vector<type::uint32> remap(vertexCount, type::uint32_max);
+    type::uint32 next = 0;
+    for(type::uint32& index : indices)
+    {
+        if(remap[index] == type::uint32_max)
+        {
+            remap[index] = next++;
+        }
+        index = remap[index];
+    }
+    return remap;
+}
+
+auto vkc::mesh::IndexTypeFor(type::uint32 vertexCount, bool uint8Supported) -> VkIndexType
+{
+    if(uint8Supported && vertexCount <= 256)
+    {
+        return VK_INDEX_TYPE_UINT8_EXT;
+    }
+    return vertexCount <= 65536 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+}
+
+auto vkc::mesh::IndexSize(VkIndexType indexType) -> type::size
+{
+    switch(indexType)
+    {
+        case VK_INDEX_TYPE_UINT8_EXT: return 1;
+        case VK_INDEX_TYPE_UINT16: return 2;
+        case VK_INDEX_TYPE_UINT32: return 4;
+        default: throw std::runtime_error("Unknown index type");
+    }
+}
+
+auto vkc::mesh::PackIndices(std::span<const type::uint32> indices, VkIndexType indexType) -> std::vector<std::byte>
+{
+    std::vector<std::byte> packed(indices.size() * IndexSize(indexType));
+    auto pack = [&indices, &packed]<typename T>(T)
+    {
+        for(type::size i = 0; i < indices.size(); ++i)
+        {
+            auto index = static_cast<T>(indices[i]);
+            std::memcpy(packed.data() + i * sizeof(T), &index, sizeof(T));
+        }
+    };
+    switch(indexType)
+    {
+        case VK_INDEX_TYPE_UINT8_EXT: pack(type::uint8()); break;
+        case VK_INDEX_TYPE_UINT16: pack(type::uint16()); break;
+        default: pack(type::uint32()); break;
+    }
+    return packed;
+}
+
+auto vkc::mesh::Optimize(std::vector<type::uint32>& indices, std::span<const glm::vec3> positions, bool uint8Supported) -> vkc::mesh::OptimizeResult
+{
+    if(indices.size() % 3 != 0)
+    {
+        throw std::runtime_error("Mesh indices aren't a triangle list");
+    }
+    auto vertexCount = static_cast<type::uint32>(positions.size());
+
+    vkc::mesh::OptimizeResult result;
+    result.acmrBefore = ACMR(indices, vertexCount);
+    OptimizeVertexCache(indices, vertexCount);
+    OptimizeOverdraw(indices, positions);
+    result.remap = OptimizeVertexFetch(indices, vertexCount);
+    result.vertexCount = static_cast<type::uint32>(std::count_if(result.remap.begin(), result.remap.end(), [](type::uint32 index) { return index != type::uint32_max; }));
+    result.acmrAfter = ACMR(indices, result.vertexCount);
+    result.indexType = IndexTypeFor(result.vertexCount, uint8Supported);
+    return result;
+}
@@ -0,0 +1,79 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#ifndef VULKANCUBE_MESHOPTIMIZER_H
+#define VULKANCUBE_MESHOPTIMIZER_H
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.h>
+#include <cstddef>
+#include <span>
+#include <vector>
+#include "../Types.h"
+
+// Reordering of triangle lists for the GPU's post-transform vertex cache, overdraw and vertex fetch
+// Stages run on 32 bit indices, and PackIndices narrows them to the type the mesh is uploaded with
+namespace vkc::mesh
+{
+    // FIFO cache size ACMR is measured with, about what desktop GPUs reuse between triangles
+    constexpr type::uint32 CacheSize = 16;
+
+    // Average cache miss ratio, vertices transformed per triangle, with a FIFO cache of cacheSize vertices
+    // 3 when no vertex is reused, approaching 0.5 for large regular grids
+    auto ACMR(std::span<const type::uint32> indices, type::uint32 vertexCount, type::uint32 cacheSize = CacheSize) -> double;
+
+    // Forsyth's linear speed vertex cache optimisation. Reorders triangles in place, greedily emitting
+    // the triangle whose vertices score highest for being recently used and having few triangles left
+    auto OptimizeVertexCache(std::span<type::uint32> indices, type::uint32 vertexCount) -> void;
+
+    // Sander, Nehab and Barczak's fast triangle reordering. Splits cache optimized triangles into clusters
+    // whose ACMR, starting from a cold cache, is within threshold of the whole mesh's,
+    // then draws clusters facing away from the mesh's centre first so they occlude those behind them
+    auto OptimizeOverdraw(std::span<type::uint32> indices, std::span<const glm::vec3> positions, float threshold = 1.05f) -> void;
+
+    // Renumbers vertices in the order indices first use them, so vertex fetches walk memory forwards
+    // Returns the new index of each vertex, or type::uint32_max for vertices no triangle uses
+    auto OptimizeVertexFetch(std::span<type::uint32> indices, type::uint32 vertexCount) -> std::vector<type::uint32>;
+
+    // Vertices rearranged by a remap from OptimizeVertexFetch, dropping unused ones
+    template<typename T>
+    auto Remap(std::span<const T> vertices, std::span<const type::uint32> remap) -> std::vector<T>
+    {
+        type::size count = 0;
+        for(type::uint32 index : remap)
+        {
+            count += index != type::uint32_max;
+        }
+        std::vector<T> out(count);
+        for(type::size i = 0; i < vertices.size(); ++i)
+        {
+            if(remap[i] != type::uint32_max)
+            {
+                out[remap[i]] = vertices[i];
+            }
+        }
+        return out;
+    }
+
+    // Narrowest index type that can address vertexCount vertices. 8 bit only if the device enabled it
+    auto IndexTypeFor(type::uint32 vertexCount, bool uint8Supported) -> VkIndexType;
+    auto IndexSize(VkIndexType indexType) -> type::size;
+    auto PackIndices(std::span<const type::uint32> indices, VkIndexType indexType) -> std::vector<std::byte>;
+
+    struct OptimizeResult
+    {
+        // New index of each vertex, see OptimizeVertexFetch
+        std::vector<type::uint32> remap;
+        type::uint32 vertexCount = 0;
+        double acmrBefore = 0.0;
+        double acmrAfter = 0.0;
+        VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+    };
+
+    // Every stage in order: vertex cache, overdraw, then vertex fetch. The caller remaps its vertices
+    auto Optimize(std::vector<type::uint32>& indices, std::span<const glm::vec3> positions, bool uint8Supported) -> vkc::mesh::OptimizeResult;
+}
+
+#endif //VULKANCUBE_MESHOPTIMIZER_H
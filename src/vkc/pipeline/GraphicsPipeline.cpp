@@ -3,103 +3,426 @@
   * https://github.com/Mnenmenth
   */
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
 #include <iostream>
+#include <thread>
 #include "GraphicsPipeline.h"
 #include "../Types.h"
-#include "SwapChain.h"
+#include "RenderTarget.h"
 #include "RenderPass.h"
 #include "../Device.h"
 #include "ShaderDetails.h"
+#include "ShaderReflection.h"
+#include "PipelineCache.h"
+#include "../DeletionQueue.h"
+#include "../descriptor/DescriptorLayoutCache.h"
 #include "../FileIO.h"
+#include "../profile/Profiler.h"
+
+namespace
+{
+    inline auto HashCombine(type::size seed, type::size value) -> type::size
+    {
+        return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+    }
+}
+
+auto vkc::PipelineVariantHash::operator()(const PipelineVariant& variant) const -> type::size
+{
+    type::size hash = variant.constants.size();
+    for(const SpecializationConstant& constant : variant.constants)
+    {
+        hash = HashCombine(hash, constant.id);
+        hash = HashCombine(hash, constant.value);
+    }
+    hash = HashCombine(hash, variant.cullMode);
+    hash = HashCombine(hash, variant.topology);
+    hash = HashCombine(hash, variant.blend);
+    return hash;
+}
 
 vkc::GraphicsPipeline::GraphicsPipeline(
         const vkc::Device& device,
-        const vkc::SwapChain& swapChain,
-        const vkc::RenderPass& renderPass,
-        const std::vector<VkDescriptorSetLayout>& descriptorLayouts,
-        const std::vector<ShaderDetails>& shaderDetails,
-        const std::vector<VkVertexInputBindingDescription>& bindingDescs,
-        const std::vector<VkVertexInputAttributeDescription>& attrDescs
+        const vkc::RenderTarget& target,
+        const vkc::RenderPass* renderPass,
+        vkc::DescriptorLayoutCache& layouts,
+        std::span<const ShaderDetails> shaderDetails,
+        std::span<const VkVertexInputBindingDescription> bindingDescs,
+        std::span<const VkVertexInputAttributeDescription> attrDescs,
+        VkSampleCountFlagBits samples,
+        vkc::PipelineCache* cache
 ) :
         m_pipeline(VK_NULL_HANDLE),
         m_layout(VK_NULL_HANDLE),
         m_oldLayout(VK_NULL_HANDLE),
 
         m_device(device),
-        m_swapChain(swapChain),
+        m_target(target),
         m_renderPass(renderPass),
 
-        m_descriptorLayouts(descriptorLayouts),
-        m_shaderDetails(shaderDetails),
+        m_layouts(layouts),
+        m_shaderDetails(shaderDetails.begin(), shaderDetails.end()),
         m_bindingDescs(bindingDescs),
-        m_attrDescs(attrDescs)
+        m_attrDescs(attrDescs),
+        m_samples(samples),
+        m_cache(cache),
+        m_generation(0)
 {
-    createPipeline();
+    loadShaders();
+    m_pipeline = compile({}, m_modules);
+    m_variants.emplace(PipelineVariant{}, m_pipeline);
 }
 
 vkc::GraphicsPipeline::~GraphicsPipeline()
 {
-    vkDestroyPipeline(m_device.logical(), m_pipeline, nullptr);
-    vkDestroyPipelineLayout(m_device.logical(), m_layout, nullptr);
+    destroy();
 }
 
 auto vkc::GraphicsPipeline::recreate() -> void
 {
-    vkDestroyPipeline(m_device.logical(), m_pipeline, nullptr);
-    vkDestroyPipelineLayout(m_device.logical(), m_layout, nullptr);
-    createPipeline();
-}
-
-auto vkc::GraphicsPipeline::createPipeline() -> void
-{
-//    std::vector<VkPipelineShaderStageCreateInfo> shaderStages(m_shaderDetails.size());
-//    for(const ShaderDetails& shader : m_shaderDetails)
-//    {
-//        std::vector<char> code;
-//        FileIO::ReadFile(shader.filePath, code);
-//
-//        VkShaderModule module = createShaderModule(code);
-//
-//        VkPipelineShaderStageCreateInfo stageInfo = {};
-//        stageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-//        stageInfo.stage = shader.stage;
-//        stageInfo.module = module;
-//        // Entry point into the shader (i.e. "main" method)
-//            // It's possible to have multiple entry points in a shader
-//        stageInfo.pName = shader.entryPoint.c_str();
-//        stageInfo.pSpecializationInfo = nullptr;
-//
-//        shaderStages.push_back(stageInfo);
-//    }
-
-    std::vector<char> code;
-    FileIO::ReadFile(m_shaderDetails[0].filePath, code);
-
-    VkShaderModule module = createShaderModule(code);
-
-    VkPipelineShaderStageCreateInfo stageInfo = {};
-    stageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    stageInfo.stage = m_shaderDetails[0].stage;
-    stageInfo.module = module;
-    // Entry point into the shader (i.e. "main" method)
-    // It's possible to have multiple entry points in a shader
-    stageInfo.pName = m_shaderDetails[0].entryPoint.c_str();
-    stageInfo.pSpecializationInfo = nullptr;
-
-    FileIO::ReadFile(m_shaderDetails[1].filePath, code);
-
-    module = createShaderModule(code);
-
-    VkPipelineShaderStageCreateInfo stageInfo1 = {};
-    stageInfo1.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    stageInfo1.stage = m_shaderDetails[1].stage;
-    stageInfo1.module = module;
-    // Entry point into the shader (i.e. "main" method)
-    // It's possible to have multiple entry points in a shader
-    stageInfo1.pName = m_shaderDetails[1].entryPoint.c_str();
-    stageInfo1.pSpecializationInfo = nullptr;
-
-    VkPipelineShaderStageCreateInfo shaderStages[] = { stageInfo, stageInfo1 };
+    std::vector<PipelineVariant> variants;
+    {
+        std::lock_guard lock(m_mutex);
+        for(const auto& [variant, pipeline] : m_variants)
+        {
+            variants.push_back(variant);
+        }
+        ++m_generation;
+    }
+    destroy();
+
+    loadShaders();
+    std::vector<VkPipeline> pipelines = compileAll(variants, m_modules);
+
+    std::lock_guard lock(m_mutex);
+    for(type::size i = 0; i < variants.size(); ++i)
+    {
+        m_variants.emplace(variants[i], pipelines[i]);
+    }
+    m_pipeline = m_variants.at({});
+}
+
+auto vkc::GraphicsPipeline::warmUp(std::span<const PipelineVariant> variants) -> void
+{
+    VKC_ZONE("GraphicsPipeline::warmUp");
+
+    std::vector<PipelineVariant> missing;
+    {
+        std::lock_guard lock(m_mutex);
+        for(const PipelineVariant& variant : variants)
+        {
+            if(!m_variants.contains(variant) && std::find(missing.begin(), missing.end(), variant) == missing.end())
+            {
+                missing.push_back(variant);
+            }
+        }
+    }
+
+    std::vector<VkPipeline> pipelines = compileAll(missing, m_modules);
+
+    std::lock_guard lock(m_mutex);
+    for(type::size i = 0; i < missing.size(); ++i)
+    {
+        // Another thread asked for it while it was compiling
+        if(!m_variants.emplace(missing[i], pipelines[i]).second)
+        {
+            m_device.vk().DestroyPipeline(m_device.logical(), pipelines[i], m_device.allocator());
+        }
+    }
+}
+
+auto vkc::GraphicsPipeline::variant(const PipelineVariant& variant) -> VkPipeline
+{
+    {
+        std::lock_guard lock(m_mutex);
+        auto it = m_variants.find(variant);
+        if(it != m_variants.end())
+        {
+            return it->second;
+        }
+    }
+
+    VkPipeline pipeline = compile(variant, m_modules);
+
+    std::lock_guard lock(m_mutex);
+    auto [it, inserted] = m_variants.emplace(variant, pipeline);
+    if(!inserted)
+    {
+        m_device.vk().DestroyPipeline(m_device.logical(), pipeline, m_device.allocator());
+    }
+    return it->second;
+}
+
+auto vkc::GraphicsPipeline::variantCount() const -> type::size
+{
+    std::lock_guard lock(m_mutex);
+    return m_variants.size();
+}
+
+auto vkc::GraphicsPipeline::prepareReload() -> void
+{
+    VKC_ZONE("GraphicsPipeline::prepareReload");
+
+    // Keeps the layout, target and render pass compiled against from being recreated until the reload is done
+    std::lock_guard reloadLock(m_reloadMutex);
+    auto reload = std::make_unique<Reload>();
+    std::vector<PipelineVariant> variants;
+    {
+        std::lock_guard lock(m_mutex);
+        for(const auto& [variant, pipeline] : m_variants)
+        {
+            variants.push_back(variant);
+        }
+        reload->generation = m_generation;
+    }
+
+    std::vector<std::vector<char>> code = readShaders();
+    // Recorded descriptor sets are only compatible with the layout they were allocated for
+    if(createLayout(code) != m_layout)
+    {
+        throw std::runtime_error("Shader reload changes the pipeline layout, restart to apply it");
+    }
+
+    try
+    {
+        for(const std::vector<char>& module : code)
+        {
+            reload->modules.push_back(createShaderModule(module));
+        }
+        std::vector<VkPipeline> pipelines = compileAll(variants, reload->modules);
+        for(type::size i = 0; i < variants.size(); ++i)
+        {
+            reload->variants.emplace(variants[i], pipelines[i]);
+        }
+    }
+    catch(...)
+    {
+        destroy(*reload);
+        throw;
+    }
+
+    std::lock_guard lock(m_mutex);
+    // Replaces one that was never swapped in, so nothing can be using it
+    if(m_reload)
+    {
+        destroy(*m_reload);
+    }
+    m_reload = std::move(reload);
+}
+
+auto vkc::GraphicsPipeline::applyReload(vkc::DeletionQueue& deletions, std::span<const VkFence> fences) -> bool
+{
+    std::lock_guard lock(m_mutex);
+    if(!m_reload)
+    {
+        return false;
+    }
+    std::unique_ptr<Reload> reload = std::move(m_reload);
+    if(reload->generation != m_generation)
+    {
+        destroy(*reload);
+        return false;
+    }
+
+    // Variants asked for since the reload was started are compiled from its shaders too, callers may
+    // still hold their current pipelines. If they don't compile, the current ones are kept for all of them
+    std::vector<PipelineVariant> missing;
+    for(const auto& [variant, pipeline] : m_variants)
+    {
+        if(!reload->variants.contains(variant))
+        {
+            missing.push_back(variant);
+        }
+    }
+    try
+    {
+        std::vector<VkPipeline> pipelines = compileAll(missing, reload->modules);
+        for(type::size i = 0; i < missing.size(); ++i)
+        {
+            reload->variants.emplace(missing[i], pipelines[i]);
+        }
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << "Shader reload failed for a new variant: " << e.what() << std::endl;
+        destroy(*reload);
+        return false;
+    }
+
+    // Swapped, so the reload now holds what the frames in flight may be using
+    std::swap(m_modules, reload->modules);
+    std::swap(m_variants, reload->variants);
+    m_pipeline = m_variants.at({});
+
+    // Destroyed without going through this, which may be gone by then
+    std::shared_ptr<Reload> retired = std::move(reload);
+    const vkc::Device& device = m_device;
+    deletions.retire(fences, [&device, retired]()
+    {
+        for(const auto& [variant, pipeline] : retired->variants)
+        {
+            device.vk().DestroyPipeline(device.logical(), pipeline, device.allocator());
+        }
+        for(VkShaderModule module : retired->modules)
+        {
+            device.vk().DestroyShaderModule(device.logical(), module, device.allocator());
+        }
+    });
+    return true;
+}
+
+auto vkc::GraphicsPipeline::lockReloads() -> std::unique_lock<std::mutex>
+{
+    return std::unique_lock(m_reloadMutex);
+}
+
+auto vkc::GraphicsPipeline::loadShaders() -> void
+{
+    VKC_ZONE("GraphicsPipeline::loadShaders");
+
+    std::vector<std::vector<char>> code = readShaders();
+    // Before any modules are created, so a mismatch doesn't leak them
+    m_layout = createLayout(code);
+
+    for(const std::vector<char>& module : code)
+    {
+        m_modules.push_back(createShaderModule(module));
+    }
+}
+
+auto vkc::GraphicsPipeline::readShaders() const -> std::vector<std::vector<char>>
+{
+    std::vector<std::vector<char>> code(m_shaderDetails.size());
+    for(type::size i = 0; i < m_shaderDetails.size(); ++i)
+    {
+        FileIO::ReadFile(m_shaderDetails[i].filePath, code[i]);
+    }
+    return code;
+}
+
+auto vkc::GraphicsPipeline::destroy() -> void
+{
+    std::lock_guard lock(m_mutex);
+    for(const auto& [variant, pipeline] : m_variants)
+    {
+        m_device.vk().DestroyPipeline(m_device.logical(), pipeline, m_device.allocator());
+    }
+    m_variants.clear();
+    m_pipeline = VK_NULL_HANDLE;
+
+    for(VkShaderModule module : m_modules)
+    {
+        m_device.vk().DestroyShaderModule(m_device.logical(), module, m_device.allocator());
+    }
+    m_modules.clear();
+
+    if(m_reload)
+    {
+        destroy(*m_reload);
+        m_reload.reset();
+    }
+}
+
+auto vkc::GraphicsPipeline::destroy(Reload& reload) const -> void
+{
+    for(const auto& [variant, pipeline] : reload.variants)
+    {
+        m_device.vk().DestroyPipeline(m_device.logical(), pipeline, m_device.allocator());
+    }
+    for(VkShaderModule module : reload.modules)
+    {
+        m_device.vk().DestroyShaderModule(m_device.logical(), module, m_device.allocator());
+    }
+    reload.variants.clear();
+    reload.modules.clear();
+}
+
+auto vkc::GraphicsPipeline::compileAll(std::span<const PipelineVariant> variants, std::span<const VkShaderModule> modules) const -> std::vector<VkPipeline>
+{
+    std::vector<VkPipeline> pipelines(variants.size(), VK_NULL_HANDLE);
+    std::atomic<type::size> next = 0;
+    std::mutex errorMutex;
+    std::exception_ptr error;
+
+    auto work = [&]()
+    {
+        for(type::size i = next++; i < variants.size(); i = next++)
+        {
+            try
+            {
+                pipelines[i] = compile(variants[i], modules);
+            }
+            catch(...)
+            {
+                std::lock_guard lock(errorMutex);
+                if(!error)
+                {
+                    error = std::current_exception();
+                }
+            }
+        }
+    };
+
+    // The calling thread takes a share too, so a single variant doesn't start a thread
+    type::size threads = std::min<type::size>(variants.size(), std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::thread> workers;
+    for(type::size i = 1; i < threads; ++i)
+    {
+        workers.emplace_back(work);
+    }
+    work();
+    for(std::thread& worker : workers)
+    {
+        worker.join();
+    }
+
+    if(error)
+    {
+        for(VkPipeline pipeline : pipelines)
+        {
+            m_device.vk().DestroyPipeline(m_device.logical(), pipeline, m_device.allocator());
+        }
+        std::rethrow_exception(error);
+    }
+    return pipelines;
+}
+
+auto vkc::GraphicsPipeline::compile(const PipelineVariant& variant, std::span<const VkShaderModule> modules) const -> VkPipeline
+{
+    VKC_ZONE("GraphicsPipeline::compile");
+
+    // Every constant is 32 bits, laid out in the order given
+    std::vector<VkSpecializationMapEntry> mapEntries;
+    std::vector<type::uint32> constantData;
+    for(const SpecializationConstant& constant : variant.constants)
+    {
+        mapEntries.push_back({constant.id, static_cast<type::uint32>(constantData.size() * sizeof(type::uint32)), sizeof(type::uint32)});
+        constantData.push_back(constant.value);
+    }
+
+    VkSpecializationInfo specialization = {};
+    specialization.mapEntryCount = static_cast<type::uint32>(mapEntries.size());
+    specialization.pMapEntries = mapEntries.data();
+    specialization.dataSize = constantData.size() * sizeof(type::uint32);
+    specialization.pData = constantData.data();
+
+    std::vector<VkPipelineShaderStageCreateInfo> shaderStages;
+    shaderStages.reserve(m_shaderDetails.size());
+    for(type::size i = 0; i < m_shaderDetails.size(); ++i)
+    {
+        VkPipelineShaderStageCreateInfo stageInfo = {};
+        stageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        stageInfo.stage = m_shaderDetails[i].stage;
+        stageInfo.module = modules[i];
+        // Entry point into the shader (i.e. "main" method)
+        // It's possible to have multiple entry points in a shader
+        stageInfo.pName = m_shaderDetails[i].entryPoint.c_str();
+        stageInfo.pSpecializationInfo = mapEntries.empty() ? nullptr : &specialization;
+
+        shaderStages.push_back(stageInfo);
+    }
 
     VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
     vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -111,15 +434,15 @@ auto vkc::GraphicsPipeline::createPipeline() -> void
     // Type of geometry that is being drawn (we're just assuming triangles for this program)
     VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
     inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    inputAssembly.topology = variant.topology;
     inputAssembly.primitiveRestartEnable = VK_FALSE;
 
     // Pipeline viewport
     VkViewport viewport = {};
     viewport.x = 0.0f;
     viewport.y = 0.0f;
-    viewport.width = static_cast<float>(m_swapChain.extent().width);
-    viewport.height = static_cast<float>(m_swapChain.extent().height);
+    viewport.width = static_cast<float>(m_target.extent().width);
+    viewport.height = static_cast<float>(m_target.extent().height);
     // Depth buffer range
     viewport.minDepth = 0.0f;
     viewport.maxDepth = 1.0f;
@@ -127,7 +450,7 @@ auto vkc::GraphicsPipeline::createPipeline() -> void
     // Pixel boundary cutoff
     VkRect2D scissor = {};
     scissor.offset = {0, 0};
-    scissor.extent = m_swapChain.extent();
+    scissor.extent = m_target.extent();
 
     // Combine viewport(s) and scissor(s) (some graphics cards allow multiple of each)
     VkPipelineViewportStateCreateInfo viewportState = {};
@@ -147,7 +470,7 @@ auto vkc::GraphicsPipeline::createPipeline() -> void
     // Fill fragments
     rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
     rasterizer.lineWidth = 1.0f;
-    rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
+    rasterizer.cullMode = variant.cullMode;
     rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
     // Bias depth values
         // This is good for shadow mapping, but we're not doing that currently
@@ -161,7 +484,7 @@ auto vkc::GraphicsPipeline::createPipeline() -> void
     VkPipelineMultisampleStateCreateInfo multisampling = {};
     multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
     multisampling.sampleShadingEnable = VK_FALSE;
-    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    multisampling.rasterizationSamples = m_samples;
     multisampling.minSampleShading = 1.0f;
     multisampling.pSampleMask = nullptr;
     multisampling.alphaToCoverageEnable = VK_FALSE;
@@ -174,8 +497,13 @@ auto vkc::GraphicsPipeline::createPipeline() -> void
             VK_COLOR_COMPONENT_G_BIT |
             VK_COLOR_COMPONENT_B_BIT |
             VK_COLOR_COMPONENT_A_BIT;
-    // Disable blending
-    colorBlendAttachment.blendEnable = VK_FALSE;
+    colorBlendAttachment.blendEnable = variant.blend ? VK_TRUE : VK_FALSE;
+    colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+    colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+    colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+    colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
 
     VkPipelineColorBlendStateCreateInfo colorBlending = {};
     colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
@@ -191,24 +519,21 @@ auto vkc::GraphicsPipeline::createPipeline() -> void
     }
 
 
-    VkPipelineLayoutCreateInfo layoutInfo = {};
-    layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    layoutInfo.setLayoutCount = static_cast<type::uint32>(m_descriptorLayouts.size());
-    layoutInfo.pSetLayouts = m_descriptorLayouts.data();
-    layoutInfo.pushConstantRangeCount = 0;
-    layoutInfo.pPushConstantRanges = nullptr;
-
-    if(vkCreatePipelineLayout(m_device.logical(), &layoutInfo, nullptr, &m_layout) != VK_SUCCESS)
-    {
-        throw std::runtime_error("Pipeline Layout creation failed");
-    }
-
+    // Attachment formats given up front instead of through a render pass
+    VkFormat colorFormat = m_target.imageFormat();
+    VkPipelineRenderingCreateInfo renderingInfo = {};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+    renderingInfo.viewMask = 0;
+    renderingInfo.colorAttachmentCount = 1;
+    renderingInfo.pColorAttachmentFormats = &colorFormat;
+    renderingInfo.depthAttachmentFormat = VK_FORMAT_UNDEFINED;
+    renderingInfo.stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
 
     VkGraphicsPipelineCreateInfo pipelineInfo = {};
     pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    pipelineInfo.stageCount = static_cast<type::uint32>(m_shaderDetails.size());
-    //pipelineInfo.pStages = shaderStages.data();
-    pipelineInfo.pStages = shaderStages;
+    pipelineInfo.pNext = m_renderPass ? nullptr : &renderingInfo;
+    pipelineInfo.stageCount = static_cast<type::uint32>(shaderStages.size());
+    pipelineInfo.pStages = shaderStages.data();
     pipelineInfo.pVertexInputState = &vertexInputInfo;
     pipelineInfo.pInputAssemblyState = &inputAssembly;
     pipelineInfo.pViewportState = &viewportState;
@@ -218,23 +543,39 @@ auto vkc::GraphicsPipeline::createPipeline() -> void
     pipelineInfo.pDepthStencilState = nullptr;
     pipelineInfo.pDynamicState = nullptr;
     pipelineInfo.layout = m_layout;
-    pipelineInfo.renderPass = m_renderPass.handle();
+    pipelineInfo.renderPass = m_renderPass ? m_renderPass->handle() : VK_NULL_HANDLE;
     pipelineInfo.subpass = 0;
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
     pipelineInfo.basePipelineIndex = -1;
 
-    if(vkCreateGraphicsPipelines(m_device.logical(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_pipeline) != VK_SUCCESS)
+    VkPipeline pipeline;
+    VkPipelineCache cache = m_cache ? m_cache->handle() : VK_NULL_HANDLE;
+    if(m_device.vk().CreateGraphicsPipelines(m_device.logical(), cache, 1, &pipelineInfo, m_device.allocator(), &pipeline) != VK_SUCCESS)
     {
         throw std::runtime_error("Graphics Pipeline creation failed");
     }
+    return pipeline;
+}
+
+auto vkc::GraphicsPipeline::createLayout(std::span<const std::vector<char>> code) const -> VkPipelineLayout
+{
+    std::vector<const vkc::ShaderReflection*> stages;
+    for(const std::vector<char>& module : code)
+    {
+        stages.push_back(&vkc::ShaderReflection::Get({reinterpret_cast<const type::uint32*>(module.data()), module.size() / sizeof(type::uint32)}));
+    }
+    vkc::PipelineReflection reflection = vkc::PipelineReflection::Merge(stages);
+    reflection.validateVertexInput(m_attrDescs);
 
-    for(auto& shader : shaderStages)
+    std::vector<VkDescriptorSetLayout> setLayouts;
+    for(const auto& bindings : reflection.sets)
     {
-        vkDestroyShaderModule(m_device.logical(), shader.module, nullptr);
+        setLayouts.push_back(m_layouts.get(bindings));
     }
+    return m_layouts.pipelineLayout(setLayouts, reflection.pushConstants);
 }
 
-auto vkc::GraphicsPipeline::createShaderModule(const std::vector<char>& code) -> VkShaderModule
+auto vkc::GraphicsPipeline::createShaderModule(const std::vector<char>& code) const -> VkShaderModule
 {
     VkShaderModuleCreateInfo info = {};
     info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
@@ -244,7 +585,7 @@ auto vkc::GraphicsPipeline::createShaderModule(const std::vector<char>& code) ->
     info.pCode = reinterpret_cast<const type::uint32*>(code.data());
 
     VkShaderModule module;
-    if(vkCreateShaderModule(m_device.logical(), &info, nullptr, &module) != VK_SUCCESS)
+    if(m_device.vk().CreateShaderModule(m_device.logical(), &info, m_device.allocator(), &module) != VK_SUCCESS)
     {
         throw std::runtime_error("Failed to create shader module");
     }
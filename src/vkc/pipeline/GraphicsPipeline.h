@@ -7,51 +7,125 @@
 #define VULKANCUBE_GRAPHICSPIPELINE_H
 
 #include <vulkan/vulkan.h>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <unordered_map>
 #include <vector>
 #include "../NonCopyable.h"
+#include "PipelineVariant.h"
 
 namespace vkc
 {
     class Device;
-    class SwapChain;
+    class RenderTarget;
     class RenderPass;
+    class DescriptorLayoutCache;
+    class PipelineCache;
+    class DeletionQueue;
     struct ShaderDetails;
     class GraphicsPipeline : public NonCopyable
     {
     public:
+        // Without a render pass the pipeline is created for dynamic rendering into the target's format
+        // Descriptor set and pipeline layouts are reflected from the shaders and shared through layouts,
+        // so they're the same handles resource sets built from that cache use
+        // Vertex descriptions are referenced rather than copied, and must outlive the pipeline, such as a VertexLayout's tables
+        // Throws if the stages disagree on a binding, or the vertex shader reads a location the descriptions don't provide
+        // Every variant is compiled into cache when given one
         GraphicsPipeline(
                 const vkc::Device& device,
-                const vkc::SwapChain& swapChain,
-                const vkc::RenderPass& renderPass,
-                const std::vector<VkDescriptorSetLayout>& descriptorLayouts,
-                const std::vector<ShaderDetails>& shaderDetails,
-                const std::vector<VkVertexInputBindingDescription>& bindingDescs,
-                const std::vector<VkVertexInputAttributeDescription>& attrDescs
+                const vkc::RenderTarget& target,
+                const vkc::RenderPass* renderPass,
+                vkc::DescriptorLayoutCache& layouts,
+                std::span<const ShaderDetails> shaderDetails,
+                std::span<const VkVertexInputBindingDescription> bindingDescs,
+                std::span<const VkVertexInputAttributeDescription> attrDescs,
+                VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT,
+                vkc::PipelineCache* cache = nullptr
                 );
         ~GraphicsPipeline();
 
+        // Rereads the shaders and recompiles every variant built so far, in parallel
+        // The caller holds lockReloads() from before the target or render pass are recreated
         auto recreate() -> void;
+        // Compiles the variants not built yet in parallel on worker threads, so none of them are compiled on first use
+        auto warmUp(std::span<const PipelineVariant> variants) -> void;
+        // Compiles on the calling thread when the variant wasn't warmed up. Safe to call from several threads
+        auto variant(const PipelineVariant& variant) -> VkPipeline;
 
+        // Rereads the shaders and compiles every variant from them without touching the current ones,
+        // so it can run on another thread while frames are drawn. Throws if the shaders don't compile into
+        // a pipeline, or need a different pipeline layout than the one resource sets were built against
+        auto prepareReload() -> void;
+        // Swaps in what prepareReload() finished at a frame boundary, on the thread that draws
+        // The replaced pipelines are retired to deletions until fences signal
+        // Variants created since prepareReload() started are compiled before swapping, so every one is replaced
+        // Returns false when there was nothing to swap in, it was compiled against a target since recreated,
+        // or one of those variants failed to compile
+        auto applyReload(vkc::DeletionQueue& deletions, std::span<const VkFence> fences) -> bool;
+        // Held by prepareReload() for its whole compile, which reads the layout, target extent and render pass
+        // Hold it from recreating the target and render pass until the old render pass is destroyed,
+        // so a reload in flight never compiles against them midway
+        [[nodiscard]]
+        auto lockReloads() -> std::unique_lock<std::mutex>;
+
+        // Default constructed variant
         [[nodiscard]]
         auto inline pipeline() const -> const VkPipeline& { return m_pipeline; }
         [[nodiscard]]
         auto inline layout() const -> const VkPipelineLayout& { return m_layout; }
+        [[nodiscard]]
+        auto inline samples() const -> VkSampleCountFlagBits { return m_samples; }
+        [[nodiscard]]
+        auto variantCount() const -> type::size;
 
     private:
         VkPipeline m_pipeline;
+        // Owned by m_layouts
         VkPipelineLayout m_layout;
         VkPipelineLayout m_oldLayout;
 
         const vkc::Device& m_device;
-        const vkc::SwapChain& m_swapChain;
-        const vkc::RenderPass& m_renderPass;
-        std::vector<VkDescriptorSetLayout> m_descriptorLayouts;
+        const vkc::RenderTarget& m_target;
+        const vkc::RenderPass* m_renderPass;
+        vkc::DescriptorLayoutCache& m_layouts;
         std::vector<ShaderDetails> m_shaderDetails;
-        std::vector<VkVertexInputBindingDescription> m_bindingDescs;
-        std::vector<VkVertexInputAttributeDescription> m_attrDescs;
+        std::span<const VkVertexInputBindingDescription> m_bindingDescs;
+        std::span<const VkVertexInputAttributeDescription> m_attrDescs;
+        // Must match the samples of the attachments rendered into
+        VkSampleCountFlagBits m_samples;
+        vkc::PipelineCache* m_cache;
+
+        using VariantMap = std::unordered_map<PipelineVariant, VkPipeline, PipelineVariantHash>;
+
+        // Pipelines and the modules they were compiled from, waiting for applyReload()
+        struct Reload
+        {
+            std::vector<VkShaderModule> modules;
+            VariantMap variants;
+            // Reloads started before a recreate() are thrown away
+            type::uint64 generation;
+        };
+
+        // Kept for the life of the pipeline so variants can be compiled later
+        std::vector<VkShaderModule> m_modules;
+        mutable std::mutex m_mutex;
+        // Taken before m_mutex when both are held
+        std::mutex m_reloadMutex;
+        VariantMap m_variants;
+        std::unique_ptr<Reload> m_reload;
+        type::uint64 m_generation;
 
-        auto createPipeline() -> void;
-        auto createShaderModule(const std::vector<char>& code) -> VkShaderModule;
+        auto loadShaders() -> void;
+        auto destroy() -> void;
+        auto destroy(Reload& reload) const -> void;
+        auto readShaders() const -> std::vector<std::vector<char>>;
+        auto createLayout(std::span<const std::vector<char>> code) const -> VkPipelineLayout;
+        // Only reads members that are fixed while compiling, so it runs on any thread
+        auto compile(const PipelineVariant& variant, std::span<const VkShaderModule> modules) const -> VkPipeline;
+        auto compileAll(std::span<const PipelineVariant> variants, std::span<const VkShaderModule> modules) const -> std::vector<VkPipeline>;
+        auto createShaderModule(const std::vector<char>& code) const -> VkShaderModule;
     };
 }
 
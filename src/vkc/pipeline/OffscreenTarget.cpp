@@ -0,0 +1,42 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#include <string>
+#include "OffscreenTarget.h"
+#include "../Device.h"
+
+vkc::OffscreenTarget::OffscreenTarget(const vkc::Device& device, VkExtent2D extent, type::uint32 numImages, VkFormat format) :
+        m_device(device),
+        m_numImages(numImages),
+        m_format(format),
+        m_extent(extent)
+{
+    createImages();
+}
+
+auto vkc::OffscreenTarget::recreate(VkExtent2D extent) -> void
+{
+    m_extent = extent;
+    m_images.clear();
+    createImages();
+}
+
+auto vkc::OffscreenTarget::createImages() -> void
+{
+    m_images.reserve(m_numImages);
+    for(type::uint32 i = 0; i < m_numImages; ++i)
+    {
+        m_images.push_back(std::make_unique<vkc::Image>(
+                m_device,
+                m_extent,
+                m_format,
+                Usage,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                VK_IMAGE_ASPECT_COLOR_BIT,
+                VK_SAMPLE_COUNT_1_BIT,
+                "offscreen target " + std::to_string(i)
+                ));
+    }
+}
@@ -0,0 +1,61 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#ifndef VULKANCUBE_OFFSCREENTARGET_H
+#define VULKANCUBE_OFFSCREENTARGET_H
+
+#include <memory>
+#include <vector>
+#include "RenderTarget.h"
+#include "../NonCopyable.h"
+#include "../Types.h"
+#include "../image/Image.h"
+
+namespace vkc
+{
+    class Device;
+    // Device local color images to render into without a surface
+    // Images are left in TRANSFER_SRC_OPTIMAL so they can be read back
+    class OffscreenTarget : public NonCopyable, public RenderTarget
+    {
+    public:
+        OffscreenTarget(const vkc::Device& device, VkExtent2D extent, type::uint32 numImages, VkFormat format = VK_FORMAT_R8G8B8A8_UNORM);
+        ~OffscreenTarget() override = default;
+
+        // Recreate the images at a new size. Device must be idle
+        auto recreate(VkExtent2D extent) -> void;
+
+        [[nodiscard]]
+        inline auto imageFormat() const -> const VkFormat& override { return m_format; }
+        [[nodiscard]]
+        inline auto extent() const -> const VkExtent2D& override { return m_extent; }
+        [[nodiscard]]
+        inline auto numImages() const -> type::size override { return m_images.size(); }
+        [[nodiscard]]
+        inline auto image(type::uint32 index) const -> VkImage override { return m_images[index]->handle(); }
+        [[nodiscard]]
+        inline auto imageView(type::uint32 index) const -> VkImageView override { return m_images[index]->view(); }
+        [[nodiscard]]
+        inline auto finalLayout() const -> VkImageLayout override { return VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL; }
+        [[nodiscard]]
+        inline auto imageUsage() const -> VkImageUsageFlags override { return Usage; }
+
+    private:
+        // Rendered to, then copied out for readback
+        static constexpr VkImageUsageFlags Usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+
+        const vkc::Device& m_device;
+
+        std::vector<std::unique_ptr<vkc::Image>> m_images;
+        type::uint32 m_numImages;
+
+        VkFormat m_format;
+        VkExtent2D m_extent;
+
+        auto createImages() -> void;
+    };
+}
+
+#endif //VULKANCUBE_OFFSCREENTARGET_H
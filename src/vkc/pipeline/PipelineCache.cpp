@@ -0,0 +1,102 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+#include "PipelineCache.h"
+#include "../Device.h"
+#include "../Types.h"
+
+namespace
+{
+    // Drivers are meant to ignore data from another device, but not all of them check the header first
+    auto Compatible(const std::vector<char>& data, const VkPhysicalDeviceProperties& properties) -> bool
+    {
+        // Header size, header version, vendor ID, device ID, then the cache UUID
+        constexpr type::size headerSize = 16 + VK_UUID_SIZE;
+        if(data.size() < headerSize)
+        {
+            return false;
+        }
+        type::uint32 header[4];
+        std::memcpy(header, data.data(), sizeof(header));
+        return header[1] == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+               header[2] == properties.vendorID &&
+               header[3] == properties.deviceID &&
+               std::memcmp(data.data() + 16, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+    }
+}
+
+vkc::PipelineCache::PipelineCache(const vkc::Device& device, std::string path) :
+        m_device(device),
+        m_path(std::move(path)),
+        m_cache(VK_NULL_HANDLE)
+{
+    std::vector<char> data;
+    if(!m_path.empty())
+    {
+        std::ifstream file(m_path, std::ios::binary);
+        data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        if(!Compatible(data, m_device.properties()))
+        {
+            data.clear();
+        }
+    }
+
+    VkPipelineCacheCreateInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    info.initialDataSize = data.size();
+    info.pInitialData = data.empty() ? nullptr : data.data();
+
+    if(m_device.vk().CreatePipelineCache(m_device.logical(), &info, m_device.allocator(), &m_cache) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Pipeline Cache creation failed");
+    }
+}
+
+vkc::PipelineCache::~PipelineCache()
+{
+    if(!m_path.empty())
+    {
+        try
+        {
+            save();
+        }
+        catch(const std::exception&)
+        {
+            // Only costs the next run its warm start
+        }
+    }
+    m_device.vk().DestroyPipelineCache(m_device.logical(), m_cache, m_device.allocator());
+}
+
+auto vkc::PipelineCache::save() const -> void
+{
+    if(m_path.empty())
+    {
+        throw std::runtime_error("Pipeline Cache has no path to save to");
+    }
+
+    type::size size = 0;
+    if(m_device.vk().GetPipelineCacheData(m_device.logical(), m_cache, &size, nullptr) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Pipeline Cache data query failed");
+    }
+    std::vector<char> data(size);
+    if(m_device.vk().GetPipelineCacheData(m_device.logical(), m_cache, &size, data.data()) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Pipeline Cache data query failed");
+    }
+
+    std::ofstream file(m_path, std::ios::binary | std::ios::trunc);
+    file.write(data.data(), static_cast<std::streamsize>(size));
+    if(!file)
+    {
+        throw std::runtime_error("Pipeline Cache write to " + m_path + " failed");
+    }
+}
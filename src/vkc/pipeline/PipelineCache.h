@@ -0,0 +1,41 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#ifndef VULKANCUBE_PIPELINECACHE_H
+#define VULKANCUBE_PIPELINECACHE_H
+
+#include <vulkan/vulkan.h>
+#include <string>
+#include "../NonCopyable.h"
+
+namespace vkc
+{
+    class Device;
+    // Driver cache shared by every pipeline compiled with it, so variants of the same shaders
+    // and pipelines compiled on other threads reuse each other's work
+    // Safe to compile into from several threads at once
+    class PipelineCache : public NonCopyable
+    {
+    public:
+        // With a path the cache starts from the file when it was written by the same driver and device,
+        // and is written back to it when destroyed
+        explicit PipelineCache(const vkc::Device& device, std::string path = {});
+        ~PipelineCache();
+
+        // Writes the cache to its path, throws if it has none or the file can't be written
+        auto save() const -> void;
+
+        [[nodiscard]]
+        inline auto handle() const -> VkPipelineCache { return m_cache; }
+
+    private:
+        const vkc::Device& m_device;
+        std::string m_path;
+
+        VkPipelineCache m_cache;
+    };
+}
+
+#endif //VULKANCUBE_PIPELINECACHE_H
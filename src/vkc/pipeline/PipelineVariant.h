@@ -0,0 +1,49 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#ifndef VULKANCUBE_PIPELINEVARIANT_H
+#define VULKANCUBE_PIPELINEVARIANT_H
+
+#include <vulkan/vulkan.h>
+#include <bit>
+#include <vector>
+#include "../Types.h"
+
+namespace vkc
+{
+    // Value of a shader's layout(constant_id = id) constant, given to every stage
+    // Floats, ints and bools are all 32 bits, so every value is stored as its bits
+    struct SpecializationConstant
+    {
+        type::uint32 id;
+        type::uint32 value;
+
+        static auto Float(type::uint32 id, float value) -> SpecializationConstant { return {id, std::bit_cast<type::uint32>(value)}; }
+        static auto Bool(type::uint32 id, bool value) -> SpecializationConstant { return {id, value ? 1u : 0u}; }
+
+        auto operator==(const SpecializationConstant&) const -> bool = default;
+    };
+
+    // State a GraphicsPipeline can be compiled with other than its shaders and vertex layout
+    // Default constructed, it's the state the pipeline was always created with
+    struct PipelineVariant
+    {
+        // Constants the shaders don't declare are ignored
+        std::vector<SpecializationConstant> constants;
+        VkCullModeFlags cullMode = VK_CULL_MODE_BACK_BIT;
+        VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        // Source alpha blending over what's already in the attachment
+        bool blend = false;
+
+        auto operator==(const PipelineVariant&) const -> bool = default;
+    };
+
+    struct PipelineVariantHash
+    {
+        auto operator()(const PipelineVariant& variant) const -> type::size;
+    };
+}
+
+#endif //VULKANCUBE_PIPELINEVARIANT_H
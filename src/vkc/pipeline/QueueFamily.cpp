@@ -7,15 +7,15 @@
 #include <vector>
 #include <iostream>
 
-auto vkc::QueueFamily::FindQueueFamilies(const VkPhysicalDevice& device, const VkSurfaceKHR& surface) -> vkc::QueueFamilyIndices
+auto vkc::QueueFamily::FindQueueFamilies(const vkc::InstanceDispatch& vk, const VkPhysicalDevice& device, const VkSurfaceKHR& surface) -> vkc::QueueFamilyIndices
 {
     QueueFamilyIndices indices;
 
     // Get queue families
     type::uint32 familyCount = 0;
-    vkGetPhysicalDeviceQueueFamilyProperties(device, &familyCount, nullptr);
+    vk.GetPhysicalDeviceQueueFamilyProperties(device, &familyCount, nullptr);
     std::vector<VkQueueFamilyProperties> families(familyCount);
-    vkGetPhysicalDeviceQueueFamilyProperties(device, &familyCount, families.data());
+    vk.GetPhysicalDeviceQueueFamilyProperties(device, &familyCount, families.data());
 
     // Iterate through families until one that supports requirements is found
     bool found = false;
@@ -30,14 +30,18 @@ auto vkc::QueueFamily::FindQueueFamilies(const VkPhysicalDevice& device, const V
         }
 
         // Check for surface presentation support
-        VkBool32 presentSupport = false;
-        vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
-        if(presentSupport)
+        // Without a surface (headless) only graphics support is needed
+        if(surface != VK_NULL_HANDLE)
         {
-            indices.present = i;
+            VkBool32 presentSupport = false;
+            vk.GetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+            if(presentSupport)
+            {
+                indices.present = i;
+            }
         }
 
-        found = indices.isComplete();
+        found = indices.isComplete(surface != VK_NULL_HANDLE);
     }
 
     return indices;
@@ -9,6 +9,7 @@
 #include <vulkan/vulkan.h>
 #include <optional>
 #include "../Types.h"
+#include "../Dispatch.h"
 #include "QueueFamilyIndices.h"
 
 namespace vkc
@@ -20,7 +21,8 @@ namespace vkc
         ~QueueFamily() = delete;
 
 
-        static auto FindQueueFamilies(const VkPhysicalDevice& device, const VkSurfaceKHR& surface) -> vkc::QueueFamilyIndices;
+        // Present support is only searched for if surface isn't VK_NULL_HANDLE
+        static auto FindQueueFamilies(const vkc::InstanceDispatch& vk, const VkPhysicalDevice& device, const VkSurfaceKHR& surface) -> vkc::QueueFamilyIndices;
     };
 }
 
@@ -18,7 +18,7 @@ namespace vkc
         // Support for drawing to surface
         std::optional<type::uint32> present;
         [[nodiscard]]
-        inline auto isComplete() const -> bool { return graphics.has_value() && present.has_value(); }
+        inline auto isComplete(bool requirePresent = true) const -> bool { return graphics.has_value() && (present.has_value() || !requirePresent); }
     };
 }
 
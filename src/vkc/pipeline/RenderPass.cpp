@@ -4,14 +4,16 @@
   */
 
 #include "RenderPass.h"
-#include "SwapChain.h"
+#include "RenderTarget.h"
 #include "../Device.h"
+#include "../image/Image.h"
 
-vkc::RenderPass::RenderPass(const vkc::Device& device, const vkc::SwapChain& swapChain) :
+vkc::RenderPass::RenderPass(const vkc::Device& device, const vkc::RenderTarget& target, VkSampleCountFlagBits samples) :
         m_renderPass(VK_NULL_HANDLE),
         m_oldRenderPass(VK_NULL_HANDLE),
+        m_samples(samples),
         m_device(device),
-        m_swapChain(swapChain)
+        m_target(target)
 {
     createRenderPass();
     createFrameBuffers();
@@ -20,7 +22,7 @@ vkc::RenderPass::RenderPass(const vkc::Device& device, const vkc::SwapChain& swa
 vkc::RenderPass::~RenderPass()
 {
     destroyFrameBuffers();
-    vkDestroyRenderPass(m_device.logical(), m_renderPass, nullptr);
+    m_device.vk().DestroyRenderPass(m_device.logical(), m_renderPass, m_device.allocator());
 }
 
 auto vkc::RenderPass::recreate() -> void
@@ -35,39 +37,59 @@ auto vkc::RenderPass::cleanupOld() -> void
 {
     if(m_oldRenderPass != VK_NULL_HANDLE)
     {
-        vkDestroyRenderPass(m_device.logical(), m_oldRenderPass, nullptr);
+        m_device.vk().DestroyRenderPass(m_device.logical(), m_oldRenderPass, m_device.allocator());
         m_oldRenderPass = VK_NULL_HANDLE;
     }
 }
 
 auto vkc::RenderPass::createRenderPass() -> void
 {
+    bool multisampled = m_samples != VK_SAMPLE_COUNT_1_BIT;
+
     // Create a new render pass as a color attachment
     VkAttachmentDescription colorAttachment = {};
-    // Format should match the format of the swap chain
-    colorAttachment.format = m_swapChain.imageFormat();
-    // No multisampling
-    colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    // Format should match the format of the render target images
+    colorAttachment.format = m_target.imageFormat();
+    colorAttachment.samples = m_samples;
     // Clear data before rendering, then store result after
+    // Multisampled data is resolved within the subpass, so it never needs to be stored
     colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    colorAttachment.storeOp = multisampled ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE;
     // Not doing anything with stencils, so don't care about it
     colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    // Don't care about initial layout, but final layout should
-    // be same as the presentation source
+    // Don't care about initial layout, but final layout should be whatever
+    // the target uses next (presentation source for a swap chain)
     colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    colorAttachment.finalLayout = multisampled ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : m_target.finalLayout();
+
+    // Target image the multisampled attachment is resolved into
+    VkAttachmentDescription resolveAttachment = {};
+    resolveAttachment.format = m_target.imageFormat();
+    resolveAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    // Every pixel is written by the resolve
+    resolveAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    resolveAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    resolveAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    resolveAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    resolveAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    resolveAttachment.finalLayout = m_target.finalLayout();
+
+    VkAttachmentDescription attachments[] = {colorAttachment, resolveAttachment};
 
     // Post-rendering subpasses
 
     // Subpass attachment reference
     VkAttachmentReference colorRef = {};
-    // Index of 0 in color attachments description array (we're only using 1)
+    // Index of 0 in color attachments description array
     colorRef.attachment = 0;
     // Use the optimal layout for color attachments
     colorRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
+    VkAttachmentReference resolveRef = {};
+    resolveRef.attachment = 1;
+    resolveRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
     // Subpass description
     VkSubpassDescription subpass = {};
     // Using for graphics computation
@@ -75,6 +97,7 @@ auto vkc::RenderPass::createRenderPass() -> void
     // Attach the color attachment
     subpass.colorAttachmentCount = 1;
     subpass.pColorAttachments = &colorRef;
+    subpass.pResolveAttachments = multisampled ? &resolveRef : nullptr;
 
     // Subpass dependencies
     VkSubpassDependency dependency = {};
@@ -85,7 +108,9 @@ auto vkc::RenderPass::createRenderPass() -> void
     // Wait for color attachment output before accessing image
     // This prevents the image being accessed by subpass and swap chain at the same time
     dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dependency.srcAccessMask = 0;
+    // The multisample image is shared between frames in flight, so the previous frame's writes to it must finish too
+    // Without this write access frames would render into it at the same time
+    dependency.srcAccessMask = multisampled ? VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT : 0;
     // Prevent transistion from happening until after reading and writing of color attachment
     dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
     dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
@@ -93,14 +118,14 @@ auto vkc::RenderPass::createRenderPass() -> void
     // Create the render pass
     VkRenderPassCreateInfo createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-    createInfo.attachmentCount = 1;
-    createInfo.pAttachments = &colorAttachment;
+    createInfo.attachmentCount = multisampled ? 2 : 1;
+    createInfo.pAttachments = attachments;
     createInfo.subpassCount = 1;
     createInfo.pSubpasses = &subpass;
     createInfo.dependencyCount = 1;
     createInfo.pDependencies = &dependency;
 
-    if(vkCreateRenderPass(m_device.logical(), &createInfo, nullptr, &m_renderPass) != VK_SUCCESS)
+    if(m_device.vk().CreateRenderPass(m_device.logical(), &createInfo, m_device.allocator(), &m_renderPass) != VK_SUCCESS)
     {
         throw std::runtime_error("Render pass creation failed");
     }
@@ -108,24 +133,45 @@ auto vkc::RenderPass::createRenderPass() -> void
 
 auto vkc::RenderPass::createFrameBuffers() -> void
 {
-    type::size numImages = m_swapChain.numImages();
+    type::size numImages = m_target.numImages();
 
     m_frameBuffers.resize(numImages);
 
+    if(m_samples != VK_SAMPLE_COUNT_1_BIT)
+    {
+        // Never stored, so it can stay in tile memory
+        m_multisampleImage = std::make_unique<vkc::Image>(
+                m_device,
+                m_target.extent(),
+                m_target.imageFormat(),
+                VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                VK_IMAGE_ASPECT_COLOR_BIT,
+                m_samples,
+                "multisample color"
+                );
+    }
+
     // Create a framebuffer for each image view
     for(type::size i = 0; i < numImages; ++i)
     {
-        VkImageView imgView = m_swapChain.imageView(i);
+        // Multisampled rendering resolves into the target image
+        VkImageView views[] = {m_target.imageView(i), VK_NULL_HANDLE};
+        if(m_multisampleImage)
+        {
+            views[0] = m_multisampleImage->view();
+            views[1] = m_target.imageView(i);
+        }
         VkFramebufferCreateInfo info = {};
         info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
         info.renderPass = m_renderPass;
-        info.attachmentCount = 1;
-        info.pAttachments = &imgView;
-        info.width = m_swapChain.extent().width;
-        info.height = m_swapChain.extent().height;
+        info.attachmentCount = m_multisampleImage ? 2 : 1;
+        info.pAttachments = views;
+        info.width = m_target.extent().width;
+        info.height = m_target.extent().height;
         info.layers = 1;
 
-        if(vkCreateFramebuffer(m_device.logical(), &info, nullptr, &m_frameBuffers[i]) != VK_SUCCESS)
+        if(m_device.vk().CreateFramebuffer(m_device.logical(), &info, m_device.allocator(), &m_frameBuffers[i]) != VK_SUCCESS)
         {
             throw std::runtime_error("Framebuffer creation failed");
         }
@@ -136,6 +182,7 @@ auto vkc::RenderPass::destroyFrameBuffers() -> void
 {
     for(VkFramebuffer& fb : m_frameBuffers)
     {
-        vkDestroyFramebuffer(m_device.logical(), fb, nullptr);
+        m_device.vk().DestroyFramebuffer(m_device.logical(), fb, m_device.allocator());
     }
+    m_multisampleImage.reset();
 }
@@ -8,6 +8,7 @@
 
 
 #include <vulkan/vulkan.h>
+#include <memory>
 #include <vector>
 #include "../NonCopyable.h"
 #include "../Types.h"
@@ -15,17 +16,22 @@
 namespace vkc
 {
     class Device;
-    class SwapChain;
+    class Image;
+    class RenderTarget;
+    // With more than one sample, the subpass renders into a transient multisample image
+    // that is resolved into the target image as the subpass ends
     class RenderPass : public NonCopyable
     {
     public:
-        RenderPass(const vkc::Device& device, const vkc::SwapChain& swapChain);
+        RenderPass(const vkc::Device& device, const vkc::RenderTarget& target, VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT);
         ~RenderPass();
 
         [[nodiscard]]
         auto inline handle() const -> const VkRenderPass& { return m_renderPass; }
         [[nodiscard]]
         inline auto frameBuffer(type::uint32 index) const -> const VkFramebuffer& { return m_frameBuffers[index]; }
+        [[nodiscard]]
+        inline auto samples() const -> VkSampleCountFlagBits { return m_samples; }
 
         auto recreate() -> void;
         auto cleanupOld() -> void;
@@ -35,9 +41,13 @@ namespace vkc
         VkRenderPass m_oldRenderPass;
 
         std::vector<VkFramebuffer> m_frameBuffers;
+        VkSampleCountFlagBits m_samples;
+        // Shared by every framebuffer, so frames in flight all render into it. The external subpass dependency
+        // waits on the previous frame's color attachment writes, which is what keeps them from overlapping
+        std::unique_ptr<vkc::Image> m_multisampleImage;
 
         const vkc::Device& m_device;
-        const vkc::SwapChain& m_swapChain;
+        const vkc::RenderTarget& m_target;
 
         auto createRenderPass() -> void;
         auto createFrameBuffers() -> void;
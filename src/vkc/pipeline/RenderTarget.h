@@ -0,0 +1,40 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#ifndef VULKANCUBE_RENDERTARGET_H
+#define VULKANCUBE_RENDERTARGET_H
+
+#include <vulkan/vulkan.h>
+#include "../Types.h"
+
+namespace vkc
+{
+    // Set of images that a RenderPass renders into, one of which is drawn to per frame
+    // Implemented by the SwapChain for presentation and OffscreenTarget for headless rendering
+    class RenderTarget
+    {
+    public:
+        virtual ~RenderTarget() = default;
+
+        [[nodiscard]]
+        virtual auto imageFormat() const -> const VkFormat& = 0;
+        [[nodiscard]]
+        virtual auto extent() const -> const VkExtent2D& = 0;
+        [[nodiscard]]
+        virtual auto numImages() const -> type::size = 0;
+        [[nodiscard]]
+        virtual auto image(type::uint32 index) const -> VkImage = 0;
+        [[nodiscard]]
+        virtual auto imageView(type::uint32 index) const -> VkImageView = 0;
+        // Layout the images are transitioned to at the end of the render pass
+        [[nodiscard]]
+        virtual auto finalLayout() const -> VkImageLayout = 0;
+        // Usage the images were created with, TRANSFER_SRC is needed to read them back
+        [[nodiscard]]
+        virtual auto imageUsage() const -> VkImageUsageFlags = 0;
+    };
+}
+
+#endif //VULKANCUBE_RENDERTARGET_H
@@ -0,0 +1,551 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include "ShaderReflection.h"
+
+namespace
+{
+    constexpr type::uint32 None = type::uint32_max;
+
+    // Numbers from the SPIR-V specification
+    constexpr type::uint32 Magic = 0x07230203;
+
+    constexpr type::uint32 OpEntryPoint = 15;
+    constexpr type::uint32 OpTypeInt = 21;
+    constexpr type::uint32 OpTypeFloat = 22;
+    constexpr type::uint32 OpTypeVector = 23;
+    constexpr type::uint32 OpTypeMatrix = 24;
+    constexpr type::uint32 OpTypeImage = 25;
+    constexpr type::uint32 OpTypeSampler = 26;
+    constexpr type::uint32 OpTypeSampledImage = 27;
+    constexpr type::uint32 OpTypeArray = 28;
+    constexpr type::uint32 OpTypeRuntimeArray = 29;
+    constexpr type::uint32 OpTypeStruct = 30;
+    constexpr type::uint32 OpTypePointer = 32;
+    constexpr type::uint32 OpConstant = 43;
+    constexpr type::uint32 OpSpecConstant = 50;
+    constexpr type::uint32 OpVariable = 59;
+    constexpr type::uint32 OpDecorate = 71;
+    constexpr type::uint32 OpMemberDecorate = 72;
+
+    constexpr type::uint32 DecorationBufferBlock = 3;
+    constexpr type::uint32 DecorationArrayStride = 6;
+    constexpr type::uint32 DecorationMatrixStride = 7;
+    constexpr type::uint32 DecorationBuiltIn = 11;
+    constexpr type::uint32 DecorationLocation = 30;
+    constexpr type::uint32 DecorationBinding = 33;
+    constexpr type::uint32 DecorationDescriptorSet = 34;
+    constexpr type::uint32 DecorationOffset = 35;
+
+    constexpr type::uint32 StorageUniformConstant = 0;
+    constexpr type::uint32 StorageInput = 1;
+    constexpr type::uint32 StorageUniform = 2;
+    constexpr type::uint32 StoragePushConstant = 9;
+    constexpr type::uint32 StorageStorageBuffer = 12;
+
+    constexpr type::uint32 DimBuffer = 5;
+    constexpr type::uint32 DimSubpassData = 6;
+
+    struct Id
+    {
+        // Offset of the instruction defining the id, 0 while it's undefined
+        type::size instruction = 0;
+        type::uint32 set = None;
+        type::uint32 binding = None;
+        type::uint32 location = None;
+        type::uint32 arrayStride = 0;
+        bool builtIn = false;
+        bool bufferBlock = false;
+    };
+
+    struct Member
+    {
+        type::uint32 offset = 0;
+        type::uint32 matrixStride = 0;
+    };
+
+    struct Module
+    {
+        std::span<const type::uint32> code;
+        std::vector<Id> ids;
+        std::unordered_map<type::uint64, Member> members;
+        std::vector<type::uint32> variables;
+
+        [[nodiscard]]
+        auto op(type::uint32 id) const -> type::uint32
+        {
+            if(id >= ids.size() || ids[id].instruction == 0)
+            {
+                throw std::runtime_error("SPIR-V reflection failed, id " + std::to_string(id) + " is never defined");
+            }
+            return code[ids[id].instruction] & 0xffff;
+        }
+
+        [[nodiscard]]
+        auto wordCount(type::uint32 id) const -> type::uint32 { return code[ids[id].instruction] >> 16; }
+
+        // Words following the opcode of the instruction defining id
+        [[nodiscard]]
+        auto operand(type::uint32 id, type::uint32 index) const -> type::uint32
+        {
+            if(index + 1 >= wordCount(id))
+            {
+                throw std::runtime_error("SPIR-V reflection failed, instruction of id " + std::to_string(id) + " is too short");
+            }
+            return code[ids[id].instruction + 1 + index];
+        }
+
+        [[nodiscard]]
+        auto member(type::uint32 structId, type::uint32 index) const -> Member
+        {
+            auto it = members.find(static_cast<type::uint64>(structId) << 32 | index);
+            return it != members.end() ? it->second : Member{};
+        }
+    };
+
+    auto StageOf(type::uint32 executionModel) -> VkShaderStageFlagBits
+    {
+        switch(executionModel)
+        {
+            case 0: return VK_SHADER_STAGE_VERTEX_BIT;
+            case 1: return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+            case 2: return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+            case 3: return VK_SHADER_STAGE_GEOMETRY_BIT;
+            case 4: return VK_SHADER_STAGE_FRAGMENT_BIT;
+            case 5: return VK_SHADER_STAGE_COMPUTE_BIT;
+            default: throw std::runtime_error("SPIR-V reflection failed, unsupported execution model " + std::to_string(executionModel));
+        }
+    }
+
+    auto Parse(std::span<const type::uint32> code, VkShaderStageFlagBits& stage) -> Module
+    {
+        if(code.size() < 5 || code[0] != Magic)
+        {
+            throw std::runtime_error("SPIR-V reflection failed, module isn't SPIR-V");
+        }
+
+        Module module;
+        module.code = code;
+        // Every id is less than the bound in the header
+        module.ids.resize(code[3]);
+
+        bool entryPoint = false;
+        for(type::size offset = 5; offset < code.size();)
+        {
+            type::uint32 count = code[offset] >> 16;
+            type::uint32 opcode = code[offset] & 0xffff;
+            if(count == 0 || offset + count > code.size())
+            {
+                throw std::runtime_error("SPIR-V reflection failed, module is truncated");
+            }
+            const type::uint32* operands = &code[offset + 1];
+            auto id = [&](type::uint32 index) -> Id&
+            {
+                if(index + 1 >= count || operands[index] >= module.ids.size())
+                {
+                    throw std::runtime_error("SPIR-V reflection failed, id out of bounds");
+                }
+                return module.ids[operands[index]];
+            };
+
+            switch(opcode)
+            {
+                case OpEntryPoint:
+                    // Only the first entry point is reflected
+                    if(!entryPoint)
+                    {
+                        stage = StageOf(operands[0]);
+                        entryPoint = true;
+                    }
+                    break;
+                case OpDecorate:
+                {
+                    Id& target = id(0);
+                    type::uint32 value = count > 3 ? operands[2] : 0;
+                    switch(operands[1])
+                    {
+                        case DecorationDescriptorSet: target.set = value; break;
+                        case DecorationBinding: target.binding = value; break;
+                        case DecorationLocation: target.location = value; break;
+                        case DecorationArrayStride: target.arrayStride = value; break;
+                        case DecorationBuiltIn: target.builtIn = true; break;
+                        case DecorationBufferBlock: target.bufferBlock = true; break;
+                        default: break;
+                    }
+                    break;
+                }
+                case OpMemberDecorate:
+                    if(count > 4)
+                    {
+                        Member& member = module.members[static_cast<type::uint64>(operands[0]) << 32 | operands[1]];
+                        if(operands[2] == DecorationOffset)
+                        {
+                            member.offset = operands[3];
+                        }
+                        else if(operands[2] == DecorationMatrixStride)
+                        {
+                            member.matrixStride = operands[3];
+                        }
+                    }
+                    break;
+                case OpTypeInt:
+                case OpTypeFloat:
+                case OpTypeVector:
+                case OpTypeMatrix:
+                case OpTypeImage:
+                case OpTypeSampler:
+                case OpTypeSampledImage:
+                case OpTypeArray:
+                case OpTypeRuntimeArray:
+                case OpTypeStruct:
+                case OpTypePointer:
+                    id(0).instruction = offset;
+                    break;
+                case OpConstant:
+                case OpSpecConstant:
+                    id(1).instruction = offset;
+                    break;
+                case OpVariable:
+                    id(1).instruction = offset;
+                    module.variables.push_back(operands[1]);
+                    break;
+                default:
+                    break;
+            }
+            offset += count;
+        }
+
+        if(!entryPoint)
+        {
+            throw std::runtime_error("SPIR-V reflection failed, module has no entry point");
+        }
+        return module;
+    }
+
+    auto DescriptorTypeOf(const Module& module, type::uint32 typeId, type::uint32 storage) -> VkDescriptorType
+    {
+        if(storage == StorageStorageBuffer || (storage == StorageUniform && module.ids[typeId].bufferBlock))
+        {
+            return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        }
+        if(storage == StorageUniform)
+        {
+            // Dynamic offsets aren't part of the shader, sets that use them need their own layout
+            return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        }
+
+        switch(module.op(typeId))
+        {
+            case OpTypeSampler:
+                return VK_DESCRIPTOR_TYPE_SAMPLER;
+            case OpTypeSampledImage:
+                return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            case OpTypeImage:
+            {
+                type::uint32 dim = module.operand(typeId, 2);
+                // 1 is used with a sampler, 2 is read and written without one
+                bool storageImage = module.operand(typeId, 6) == 2;
+                if(dim == DimBuffer)
+                {
+                    return storageImage ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+                }
+                if(dim == DimSubpassData)
+                {
+                    return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+                }
+                return storageImage ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+            }
+            default:
+                throw std::runtime_error("SPIR-V reflection failed, unsupported descriptor type");
+        }
+    }
+
+    auto SizeOf(const Module& module, type::uint32 typeId, type::uint32 matrixStride = 0) -> type::uint32
+    {
+        switch(module.op(typeId))
+        {
+            case OpTypeInt:
+            case OpTypeFloat:
+                return module.operand(typeId, 1) / 8;
+            case OpTypeVector:
+                return module.operand(typeId, 2) * SizeOf(module, module.operand(typeId, 1));
+            case OpTypeMatrix:
+            {
+                type::uint32 columns = module.operand(typeId, 2);
+                return columns * (matrixStride != 0 ? matrixStride : SizeOf(module, module.operand(typeId, 1)));
+            }
+            case OpTypeArray:
+            {
+                type::uint32 length = module.operand(module.operand(typeId, 2), 2);
+                type::uint32 stride = module.ids[typeId].arrayStride;
+                return length * (stride != 0 ? stride : SizeOf(module, module.operand(typeId, 1)));
+            }
+            case OpTypeStruct:
+            {
+                // Members are placed by their offsets, so the last one to end decides the size
+                type::uint32 size = 0;
+                for(type::uint32 i = 0; i + 2 < module.wordCount(typeId); ++i)
+                {
+                    Member member = module.member(typeId, i);
+                    size = std::max(size, member.offset + SizeOf(module, module.operand(typeId, i + 1), member.matrixStride));
+                }
+                return size;
+            }
+            default:
+                throw std::runtime_error("SPIR-V reflection failed, push constant member of unsupported type");
+        }
+    }
+
+    // Format a vertex input would have if read as 32 bit components, since that's how SPIR-V declares them
+    auto VertexFormatOf(const Module& module, type::uint32 typeId) -> VkFormat
+    {
+        static constexpr VkFormat Formats[3][4] =
+                {
+                        {VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT},
+                        {VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT},
+                        {VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT}
+                };
+
+        type::uint32 components = 1;
+        if(module.op(typeId) == OpTypeVector)
+        {
+            components = module.operand(typeId, 2);
+            typeId = module.operand(typeId, 1);
+        }
+        type::uint32 op = module.op(typeId);
+        if((op != OpTypeFloat && op != OpTypeInt) || module.operand(typeId, 1) != 32 || components > 4)
+        {
+            return VK_FORMAT_UNDEFINED;
+        }
+        type::uint32 kind = op == OpTypeFloat ? 0 : (module.operand(typeId, 2) == 1 ? 1 : 2);
+        return Formats[kind][components - 1];
+    }
+
+    enum class NumericType
+    {
+        Float,
+        Int,
+        Uint
+    };
+
+    // Normalized and scaled formats are read as floats
+    auto NumericTypeOf(VkFormat format) -> NumericType
+    {
+        switch(format)
+        {
+            case VK_FORMAT_R8_SINT:
+            case VK_FORMAT_R8G8_SINT:
+            case VK_FORMAT_R8G8B8A8_SINT:
+            case VK_FORMAT_R16_SINT:
+            case VK_FORMAT_R16G16_SINT:
+            case VK_FORMAT_R16G16B16A16_SINT:
+            case VK_FORMAT_R32_SINT:
+            case VK_FORMAT_R32G32_SINT:
+            case VK_FORMAT_R32G32B32_SINT:
+            case VK_FORMAT_R32G32B32A32_SINT:
+            case VK_FORMAT_A2B10G10R10_SINT_PACK32:
+                return NumericType::Int;
+            case VK_FORMAT_R8_UINT:
+            case VK_FORMAT_R8G8_UINT:
+            case VK_FORMAT_R8G8B8A8_UINT:
+            case VK_FORMAT_R16_UINT:
+            case VK_FORMAT_R16G16_UINT:
+            case VK_FORMAT_R16G16B16A16_UINT:
+            case VK_FORMAT_R32_UINT:
+            case VK_FORMAT_R32G32_UINT:
+            case VK_FORMAT_R32G32B32_UINT:
+            case VK_FORMAT_R32G32B32A32_UINT:
+            case VK_FORMAT_A2B10G10R10_UINT_PACK32:
+                return NumericType::Uint;
+            default:
+                return NumericType::Float;
+        }
+    }
+}
+
+auto vkc::ShaderReflection::Reflect(std::span<const type::uint32> code) -> ShaderReflection
+{
+    ShaderReflection reflection = {};
+    Module module = Parse(code, reflection.stage);
+
+    for(type::uint32 variable : module.variables)
+    {
+        const Id& var = module.ids[variable];
+        type::uint32 storage = module.operand(variable, 2);
+        // Variables are pointers to the type they hold
+        type::uint32 typeId = module.operand(module.operand(variable, 0), 2);
+
+        switch(storage)
+        {
+            case StorageUniformConstant:
+            case StorageUniform:
+            case StorageStorageBuffer:
+            {
+                if(var.binding == None)
+                {
+                    break;
+                }
+                type::uint32 count = 1;
+                if(module.op(typeId) == OpTypeRuntimeArray)
+                {
+                    throw std::runtime_error("SPIR-V reflection failed, binding " + std::to_string(var.binding) + " is a runtime sized array");
+                }
+                if(module.op(typeId) == OpTypeArray)
+                {
+                    count = module.operand(module.operand(typeId, 2), 2);
+                    typeId = module.operand(typeId, 1);
+                }
+
+                VkDescriptorSetLayoutBinding binding = {};
+                binding.binding = var.binding;
+                binding.descriptorType = DescriptorTypeOf(module, typeId, storage);
+                binding.descriptorCount = count;
+                binding.stageFlags = reflection.stage;
+                binding.pImmutableSamplers = nullptr;
+                // Sets default to 0 when the shader doesn't say
+                reflection.bindings.push_back({var.set == None ? 0 : var.set, binding});
+                break;
+            }
+            case StoragePushConstant:
+            {
+                type::uint32 offset = type::uint32_max;
+                for(type::uint32 i = 0; i + 2 < module.wordCount(typeId); ++i)
+                {
+                    offset = std::min(offset, module.member(typeId, i).offset);
+                }
+                type::uint32 size = SizeOf(module, typeId);
+                if(size > 0)
+                {
+                    reflection.pushConstants = {static_cast<VkShaderStageFlags>(reflection.stage), offset, size - offset};
+                }
+                break;
+            }
+            case StorageInput:
+            {
+                if(reflection.stage != VK_SHADER_STAGE_VERTEX_BIT || var.builtIn || var.location == None)
+                {
+                    break;
+                }
+                // Matrices take a location per column
+                type::uint32 locations = 1;
+                if(module.op(typeId) == OpTypeMatrix)
+                {
+                    locations = module.operand(typeId, 2);
+                    typeId = module.operand(typeId, 1);
+                }
+                VkFormat format = VertexFormatOf(module, typeId);
+                for(type::uint32 i = 0; i < locations; ++i)
+                {
+                    reflection.vertexInputs.push_back({var.location + i, format});
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    std::sort(reflection.vertexInputs.begin(), reflection.vertexInputs.end(), [](const auto& a, const auto& b) { return a.location < b.location; });
+    return reflection;
+}
+
+auto vkc::ShaderReflection::Get(std::span<const type::uint32> code) -> const ShaderReflection&
+{
+    static std::mutex mutex;
+    static std::unordered_map<type::uint64, std::unique_ptr<ShaderReflection>> cache;
+
+    // FNV-1a over the words, seeded with the length
+    type::uint64 hash = 0xcbf29ce484222325ull ^ code.size();
+    for(type::uint32 word : code)
+    {
+        hash = (hash ^ word) * 0x100000001b3ull;
+    }
+
+    std::lock_guard lock(mutex);
+    auto it = cache.find(hash);
+    if(it == cache.end())
+    {
+        it = cache.emplace(hash, std::make_unique<ShaderReflection>(Reflect(code))).first;
+    }
+    return *it->second;
+}
+
+auto vkc::PipelineReflection::Merge(std::span<const ShaderReflection* const> stages) -> PipelineReflection
+{
+    PipelineReflection merged;
+    for(const ShaderReflection* stage : stages)
+    {
+        for(const ShaderReflection::Binding& binding : stage->bindings)
+        {
+            if(binding.set >= merged.sets.size())
+            {
+                merged.sets.resize(binding.set + 1);
+            }
+            std::vector<VkDescriptorSetLayoutBinding>& set = merged.sets[binding.set];
+            auto it = std::find_if(set.begin(), set.end(), [&](const auto& other) { return other.binding == binding.binding.binding; });
+            if(it == set.end())
+            {
+                set.push_back(binding.binding);
+                continue;
+            }
+            if(it->descriptorType != binding.binding.descriptorType || it->descriptorCount != binding.binding.descriptorCount)
+            {
+                throw std::runtime_error("Set " + std::to_string(binding.set) + " binding " + std::to_string(binding.binding.binding) +
+                        " is declared differently by two shader stages");
+            }
+            it->stageFlags |= binding.binding.stageFlags;
+        }
+
+        const VkPushConstantRange& range = stage->pushConstants;
+        if(range.size > 0)
+        {
+            auto it = std::find_if(merged.pushConstants.begin(), merged.pushConstants.end(), [&](const auto& other)
+            {
+                return other.offset == range.offset && other.size == range.size;
+            });
+            if(it == merged.pushConstants.end())
+            {
+                merged.pushConstants.push_back(range);
+            }
+            else
+            {
+                it->stageFlags |= range.stageFlags;
+            }
+        }
+
+        if(stage->stage == VK_SHADER_STAGE_VERTEX_BIT)
+        {
+            merged.vertexInputs = stage->vertexInputs;
+        }
+    }
+
+    for(std::vector<VkDescriptorSetLayoutBinding>& set : merged.sets)
+    {
+        std::sort(set.begin(), set.end(), [](const auto& a, const auto& b) { return a.binding < b.binding; });
+    }
+    return merged;
+}
+
+auto vkc::PipelineReflection::validateVertexInput(std::span<const VkVertexInputAttributeDescription> attributes) const -> void
+{
+    for(const ShaderReflection::VertexInput& input : vertexInputs)
+    {
+        auto it = std::find_if(attributes.begin(), attributes.end(), [&](const auto& attribute) { return attribute.location == input.location; });
+        if(it == attributes.end())
+        {
+            throw std::runtime_error("Vertex input location " + std::to_string(input.location) + " has no attribute");
+        }
+        if(input.format != VK_FORMAT_UNDEFINED && NumericTypeOf(input.format) != NumericTypeOf(it->format))
+        {
+            throw std::runtime_error("Vertex input location " + std::to_string(input.location) + " has an attribute of a different numeric type");
+        }
+    }
+}
@@ -0,0 +1,62 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#ifndef VULKANCUBE_SHADERREFLECTION_H
+#define VULKANCUBE_SHADERREFLECTION_H
+
+#include <vulkan/vulkan.h>
+#include <span>
+#include <vector>
+#include "../Types.h"
+
+namespace vkc
+{
+    // Resources a SPIR-V module declares, read from the decorations of its variables
+    struct ShaderReflection
+    {
+        struct Binding
+        {
+            type::uint32 set;
+            VkDescriptorSetLayoutBinding binding;
+        };
+
+        struct VertexInput
+        {
+            type::uint32 location;
+            // Undefined for inputs that aren't 32 bit scalars or vectors
+            VkFormat format;
+        };
+
+        VkShaderStageFlagBits stage;
+        std::vector<Binding> bindings;
+        // Size is 0 when the module has no push constants
+        VkPushConstantRange pushConstants;
+        // Only filled for vertex shaders, sorted by location
+        std::vector<VertexInput> vertexInputs;
+
+        // Throws if code isn't SPIR-V, or declares a resource that can't be described by a layout
+        static auto Reflect(std::span<const type::uint32> code) -> ShaderReflection;
+        // Same, but each module is only parsed once. Results are kept for the life of the program, keyed by a hash of the module
+        static auto Get(std::span<const type::uint32> code) -> const ShaderReflection&;
+    };
+
+    // Reflections of every stage of a pipeline, merged
+    struct PipelineReflection
+    {
+        // Indexed by set. Sets between used ones are empty
+        std::vector<std::vector<VkDescriptorSetLayoutBinding>> sets;
+        // At most one range per stage, stages using the same range share it
+        std::vector<VkPushConstantRange> pushConstants;
+        std::vector<ShaderReflection::VertexInput> vertexInputs;
+
+        // Throws if two stages declare the same binding with a different type or count
+        static auto Merge(std::span<const ShaderReflection* const> stages) -> PipelineReflection;
+
+        // Throws if a vertex input has no attribute, or an attribute of a different numeric type
+        auto validateVertexInput(std::span<const VkVertexInputAttributeDescription> attributes) const -> void;
+    };
+}
+
+#endif //VULKANCUBE_SHADERREFLECTION_H
@@ -0,0 +1,187 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <stdexcept>
+#include "ShaderWatcher.h"
+#include "GraphicsPipeline.h"
+#include "../profile/Profiler.h"
+
+#ifdef __linux__
+#include <cerrno>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // Editors often write a file more than once when saving it, so compiling waits for them to go quiet
+    constexpr int SettleMs = 100;
+
+    auto IsShaderSource(const std::string& name) -> bool
+    {
+        static constexpr std::array<type::cstr, 6> extensions = {".vert", ".frag", ".comp", ".geom", ".tesc", ".tese"};
+        for(type::cstr extension : extensions)
+        {
+            std::string suffix = extension;
+            if(name.size() > suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    auto Quote(const std::string& arg) -> std::string
+    {
+        std::string quoted = "'";
+        for(char c : arg)
+        {
+            quoted += c == '\'' ? std::string("'\\''") : std::string(1, c);
+        }
+        return quoted + "'";
+    }
+}
+
+auto vkc::ShaderWatcher::Supported() -> bool
+{
+#ifdef __linux__
+    return true;
+#else
+    return false;
+#endif
+}
+
+vkc::ShaderWatcher::ShaderWatcher(vkc::GraphicsPipeline& pipeline, std::string sourceDir, std::string outputDir, std::string compiler) :
+        m_pipeline(pipeline),
+        m_sourceDir(std::move(sourceDir)),
+        m_outputDir(std::move(outputDir)),
+        m_compiler(std::move(compiler)),
+        m_inotify(-1),
+        m_stop{-1, -1},
+        m_reloads(0),
+        m_failures(0)
+{
+#ifdef __linux__
+    m_inotify = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    if(m_inotify < 0)
+    {
+        throw std::runtime_error("Shader watcher inotify initialization failed");
+    }
+    // Saves that replace the file arrive as a move rather than a write
+    if(inotify_add_watch(m_inotify, m_sourceDir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0 || pipe(m_stop) != 0)
+    {
+        close(m_inotify);
+        throw std::runtime_error("Shader watcher failed to watch " + m_sourceDir);
+    }
+    m_thread = std::thread(&ShaderWatcher::run, this);
+#else
+    throw std::runtime_error("Shader watching is only supported on Linux");
+#endif
+}
+
+vkc::ShaderWatcher::~ShaderWatcher()
+{
+#ifdef __linux__
+    char stop = 0;
+    (void)write(m_stop[1], &stop, 1);
+    m_thread.join();
+    close(m_stop[0]);
+    close(m_stop[1]);
+    close(m_inotify);
+#endif
+}
+
+auto vkc::ShaderWatcher::run() -> void
+{
+#ifdef __linux__
+    std::set<std::string> changed;
+    while(true)
+    {
+        pollfd fds[2] = {{m_inotify, POLLIN, 0}, {m_stop[0], POLLIN, 0}};
+        int ready = poll(fds, 2, changed.empty() ? -1 : SettleMs);
+        if(ready < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if(ready < 0 || fds[1].revents != 0)
+        {
+            return;
+        }
+
+        if(ready == 0)
+        {
+            VKC_ZONE("ShaderWatcher::reload");
+            bool compiled = true;
+            for(const std::string& name : changed)
+            {
+                // Every changed source is compiled so all of their errors are reported at once
+                compiled = compile(name) && compiled;
+            }
+            changed.clear();
+            if(!compiled)
+            {
+                ++m_failures;
+                continue;
+            }
+
+            try
+            {
+                m_pipeline.prepareReload();
+                ++m_reloads;
+                std::cout << "Shaders recompiled, swapping in at the next frame" << std::endl;
+            }
+            catch(const std::exception& e)
+            {
+                ++m_failures;
+                std::cerr << "Shader reload failed: " << e.what() << std::endl;
+            }
+            continue;
+        }
+
+        alignas(inotify_event) char buffer[4096];
+        ssize_t length;
+        while((length = read(m_inotify, buffer, sizeof(buffer))) > 0)
+        {
+            for(char* it = buffer; it < buffer + length;)
+            {
+                auto* event = reinterpret_cast<inotify_event*>(it);
+                if(event->len > 0 && IsShaderSource(event->name))
+                {
+                    changed.insert(event->name);
+                }
+                it += sizeof(inotify_event) + event->len;
+            }
+        }
+    }
+#endif
+}
+
+auto vkc::ShaderWatcher::compile(const std::string& name) const -> bool
+{
+    std::string source = m_sourceDir + "/" + name;
+    std::string output = m_outputDir + "/" + name + ".spv";
+    // Renamed into place once complete, so a reload never reads a partly written module
+    std::string partial = output + ".partial";
+
+    std::string command = Quote(m_compiler) + " " + Quote(source) + " -o " + Quote(partial);
+    if(std::system(command.c_str()) != 0)
+    {
+        std::cerr << "Shader compilation of " << source << " failed" << std::endl;
+        std::remove(partial.c_str());
+        return false;
+    }
+    if(std::rename(partial.c_str(), output.c_str()) != 0)
+    {
+        std::cerr << "Shader " << output << " couldn't be replaced" << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,53 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#ifndef VULKANCUBE_SHADERWATCHER_H
+#define VULKANCUBE_SHADERWATCHER_H
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include "../NonCopyable.h"
+#include "../Types.h"
+
+namespace vkc
+{
+    class GraphicsPipeline;
+    // Development aid that recompiles GLSL sources as they're saved and has the pipeline prepare a reload from them,
+    // all on a worker thread. The pipeline's owner still swaps the reload in with applyReload() at a frame boundary
+    // Watches with inotify, so it's only supported on Linux
+    class ShaderWatcher : public NonCopyable
+    {
+    public:
+        // Sources in sourceDir are compiled into outputDir/<source name>.spv, the names the shaders target produces
+        ShaderWatcher(vkc::GraphicsPipeline& pipeline, std::string sourceDir, std::string outputDir, std::string compiler = "glslc");
+        ~ShaderWatcher();
+
+        static auto Supported() -> bool;
+
+        [[nodiscard]]
+        inline auto reloads() const -> type::uint32 { return m_reloads; }
+        [[nodiscard]]
+        inline auto failures() const -> type::uint32 { return m_failures; }
+
+    private:
+        vkc::GraphicsPipeline& m_pipeline;
+        std::string m_sourceDir;
+        std::string m_outputDir;
+        std::string m_compiler;
+
+        int m_inotify;
+        // Written to on destruction to wake the worker
+        int m_stop[2];
+        std::atomic<type::uint32> m_reloads;
+        std::atomic<type::uint32> m_failures;
+        std::thread m_thread;
+
+        auto run() -> void;
+        auto compile(const std::string& name) const -> bool;
+    };
+}
+
+#endif //VULKANCUBE_SHADERWATCHER_H
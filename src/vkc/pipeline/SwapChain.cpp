@@ -6,6 +6,7 @@
 #include <iostream>
 #include "SwapChain.h"
 #include "../Device.h"
+#include "../Instance.h"
 #include "../Window.h"
 #include "../Types.h"
 
@@ -14,6 +15,7 @@ vkc::SwapChain::SwapChain(const vkc::Device& device, const vkc::Window& window)
         m_oldSwapChain(VK_NULL_HANDLE),
         m_extent(),
         m_imageFormat(),
+        m_imageUsage(0),
         m_device(device),
         m_window(window)
 {
@@ -34,14 +36,14 @@ auto vkc::SwapChain::cleanupOld() -> void
     // Destroy old swap chain if it exists
     if(m_oldSwapChain != VK_NULL_HANDLE)
     {
-        vkDestroySwapchainKHR(m_device.logical(), m_oldSwapChain, nullptr);
+        m_device.vk().DestroySwapchainKHR(m_device.logical(), m_oldSwapChain, m_device.allocator());
         m_oldSwapChain = VK_NULL_HANDLE;
     }
 }
 
 auto vkc::SwapChain::createSwapChain() -> void
 {
-    m_supportDetails = QuerySwapChainSupport(m_device.physical(), m_window.surface());
+    m_supportDetails = QuerySwapChainSupport(m_device.instance().vk(), m_device.physical(), m_window.surface());
     m_extent = ChooseSwapExtent(m_supportDetails.capabilities, m_window);
 
     // Choose the swap surface format
@@ -99,7 +101,13 @@ auto vkc::SwapChain::createSwapChain() -> void
     // This is always 1 unless doing something like stereoscopic 3D
     createInfo.imageArrayLayers = 1;
     // Image is being directly rendered to, so make i a color attachment
-    createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    m_imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    // Also allow copying out of the images for frame capture, where the surface supports it
+    if(m_supportDetails.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT)
+    {
+        m_imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    }
+    createInfo.imageUsage = m_imageUsage;
 
     // How to handle swap chain images across multiple queue families
     const QueueFamilyIndices& indices = m_device.queueFamilyIndices();
@@ -130,15 +138,19 @@ auto vkc::SwapChain::createSwapChain() -> void
     createInfo.clipped = VK_TRUE;
     createInfo.oldSwapchain = m_oldSwapChain;
 
-    if(vkCreateSwapchainKHR(m_device.logical(), &createInfo, nullptr, &m_swapChain) != VK_SUCCESS)
+    if(m_device.vk().CreateSwapchainKHR(m_device.logical(), &createInfo, m_device.allocator(), &m_swapChain) != VK_SUCCESS)
     {
         throw std::runtime_error("Swap chain creation failed");
     }
 
     // Get new swap chain images
-    vkGetSwapchainImagesKHR(m_device.logical(), m_swapChain, &imageCount, nullptr);
+    m_device.vk().GetSwapchainImagesKHR(m_device.logical(), m_swapChain, &imageCount, nullptr);
     m_images.resize(imageCount);
-    vkGetSwapchainImagesKHR(m_device.logical(), m_swapChain, &imageCount, m_images.data());
+    m_device.vk().GetSwapchainImagesKHR(m_device.logical(), m_swapChain, &imageCount, m_images.data());
+
+    // The presentation engine owns the images, so their size is estimated from the 32 bit formats chosen
+    VkDeviceSize imageSize = static_cast<VkDeviceSize>(m_extent.width) * m_extent.height * 4;
+    m_device.memoryTracker().addExternal(this, imageSize * imageCount, vkc::MemoryCategory::SwapChain, "swap chain images");
 }
 
 auto vkc::SwapChain::createImageViews() -> void
@@ -165,7 +177,7 @@ auto vkc::SwapChain::createImageViews() -> void
         createInfo.subresourceRange.baseArrayLayer = 0;
         createInfo.subresourceRange.layerCount = 1;
 
-        if(vkCreateImageView(m_device.logical(), &createInfo, nullptr, &m_imageViews[i]) != VK_SUCCESS)
+        if(m_device.vk().CreateImageView(m_device.logical(), &createInfo, m_device.allocator(), &m_imageViews[i]) != VK_SUCCESS)
         {
             throw std::runtime_error("Image view creation failed");
         }
@@ -176,41 +188,42 @@ auto vkc::SwapChain::destroyImageViews() -> void
 {
     for(VkImageView& view : m_imageViews)
     {
-        vkDestroyImageView(m_device.logical(), view, nullptr);
+        m_device.vk().DestroyImageView(m_device.logical(), view, m_device.allocator());
     }
 }
 
 vkc::SwapChain::~SwapChain()
 {
     destroyImageViews();
-    vkDestroySwapchainKHR(m_device.logical(), m_swapChain, nullptr);
+    m_device.vk().DestroySwapchainKHR(m_device.logical(), m_swapChain, m_device.allocator());
+    m_device.memoryTracker().removeExternal(this);
 }
 
-auto vkc::SwapChain::QuerySwapChainSupport(const VkPhysicalDevice& device, const VkSurfaceKHR& surface) -> vkc::SwapChainSupportDetails
+auto vkc::SwapChain::QuerySwapChainSupport(const vkc::InstanceDispatch& vk, const VkPhysicalDevice& device, const VkSurfaceKHR& surface) -> vkc::SwapChainSupportDetails
 {
     SwapChainSupportDetails details;
 
     // Get capabilities of both device and surface
-    vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device, surface, &details.capabilities);
+    vk.GetPhysicalDeviceSurfaceCapabilitiesKHR(device, surface, &details.capabilities);
 
     // Get number of supported surface formats
     type::uint32 formatCount;
-    vkGetPhysicalDeviceSurfaceFormatsKHR(device, surface, &formatCount, nullptr);
+    vk.GetPhysicalDeviceSurfaceFormatsKHR(device, surface, &formatCount, nullptr);
     // Get supported surface formats
     if(formatCount > 0)
     {
         details.formats.resize(formatCount);
-        vkGetPhysicalDeviceSurfaceFormatsKHR(device, surface, &formatCount, details.formats.data());
+        vk.GetPhysicalDeviceSurfaceFormatsKHR(device, surface, &formatCount, details.formats.data());
     }
 
     // Get number of supported presentation modes
     type::uint32 presentModeCount;
-    vkGetPhysicalDeviceSurfacePresentModesKHR(device, surface, &presentModeCount, nullptr);
+    vk.GetPhysicalDeviceSurfacePresentModesKHR(device, surface, &presentModeCount, nullptr);
 
     if(presentModeCount > 0)
     {
         details.presentModes.resize(presentModeCount);
-        vkGetPhysicalDeviceSurfacePresentModesKHR(device, surface, &presentModeCount, details.presentModes.data());
+        vk.GetPhysicalDeviceSurfacePresentModesKHR(device, surface, &presentModeCount, details.presentModes.data());
     }
 
     return details;
@@ -8,19 +8,21 @@
 
 #include <vector>
 #include "SwapChainSupportDetails.h"
+#include "RenderTarget.h"
 #include "../NonCopyable.h"
 #include "../Types.h"
+#include "../Dispatch.h"
 
 namespace vkc
 {
     class Device;
     class Window;
 
-    class SwapChain : public NonCopyable
+    class SwapChain : public NonCopyable, public RenderTarget
     {
     public:
         explicit SwapChain(const vkc::Device& device, const vkc::Window& window);
-        ~SwapChain();
+        ~SwapChain() override;
 
         auto recreate() -> void;
         auto cleanupOld() -> void;
@@ -28,18 +30,24 @@ namespace vkc
         [[nodiscard]]
         inline auto handle() const -> const VkSwapchainKHR& { return m_swapChain; }
         [[nodiscard]]
-        inline auto imageFormat() const -> const VkFormat& { return m_imageFormat; }
+        inline auto imageFormat() const -> const VkFormat& override { return m_imageFormat; }
         [[nodiscard]]
-        inline auto extent() const -> const VkExtent2D& { return m_extent; }
+        inline auto extent() const -> const VkExtent2D& override { return m_extent; }
         [[nodiscard]]
-        inline auto numImages() const -> type::size { return m_images.size(); }
+        inline auto numImages() const -> type::size override { return m_images.size(); }
+        [[nodiscard]]
+        inline auto finalLayout() const -> VkImageLayout override { return VK_IMAGE_LAYOUT_PRESENT_SRC_KHR; }
+        [[nodiscard]]
+        inline auto imageUsage() const -> VkImageUsageFlags override { return m_imageUsage; }
 
         [[nodiscard]]
         inline auto supportDetails() const -> const vkc::SwapChainSupportDetails& { return m_supportDetails; }
         [[nodiscard]]
-        inline auto imageView(type::uint32 index) const -> VkImageView { return m_imageViews[index]; }
+        inline auto image(type::uint32 index) const -> VkImage override { return m_images[index]; }
+        [[nodiscard]]
+        inline auto imageView(type::uint32 index) const -> VkImageView override { return m_imageViews[index]; }
 
-        static auto QuerySwapChainSupport(const VkPhysicalDevice& device, const VkSurfaceKHR& surface) -> vkc::SwapChainSupportDetails;
+        static auto QuerySwapChainSupport(const vkc::InstanceDispatch& vk, const VkPhysicalDevice& device, const VkSurfaceKHR& surface) -> vkc::SwapChainSupportDetails;
         static auto ChooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities, const vkc::Window& window) -> VkExtent2D;
 
     private:
@@ -56,6 +64,7 @@ namespace vkc
 
         VkFormat m_imageFormat;
         VkExtent2D m_extent;
+        VkImageUsageFlags m_imageUsage;
 
         auto createSwapChain() -> void;
         auto createImageViews() -> void;
@@ -0,0 +1,182 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#include <atomic>
+#include <csignal>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include "FrameStats.h"
+
+namespace
+{
+    std::atomic<bool> exportRequested = false;
+
+    auto ExportSignalHandler(int) -> void
+    {
+        exportRequested.store(true, std::memory_order_relaxed);
+    }
+
+    auto ToMs(double nanoseconds) -> double { return nanoseconds / 1'000'000.0; }
+
+    auto EndsWith(const std::string& str, const std::string& suffix) -> bool
+    {
+        return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+}
+
+vkc::profile::FrameStats::FrameStats(const std::string& exportPath) :
+        m_exportPath(exportPath),
+        m_current(),
+        m_touched(0),
+        m_frames(0),
+        m_stutters(0),
+        m_averageFrame(0.0)
+{
+}
+
+vkc::profile::FrameStats::~FrameStats()
+{
+    if(m_exportPath.empty())
+    {
+        return;
+    }
+    try
+    {
+        exportTo(m_exportPath);
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+    }
+}
+
+auto vkc::profile::FrameStats::endFrame() -> void
+{
+    constexpr auto cpuIndex = static_cast<type::size>(Metric::CpuFrame);
+    if(m_touched & (1u << cpuIndex))
+    {
+        auto frame = static_cast<double>(m_current[cpuIndex]);
+        if(m_averageFrame > 0.0 && frame > m_averageFrame * StutterFactor)
+        {
+            ++m_stutters;
+        }
+        // Average over roughly the last 32 frames
+        m_averageFrame = m_averageFrame > 0.0 ? m_averageFrame + (frame - m_averageFrame) / 32.0 : frame;
+    }
+
+    for(type::size i = 0; i < m_current.size(); ++i)
+    {
+        if(m_touched & (1u << i))
+        {
+            m_histograms[i].record(m_current[i]);
+        }
+        m_current[i] = 0;
+    }
+    m_touched = 0;
+    ++m_frames;
+
+    if(exportRequested.exchange(false, std::memory_order_relaxed) && !m_exportPath.empty())
+    {
+        exportTo(m_exportPath);
+    }
+}
+
+auto vkc::profile::FrameStats::discardFrame() -> void
+{
+    m_current.fill(0);
+    m_touched = 0;
+}
+
+auto vkc::profile::FrameStats::lowFps(double fraction) const -> double
+{
+    double frameNs = histogram(Metric::CpuFrame).tailMean(fraction);
+    return frameNs > 0.0 ? 1'000'000'000.0 / frameNs : 0.0;
+}
+
+auto vkc::profile::FrameStats::writeCsv(std::ostream& out) const -> void
+{
+    out << "metric,count,min_ms,mean_ms,p50_ms,p90_ms,p99_ms,p99_9_ms,max_ms\n";
+    for(type::size i = 0; i < m_histograms.size(); ++i)
+    {
+        const auto& hist = m_histograms[i];
+        out << MetricName(static_cast<Metric>(i)) << ','
+            << hist.count() << ','
+            << ToMs(static_cast<double>(hist.min())) << ','
+            << ToMs(hist.mean()) << ','
+            << ToMs(static_cast<double>(hist.percentile(50.0))) << ','
+            << ToMs(static_cast<double>(hist.percentile(90.0))) << ','
+            << ToMs(static_cast<double>(hist.percentile(99.0))) << ','
+            << ToMs(static_cast<double>(hist.percentile(99.9))) << ','
+            << ToMs(static_cast<double>(hist.max())) << '\n';
+    }
+    out << "frames," << m_frames << '\n'
+        << "stutters," << m_stutters << '\n'
+        << "1%_low_fps," << lowFps(0.01) << '\n'
+        << "0.1%_low_fps," << lowFps(0.001) << '\n';
+}
+
+auto vkc::profile::FrameStats::writeJson(std::ostream& out) const -> void
+{
+    out << "{\n"
+        << "  \"frames\": " << m_frames << ",\n"
+        << "  \"stutters\": " << m_stutters << ",\n"
+        << "  \"onePercentLowFps\": " << lowFps(0.01) << ",\n"
+        << "  \"pointOnePercentLowFps\": " << lowFps(0.001) << ",\n"
+        << "  \"metrics\": {";
+    for(type::size i = 0; i < m_histograms.size(); ++i)
+    {
+        const auto& hist = m_histograms[i];
+        out << (i == 0 ? "\n" : ",\n")
+            << "    \"" << MetricName(static_cast<Metric>(i)) << "\": {"
+            << "\"count\": " << hist.count()
+            << ", \"minMs\": " << ToMs(static_cast<double>(hist.min()))
+            << ", \"meanMs\": " << ToMs(hist.mean())
+            << ", \"p50Ms\": " << ToMs(static_cast<double>(hist.percentile(50.0)))
+            << ", \"p90Ms\": " << ToMs(static_cast<double>(hist.percentile(90.0)))
+            << ", \"p99Ms\": " << ToMs(static_cast<double>(hist.percentile(99.0)))
+            << ", \"p999Ms\": " << ToMs(static_cast<double>(hist.percentile(99.9)))
+            << ", \"maxMs\": " << ToMs(static_cast<double>(hist.max())) << "}";
+    }
+    out << "\n  }\n}\n";
+}
+
+auto vkc::profile::FrameStats::exportTo(const std::string& path) const -> void
+{
+    std::ofstream file(path);
+    if(!file)
+    {
+        throw std::runtime_error("Failed to open frame statistics file " + path);
+    }
+
+    if(EndsWith(path, ".csv"))
+    {
+        writeCsv(file);
+    }
+    else
+    {
+        writeJson(file);
+    }
+}
+
+auto vkc::profile::FrameStats::InstallSignalHandler() -> void
+{
+#ifdef SIGUSR1
+    std::signal(SIGUSR1, ExportSignalHandler);
+#endif
+}
+
+auto vkc::profile::FrameStats::MetricName(Metric metric) -> type::cstr
+{
+    switch(metric)
+    {
+        case Metric::CpuFrame: return "cpuFrame";
+        case Metric::GpuFrame: return "gpuFrame";
+        case Metric::AcquireWait: return "acquireWait";
+        case Metric::FenceWait: return "fenceWait";
+        case Metric::Present: return "present";
+        default: return "unknown";
+    }
+}
@@ -0,0 +1,108 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#ifndef VULKANCUBE_FRAMESTATS_H
+#define VULKANCUBE_FRAMESTATS_H
+
+#include <array>
+#include <chrono>
+#include <iosfwd>
+#include <string>
+#include "../NonCopyable.h"
+#include "../Types.h"
+#include "Histogram.h"
+
+namespace vkc::profile
+{
+    // Per-frame timing collector
+    // Values are accumulated over a frame with add() and committed to the
+    // histograms by endFrame(), so metrics measured more than once per frame
+    // (i.e. multiple fence waits) are reported as a single per-frame total
+    class FrameStats : public NonCopyable
+    {
+    public:
+        enum class Metric : type::uint32
+        {
+            CpuFrame,
+            GpuFrame,
+            AcquireWait,
+            FenceWait,
+            Present,
+            Count
+        };
+
+        // Times a scope and adds the elapsed time to a metric
+        class Scope
+        {
+        public:
+            Scope(FrameStats& stats, Metric metric) : m_stats(stats), m_metric(metric), m_start(std::chrono::steady_clock::now()) {}
+            ~Scope() { m_stats.add(m_metric, std::chrono::steady_clock::now() - m_start); }
+
+            Scope(const Scope&) = delete;
+            auto operator=(const Scope&) -> Scope& = delete;
+
+        private:
+            FrameStats& m_stats;
+            Metric m_metric;
+            std::chrono::steady_clock::time_point m_start;
+        };
+
+        // A frame is counted as a stutter when it takes this many times longer than the recent average
+        static constexpr double StutterFactor = 2.0;
+
+        // Results are written to exportPath on destruction and whenever an export is
+        // requested by signal. The format is CSV if the path ends in .csv, JSON otherwise
+        // An empty path disables exporting, for callers that read the results themselves
+        explicit FrameStats(const std::string& exportPath);
+        ~FrameStats();
+
+        inline auto add(Metric metric, type::uint64 nanoseconds) -> void
+        {
+            auto index = static_cast<type::size>(metric);
+            m_current[index] += nanoseconds;
+            m_touched |= 1u << index;
+        }
+        inline auto add(Metric metric, std::chrono::steady_clock::duration duration) -> void
+        {
+            add(metric, static_cast<type::uint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()));
+        }
+
+        auto endFrame() -> void;
+        // Drops what was accumulated since the last endFrame(), for frames that were never submitted
+        auto discardFrame() -> void;
+
+        [[nodiscard]]
+        inline auto histogram(Metric metric) const -> const vkc::profile::Histogram& { return m_histograms[static_cast<type::size>(metric)]; }
+        [[nodiscard]]
+        inline auto frames() const -> type::uint64 { return m_frames; }
+        [[nodiscard]]
+        inline auto stutters() const -> type::uint64 { return m_stutters; }
+        // Average FPS of the slowest fraction of frames, i.e. 0.01 for 1% lows
+        [[nodiscard]]
+        auto lowFps(double fraction) const -> double;
+
+        auto writeCsv(std::ostream& out) const -> void;
+        auto writeJson(std::ostream& out) const -> void;
+        auto exportTo(const std::string& path) const -> void;
+
+        // Request an export from outside the frame loop with SIGUSR1 where available
+        static auto InstallSignalHandler() -> void;
+        static auto MetricName(Metric metric) -> type::cstr;
+
+    private:
+        std::string m_exportPath;
+
+        std::array<vkc::profile::Histogram, static_cast<type::size>(Metric::Count)> m_histograms;
+        std::array<type::uint64, static_cast<type::size>(Metric::Count)> m_current;
+        type::uint32 m_touched;
+
+        type::uint64 m_frames;
+        type::uint64 m_stutters;
+        // Exponential moving average of the cpu frame time, used as the stutter baseline
+        double m_averageFrame;
+    };
+}
+
+#endif //VULKANCUBE_FRAMESTATS_H
@@ -0,0 +1,103 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#include <stdexcept>
+#include "GpuTimer.h"
+#include "../Device.h"
+#include "../Instance.h"
+
+vkc::profile::GpuTimer::GpuTimer(const vkc::Device& device, type::uint32 numSlots) :
+        m_device(device),
+        m_pool(VK_NULL_HANDLE),
+        m_supported(false),
+        m_nsPerTick(0.0),
+        m_validMask(0)
+{
+    const VkPhysicalDeviceProperties& props = m_device.properties();
+
+    type::uint32 familyCount = 0;
+    m_device.instance().vk().GetPhysicalDeviceQueueFamilyProperties(m_device.physical(), &familyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> families(familyCount);
+    m_device.instance().vk().GetPhysicalDeviceQueueFamilyProperties(m_device.physical(), &familyCount, families.data());
+
+    // Timestamps are only usable if the graphics queue has valid bits for them
+    type::uint32 validBits = families[m_device.queueFamilyIndices().graphics.value()].timestampValidBits;
+    m_supported = validBits > 0 && props.limits.timestampPeriod > 0.0f;
+    m_nsPerTick = props.limits.timestampPeriod;
+    m_validMask = validBits >= 64 ? type::uint64_max : (1ull << validBits) - 1;
+
+    recreate(numSlots);
+}
+
+vkc::profile::GpuTimer::~GpuTimer()
+{
+    destroyPool();
+}
+
+auto vkc::profile::GpuTimer::recreate(type::uint32 numSlots) -> void
+{
+    destroyPool();
+    m_submitted.assign(numSlots, false);
+
+    if(!m_supported)
+        return;
+
+    VkQueryPoolCreateInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    // Begin and end timestamp per slot
+    info.queryCount = numSlots * 2;
+
+    if(m_device.vk().CreateQueryPool(m_device.logical(), &info, m_device.allocator(), &m_pool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Timestamp query pool creation failed");
+    }
+}
+
+auto vkc::profile::GpuTimer::cmdBegin(VkCommandBuffer cmd, type::uint32 slot) const -> void
+{
+    if(m_pool == VK_NULL_HANDLE)
+        return;
+
+    // Command buffers are resubmitted as is, so reset the queries every time they execute
+    m_device.vk().CmdResetQueryPool(cmd, m_pool, slot * 2, 2);
+    m_device.vk().CmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_pool, slot * 2);
+}
+
+auto vkc::profile::GpuTimer::cmdEnd(VkCommandBuffer cmd, type::uint32 slot) const -> void
+{
+    if(m_pool == VK_NULL_HANDLE)
+        return;
+
+    m_device.vk().CmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_pool, slot * 2 + 1);
+}
+
+auto vkc::profile::GpuTimer::collect(type::uint32 slot) -> std::optional<type::uint64>
+{
+    if(m_pool == VK_NULL_HANDLE || !m_submitted[slot])
+        return std::nullopt;
+
+    type::uint64 timestamps[2];
+    VkResult result = m_device.vk().GetQueryPoolResults(
+            m_device.logical(), m_pool, slot * 2, 2,
+            sizeof(timestamps), timestamps, sizeof(type::uint64),
+            VK_QUERY_RESULT_64_BIT
+            );
+    if(result != VK_SUCCESS)
+        return std::nullopt;
+
+    m_submitted[slot] = false;
+    type::uint64 ticks = (timestamps[1] - timestamps[0]) & m_validMask;
+    return static_cast<type::uint64>(static_cast<double>(ticks) * m_nsPerTick);
+}
+
+auto vkc::profile::GpuTimer::destroyPool() -> void
+{
+    if(m_pool != VK_NULL_HANDLE)
+    {
+        m_device.vk().DestroyQueryPool(m_device.logical(), m_pool, m_device.allocator());
+        m_pool = VK_NULL_HANDLE;
+    }
+}
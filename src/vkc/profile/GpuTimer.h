@@ -0,0 +1,59 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#ifndef VULKANCUBE_GPUTIMER_H
+#define VULKANCUBE_GPUTIMER_H
+
+#include <vulkan/vulkan.h>
+#include <optional>
+#include <vector>
+#include "../NonCopyable.h"
+#include "../Types.h"
+
+namespace vkc
+{
+    class Device;
+}
+
+namespace vkc::profile
+{
+    // Timestamp query pair per slot (one slot per command buffer) measuring
+    // GPU execution time of a recorded command buffer
+    class GpuTimer : public NonCopyable
+    {
+    public:
+        GpuTimer(const vkc::Device& device, type::uint32 numSlots);
+        ~GpuTimer();
+
+        // Resize to a new number of slots. Device must be idle
+        auto recreate(type::uint32 numSlots) -> void;
+
+        // Record at the start and end of the timed commands
+        auto cmdBegin(VkCommandBuffer cmd, type::uint32 slot) const -> void;
+        auto cmdEnd(VkCommandBuffer cmd, type::uint32 slot) const -> void;
+
+        inline auto markSubmitted(type::uint32 slot) -> void { if(m_pool != VK_NULL_HANDLE) m_submitted[slot] = true; }
+        // GPU time in nanoseconds of the last submission of the slot
+        // Only call once the fence of that submission has been waited on
+        auto collect(type::uint32 slot) -> std::optional<type::uint64>;
+
+        [[nodiscard]]
+        inline auto supported() const -> bool { return m_supported; }
+
+    private:
+        const vkc::Device& m_device;
+
+        VkQueryPool m_pool;
+        std::vector<bool> m_submitted;
+
+        bool m_supported;
+        double m_nsPerTick;
+        type::uint64 m_validMask;
+
+        auto destroyPool() -> void;
+    };
+}
+
+#endif //VULKANCUBE_GPUTIMER_H
@@ -0,0 +1,145 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#ifndef VULKANCUBE_HISTOGRAM_H
+#define VULKANCUBE_HISTOGRAM_H
+
+#include <array>
+#include <algorithm>
+#include <bit>
+#include "../Types.h"
+
+namespace vkc::profile
+{
+    // Fixed size log-linear histogram (same bucketing scheme as HdrHistogram)
+    // Every power of two range is split into SubBuckets/2 linear buckets, so the
+    // relative error of any recorded value is at most 2/SubBuckets (~1.6% here)
+    // Values are expected in nanoseconds and are clamped to ~18 minutes
+    class Histogram
+    {
+    public:
+        static constexpr type::uint32 SubBucketBits = 7;
+        static constexpr type::uint64 SubBuckets = 1ull << SubBucketBits;
+        static constexpr type::uint64 HalfSubBuckets = SubBuckets / 2;
+        static constexpr type::uint32 MaxMagnitude = 40;
+        static constexpr type::uint64 MaxValue = (1ull << MaxMagnitude) - 1;
+        static constexpr type::size NumBuckets = (MaxMagnitude - SubBucketBits + 2) * HalfSubBuckets;
+
+        inline auto record(type::uint64 value) -> void
+        {
+            value = std::min(value, MaxValue);
+            ++m_counts[IndexOf(value)];
+            ++m_count;
+            m_sum += value;
+            m_min = std::min(m_min, value);
+            m_max = std::max(m_max, value);
+        }
+
+        inline auto reset() -> void { *this = Histogram(); }
+
+        [[nodiscard]]
+        inline auto count() const -> type::uint64 { return m_count; }
+        [[nodiscard]]
+        inline auto sum() const -> type::uint64 { return m_sum; }
+        [[nodiscard]]
+        inline auto min() const -> type::uint64 { return m_count ? m_min : 0; }
+        [[nodiscard]]
+        inline auto max() const -> type::uint64 { return m_max; }
+        [[nodiscard]]
+        inline auto mean() const -> double { return m_count ? static_cast<double>(m_sum) / static_cast<double>(m_count) : 0.0; }
+
+        // Value at the given percentile (0-100), reported as the midpoint of the bucket it falls in
+        [[nodiscard]]
+        auto percentile(double p) const -> type::uint64
+        {
+            if(m_count == 0)
+                return 0;
+
+            auto target = static_cast<type::uint64>(static_cast<double>(m_count) * std::clamp(p, 0.0, 100.0) / 100.0 + 0.5);
+            target = std::max<type::uint64>(target, 1);
+
+            type::uint64 seen = 0;
+            for(type::size i = 0; i < NumBuckets; ++i)
+            {
+                seen += m_counts[i];
+                if(seen >= target)
+                {
+                    return std::clamp(Midpoint(i), m_min, m_max);
+                }
+            }
+            return m_max;
+        }
+
+        // Mean of the slowest fraction (0-1) of recorded values, e.g. 0.01 for "1% lows"
+        [[nodiscard]]
+        auto tailMean(double fraction) const -> double
+        {
+            if(m_count == 0)
+                return 0.0;
+
+            auto wanted = std::max<type::uint64>(1, static_cast<type::uint64>(static_cast<double>(m_count) * fraction));
+            type::uint64 taken = 0;
+            double total = 0.0;
+            for(type::size i = NumBuckets; i-- > 0 && taken < wanted;)
+            {
+                type::uint64 n = std::min(m_counts[i], wanted - taken);
+                total += static_cast<double>(n) * static_cast<double>(std::clamp(Midpoint(i), m_min, m_max));
+                taken += n;
+            }
+            return total / static_cast<double>(taken);
+        }
+
+        auto merge(const Histogram& other) -> void
+        {
+            for(type::size i = 0; i < NumBuckets; ++i)
+            {
+                m_counts[i] += other.m_counts[i];
+            }
+            m_count += other.m_count;
+            m_sum += other.m_sum;
+            m_min = std::min(m_min, other.m_min);
+            m_max = std::max(m_max, other.m_max);
+        }
+
+        static constexpr auto IndexOf(type::uint64 value) -> type::size
+        {
+            if(value < SubBuckets)
+                return static_cast<type::size>(value);
+
+            // Which power of two range the value is in, relative to the linear range
+            type::uint32 magnitude = static_cast<type::uint32>(std::bit_width(value)) - SubBucketBits;
+            type::uint64 sub = value >> magnitude;
+            return static_cast<type::size>(magnitude * HalfSubBuckets + sub);
+        }
+
+        static constexpr auto LowestValue(type::size index) -> type::uint64
+        {
+            if(index < SubBuckets)
+                return index;
+
+            type::uint64 magnitude = index / HalfSubBuckets - 1;
+            type::uint64 sub = index - magnitude * HalfSubBuckets;
+            return sub << magnitude;
+        }
+
+        static constexpr auto Midpoint(type::size index) -> type::uint64
+        {
+            if(index < SubBuckets)
+                return index;
+
+            type::uint64 magnitude = index / HalfSubBuckets - 1;
+            return LowestValue(index) + ((1ull << magnitude) >> 1);
+        }
+
+    private:
+        std::array<type::uint64, NumBuckets> m_counts = {};
+        type::uint64 m_count = 0;
+        type::uint64 m_sum = 0;
+        type::uint64 m_min = type::uint64_max;
+        type::uint64 m_max = 0;
+    };
+}
+
+#endif //VULKANCUBE_HISTOGRAM_H
@@ -0,0 +1,169 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include "Profiler.h"
+
+std::atomic<bool> vkc::profile::Active = false;
+thread_local constinit vkc::profile::EventRing* vkc::profile::ThreadRing = nullptr;
+
+namespace
+{
+    // Rings are shared with the registry so events recorded by a thread
+    // that already exited can still be flushed
+    std::mutex registryMutex;
+    std::vector<std::shared_ptr<vkc::profile::EventRing>> registry;
+}
+
+auto vkc::profile::RegisterThread() -> vkc::profile::EventRing*
+{
+    std::lock_guard lock(registryMutex);
+    auto ring = std::make_shared<EventRing>(static_cast<type::uint32>(registry.size()));
+    registry.push_back(ring);
+    ThreadRing = ring.get();
+    return ThreadRing;
+}
+
+vkc::profile::Profiler::Profiler(const std::string& tracePath, std::chrono::milliseconds flushInterval) :
+        m_trace(tracePath),
+        m_firstEvent(true),
+        m_flushInterval(flushInterval),
+        m_startTicks(Now()),
+        m_startTime(std::chrono::steady_clock::now()),
+        m_nsPerTick(1e9 * std::chrono::steady_clock::period::num / std::chrono::steady_clock::period::den),
+        m_stop(false)
+{
+    if(!m_trace)
+    {
+        throw std::runtime_error("Failed to open trace file " + tracePath);
+    }
+
+    // Chrome trace event format, object form so a summary can be appended on shutdown
+    m_trace << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+
+    Active.store(true, std::memory_order_relaxed);
+    m_thread = std::thread(&Profiler::run, this);
+}
+
+vkc::profile::Profiler::~Profiler()
+{
+    Active.store(false, std::memory_order_relaxed);
+    {
+        std::lock_guard lock(m_wakeMutex);
+        m_stop = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+
+    // Pick up anything pushed between the last flush and deactivation
+    flush();
+
+    std::lock_guard lock(m_zonesMutex);
+    m_trace << "\n],\"zoneSummary\":{";
+    bool first = true;
+    for(const auto& [name, hist] : m_zones)
+    {
+        m_trace << (first ? "" : ",") << "\n\"" << name << "\":{"
+                << "\"count\":" << hist.count()
+                << ",\"minNs\":" << hist.min()
+                << ",\"avgNs\":" << static_cast<type::uint64>(hist.mean())
+                << ",\"p99Ns\":" << hist.percentile(99.0)
+                << ",\"maxNs\":" << hist.max() << "}";
+        first = false;
+    }
+    m_trace << "\n}}\n";
+}
+
+auto vkc::profile::Profiler::printSummary(std::ostream& out) -> void
+{
+    flush();
+    std::lock_guard lock(m_zonesMutex);
+
+    out << std::left << std::setw(40) << "Zone"
+        << std::right << std::setw(10) << "Count"
+        << std::setw(12) << "Min(us)"
+        << std::setw(12) << "Avg(us)"
+        << std::setw(12) << "P99(us)" << '\n';
+    out << std::fixed << std::setprecision(2);
+    for(const auto& [name, hist] : m_zones)
+    {
+        out << std::left << std::setw(40) << name
+            << std::right << std::setw(10) << hist.count()
+            << std::setw(12) << hist.min() / 1000.0
+            << std::setw(12) << hist.mean() / 1000.0
+            << std::setw(12) << hist.percentile(99.0) / 1000.0 << '\n';
+    }
+    out << std::defaultfloat;
+}
+
+auto vkc::profile::Profiler::run() -> void
+{
+    std::unique_lock lock(m_wakeMutex);
+    while(!m_stop)
+    {
+        m_wake.wait_for(lock, m_flushInterval, [this] { return m_stop; });
+        lock.unlock();
+        flush();
+        lock.lock();
+    }
+}
+
+auto vkc::profile::Profiler::flush() -> void
+{
+    std::vector<std::shared_ptr<EventRing>> rings;
+    {
+        std::lock_guard lock(registryMutex);
+        rings = registry;
+    }
+
+    // Holding the zone lock also keeps this the only consumer of the rings
+    std::lock_guard lock(m_zonesMutex);
+    calibrate();
+    for(auto& ring : rings)
+    {
+        type::uint32 tid = ring->threadId();
+        ring->drain([this, tid](const ZoneEvent& event) {
+            type::uint64 begin = toNanoseconds(event.begin);
+            type::uint64 end = toNanoseconds(event.end);
+            type::uint64 duration = end > begin ? end - begin : 0;
+
+            m_zones[event.name].record(duration);
+
+            // Complete ("X") events carry begin and duration, timestamps are in microseconds
+            m_trace << (m_firstEvent ? "" : ",\n")
+                    << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << tid
+                    << ",\"ts\":" << begin / 1000 << '.' << std::setw(3) << std::setfill('0') << begin % 1000
+                    << ",\"dur\":" << duration / 1000 << '.' << std::setw(3) << std::setfill('0') << duration % 1000
+                    << std::setfill(' ') << '}';
+            m_firstEvent = false;
+        });
+    }
+    m_trace.flush();
+}
+
+auto vkc::profile::Profiler::calibrate() -> void
+{
+#ifdef VKC_PROFILER_TSC
+    // Refine the tick rate against the steady clock, the longer the run the more accurate it gets
+    type::uint64 ticks = Now() - m_startTicks;
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_startTime).count();
+    if(ticks > 0 && elapsed > 0)
+    {
+        m_nsPerTick = static_cast<double>(elapsed) / static_cast<double>(ticks);
+    }
+#endif
+}
+
+auto vkc::profile::Profiler::toNanoseconds(type::uint64 ticks) const -> type::uint64
+{
+    // Relative to profiler start. Events from before then are clamped to zero
+    if(ticks < m_startTicks)
+        return 0;
+    return static_cast<type::uint64>(static_cast<double>(ticks - m_startTicks) * m_nsPerTick);
+}
@@ -0,0 +1,179 @@
+/**
+  * Created by Earl Kennedy
+  * https://github.com/Mnenmenth
+  */
+
+#ifndef VULKANCUBE_PROFILER_H
+#define VULKANCUBE_PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <iosfwd>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "../NonCopyable.h"
+#include "../Types.h"
+#include "Histogram.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define VKC_PROFILER_TSC
+#elif defined(_M_X64)
+#include <intrin.h>
+#define VKC_PROFILER_TSC
+#endif
+
+namespace vkc::profile
+{
+    // Raw timestamp, in CPU ticks where an invariant TSC is available
+    // Ticks are converted to nanoseconds on the flush thread so zones never pay for it
+    inline auto Now() -> type::uint64
+    {
+#ifdef VKC_PROFILER_TSC
+        return __rdtsc();
+#else
+        return static_cast<type::uint64>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    struct ZoneEvent
+    {
+        const char* name;
+        type::uint64 begin;
+        type::uint64 end;
+    };
+
+    // Single producer, single consumer ring of zone events
+    // The owning thread pushes, the profiler flush thread pops
+    class EventRing : public NonCopyable
+    {
+    public:
+        static constexpr type::size Capacity = 1 << 14;
+
+        explicit EventRing(type::uint32 threadId) : m_threadId(threadId) {}
+
+        inline auto push(const ZoneEvent& event) -> void
+        {
+            type::uint64 head = m_head.load(std::memory_order_relaxed);
+            // Only re-read the consumer position when the ring looks full
+            if(head - m_cachedTail >= Capacity)
+            {
+                m_cachedTail = m_tail.load(std::memory_order_acquire);
+                if(head - m_cachedTail >= Capacity)
+                {
+                    m_dropped.store(m_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                    return;
+                }
+            }
+            m_events[head & (Capacity - 1)] = event;
+            m_head.store(head + 1, std::memory_order_release);
+        }
+
+        // Consumer side. Calls func for every pending event and returns how many were read
+        template<typename Func>
+        auto drain(Func&& func) -> type::size
+        {
+            type::uint64 tail = m_tail.load(std::memory_order_relaxed);
+            type::uint64 head = m_head.load(std::memory_order_acquire);
+            for(type::uint64 i = tail; i < head; ++i)
+            {
+                func(m_events[i & (Capacity - 1)]);
+            }
+            m_tail.store(head, std::memory_order_release);
+            return static_cast<type::size>(head - tail);
+        }
+
+        [[nodiscard]]
+        inline auto threadId() const -> type::uint32 { return m_threadId; }
+        [[nodiscard]]
+        inline auto dropped() const -> type::uint64 { return m_dropped.load(std::memory_order_relaxed); }
+
+    private:
+        alignas(64) std::atomic<type::uint64> m_head = 0;
+        type::uint64 m_cachedTail = 0;
+        std::atomic<type::uint64> m_dropped = 0;
+        alignas(64) std::atomic<type::uint64> m_tail = 0;
+
+        type::uint32 m_threadId;
+        ZoneEvent m_events[Capacity];
+    };
+
+    // Set while a Profiler is running, zones are discarded otherwise
+    extern std::atomic<bool> Active;
+    // Current thread's ring. Null until the thread records its first zone
+    extern thread_local constinit EventRing* ThreadRing;
+    auto RegisterThread() -> EventRing*;
+
+    // Scoped zone. Records a single event holding both the begin and end timestamp
+    // when it goes out of scope
+    class Zone
+    {
+    public:
+        explicit Zone(const char* name) : m_name(name), m_begin(Now()) {}
+        ~Zone()
+        {
+            if(Active.load(std::memory_order_relaxed))
+            {
+                type::uint64 end = Now();
+                EventRing* ring = ThreadRing ? ThreadRing : RegisterThread();
+                ring->push({m_name, m_begin, end});
+            }
+        }
+
+        Zone(const Zone&) = delete;
+        auto operator=(const Zone&) -> Zone& = delete;
+
+    private:
+        const char* m_name;
+        type::uint64 m_begin;
+    };
+
+    // Drains every thread's ring on a background thread, streams the events to a
+    // Chrome trace event file and keeps per-zone duration histograms
+    class Profiler : public NonCopyable
+    {
+    public:
+        explicit Profiler(const std::string& tracePath, std::chrono::milliseconds flushInterval = std::chrono::milliseconds(10));
+        ~Profiler();
+
+        // Flushes pending events, then prints per-zone count, min, avg and p99 in microseconds
+        auto printSummary(std::ostream& out) -> void;
+
+    private:
+        std::ofstream m_trace;
+        bool m_firstEvent;
+        std::chrono::milliseconds m_flushInterval;
+
+        // Tick to nanosecond calibration
+        type::uint64 m_startTicks;
+        std::chrono::steady_clock::time_point m_startTime;
+        double m_nsPerTick;
+
+        std::map<std::string, vkc::profile::Histogram> m_zones;
+        std::mutex m_zonesMutex;
+
+        std::thread m_thread;
+        std::mutex m_wakeMutex;
+        std::condition_variable m_wake;
+        bool m_stop;
+
+        auto run() -> void;
+        auto flush() -> void;
+        auto calibrate() -> void;
+        auto toNanoseconds(type::uint64 ticks) const -> type::uint64;
+    };
+}
+
+#ifdef VKC_PROFILER
+#define VKC_ZONE_CONCAT_IMPL(a, b) a##b
+#define VKC_ZONE_CONCAT(a, b) VKC_ZONE_CONCAT_IMPL(a, b)
+#define VKC_ZONE(name) ::vkc::profile::Zone VKC_ZONE_CONCAT(vkcZone_, __COUNTER__)(name)
+#else
+#define VKC_ZONE(name) ((void)0)
+#endif
+
+#endif //VULKANCUBE_PROFILER_H
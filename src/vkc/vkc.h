@@ -15,6 +15,7 @@
 #include "pipeline/QueueFamilyIndices.h"
 #include "pipeline/QueueFamily.h"
 #include "pipeline/SwapChainSupportDetails.h"
+#include "pipeline/RenderTarget.h"
 #include "pipeline/SwapChain.h"
 #include "Types.h"
 